@@ -5,18 +5,25 @@ void check_outliers( int t, Array2D<double>& lik, vector<double>& meanlik,
 {
   int t0 = t/2;
   int numChains = lik.n_y();
-  double Q1;
-  double Q3;
-  double IQR;
-  double UR;
-  vector<double> liksrt(numChains);
   if ((int) meanlik.size() < numChains) 
     meanlik.resize(numChains, -INFINITY);
   
-  for (int i(0); i < numChains; ++i) {
+  for (int i(0); i < numChains; ++i)
     meanlik[i] = gsl_stats_mean(lik.pt(t0,i), numChains, t - t0);
-    liksrt[i] = meanlik[i];
-  }
+  check_outliers_from_means(meanlik, outliers);
+}
+
+
+// PE: outlier detection given the mean log-likelihood of each chain (e.g., from
+// running statistics)
+void check_outliers_from_means( const vector<double>& meanlik, vector<bool>& outliers )
+{
+  int numChains = meanlik.size();
+  double Q1;
+  double Q3;
+  double IQR;
+  double UR;
+  vector<double> liksrt(meanlik.begin(), meanlik.end());
   
   sort(liksrt.begin(), liksrt.end());
   Q1 = gsl_stats_quantile_from_sorted_data(liksrt.data() ,1 ,liksrt.size() ,0.25);
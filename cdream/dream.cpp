@@ -36,6 +36,8 @@
 #include <algorithm>
 #include <map>
 #include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>   // [PE] for truncate()
 using namespace std;
 
 #include <gsl/gsl_math.h>
@@ -51,6 +53,145 @@ using namespace std;
 
 #include "model_object.h"
 #include "utilities_pub.h"
+#include "checkpoint.h"
+
+
+// PE: Small per-chain cache of recently evaluated (state, likelihood) pairs, so
+// that re-proposing an already-evaluated state doesn't require computing a new
+// model image. Only valid for deterministic likelihood functions. Each chain's
+// cache is a ring buffer of nSlots entries; lookup requires exact equality.
+class LikelihoodCache {
+public:
+  LikelihoodCache( int numChains, int cacheSize, int numVars ) :
+    nSlots(cacheSize), nvar(numVars), nHits(0),
+    states(numChains, max(cacheSize, 1), numVars), liks(numChains, max(cacheSize, 1)),
+    nStored(numChains, 0), nextSlot(numChains, 0)
+  { }
+
+  bool Lookup( int chain, const double* theState, double& likValue )
+  {
+    for (int k = 0; k < nStored[chain]; ++k) {
+      if (memcmp(states.pt(chain, k), theState, nvar*sizeof(double)) == 0) {
+        likValue = liks(chain, k);
+        ++nHits;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Store( int chain, const double* theState, double likValue )
+  {
+    if (nSlots <= 0)
+      return;
+    int k = nextSlot[chain];
+    memcpy(states.pt(chain, k), theState, nvar*sizeof(double));
+    liks(chain, k) = likValue;
+    nextSlot[chain] = (k + 1) % nSlots;
+    if (nStored[chain] < nSlots)
+      ++nStored[chain];
+  }
+
+  int NumHits( ) { return nHits; }
+
+private:
+  int nSlots, nvar, nHits;
+  Array3D<double> states;
+  Array2D<double> liks;
+  vector<int> nStored;
+  vector<int> nextSlot;
+};
+
+
+// PE: Chain history for windowed mode, where state and lik only hold the most
+// recent nHist generations (generation g is stored in row g % nHist). Older
+// generations -- which are still needed when samples are removed from the start
+// of the running-statistics windows -- are appended to a binary file (one record
+// per generation: state values followed by likelihood values) and read back on
+// demand. With nHist = 0, everything is in memory and the file isn't used.
+class ChainHistory {
+public:
+  ChainHistory( Array3D<double>& theState, Array2D<double>& theLik, int historySize ) :
+    state(theState), lik(theLik), nHist(historySize), historyFile(NULL),
+    nState(theState.n_y()*theState.n_z()), nLik(theLik.n_y()),
+    buffer(nState + nLik, 0.0)
+  { }
+
+  ~ChainHistory( )
+  {
+    if (historyFile != NULL) {
+      fclose(historyFile);
+      if (filename != "")
+        remove(filename.c_str());
+    }
+  }
+
+  // returns false if the history file couldn't be opened; if reopen = true,
+  // we continue using the existing file (when resuming from a checkpoint)
+  bool Open( const string& rootName, bool reopen = false )
+  {
+    if (nHist <= 0)
+      return true;
+    if (rootName != "" && rootName != "-") {
+      filename = rootName + ".history.bin";
+      historyFile = fopen(filename.c_str(), (reopen) ? "r+b" : "w+b");
+    } else
+      historyFile = tmpfile();
+    return (historyFile != NULL);
+  }
+
+  // saves generation gen (which must currently be in memory) to the file
+  void Append( int gen )
+  {
+    if (historyFile == NULL)
+      return;
+    int row = gen % nHist;
+    fseeko(historyFile, RecordOffset(gen), SEEK_SET);
+    fwrite(state.pt(row,0,0), sizeof(double), nState, historyFile);
+    fwrite(lik.pt(row,0), sizeof(double), nLik, historyFile);
+  }
+
+  // state (all chains) for generation gen, when the current generation is t
+  const double* StateRow( int gen, int t )
+  {
+    if (nHist <= 0)
+      return state.pt(gen,0,0);
+    if (gen > t - nHist)
+      return state.pt(gen % nHist,0,0);
+    ReadRecord(gen);
+    return buffer.data();
+  }
+
+  // likelihoods (all chains) for generation gen, when the current generation is t
+  const double* LikRow( int gen, int t )
+  {
+    if (nHist <= 0)
+      return lik.pt(gen,0);
+    if (gen > t - nHist)
+      return lik.pt(gen % nHist,0);
+    ReadRecord(gen);
+    return buffer.data() + nState;
+  }
+
+private:
+  off_t RecordOffset( int gen ) { return (off_t)gen*(nState + nLik)*sizeof(double); }
+
+  void ReadRecord( int gen )
+  {
+    fseeko(historyFile, RecordOffset(gen), SEEK_SET);
+    if (fread(buffer.data(), sizeof(double), nState + nLik, historyFile) != (size_t)(nState + nLik))
+      fprintf(stderr, "DREAM: error reading generation %d from chain-history file!\n", gen);
+  }
+
+  Array3D<double>& state;
+  Array2D<double>& lik;
+  int nHist;
+  FILE* historyFile;
+  string filename;
+  int nState, nLik;
+  vector<double> buffer;
+};
+
 
 
 int dream( const dream_pars* p, rng::RngStream* rng )
@@ -77,8 +218,21 @@ int dream( const dream_pars* p, rng::RngStream* rng )
   }
   
   // MCMC chains
-  Array3D<double> state(p->maxEvals, p->numChains, p->nvar);
-  Array2D<double> lik(p->maxEvals + 1, p->numChains);
+  // PE: with a history window, only the most recent nHist generations are kept
+  // in memory (older generations go to a binary history file)
+  int nHist = p->maxEvals;
+  int historyWindow = 0;
+  if (p->historyWindow > 0 && p->historyWindow < p->maxEvals) {
+    if (p->appendFile) {
+      if (p->verboseLevel > 0)
+        printf("History window is not used when resuming; keeping all generations in memory.\n");
+    } else {
+      historyWindow = max(p->historyWindow, MIN_HISTORY_WINDOW);
+      nHist = historyWindow;
+    }
+  }
+  Array3D<double> state(nHist, p->numChains, p->nvar);
+  Array2D<double> lik(nHist, p->numChains);
 
   Array2D<double> proposal(p->numChains, p->nvar);
   Array2D<double> proposal_two(p->numChains, p->nvar);
@@ -91,12 +245,46 @@ int dream( const dream_pars* p, rng::RngStream* rng )
   // PE: needed for easier printing of individual steps
   double *tempParams = (double *)malloc(p->nvar * sizeof(double));
 
+  // =========================================================================
+  // PE: checkpoints require chain files (so we can record how much of each has
+  // been written) and an RNG whose state can be saved
+
+  bool checkpointing = (p->checkpointFile != "" && p->outputRootname != "" 
+                        && p->outputRootname != "-" && rng->state_size() > 0);
+  if (p->checkpointFile != "" && ! checkpointing)
+    fprintf(stderr, "DREAM: checkpoints not possible without chain output files; ignoring.\n");
+  CheckpointWriter checkpointWriter;
+  CheckpointReader checkpointReader;
+  bool resumed = false;
+  vector<int64_t> chainFileSizes(p->numChains, 0);
+  if (checkpointing && p->resume) {
+    int savedDims[5] = {0, 0, 0, 0, 0};
+    if (checkpointReader.Open(p->checkpointFile, "DREAM")) {
+      checkpointReader.GetArray(savedDims, 5);
+      checkpointReader.GetArray(chainFileSizes.data(), p->numChains);
+      resumed = (savedDims[0] == p->nvar && savedDims[1] == p->numChains && savedDims[2] == p->nCR
+                 && savedDims[3] == p->loopSteps && savedDims[4] == nHist);
+    }
+    if (! resumed)
+      fprintf(stderr, "DREAM: unable to resume from checkpoint file \"%s\"; starting from scratch.\n", 
+              p->checkpointFile.c_str());
+  }
+
   // =========================================================================
   // read previous state
 
-  int prevLines = dream_restore_state(p, state, lik, pCR, inBurnIn);
-  if (prevLines < 0) {
-    fprintf(stderr, "DREAM: previous MCMC output files not found!\n");
+  int prevLines = 0;
+  if (! resumed) {
+    prevLines = dream_restore_state(p, state, lik, pCR, inBurnIn);
+    if (prevLines < 0) {
+      fprintf(stderr, "DREAM: previous MCMC output files not found!\n");
+      return DREAM_EXIT_NO_OUTPUT_FILES;
+    }
+  }
+  ChainHistory history(state, lik, historyWindow);
+  if (! history.Open(p->outputRootname, resumed)) {
+    fprintf(stderr, "DREAM: unable to open chain-history file!\n");
+    free(tempParams);
     return DREAM_EXIT_NO_OUTPUT_FILES;
   }
   // =========================================================================
@@ -104,7 +292,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
 
   ostringstream chainFilename;
   vector<ostream*> oout;
-  ios_base::openmode fmode = (p->appendFile) ? (ios_base::out | ios_base::app) : ios_base::out;
+  ios_base::openmode fmode = (p->appendFile || resumed) ? (ios_base::out | ios_base::app) : ios_base::out;
 
   // PE: changed output chain-file names so they start with 1, not 0
   oout.resize(p->numChains, &cout);
@@ -112,9 +300,16 @@ int dream( const dream_pars* p, rng::RngStream* rng )
     for (int i = 0; i < p->numChains; ++i) {
       chainFilename.str("");
       chainFilename << p->outputRootname << "." << i + 1 << ".txt";
+      if (resumed) {
+        // PE: discard anything written after the checkpoint, then continue the file
+        if (truncate(chainFilename.str().c_str(), (off_t)chainFileSizes[i]) != 0)
+          fprintf(stderr, "DREAM: unable to truncate chain file \"%s\"!\n", chainFilename.str().c_str());
+      }
       oout[i] = new ofstream(chainFilename.str().c_str(), fmode);
       oout[i]->setf(ios::scientific, ios::floatfield);
       oout[i]->precision(12);
+      if (resumed)
+        continue;
       for (int n = 0; n < p->outputHeaderLines.size(); n++)
         *oout[i] << p->outputHeaderLines[n];
       if (p->appendFile)
@@ -127,7 +322,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
 
   int do_calc(1);
 
-  if (! p->appendFile) {
+  if (! p->appendFile && ! resumed) {
     Array2DView<double> initVar(state.n_y(), state.n_z(), state.pt(0,0,0));
     ArrayView<double> initLik(lik.n_y(), lik.pt(0,0));
     dream_initialize(p, rng, initVar, initLik);
@@ -156,8 +351,15 @@ int dream( const dream_pars* p, rng::RngStream* rng )
   int numAccepted = 0;
   int ireport = 0;
   double drand = 0.0;
+  bool recalcPrevLik = false;
+  bool earlyRejection = (p->earlyRejection && p->boundedFun != NULL);
+  double minLik;
 
   vector<int> acceptStep(p->numChains, 0);
+  // PE: for early rejection, Metropolis uniform deviates are drawn *before* the
+  // proposals are evaluated (-1 = no deviate drawn for this chain)
+  vector<double> acceptDraw(p->numChains, -1.0);
+  LikelihoodCache likCache(p->numChains, (p->deterministicLik) ? p->likCacheSize : 0, p->nvar);
 
   vector<double> pairDiff(p->nvar);
   vector<double> e(p->nvar);
@@ -182,7 +384,69 @@ int dream( const dream_pars* p, rng::RngStream* rng )
   double delta_sum(0.0);
   double pCR_sum(0.0);
 
+  // PE: running within-chain statistics for the convergence (state) and outlier
+  // (lik) diagnostics, updated each generation so the checks don't have to
+  // rescan the chain history
+  RunningStats stateStats(p->numChains, p->nvar);
+  RunningStats likStats(p->numChains, 1);
+  for (int g = 0; g < prevLines; ++g) {
+    stateStats.Add(history.StateRow(g, prevLines));
+    likStats.Add(history.LikRow(g, prevLines));
+  }
+
+  // PE: restore everything else from the checkpoint (sizes were checked above)
+  vector<double> statsMoments(stateStats.MomentsSize());
+  vector<char> rngState(rng->state_size());
+  int statsCount, statsFirst, statsNext;
+  if (resumed) {
+    int firstRow;
+    checkpointReader.Get(prevLines);
+    checkpointReader.Get(genNumber);
+    checkpointReader.Get(inBurnIn);
+    checkpointReader.Get(burnInStart);
+    checkpointReader.Get(curRun);
+    checkpointReader.Get(numAccepted);
+    checkpointReader.Get(ireport);
+    checkpointReader.Get(nLikelihoodEvals);
+    checkpointReader.GetArray(pCR.data(), p->nCR);
+    checkpointReader.GetArray(delta_tot.data(), p->nCR);
+    checkpointReader.GetArray(L.data(), p->nCR);
+    checkpointReader.GetArray(totalSteps.data(), p->nCR);
+    checkpointReader.GetArray(CRm.pt(), p->numChains*p->loopSteps);
+    checkpointReader.GetArray(bstar.data(), p->nvar);
+    checkpointReader.Get(firstRow);
+    for (int g = firstRow; g <= prevLines; ++g) {
+      checkpointReader.GetArray(state.pt(g % nHist, 0, 0), p->numChains*p->nvar);
+      checkpointReader.GetArray(lik.pt(g % nHist, 0), p->numChains);
+    }
+    checkpointReader.Get(statsCount);
+    checkpointReader.Get(statsFirst);
+    checkpointReader.Get(statsNext);
+    checkpointReader.GetArray(statsMoments.data(), stateStats.MomentsSize());
+    stateStats.SetState(statsCount, statsFirst, statsNext, statsMoments.data());
+    checkpointReader.Get(statsCount);
+    checkpointReader.Get(statsFirst);
+    checkpointReader.Get(statsNext);
+    checkpointReader.GetArray(statsMoments.data(), likStats.MomentsSize());
+    likStats.SetState(statsCount, statsFirst, statsNext, statsMoments.data());
+    checkpointReader.GetArray(rngState.data(), rngState.size());
+    if (! checkpointReader.Finished()) {
+      fprintf(stderr, "DREAM: checkpoint file \"%s\" is incomplete or corrupted!\n", 
+              p->checkpointFile.c_str());
+      for (int i = 0; i < p->numChains; ++i)
+        if (oout[i] != &cout) 
+          delete oout[i];
+      free(tempParams);
+      return DREAM_EXIT_ERROR;
+    }
+    rng->set_state(rngState.data());
+    if (p->verboseLevel > 0)
+      printf("Resuming DREAM from checkpoint after generation %d.\n", prevLines);
+  }
+
   for (int t = prevLines + 1; t < p->maxEvals; ++t) {   // loop over time/generations
+    int cur = t % nHist;
+    int prev = (t - 1) % nHist;
 
     // beginning of loop, generate crossover probabilities
     if (genNumber == 0) { 
@@ -200,7 +464,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
       // generate proposal
       // PE: i = chain index, j = variable index
       for (int j = 0; j < p->nvar; ++j) 
-        proposal(i,j) = state(t - 1, i, j);
+        proposal(i,j) = state(prev, i, j);
       // pick pairs
       vector<int> r1(delta, 0);
       vector<int> r2(delta, 0);
@@ -229,7 +493,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
           pairDiff[j] = 0.0;
           for (int a(0); a < delta; ++a) {
             if (r1[a] != r2[a]) 
-              pairDiff[j] += state(t - 1, r1[a], j) - state(t - 1, r2[a], j);
+              pairDiff[j] += state(prev, r1[a], j) - state(prev, r2[a], j);
           }
           // check for crossover events
           crossRate = 1.0*CRm(i, genNumber) / p->nCR;
@@ -254,17 +518,21 @@ int dream( const dream_pars* p, rng::RngStream* rng )
             // calculate step for this dimension
             step[j] = (1 + e[j])*gamma*pairDiff[j] + epsilon[j];
             // update proposal
-            proposal(i,j) = state(t - 1,i,j) + step[j];
+            proposal(i,j) = state(prev,i,j) + step[j];
           } else {
-            proposal(i,j) = state(t - 1,i,j);
+            proposal(i,j) = state(prev,i,j);
           }
         }
       } else {   // PE: entire proposal is actually identical to current state
-        for (int j = 0; j < p->nvar; ++j) proposal(i,j) = state(t - 1,i,j);
+        for (int j = 0; j < p->nvar; ++j) proposal(i,j) = state(prev,i,j);
         }
     }  // end of loop(i) over chains
 
 
+    // PE: likelihood of the current state only needs to be recalculated if the
+    // likelihood function is non-deterministic
+    recalcPrevLik = (p->recalcLik + inBurnIn > 0) && (! p->deterministicLik);
+
     for (int i = 0; i < p->numChains; ++i) {
       // loop over individual chains to calculate likelihoods of proposals
       // and determine acceptances
@@ -278,35 +546,59 @@ int dream( const dream_pars* p, rng::RngStream* rng )
             }
           }
         }
-        if (p->recalcLik + inBurnIn > 0) {
-          lik(t - 1,i) = p->fun(i, t - 1, state.pt(t - 1, i), p->extraData, true);
+        if (recalcPrevLik) {
+          lik(prev,i) = p->fun(i, t - 1, state.pt(prev, i), p->extraData, true);
           nLikelihoodEvals++;
         }
-        if (do_calc) {
-          lik(t,i) = p->fun(i, t, proposal(i), p->extraData, false);
-          nLikelihoodEvals++;
-          // if (p->vflag) cout << ". Likelihood = " << lik(t,i) << endl;
+        acceptDraw[i] = -1.0;
+        if (do_calc && earlyRejection) {
+          // proposal will be accepted only if lik(cur,i) > lik(t-1,i) + log(u)
+          rng->uniform(1, &drand);
+          acceptDraw[i] = drand;
+          minLik = lik(prev,i) + log(drand);
+          if (! likCache.Lookup(i, proposal(i), lik(cur,i))) {
+            lik(cur,i) = p->boundedFun(i, t, proposal(i), p->extraData, minLik);
+            nLikelihoodEvals++;
+            // values below minLik may be from an incomplete evaluation, so don't cache them
+            if (lik(cur,i) >= minLik)
+              likCache.Store(i, proposal(i), lik(cur,i));
+          }
+        } else if (do_calc) {
+          if (! likCache.Lookup(i, proposal(i), lik(cur,i))) {
+            lik(cur,i) = p->fun(i, t, proposal(i), p->extraData, false);
+            nLikelihoodEvals++;
+            likCache.Store(i, proposal(i), lik(cur,i));
+          }
+          // if (p->vflag) cout << ". Likelihood = " << lik(cur,i) << endl;
         } else
-          lik(t,i) = -INFINITY;
+          lik(cur,i) = -INFINITY;
       } else {
+        acceptDraw[i] = -1.0;
         for (int j = 0; j < p->nvar; ++j) 
-          proposal(i,j) = state(t - 1,i,j);
-        if (p->recalcLik + inBurnIn > 0) {
-          lik(t,i) = p->fun(i, t, proposal(i), p->extraData, true);
+          proposal(i,j) = state(prev,i,j);
+        if (recalcPrevLik) {
+          lik(cur,i) = p->fun(i, t, proposal(i), p->extraData, true);
           nLikelihoodEvals++;
         } else {
-          lik(t,i) = lik(t - 1,i);
+          lik(cur,i) = lik(prev,i);
         }
       }
     }
 
     for (int i = 0; i < p->numChains; ++i) {
-      double newLikelihood = lik(t,i);
-      double prevLikelihood = lik(t - 1,i);
+      double newLikelihood = lik(cur,i);
+      double prevLikelihood = lik(prev,i);
       if (newLikelihood == -INFINITY) 
         acceptStep[i] = 0;
       else if (newLikelihood >= prevLikelihood) 
         acceptStep[i] = 1;
+      else if (acceptDraw[i] >= 0.0) {
+        // early-rejection mode: use the uniform deviate drawn before evaluation
+        if (log(acceptDraw[i]) < newLikelihood - prevLikelihood) 
+          acceptStep[i] = 1;
+        else 
+          acceptStep[i] = 0;
+      }
       else {
         rng->uniform(1, &drand);
         if (log(drand) < newLikelihood - prevLikelihood) 
@@ -322,13 +614,15 @@ int dream( const dream_pars* p, rng::RngStream* rng )
       if (acceptStep[i]) {
         ++numAccepted;
         for (int j = 0; j < p->nvar; ++j) 
-          state(t,i,j) = proposal(i,j);
+          state(cur,i,j) = proposal(i,j);
       } else {
         for (int j = 0; j < p->nvar; ++j)
-          state(t,i,j) = state(t - 1,i,j);
-        lik(t,i) = lik(t - 1,i);
+          state(cur,i,j) = state(prev,i,j);
+        lik(cur,i) = lik(prev,i);
       }
     }  // end of loop(i) over individual chains
+    // (lik(t - 1) is final only now, since it may have been recalculated)
+    likStats.Add(history.LikRow(t - 1, t));
 
 
     // ---------------------------------------------------------------------
@@ -336,7 +630,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
     if (inBurnIn && p->pCR_update) {
       // get standard deviations between the chains
       for (int j = 0; j < p->nvar; ++j) {
-        sd[j] = gsl_stats_sd(state.pt(t,0,j), p->nvar, p->numChains);
+        sd[j] = gsl_stats_sd(state.pt(cur,0,j), p->nvar, p->numChains);
 //          if (! p->varLock[j] && sd[j] == 0.0) {
 //            bstar[j] *= 2;
 //            cerr << "Variable " << j << " has collapsed. Increasing stochasticity to " << bstar[j] << "." << endl;
@@ -348,7 +642,7 @@ int dream( const dream_pars* p, rng::RngStream* rng )
           delta_normX[i] = 0.0;
           for (int j = 0; j < p->nvar; ++j) {
             if (! p->varLock[j] && sd[j] > 0.0) {
-              delta_normX[i] += gsl_pow_2((state(t,i,j) - state(t - 1,i,j))/sd[j]);
+              delta_normX[i] += gsl_pow_2((state(cur,i,j) - state(prev,i,j))/sd[j]);
             }
           }
           delta_tot[CRm(i, genNumber) - 1] += delta_normX[i];
@@ -389,14 +683,19 @@ int dream( const dream_pars* p, rng::RngStream* rng )
         // remove outlier chains
         vector<double> meanlik(p->numChains, -INFINITY);
         vector<bool> outliers(p->numChains, false);
-        check_outliers(t, lik, meanlik, outliers);
+        // outlier window = generations [t/2, t - 1]
+        while (likStats.FirstGen() < t/2 && likStats.Count() > 0)
+          likStats.Remove(history.LikRow(likStats.FirstGen(), t));
+        for (int i = 0; i < p->numChains; ++i)
+          meanlik[i] = likStats.Mean(i, 0);
+        check_outliers_from_means(meanlik, outliers);
         int best_chain = gsl_stats_max_index(meanlik.data(), 1, p->numChains);
         for (int i = 0; i < p->numChains; ++i) {
           if (outliers[i] && i != best_chain) {
             // chain is an outlier
-            lik(t,i) = lik(t,best_chain);
+            lik(cur,i) = lik(cur,best_chain);
             for (int j = 0; j < p->nvar; ++j) 
-              state(t,i,j) = state(t,best_chain,j);
+              state(cur,i,j) = state(cur,best_chain,j);
             // PE: if we're not currently in burn-in (and p->burnIn > 0), re-enter it!
             if (! inBurnIn && p->burnIn > 0) {
               if (p->verboseLevel > 0) {
@@ -417,7 +716,11 @@ int dream( const dream_pars* p, rng::RngStream* rng )
         if (++curRun >= p->gelmanEvals) {
           if (p->verboseLevel > 0)
             printf("[%d] performing convergence diagnostics:", t);
-          gelman_rubin(state, scaleReduction, p->varLock, burnInStart + p->burnIn, t);
+          // G-R window = generations [(t + end of burn-in)/2, t - 2]
+          int t0 = (t + burnInStart + p->burnIn)/2;
+          while (stateStats.FirstGen() < t0 && stateStats.Count() > 0)
+            stateStats.Remove(history.StateRow(stateStats.FirstGen(), t));
+          gelman_rubin_incremental(stateStats, scaleReduction, p->varLock);
           // estimate variance
           int exitLoop(p->nvar);
           if (p->verboseLevel > 0)
@@ -460,22 +763,74 @@ int dream( const dream_pars* p, rng::RngStream* rng )
       ireport = 0;
       for (int i = 0; i < p->numChains; ++i) {
         for (int j = 0; j < p->nvar; j++)
-          tempParams[j] = state(t,i,j);
+          tempParams[j] = state(cur,i,j);
         string paramString = theModel->PrintModelParamsHorizontalString(tempParams);
         *oout[i] << paramString << " ";
-        *oout[i] << lik(t,i) << " " << (t < burnInStart + p->burnIn) << " " << " ";
+        *oout[i] << lik(cur,i) << " " << (t < burnInStart + p->burnIn) << " " << " ";
         for (int j(0); j < p->nCR; ++j) 
           *oout[i] << pCR[j] << " ";
         *oout[i] << acceptStep[i] << endl;
       }
     }
+
+    stateStats.Add(history.StateRow(t - 1, t));
+    history.Append(t - 1);
+
+    // PE: periodic checkpoint (generation t is complete); the state is copied into
+    // the writer's buffer here, and written to disk in a background thread
+    if (checkpointing && p->checkpointInterval > 0 && (t % p->checkpointInterval) == 0) {
+      int dims[5] = {p->nvar, p->numChains, p->nCR, p->loopSteps, nHist};
+      // earliest generation still needed: start of the diagnostic windows, or the
+      // oldest generation in memory (older ones are in the history file)
+      int firstRow = min(stateStats.FirstGen(), likStats.FirstGen());
+      firstRow = max(firstRow, t - nHist + 1);
+      for (int i = 0; i < p->numChains; ++i) {
+        oout[i]->flush();
+        chainFileSizes[i] = (int64_t)oout[i]->tellp();
+      }
+      checkpointWriter.Begin("DREAM");
+      checkpointWriter.AddArray(dims, 5);
+      checkpointWriter.AddArray(chainFileSizes.data(), p->numChains);
+      checkpointWriter.Add(t);
+      checkpointWriter.Add(genNumber);
+      checkpointWriter.Add(inBurnIn);
+      checkpointWriter.Add(burnInStart);
+      checkpointWriter.Add(curRun);
+      checkpointWriter.Add(numAccepted);
+      checkpointWriter.Add(ireport);
+      checkpointWriter.Add(nLikelihoodEvals);
+      checkpointWriter.AddArray(pCR.data(), p->nCR);
+      checkpointWriter.AddArray(delta_tot.data(), p->nCR);
+      checkpointWriter.AddArray(L.data(), p->nCR);
+      checkpointWriter.AddArray(totalSteps.data(), p->nCR);
+      checkpointWriter.AddArray(CRm.pt(), p->numChains*p->loopSteps);
+      checkpointWriter.AddArray(bstar.data(), p->nvar);
+      checkpointWriter.Add(firstRow);
+      for (int g = firstRow; g <= t; ++g) {
+        checkpointWriter.AddArray(state.pt(g % nHist, 0, 0), p->numChains*p->nvar);
+        checkpointWriter.AddArray(lik.pt(g % nHist, 0), p->numChains);
+      }
+      stateStats.GetState(statsCount, statsFirst, statsNext, statsMoments.data());
+      checkpointWriter.Add(statsCount);
+      checkpointWriter.Add(statsFirst);
+      checkpointWriter.Add(statsNext);
+      checkpointWriter.AddArray(statsMoments.data(), stateStats.MomentsSize());
+      likStats.GetState(statsCount, statsFirst, statsNext, statsMoments.data());
+      checkpointWriter.Add(statsCount);
+      checkpointWriter.Add(statsFirst);
+      checkpointWriter.Add(statsNext);
+      checkpointWriter.AddArray(statsMoments.data(), likStats.MomentsSize());
+      rng->get_state(rngState.data());
+      checkpointWriter.AddArray(rngState.data(), rngState.size());
+      checkpointWriter.WriteAsync(p->checkpointFile);
+    }
   }  // end of loop(i) over generations
   
   
 
   for (int i(0); i < p->numChains; ++i) {
-    // close output files
-    if (oout[i] != NULL) 
+    // close output files (chains may be going to stdout)
+    if ((oout[i] != NULL) && (oout[i] != &cout))
       delete oout[i];
   }
 
@@ -483,8 +838,12 @@ int dream( const dream_pars* p, rng::RngStream* rng )
   free(tempParams);
   
   
-  if (p->verboseLevel > 0)
-    printf("%d likelihood function calls\n", nLikelihoodEvals);
+  if (p->verboseLevel > 0) {
+    printf("%d likelihood function calls", nLikelihoodEvals);
+    if (likCache.NumHits() > 0)
+      printf(" (plus %d repeated states taken from cache)", likCache.NumHits());
+    printf("\n");
+  }
   if (! converged) {
     if (p->verboseLevel > 0)
       printf("Maximum number of iterations reached.\n");
@@ -16,6 +16,7 @@ using namespace std;
 #include <rng/RngStream.h>
 #include "array.h"
 #include "dream_params.h"
+#include "running_stats.h"
 
 
 // Return values
@@ -24,6 +25,9 @@ const int  DREAM_EXIT_ERROR = -1;
 const int  DREAM_EXIT_CONVERGENCE = 0;
 const int  DREAM_EXIT_MAX_ITERATIONS = 1;
 
+// PE: smallest allowed number of in-memory generations (dream_pars.historyWindow)
+const int  MIN_HISTORY_WINDOW = 10;
+
 
 int dream_restore_state( const dream_pars* p, Array3D<double>& state, 
 						Array2D<double>& lik, vector<double>& pCR, int& inBurnIn );
@@ -36,6 +40,8 @@ int dream( const dream_pars* p, rng::RngStream* rng );
 void check_outliers( int t, Array2D<double>& lik, vector<double>& meanlik,
                     vector<bool>& outliers );
 
+void check_outliers_from_means( const vector<double>& meanlik, vector<bool>& outliers );
+
 void gen_CR( rng::RngStream* rng, const vector<double>& pCR, 
             Array2D<int>& CRm, vector<unsigned>& L );
 
@@ -43,4 +49,11 @@ void gelman_rubin( Array3D<double>& state, vector<double>& scaleReduction,
                   const int* lockVar, int first = 0, int numIter = -1, 
                   int adjustDF = 0 );
 
+void gelman_rubin_incremental( const RunningStats& stats, vector<double>& scaleReduction,
+                  const int* lockVar, int adjustDF = 0 );
+
+void gelman_rubin_from_moments( Array2D<double>& chainMean, Array2D<double>& chainVar,
+                  int n, vector<double>& scaleReduction, const int* lockVar, 
+                  int adjustDF = 0 );
+
 #endif   // __DREAM_H__
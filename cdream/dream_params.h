@@ -10,6 +10,11 @@ using namespace std;
 typedef double (*LikelihoodFunction)( int chain_id, int gen, const double* state, 
                          const void* pars, bool recalc );
 
+// PE: likelihood function which may stop early -- returning a value < minLik -- as
+// soon as it is certain that the likelihood is < minLik
+typedef double (*BoundedLikelihoodFunction)( int chain_id, int gen, const double* state, 
+                         const void* pars, double minLik );
+
 typedef struct t_dream_pars {
   int verboseLevel;                 /* vebose flag   [PE: can be 0, 1, or > 1] */
   int maxEvals;              /* max number of function evaluations */
@@ -20,6 +25,13 @@ typedef struct t_dream_pars {
   int diagnostics;           /* report diagnostics at the end of the run */
   int burnIn;                /* number of steps for which to run an adaptive proposal size */
   int recalcLik;             /* recalculate likelihood of previously evaluated states */
+  int deterministicLik;      /* likelihood depends only on state: never recalculate [PE] */
+  int likCacheSize;          /* # recently evaluated states cached per chain (if deterministicLik) */
+  int earlyRejection;        /* draw Metropolis uniform first, and use boundedFun */
+  int historyWindow;         /* if > 0, # generations kept in memory (rest on disk) */
+  string checkpointFile;     /* binary checkpoint file ("" = no checkpoints) */
+  int checkpointInterval;    /* # generations between checkpoints */
+  int resume;                /* restart from checkpointFile */
 
   // DREAM variables
   int collapseOutliers;
@@ -52,6 +64,7 @@ typedef struct t_dream_pars {
   vector<string> parameterNames;
 
   LikelihoodFunction fun;
+  BoundedLikelihoodFunction boundedFun;   // only used if earlyRejection = 1
   void* extraData;
   
   vector<string> outputHeaderLines;
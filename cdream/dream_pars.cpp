@@ -14,6 +14,13 @@ void SetupDreamParams( dream_pars* p, size_t n, const double* init, const string
   p->diagnostics = 0;
   p->burnIn = 0;
   p->recalcLik = 0;
+  p->deterministicLik = 0;
+  p->likCacheSize = 4;
+  p->earlyRejection = 0;
+  p->historyWindow = 0;
+  p->checkpointFile = "";
+  p->checkpointInterval = 0;
+  p->resume = 0;
   p->noise = 0.05;            // recommended value in Vrugt+09: 0.05 (alternates: 0.01, 0.1)
   p->bstar_zero = 1e-3;       // recommended value in Vrugt+09: 1.0e-6
   p->collapseOutliers = 1;
@@ -25,6 +32,7 @@ void SetupDreamParams( dream_pars* p, size_t n, const double* init, const string
   p->nCR = 3;                 // recommended value in Vrugt+09: 3
   p->reenterBurnin = 0.2;
   p->fun = NULL;
+  p->boundedFun = NULL;
   p->extraData = NULL;
   p->outputHeaderLines.push_back("# mult_params L burnin gen mult_pCR accept\n");
 
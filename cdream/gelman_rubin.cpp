@@ -12,6 +12,64 @@ void gelman_rubin( Array3D<double>& state,  vector<double>& scaleReduction,
 
   Array2D<double> chainMean(numChains, numPars);
   Array2D<double> chainVar(numChains, numPars);
+
+  chainMean.set_all(0.0);
+  chainVar.set_all(0.0);
+
+  int i, j;
+  int t0 = (t + first)/2;
+  int n = t - t0 - 1;
+
+  // get within-chain means and variances
+  for (i = 0; i < numChains; ++i) {
+    for (j = 0; j < numPars; ++j) {
+      if (! lockVar[j]) {
+        chainMean(i,j) = gsl_stats_mean(state.pt(t0,i,j), numChains*numPars, n);
+        chainVar(i,j) = gsl_stats_variance_m(state.pt(t0,i,j), numChains*numPars, n, chainMean(i,j));
+      }
+    } 
+  }
+
+  gelman_rubin_from_moments(chainMean, chainVar, n, scaleReduction, lockVar, adjustDF);
+}
+
+
+// PE: same as gelman_rubin, but using within-chain means and variances which
+// have been accumulated generation by generation (over the appropriate window)
+// in stats; cost is independent of chain length
+void gelman_rubin_incremental( const RunningStats& stats, vector<double>& scaleReduction,
+				 	const int* lockVar, int adjustDF ) 
+{
+  int numChains = stats.NumChains();
+  int numPars = stats.NumPars();
+  Array2D<double> chainMean(numChains, numPars);
+  Array2D<double> chainVar(numChains, numPars);
+
+  chainMean.set_all(0.0);
+  chainVar.set_all(0.0);
+  for (int i = 0; i < numChains; ++i) {
+    for (int j = 0; j < numPars; ++j) {
+      if (! lockVar[j]) {
+        chainMean(i,j) = stats.Mean(i, j);
+        chainVar(i,j) = stats.Variance(i, j);
+      }
+    } 
+  }
+
+  gelman_rubin_from_moments(chainMean, chainVar, stats.Count(), scaleReduction, lockVar, 
+  							adjustDF);
+}
+
+
+// PE: between-chain part of Gelman-Rubin calculation, given the within-chain
+// means and variances (each computed from n samples per chain)
+void gelman_rubin_from_moments( Array2D<double>& chainMean, Array2D<double>& chainVar,
+					int n, vector<double>& scaleReduction, const int* lockVar, 
+					int adjustDF ) 
+{
+  int numChains = chainMean.n_x();
+  int numPars = chainMean.n_y();
+
   Array2D<double> chainMean2(numChains, numPars);
   vector<double> chainBetMean(numPars, 0.0);
   vector<double> chainBetMean2(numPars, 0.0);
@@ -20,23 +78,16 @@ void gelman_rubin( Array3D<double>& state,  vector<double>& scaleReduction,
   vector<double> varVar(numPars, 0.0);
   vector<double> estimatedVar(numPars, 0.0);
 
-  chainMean.set_all(0.0);
-  chainVar.set_all(0.0);
+  chainMean2.set_all(0.0);
   if ((int) scaleReduction.size() < numPars) 
     scaleReduction.resize(numPars, 0.0);
 
   int i, j;
-  int t0 = (t + first)/2;
-  int n = t - t0 - 1;
 
-  // get within-chain means and variances
   for (i = 0; i < numChains; ++i) {
     for (j = 0; j < numPars; ++j) {
-      if (! lockVar[j]) {
-        chainMean(i,j) = gsl_stats_mean(state.pt(t0,i,j), numChains*numPars, n);
+      if (! lockVar[j])
         chainMean2(i,j) = gsl_pow_2(chainMean(i,j));
-        chainVar(i,j) = gsl_stats_variance_m(state.pt(t0,i,j), numChains*numPars, n, chainMean(i,j));
-      }
     } 
   }
 
@@ -1,6 +1,7 @@
 #ifndef __GSLSTREAM_H__
 #define __GSLSTREAM_H__
 
+#include <cstring>
 #include "RngStream.h"
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
@@ -53,6 +54,10 @@ namespace rng {
         *k = gsl_ran_poisson(rng,lambda);
       }
 
+      inline size_t state_size() { return gsl_rng_size(rng); }
+      inline void get_state(void* s) { memcpy(s, gsl_rng_state(rng), gsl_rng_size(rng)); }
+      inline void set_state(const void* s) { memcpy(gsl_rng_state(rng), s, gsl_rng_size(rng)); }
+
     protected:
       const gsl_rng_type* type;
       gsl_rng* rng;
@@ -63,6 +63,12 @@ namespace rng {
       virtual void shuffle( int* x, size_t n ) = 0;
       virtual void shuffle( double* x, size_t n ) = 0;
 
+      // PE: saving and restoring the generator state (for checkpoints);
+      // state_size() = 0 means this isn't supported
+      virtual size_t state_size() { return 0; }
+      virtual void get_state( void* s ) {}
+      virtual void set_state( const void* s ) {}
+
 //      template<typename T> void shuffle(T* x, size_t n) {
 //        std::cerr << "Shuffling not implemented!" << std::endl;
 //      }
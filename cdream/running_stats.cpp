@@ -0,0 +1,83 @@
+// Running means and variances with sliding windows, using Welford's (1962)
+// updating formulas; samples can also be removed from the start of the window
+// by inverting the update.
+
+#include "running_stats.h"
+
+RunningStats::RunningStats( int nChains, int nPars ) :
+  numChains(nChains), numPars(nPars), n(0), firstGen(0), nextGen(0),
+  mean(nChains*nPars, 0.0), M2(nChains*nPars, 0.0)
+{
+}
+
+
+void RunningStats::Reset( int startGen )
+{
+  n = 0;
+  firstGen = nextGen = startGen;
+  for (int k(0); k < numChains*numPars; ++k)
+    mean[k] = M2[k] = 0.0;
+}
+
+
+void RunningStats::Add( const double* values )
+{
+  double delta;
+  ++n;
+  ++nextGen;
+  for (int k(0); k < numChains*numPars; ++k) {
+    delta = values[k] - mean[k];
+    mean[k] += delta/n;
+    M2[k] += delta*(values[k] - mean[k]);
+  }
+}
+
+
+void RunningStats::Remove( const double* values )
+{
+  double delta;
+  ++firstGen;
+  if (--n <= 0) {
+    Reset(firstGen);
+    return;
+  }
+  for (int k(0); k < numChains*numPars; ++k) {
+    delta = values[k] - mean[k];
+    mean[k] -= delta/n;
+    M2[k] -= delta*(values[k] - mean[k]);
+    if (M2[k] < 0.0)   // guard against round-off
+      M2[k] = 0.0;
+  }
+}
+
+
+double RunningStats::Variance( int chain, int par ) const
+{
+  if (n < 2)
+    return 0.0;
+  return M2[chain*numPars + par]/(n - 1);
+}
+
+
+void RunningStats::GetState( int& count, int& first, int& next, double* moments ) const
+{
+  count = n;
+  first = firstGen;
+  next = nextGen;
+  for (int k(0); k < numChains*numPars; ++k) {
+    moments[k] = mean[k];
+    moments[numChains*numPars + k] = M2[k];
+  }
+}
+
+
+void RunningStats::SetState( int count, int first, int next, const double* moments )
+{
+  n = count;
+  firstGen = first;
+  nextGen = next;
+  for (int k(0); k < numChains*numPars; ++k) {
+    mean[k] = moments[k];
+    M2[k] = moments[numChains*numPars + k];
+  }
+}
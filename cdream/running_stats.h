@@ -0,0 +1,39 @@
+#ifndef __RUNNING_STATS_H__
+#define __RUNNING_STATS_H__
+
+#include <vector>
+using namespace std;
+
+// PE: Running (Welford) means and variances for each (chain, parameter) pair, over
+// a window of generations [firstGen, nextGen) which can be extended at the end
+// and shrunk at the start. Add() and Remove() take a row of numChains*numPars
+// values (i.e., one generation of state(t,i,j), or of lik(t,i) with numPars = 1).
+class RunningStats {
+public:
+  RunningStats( int numChains, int numPars );
+  void Add( const double* values );
+  void Remove( const double* values );
+  void Reset( int startGen );
+  
+  int NumChains( ) const { return numChains; }
+  int NumPars( ) const { return numPars; }
+  int Count( ) const { return n; }
+  int FirstGen( ) const { return firstGen; }
+  int NextGen( ) const { return nextGen; }
+  double Mean( int chain, int par ) const { return mean[chain*numPars + par]; }
+  // sample variance (normalized by n - 1, as with gsl_stats_variance)
+  double Variance( int chain, int par ) const;
+
+  // PE: raw state, for checkpointing; moments has 2*numChains*numPars values
+  int MomentsSize( ) const { return 2*numChains*numPars; }
+  void GetState( int& count, int& first, int& next, double* moments ) const;
+  void SetState( int count, int first, int next, const double* moments );
+
+private:
+  int numChains, numPars;
+  int n, firstGen, nextGen;
+  vector<double> mean;
+  vector<double> M2;
+};
+
+#endif   // __RUNNING_STATS_H__
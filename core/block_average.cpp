@@ -0,0 +1,173 @@
+/* FILE: block_average.cpp --------------------------------------------- */
+
+// Code for making block-averaged (lower-resolution) versions of data, mask, weight,
+// and PSF images, and for converting image-function parameter values between the
+// original and block-averaged pixel scales; used for coarse-to-fine fitting.
+//
+// Pixel coordinates use the IRAF convention (center of first pixel = 1.0). Block
+// (I, J) of a block-averaged image with blockSize = f covers original pixels
+// f*I ... f*I + f-1 (0-based), so a position x on the original image corresponds
+// to (x + (f - 1)/2)/f on the block-averaged image.
+//
+// Since we *average* (rather than sum) pixel values, surface-brightness parameters
+// are unchanged; lengths scale as 1/f and total fluxes as 1/f^2. Which of these
+// applies to each parameter is specified by the FunctionObject subclasses (see
+// FunctionObject::GetParameterScalings).
+
+
+#include <stdio.h>
+#include <math.h>
+
+#include "block_average.h"
+
+using namespace std;
+
+
+
+/* ---------------- FUNCTION: BlockAveragedSize ------------------------ */
+
+int BlockAveragedSize( int n, int blockSize )
+{
+  return (n + blockSize - 1) / blockSize;
+}
+
+
+/* ---------------- FUNCTION: BlockAveragedPsfSize --------------------- */
+
+int BlockAveragedPsfSize( int n, int blockSize )
+{
+  double  halfWidth = 0.5*(n - 1);
+  return 2*(int)floor(halfWidth/blockSize + 0.5) + 1;
+}
+
+
+/* ---------------- FUNCTION: BlockAverageImage ------------------------ */
+
+void BlockAverageImage( const double *image, const double *mask, const double *weights,
+						int nColumns, int nRows, int blockSize, double *outputImage,
+						double *outputMask, double *outputWeights )
+{
+  int  nColumns_out = BlockAveragedSize(nColumns, blockSize);
+  int  nRows_out = BlockAveragedSize(nRows, blockSize);
+  long  z, z_out;
+  int  nValid;
+  double  sum, varianceSum;
+  bool  pixelOK;
+
+  for (int I = 0; I < nRows_out; I++) {
+    for (int J = 0; J < nColumns_out; J++) {
+      nValid = 0;
+      sum = varianceSum = 0.0;
+      for (int i = I*blockSize; (i < (I + 1)*blockSize) && (i < nRows); i++) {
+        for (int j = J*blockSize; (j < (J + 1)*blockSize) && (j < nColumns); j++) {
+          z = (long)i*nColumns + j;
+          pixelOK = (mask == NULL) || (mask[z] > 0.0);
+          if (weights != NULL)
+            pixelOK = pixelOK && (weights[z] > 0.0);
+          if (pixelOK) {
+            sum += image[z];
+            if (weights != NULL)
+              varianceSum += 1.0/weights[z];
+            nValid++;
+          }
+        }
+      }
+      z_out = (long)I*nColumns_out + J;
+      if (nValid > 0) {
+        outputImage[z_out] = sum/nValid;
+        outputMask[z_out] = 1.0;
+        // variance of mean = sum(sigma^2)/n^2
+        if (outputWeights != NULL)
+          outputWeights[z_out] = (double)nValid*nValid/varianceSum;
+      } else {
+        outputImage[z_out] = 0.0;
+        outputMask[z_out] = 0.0;
+        if (outputWeights != NULL)
+          outputWeights[z_out] = 0.0;
+      }
+    }
+  }
+}
+
+
+// Offset (in output pixels) for a PSF pixel at offset delta from the PSF center;
+// rounds halves away from zero, so the rebinned PSF stays symmetric
+static int RebinnedOffset( double delta, int blockSize )
+{
+  if (delta >= 0.0)
+    return (int)floor(delta/blockSize + 0.5);
+  else
+    return -(int)floor(-delta/blockSize + 0.5);
+}
+
+
+/* ---------------- FUNCTION: BlockAveragePsf -------------------------- */
+/// Each PSF pixel is added to the output pixel nearest to its (scaled) offset from
+/// the PSF center.
+void BlockAveragePsf( const double *psf, int nColumns, int nRows, int blockSize,
+					double *outputPsf )
+{
+  int  nColumns_out = BlockAveragedPsfSize(nColumns, blockSize);
+  int  nRows_out = BlockAveragedPsfSize(nRows, blockSize);
+  double  xCenter = 0.5*(nColumns - 1);
+  double  yCenter = 0.5*(nRows - 1);
+  int  I, J;
+
+  for (long z = 0; z < (long)nColumns_out*nRows_out; z++)
+    outputPsf[z] = 0.0;
+  for (int i = 0; i < nRows; i++) {
+    I = RebinnedOffset(i - yCenter, blockSize) + nRows_out/2;
+    I = (I < 0) ? 0 : ((I >= nRows_out) ? nRows_out - 1 : I);
+    for (int j = 0; j < nColumns; j++) {
+      J = RebinnedOffset(j - xCenter, blockSize) + nColumns_out/2;
+      J = (J < 0) ? 0 : ((J >= nColumns_out) ? nColumns_out - 1 : J);
+      outputPsf[(long)I*nColumns_out + J] += psf[(long)i*nColumns + j];
+    }
+  }
+}
+
+
+/* ---------------- FUNCTION: BlockAverageParameter -------------------- */
+
+double BlockAverageParameter( double value, int scalingType, int blockSize )
+{
+  double  f = (double)blockSize;
+
+  switch (scalingType) {
+    case PARAM_SCALING_POSITION:
+      return (value + 0.5*(f - 1.0))/f;
+    case PARAM_SCALING_LENGTH:
+      return value/f;
+    case PARAM_SCALING_TOTAL_FLUX:
+      return value/(f*f);
+    case PARAM_SCALING_INV_LENGTH:
+      return value*f;
+    default:
+      return value;
+  }
+}
+
+
+/* ---------------- FUNCTION: UnBlockAverageParameter ------------------ */
+
+double UnBlockAverageParameter( double value, int scalingType, int blockSize )
+{
+  double  f = (double)blockSize;
+
+  switch (scalingType) {
+    case PARAM_SCALING_POSITION:
+      return value*f - 0.5*(f - 1.0);
+    case PARAM_SCALING_LENGTH:
+      return value*f;
+    case PARAM_SCALING_TOTAL_FLUX:
+      return value*f*f;
+    case PARAM_SCALING_INV_LENGTH:
+      return value/f;
+    default:
+      return value;
+  }
+}
+
+
+
+/* END OF FILE: block_average.cpp -------------------------------------- */
@@ -0,0 +1,47 @@
+/** @file
+    \brief Block-averaging of images and PSFs, and the corresponding rescaling
+           of image-function parameters, for coarse-to-fine (multi-resolution) fitting.
+ *
+ */
+
+#ifndef _BLOCK_AVERAGE_H_
+#define _BLOCK_AVERAGE_H_
+
+#include "definitions.h"   // for PARAM_SCALING_xxx
+
+
+/// Size of the block-averaged version of an image dimension of length n (partial
+/// blocks at the right/top edges are kept)
+int BlockAveragedSize( int n, int blockSize );
+
+/// Size of the rebinned version of a PSF dimension of length n (always odd, so
+/// the PSF stays centered)
+int BlockAveragedPsfSize( int n, int blockSize );
+
+/// \brief Block-averages an image (and its weights), using only unmasked pixels
+///
+/// mask uses 1 = valid, 0 = masked; outputMask uses the same convention (a block is
+/// valid if it contains at least one valid pixel). If weights (1/sigma^2) is non-NULL,
+/// the weights of the block averages are stored in outputWeights. Output arrays must
+/// be BlockAveragedSize(nColumns) x BlockAveragedSize(nRows) in size.
+void BlockAverageImage( const double *image, const double *mask, const double *weights,
+						int nColumns, int nRows, int blockSize, double *outputImage,
+						double *outputMask, double *outputWeights=NULL );
+
+/// \brief Rebins a PSF image onto pixels blockSize times larger, keeping the PSF
+///        centered and its total flux unchanged
+///
+/// outputPsf must be BlockAveragedPsfSize(nColumns) x BlockAveragedPsfSize(nRows) in size.
+void BlockAveragePsf( const double *psf, int nColumns, int nRows, int blockSize,
+					double *outputPsf );
+
+/// Converts a parameter value from the original image to the block-averaged image;
+/// scalingType is the parameter's PARAM_SCALING_xxx type (see FunctionObject::
+/// GetParameterScalings)
+double BlockAverageParameter( double value, int scalingType, int blockSize );
+
+/// Converts a parameter value from the block-averaged image back to the original image
+double UnBlockAverageParameter( double value, int scalingType, int blockSize );
+
+
+#endif /* _BLOCK_AVERAGE_H_ */
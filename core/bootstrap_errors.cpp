@@ -45,6 +45,7 @@
 #endif
 #include "diff_evoln_fit.h"
 #include "mersenne_twister.h"
+#include "rng_streams.h"
 #include "bootstrap_errors.h"
 #include "statistics.h"
 #include "print_results.h"
@@ -62,7 +63,8 @@ const int PROGRESS_BAR_WIDTH = 80;
 int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLimits, 
 					const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 					const int nIterations, const int nFreeParams, const int whichStatistic, 
-					double **outputParamArray, FILE *outputFile_ptr, unsigned long rngSeed=0 );
+					double **outputParamArray, FILE *outputFile_ptr, unsigned long rngSeed=0,
+					int rngType=RNG_MERSENNE_TWISTER );
 
 
 
@@ -77,7 +79,7 @@ int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLi
 int BootstrapErrors( const double *bestfitParams, vector<mp_par> parameterLimits, 
 					const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 					const int nIterations, const int nFreeParams, const int whichStatistic, 
-					FILE *outputFile_ptr, unsigned long rngSeed )
+					FILE *outputFile_ptr, unsigned long rngSeed, int rngType )
 {
   double  *paramSigmas;
   double  *bestfitParams_offsetCorrected, *paramOffsets;
@@ -108,7 +110,7 @@ int BootstrapErrors( const double *bestfitParams, vector<mp_par> parameterLimits
   // do the bootstrap iterations (saving to file if user requested it)
   nSuccessfulIterations = BootstrapErrorsBase(bestfitParams, parameterLimits, paramLimitsExist, 
 					theModel, ftol, nIterations, nFreeParams, whichStatistic, 
-					outputParamArray, outputFile_ptr, rngSeed);
+					outputParamArray, outputFile_ptr, rngSeed, rngType);
   
   if (nSuccessfulIterations < MIN_ITERATIONS_FOR_STATISTICS) {
     printf("\nNot enough successful bootstrap iterations (%d) for meaningful statistics!\n",
@@ -165,17 +167,20 @@ int BootstrapErrors( const double *bestfitParams, vector<mp_par> parameterLimits
 /// Base function called by the wrapper functions (above), which does the main work
 /// of overseeing the bootstrap resampling.
 /// Saving individual best-fit vales to file is done *if* outputFile_ptr != NULL.
+/// If rngType = RNG_PHILOX, then the resample for iteration i is generated from
+/// the counter-based stream (rngSeed, i), and so does not depend on the other iterations.
 /// Returns the number of successful iterations performed (-1 if an error was
 /// encountered)
 int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLimits, 
 					const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 					const int nIterations, const int nFreeParams, const int whichStatistic, 
-					double **outputParamArray, FILE *outputFile_ptr, unsigned long rngSeed )
+					double **outputParamArray, FILE *outputFile_ptr, unsigned long rngSeed,
+					int rngType )
 {
   double  *paramsVect, *paramOffsets;
   int  i, status, nIter, nDone, nSuccessfulIters;
   int  nParams = theModel->GetNParams();
-  int  nValidPixels = theModel->GetNValidPixels();
+  int  nDeviates;
   int  verboseLevel = -1;   // ensure minimizer stays silent
   bool  saveToFile = false;
   string  outputLine, iterTemplate;
@@ -183,10 +188,11 @@ int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLi
   if (outputFile_ptr != NULL)
     saveToFile = true;
   
-  if (rngSeed > 0)
+  if (rngSeed == 0)
+    rngSeed = (unsigned long)time((time_t *)NULL);
+  if (rngType != RNG_PHILOX)
     init_genrand(rngSeed);
-  else
-    init_genrand((unsigned long)time((time_t *)NULL));
+  RNGStream  rngStream(rngSeed);
 
   paramsVect = (double *) calloc(nParams, sizeof(double));
   paramOffsets = (double *) calloc(nParams, sizeof(double));
@@ -197,6 +203,8 @@ int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLi
     free(paramsVect);
     return -1;
   }
+  // length of deviates vector for L-M depends on how bootstrap samples are stored
+  nDeviates = theModel->GetNDeviates();
 
   if ((whichStatistic == FITSTAT_CHISQUARE) || (whichStatistic == FITSTAT_POISSON_MLR))
     printf("Starting bootstrap iterations (L-M solver):\n");
@@ -215,11 +223,16 @@ int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLi
   nSuccessfulIters = 0;
   for (nIter = 0; nIter < nIterations; nIter++) {
     fflush(stdout);
-    theModel->MakeBootstrapSample();
+    if (rngType == RNG_PHILOX) {
+      rngStream.SetStream((unsigned long)nIter);
+      theModel->MakeBootstrapSample(&rngStream);
+    }
+    else
+      theModel->MakeBootstrapSample();
     for (i = 0; i < nParams; i++)
       paramsVect[i] = bestfitParams[i];
     if ((whichStatistic == FITSTAT_CHISQUARE) || (whichStatistic == FITSTAT_POISSON_MLR)) {
-      status = LevMarFit(nParams, nFreeParams, nValidPixels, paramsVect, parameterLimits, 
+      status = LevMarFit(nParams, nFreeParams, nDeviates, paramsVect, parameterLimits, 
       					theModel, ftol, paramLimitsExist, verboseLevel);
     } else {
 #ifndef NO_NLOPT
@@ -270,19 +283,21 @@ int BootstrapErrorsBase( const double *bestfitParams, vector<mp_par> parameterLi
 int BootstrapErrorsArrayOnly( const double *bestfitParams, vector<mp_par> parameterLimits, 
 					const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 					const int nIterations, const int nFreeParams, const int whichStatistic, 
-					double *outputParamArray, unsigned long rngSeed, bool verboseFlag )
+					double *outputParamArray, unsigned long rngSeed, bool verboseFlag,
+					int rngType )
 {
   double  *paramsVect, *paramOffsets;
   int  i, status, nIter, nDone, nSuccessfulIters;
   int  nParams = theModel->GetNParams();
-  int  nValidPixels = theModel->GetNValidPixels();
+  int  nDeviates;
   int  verboseLevel = -1;   // ensure minimizer stays silent
   string  iterTemplate;
 
-  if (rngSeed > 0)
+  if (rngSeed == 0)
+    rngSeed = (unsigned long)time((time_t *)NULL);
+  if (rngType != RNG_PHILOX)
     init_genrand(rngSeed);
-  else
-    init_genrand((unsigned long)time((time_t *)NULL));
+  RNGStream  rngStream(rngSeed);
 
   paramsVect = (double *) calloc(nParams, sizeof(double));
   paramOffsets = (double *) calloc(nParams, sizeof(double));
@@ -293,6 +308,8 @@ int BootstrapErrorsArrayOnly( const double *bestfitParams, vector<mp_par> parame
     free(paramsVect);
     return -1;
   }
+  // length of deviates vector for L-M depends on how bootstrap samples are stored
+  nDeviates = theModel->GetNDeviates();
 
   int  nDigits = floor(log10(nIterations)) + 1;
   iterTemplate = PrintToString("] %%%dd", nDigits) + " (%3.1f%%)\r";
@@ -304,11 +321,16 @@ int BootstrapErrorsArrayOnly( const double *bestfitParams, vector<mp_par> parame
   for (nIter = 0; nIter < nIterations; nIter++) {
   	if (verboseFlag)
   	  fflush(stdout);
-    theModel->MakeBootstrapSample();
+    if (rngType == RNG_PHILOX) {
+      rngStream.SetStream((unsigned long)nIter);
+      theModel->MakeBootstrapSample(&rngStream);
+    }
+    else
+      theModel->MakeBootstrapSample();
     for (i = 0; i < nParams; i++)
       paramsVect[i] = bestfitParams[i];
     if ((whichStatistic == FITSTAT_CHISQUARE) || (whichStatistic == FITSTAT_POISSON_MLR)) {
-      status = LevMarFit(nParams, nFreeParams, nValidPixels, paramsVect, parameterLimits, 
+      status = LevMarFit(nParams, nFreeParams, nDeviates, paramsVect, parameterLimits, 
       					theModel, ftol, paramLimitsExist, verboseLevel);
     } else {
 #ifndef NO_NLOPT
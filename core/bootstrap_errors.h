@@ -23,7 +23,8 @@
 int BootstrapErrors( const double *bestfitParams, vector<mp_par> parameterLimits, 
 				const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 				const int nIterations, const int nFreeParams, const int whichStatistic, 
-				FILE *outputFile_ptr, unsigned long rngSeed=0 );
+				FILE *outputFile_ptr, unsigned long rngSeed=0, 
+				int rngType=RNG_MERSENNE_TWISTER );
 
 
 // NOTE: The following function is used in PyImfit
@@ -38,7 +39,7 @@ int BootstrapErrorsArrayOnly( const double *bestfitParams, vector<mp_par> parame
 					const bool paramLimitsExist, ModelObject *theModel, const double ftol, 
 					const int nIterations, const int nFreeParams, const int whichStatistic, 
 					double *outputParamArray, unsigned long rngSeed=0, 
-					bool verboseFlag=false );
+					bool verboseFlag=false, int rngType=RNG_MERSENNE_TWISTER );
 
 
 #endif  // _BOOTSTRAP_ERRORS_H_
@@ -0,0 +1,230 @@
+/* FILE: checkpoint.cpp ------------------------------------------------ */
+/*
+ * Classes for writing and reading binary checkpoint files, so that long DE fits
+ * and DREAM MCMC runs can be restarted after being interrupted.
+ *
+ * File layout:
+ *    "IMFITCKP" (8 bytes)
+ *    format version (int32)
+ *    length of kind label (int32), followed by the label itself
+ *    solver-specific data
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+const char  CHECKPOINT_MAGIC[] = "IMFITCKP";
+const int  CHECKPOINT_MAGIC_LENGTH = 8;
+const int32_t  CHECKPOINT_VERSION = 1;
+
+
+// Flushes the directory containing filename to disk, so that a preceding rename
+// survives a crash. (Failure is ignored, since not all filesystems support
+// fsync on directories.)
+static void SyncParentDirectory( const string& filename )
+{
+  size_t  slashPos = filename.rfind('/');
+  string  dirName;
+  int  dirFD;
+
+  if (slashPos == string::npos)
+    dirName = ".";
+  else if (slashPos == 0)
+    dirName = "/";
+  else
+    dirName = filename.substr(0, slashPos);
+  dirFD = open(dirName.c_str(), O_RDONLY);
+  if (dirFD >= 0) {
+    fsync(dirFD);
+    close(dirFD);
+  }
+}
+
+
+// Writes the buffer to filename + ".tmp", forces it to disk, then renames it to
+// filename (so that filename always holds a complete checkpoint, even after a
+// crash or power failure); sets *status = true on success. Runs in the writer
+// thread.
+static void WriteCheckpointFile( const vector<char> *theBuffer, const string filename,
+								bool *status )
+{
+  string  tempFilename = filename + ".tmp";
+  FILE  *outputFile;
+  bool  ok = false;
+
+  outputFile = fopen(tempFilename.c_str(), "wb");
+  if (outputFile != NULL) {
+    size_t  nWritten = fwrite(theBuffer->data(), 1, theBuffer->size(), outputFile);
+    ok = (nWritten == theBuffer->size());
+    if (ok)
+      ok = (fflush(outputFile) == 0) && (fsync(fileno(outputFile)) == 0);
+    if (fclose(outputFile) != 0)
+      ok = false;
+    if (ok)
+      ok = (rename(tempFilename.c_str(), filename.c_str()) == 0);
+    if (ok)
+      SyncParentDirectory(filename);
+  }
+  *status = ok;
+}
+
+
+
+/* ---------------- CONSTRUCTOR ---------------------------------------- */
+
+CheckpointWriter::CheckpointWriter( )
+{
+  writing = false;
+  lastWriteOK = true;
+}
+
+
+/* ---------------- DESTRUCTOR ----------------------------------------- */
+
+CheckpointWriter::~CheckpointWriter( )
+{
+  Wait();
+}
+
+
+/* ---------------- PUBLIC METHOD: Begin ------------------------------- */
+
+void CheckpointWriter::Begin( const string& kind )
+{
+  int32_t  kindLength = (int32_t)kind.size();
+
+  buffer.clear();
+  AddBytes(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LENGTH);
+  Add(CHECKPOINT_VERSION);
+  Add(kindLength);
+  AddBytes(kind.data(), kindLength);
+}
+
+
+/* ---------------- PUBLIC METHOD: AddBytes ---------------------------- */
+
+void CheckpointWriter::AddBytes( const void *data, size_t nBytes )
+{
+  const char  *bytes = (const char *)data;
+  buffer.insert(buffer.end(), bytes, bytes + nBytes);
+}
+
+
+/* ---------------- PUBLIC METHOD: WriteAsync -------------------------- */
+/// The current buffer is swapped (not copied) into the pending-write slot, so the
+/// caller can immediately start assembling the next checkpoint.
+bool CheckpointWriter::WriteAsync( const string& filename )
+{
+  bool  previousOK = Wait();
+
+  pendingBuffer.swap(buffer);
+  buffer.clear();
+  pendingFilename = filename;
+  writing = true;
+  writerThread = thread(WriteCheckpointFile, &pendingBuffer, pendingFilename, &lastWriteOK);
+  return previousOK;
+}
+
+
+/* ---------------- PUBLIC METHOD: Wait -------------------------------- */
+
+bool CheckpointWriter::Wait( )
+{
+  if (writing) {
+    writerThread.join();
+    writing = false;
+    if (! lastWriteOK)
+      fprintf(stderr, "*** WARNING: unable to write checkpoint file \"%s\"!\n",
+      			pendingFilename.c_str());
+  }
+  return lastWriteOK;
+}
+
+
+
+
+/* ---------------- CONSTRUCTOR ---------------------------------------- */
+
+CheckpointReader::CheckpointReader( )
+{
+  position = 0;
+  readOK = false;
+}
+
+
+/* ---------------- PUBLIC METHOD: Open -------------------------------- */
+
+bool CheckpointReader::Open( const string& filename, const string& kind )
+{
+  FILE  *inputFile;
+  char  magic[CHECKPOINT_MAGIC_LENGTH];
+  int32_t  version, kindLength;
+  long  fileSize;
+
+  data.clear();
+  position = 0;
+  readOK = false;
+  inputFile = fopen(filename.c_str(), "rb");
+  if (inputFile == NULL)
+    return false;
+  fseek(inputFile, 0, SEEK_END);
+  fileSize = ftell(inputFile);
+  fseek(inputFile, 0, SEEK_SET);
+  if (fileSize > 0) {
+    data.resize(fileSize);
+    readOK = (fread(data.data(), 1, fileSize, inputFile) == (size_t)fileSize);
+  }
+  fclose(inputFile);
+  if (! readOK)
+    return false;
+
+  GetBytes(magic, CHECKPOINT_MAGIC_LENGTH);
+  Get(version);
+  Get(kindLength);
+  if ((! readOK) || (strncmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LENGTH) != 0)
+  		|| (version != CHECKPOINT_VERSION) || (kindLength != (int32_t)kind.size())) {
+    readOK = false;
+    return false;
+  }
+  string  fileKind(kindLength, ' ');
+  GetBytes(&fileKind[0], kindLength);
+  if (fileKind != kind)
+    readOK = false;
+  return readOK;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetBytes ---------------------------- */
+
+bool CheckpointReader::GetBytes( void *outputData, size_t nBytes )
+{
+  if ((! readOK) || (position + nBytes > data.size())) {
+    readOK = false;
+    return false;
+  }
+  memcpy(outputData, data.data() + position, nBytes);
+  position += nBytes;
+  return true;
+}
+
+
+
+
+/* ---------------- FUNCTION: CheckpointExists ------------------------- */
+
+bool CheckpointExists( const string& filename )
+{
+  FILE  *inputFile = fopen(filename.c_str(), "rb");
+  if (inputFile == NULL)
+    return false;
+  fclose(inputFile);
+  return true;
+}
+
+
+/* END OF FILE: checkpoint.cpp ----------------------------------------- */
@@ -0,0 +1,100 @@
+/** @file
+ * \brief Binary checkpoint files for long-running solvers (DE, DREAM MCMC)
+ */
+
+/* Header file for CheckpointWriter and CheckpointReader.
+ *
+ * A checkpoint is a flat binary record: a short header (magic string, format
+ * version, and a "kind" label identifying the solver), followed by whatever
+ * values the solver chooses to save, in order. The solver reads them back in the
+ * same order on restart. Files are written in native byte order, since they are
+ * only meant to be read back by the same executable on the same machine type.
+ *
+ * CheckpointWriter::WriteAsync() hands the already-serialized buffer to a
+ * background thread, so the calling (compute) loop only pays for a memcpy-style
+ * copy of the state; the file is written to "<filename>.tmp" and then renamed,
+ * so an interruption during the write never leaves a corrupted checkpoint.
+ */
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <thread>
+
+using namespace std;
+
+
+/// Settings for periodic checkpointing (passed to solvers)
+typedef struct {
+  string  filename;   ///< checkpoint file ("" = no checkpointing)
+  int  interval;      ///< write a checkpoint every this many generations
+  bool  resume;       ///< if true, restart from existing checkpoint file
+} CheckpointSettings;
+
+
+/// \brief Serializes solver state and writes it to disk in a background thread
+class CheckpointWriter
+{
+  public:
+    CheckpointWriter( );
+    ~CheckpointWriter( );
+
+    /// Clears the buffer and starts a new checkpoint of the specified kind
+    void Begin( const string& kind );
+
+    void AddBytes( const void *data, size_t nBytes );
+    template <typename T> void Add( const T& value )
+      { AddBytes(&value, sizeof(T)); };
+    template <typename T> void AddArray( const T *values, long n )
+      { AddBytes(values, n*sizeof(T)); };
+
+    /// Starts writing the current buffer to filename in the background (waits for
+    /// any previous write to finish first); returns false if that write failed
+    bool WriteAsync( const string& filename );
+
+    /// Waits for any pending write to finish; returns false if it failed
+    bool Wait( );
+
+  private:
+    vector<char>  buffer;
+    vector<char>  pendingBuffer;
+    string  pendingFilename;
+    thread  writerThread;
+    bool  writing;
+    bool  lastWriteOK;
+};
+
+
+/// \brief Reads a checkpoint file written by CheckpointWriter
+class CheckpointReader
+{
+  public:
+    CheckpointReader( );
+
+    /// Reads filename; returns false if it doesn't exist or isn't a checkpoint of
+    /// the specified kind
+    bool Open( const string& filename, const string& kind );
+
+    bool GetBytes( void *data, size_t nBytes );
+    template <typename T> bool Get( T& value )
+      { return GetBytes(&value, sizeof(T)); };
+    template <typename T> bool GetArray( T *values, long n )
+      { return GetBytes(values, n*sizeof(T)); };
+
+    /// True if all reads so far were successful and the whole file has been read
+    bool Finished( ) { return (readOK && (position == data.size())); };
+
+  private:
+    vector<char>  data;
+    size_t  position;
+    bool  readOK;
+};
+
+
+/// Returns true if the file exists and can be opened for reading
+bool CheckpointExists( const string& filename );
+
+
+#endif /* _CHECKPOINT_H_ */
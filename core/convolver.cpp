@@ -107,9 +107,14 @@
 
 /* ------------------------ Include Files (Header Files )--------------- */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
 
 #include "fftw3.h"
 
@@ -118,9 +123,42 @@
 #endif  // FFTW_THREADING
 
 #include "convolver.h"
+#include "profile_counters.h"
 
 #define DEFAULT_OPENMP_CHUNK_SIZE  10
 
+// minimum size (per side) of FFT tiles for overlap-save convolution; default tile
+// size is ~ 4 times the PSF size, so that ~ 75% of each tile's output is usable
+const int  MIN_FFT_TILE_SIZE = 64;
+const int  FFT_TILE_PSF_RATIO = 4;
+
+// PSF is treated as separable (rank-1) if the outer product of its central row and
+// column reproduces every PSF pixel to within this fraction of the peak value
+const double  SEPARABLE_PSF_TOLERANCE = 1.0e-10;
+// Cost model for CONVOLVE_AUTO, in units of one multiply-add of the direct
+// convolution loop: a real-to-complex or complex-to-real FFT of N pixels costs
+// ~ FFT_COST_FACTOR * N log2(N), plus ~ FFT_PIXEL_COST * N for zero-padding,
+// complex multiplication, and copying the result back. Only the ratio to the
+// direct cost matters. Calibrated (single thread, FFTW 3.3 with FFTW_ESTIMATE
+// plans) by timing CONVOLVE_FFT and CONVOLVE_DIRECT for data images of 64--1024
+// pixels on a side with non-separable PSFs of 5--51 pixels: the measured factor
+// ranges from ~ 0.35 to ~ 3.7 depending on how the padded size factors, with a
+// median of ~ 1.0; with the values below, the cost model picks the faster method
+// in 26 of 30 cases, and is never more than a factor of ~ 2.3 slower than the
+// better choice.
+const double  FFT_COST_FACTOR = 1.0;
+const double  FFT_PIXEL_COST = 6.0;
+
+// default tolerance for CONVOLVE_LOWRANK, and maximum number of sweeps for the
+// Jacobi SVD used to compute the low-rank approximation
+const double  DEFAULT_LOWRANK_TOLERANCE = 1.0e-6;
+const int  MAX_JACOBI_SWEEPS = 60;
+
+// maximum number of images, and maximum memory for their padded real + complex
+// arrays, for each batch of FFTs in ConvolveImages
+const int  MAX_FFT_BATCH_IMAGES = 16;
+const double  MAX_FFT_BATCH_BYTES = 512.0e6;
+
 
 			
 /* ---------------- CONSTRUCTOR ---------------------------------------- */
@@ -132,8 +170,21 @@ Convolver::Convolver( )
   imageInfoSet = false;
   fftVectorsAllocated = false;
   fftPlansCreated = false;
+  fftwPlanFlags = FFTW_ESTIMATE;
+  nFFTWThreads = 1;
+  nBatchImages = 0;
+  batchVectorsAllocated = false;
   normalizePSF = true;   // default is to normalize the PSF
   maxRequestedThreads = 0;   // default value --> use all available processors/cores
+  convolutionMethod = CONVOLVE_FFT;
+  outputRegionSet = false;
+  nColumns_tileRequested = nRows_tileRequested = 0;   // 0 = choose automatically
+  tileVectorsAllocated = false;
+  tilePlansCreated = false;
+  nSeparableTerms = 0;
+  lowRankTolerance = DEFAULT_LOWRANK_TOLERANCE;
+  lowRankResidual = 0.0;
+  directVectorsAllocated = false;
 }
 
 
@@ -156,6 +207,31 @@ Convolver::~Convolver( )
     fftw_free(multiplied_cmplx);
     fftw_free(convolvedImage_out);
   }
+  if (batchVectorsAllocated) {
+    fftw_destroy_plan(plan_batchForward);
+    fftw_destroy_plan(plan_batchInverse);
+    fftw_free(batch_in_padded);
+    fftw_free(batch_fft_cmplx);
+  }
+  if (tilePlansCreated) {
+    fftw_destroy_plan(plan_tileForward);
+    fftw_destroy_plan(plan_tileInverse);
+  }
+  if (tileVectorsAllocated) {
+    fftw_free(psf_in_tile);
+    fftw_free(psf_fft_tile);
+    free(tileBandOutput);
+    free(tileHaloRows);
+    free(tileHaloTemp);
+  }
+  if (nSeparableTerms > 0) {
+    free(psfRowKernels);
+    free(psfColumnKernels);
+  }
+  if (directVectorsAllocated) {
+    free(directOutput);
+    free(directTemp);
+  }
 }
 
 
@@ -168,6 +244,59 @@ void Convolver::SetMaxThreads( int maximumThreadNumber )
 }
 
 
+/* ---------------- SetConvolutionMethod ------------------------------- */
+/// Specify which convolution method to use (must be called before DoFullSetup).
+/// Returns 0 on success, -1 if method is not recognized.
+int Convolver::SetConvolutionMethod( int method )
+{
+  if ((method != CONVOLVE_FFT) && (method != CONVOLVE_FFT_TILED) 
+  		&& (method != CONVOLVE_DIRECT) && (method != CONVOLVE_LOWRANK) 
+  		&& (method != CONVOLVE_AUTO)) {
+    fprintf(stderr, "*** ERROR: Convolver::SetConvolutionMethod: unrecognized method (%d)!\n",
+    		method);
+    return -1;
+  }
+  convolutionMethod = method;
+  return 0;
+}
+
+
+/* ---------------- SetFFTTileSize ------------------------------------- */
+/// Specify the size of the FFT tiles used by CONVOLVE_FFT_TILED; values of 0
+/// mean "choose automatically" (the default). Tile dimensions smaller than the
+/// PSF are increased to the PSF size.
+void Convolver::SetFFTTileSize( int nColumns, int nRows )
+{
+  nColumns_tileRequested = nColumns;
+  nRows_tileRequested = nRows;
+}
+
+
+/* ---------------- SetLowRankTolerance -------------------------------- */
+/// Specify the tolerance for CONVOLVE_LOWRANK: the smallest number of separable
+/// (rank-1) terms is kept such that the Frobenius norm of the discarded part of
+/// the PSF is <= tolerance times the Frobenius norm of the PSF.
+void Convolver::SetLowRankTolerance( double tolerance )
+{
+  lowRankTolerance = tolerance;
+}
+
+
+/* ---------------- SetOutputRegion ------------------------------------ */
+/// Specify that only the subsection of the image with lower-left corner at
+/// (x0,y0) [0-based] and size nColumns x nRows is needed after convolution;
+/// CONVOLVE_FFT_TILED, CONVOLVE_DIRECT, and CONVOLVE_LOWRANK will only compute
+/// (and overwrite) pixels in this region. (CONVOLVE_FFT always convolves the whole image.)
+void Convolver::SetOutputRegion( int x0, int y0, int nColumns, int nRows )
+{
+  x0_output = x0;
+  y0_output = y0;
+  nColumns_output = nColumns;
+  nRows_output = nRows;
+  outputRegionSet = true;
+}
+
+
 /* ---------------- SetupPSF ------------------------------------------- */
 /// Pass in a pointer to the pixel vector for the input PSF image, as well as
 /// the image dimensions and whether PSF needs to be normalized.
@@ -208,11 +337,77 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
   
   debugStatus = debugLevel;
   
-  // compute padding dimensions
   if ((! psfInfoSet) || (! imageInfoSet)) {
     fprintf(stderr, "*** WARNING: Convolver::DoFullSetup: PSF and/or image parameters not set!\n");
     return -1;
   }
+  if (! outputRegionSet) {
+    x0_output = y0_output = 0;
+    nColumns_output = nColumns_image;
+    nRows_output = nRows_image;
+  }
+  if ((x0_output < 0) || (y0_output < 0) || (nColumns_output < 1) || (nRows_output < 1)
+  		|| (x0_output + nColumns_output > nColumns_image) 
+  		|| (y0_output + nRows_output > nRows_image)) {
+    fprintf(stderr, "*** WARNING: Convolver::DoFullSetup: output region lies outside image!\n");
+    return -1;
+  }
+
+#ifdef FFTW_THREADING
+  int  threadStatus;
+  threadStatus = fftw_init_threads();
+#endif  // FFTW_THREADING
+
+  if (doFFTWMeasure)
+    fftwFlags = FFTW_MEASURE;
+  else
+    fftwFlags = FFTW_ESTIMATE;
+  fftwPlanFlags = fftwFlags;
+
+  // Normalize the PSF
+  if ((debugStatus >= 1) && (normalizePSF)) {
+    printf("Normalizing the PSF ...\n");
+    if (debugStatus >= 2) {
+      printf("The whole input PSF image, row by row:\n");
+      PrintRealImage(psfPixels, nColumns_psf, nRows_psf);
+    }
+  }
+  // Use Kahan summation to avoid underflow
+  if (normalizePSF) {
+    psfSum = 0.0;
+    double  storedError = 0.0, adjustedVal = 0.0, tempSum = 0.0;
+    for (k = 0; k < nPixels_psf; k++) {
+      adjustedVal = psfPixels[k] - storedError;
+      tempSum = psfSum + adjustedVal;
+      storedError = (tempSum - psfSum) - adjustedVal;
+      psfSum = tempSum;
+    }
+    for (k = 0; k < nPixels_psf; k++)
+      psfPixels[k] = psfPixels[k] / psfSum;
+    if (debugStatus >= 2) {
+      printf("The whole *normalized* PSF image, row by row:\n");
+      PrintRealImage(psfPixels, nColumns_psf, nRows_psf);
+    }
+  }
+
+  if ((convolutionMethod == CONVOLVE_DIRECT) || (convolutionMethod == CONVOLVE_AUTO)) {
+    if (CheckPSFSeparability())
+      nSeparableTerms = 1;
+  }
+  if (convolutionMethod == CONVOLVE_AUTO)
+    convolutionMethod = ChooseConvolutionMethod();
+  if (convolutionMethod == CONVOLVE_LOWRANK) {
+    if (ComputeLowRankPSF() < 0)
+      return -1;
+  }
+  if ((convolutionMethod == CONVOLVE_DIRECT) || (convolutionMethod == CONVOLVE_LOWRANK))
+    return SetupDirect();
+  if (convolutionMethod == CONVOLVE_FFT_TILED)
+    return SetupTiledFFT(fftwFlags);
+
+
+  // Standard full-image FFT convolution
+  // compute padding dimensions
   nColumns_padded = nColumns_image + nColumns_psf - 1;
   nRows_padded = nRows_image + nRows_psf - 1;
   nPixels_padded = (long)nColumns_padded * (long)nRows_padded;
@@ -226,12 +421,6 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
     printf("Complex images will have dimensions %d x %d pixels in size\n", nCols_trimmed, 
     		nRows_padded);
 
-
-#ifdef FFTW_THREADING
-  int  threadStatus;
-  threadStatus = fftw_init_threads();
-#endif  // FFTW_THREADING
-
   // allocate memory for double and fftw_complex arrays
   image_in_padded = (double*) fftw_malloc(sizeof(double) * nPixels_padded);
   image_fft_cmplx = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_padded_complex);
@@ -249,10 +438,6 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
 
 
   // set up FFTW plans
-  if (doFFTWMeasure)
-    fftwFlags = FFTW_MEASURE;
-  else
-    fftwFlags = FFTW_ESTIMATE;
   // Note that there's not much purpose in multi-threading plan_psf, since we only do
   // the FFT of the PSF once
   plan_psf = fftw_plan_dft_r2c_2d(nRows_padded, nColumns_padded, psf_in_padded, 
@@ -268,6 +453,7 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
     nThreads = maxRequestedThreads;
   if (nThreads < 1)
     nThreads = 1;
+  nFFTWThreads = nThreads;
   fftw_plan_with_nthreads(nThreads);
 #endif  // FFTW_THREADING
 
@@ -279,46 +465,20 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
   fftPlansCreated = true;
 
 
-  // Generate the Fourier transform of the PSF:
-  // 1. Normalize the PSF
-  if ((debugStatus >= 1) && (normalizePSF)) {
-    printf("Normalizing the PSF ...\n");
-    if (debugStatus >= 2) {
-      printf("The whole input PSF image, row by row:\n");
-      PrintRealImage(psfPixels, nColumns_psf, nRows_psf);
-    }
-  }
-  // Use Kahan summation to avoid underflow
-  if (normalizePSF) {
-    psfSum = 0.0;
-    double  storedError = 0.0, adjustedVal = 0.0, tempSum = 0.0;
-    for (k = 0; k < nPixels_psf; k++) {
-      adjustedVal = psfPixels[k] - storedError;
-      tempSum = psfSum + adjustedVal;
-      storedError = (tempSum - psfSum) - adjustedVal;
-      psfSum = tempSum;
-    }
-    for (k = 0; k < nPixels_psf; k++)
-      psfPixels[k] = psfPixels[k] / psfSum;
-    if (debugStatus >= 2) {
-      printf("The whole *normalized* PSF image, row by row:\n");
-      PrintRealImage(psfPixels, nColumns_psf, nRows_psf);
-    }
-  }
-
-  // 2. Prepare padded psf array for FFT, and then copy input PSF into
+  // Generate the Fourier transform of the (normalized) PSF:
+  // 1. Prepare padded psf array for FFT, and then copy input PSF into
   // it with appropriate shift/wrap:
   for (k = 0; k < nPixels_padded; k++)
     psf_in_padded[k] = 0.0;
   if (debugStatus >= 1)
     printf("Shifting and wrapping the PSF ...\n");
-  ShiftAndWrapPSF();
+  ShiftAndWrapPSF(psf_in_padded, nColumns_padded, nRows_padded);
   if (debugStatus >= 2) {
     printf("The whole padded, normalized PSF image, row by row:\n");
     PrintRealImage(psf_in_padded, nColumns_padded, nRows_padded);
   }
   
-  // 3. Do forward FFT on PSF image
+  // 2. Do forward FFT on PSF image
   if (debugStatus >= 1)
     printf("Performing FFT of PSF image ...\n");
   fftw_execute(plan_psf);
@@ -327,18 +487,295 @@ int Convolver::DoFullSetup( int debugLevel, bool doFFTWMeasure )
 }
 
 
+/* ---------------- SetupTiledFFT -------------------------------------- */
+/// Setup for overlap-save convolution (CONVOLVE_FFT_TILED): determine tile size,
+/// allocate PSF and output arrays, create (single-threaded) FFTW plans for tiles,
+/// and compute the Fourier transform of the PSF at the tile size.
+/// Memory use does not grow with the image area: each thread needs its own set of
+/// tile-sized arrays, plus there are buffers for one row of tiles ("band") of
+/// output and for the PSF-height strip of input rows just above the current band.
+int Convolver::SetupTiledFFT( unsigned fftwFlags )
+{
+  double  *tempIn;
+  fftw_complex  *tempOut;
+  
+  // Determine tile size: default is ~ FFT_TILE_PSF_RATIO times the PSF size, but
+  // no bigger than needed to cover the output region with a single tile
+  if (nColumns_tileRequested > 0)
+    nColumns_tile = std::max(nColumns_tileRequested, nColumns_psf);
+  else {
+    nColumns_tile = GoodFFTSize(std::max(FFT_TILE_PSF_RATIO*(nColumns_psf - 1), MIN_FFT_TILE_SIZE));
+    nColumns_tile = std::min(nColumns_tile, GoodFFTSize(nColumns_output + nColumns_psf - 1));
+  }
+  if (nRows_tileRequested > 0)
+    nRows_tile = std::max(nRows_tileRequested, nRows_psf);
+  else {
+    nRows_tile = GoodFFTSize(std::max(FFT_TILE_PSF_RATIO*(nRows_psf - 1), MIN_FFT_TILE_SIZE));
+    nRows_tile = std::min(nRows_tile, GoodFFTSize(nRows_output + nRows_psf - 1));
+  }
+  // each tile produces this many uncontaminated (non-wrapped) output pixels per side
+  nColumns_tileValid = nColumns_tile - nColumns_psf + 1;
+  nRows_tileValid = nRows_tile - nRows_psf + 1;
+  nPixels_tile = (long)nColumns_tile * (long)nRows_tile;
+  nPixels_tile_complex = (long)nRows_tile * (long)(nColumns_tile/2 + 1);
+  tileRescaleFactor = 1.0 / nPixels_tile;
+  if (debugStatus >= 1)
+    printf("Overlap-save convolution: FFT tiles = %d x %d pixels (%d x %d useful)\n",
+    		nColumns_tile, nRows_tile, nColumns_tileValid, nRows_tileValid);
+
+  psf_in_tile = (double*) fftw_malloc(sizeof(double) * nPixels_tile);
+  psf_fft_tile = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_tile_complex);
+  // rows above the output block in each tile which lie in the previous band
+  nRows_tileHalo = nRows_psf - 1 - nRows_psf/2;
+  tileBandOutput = (double *) calloc((size_t)nColumns_output * (size_t)nRows_tileValid, 
+  									sizeof(double));
+  tileHaloRows = (double *) calloc((size_t)nColumns_image * (size_t)std::max(nRows_tileHalo, 1), 
+  									sizeof(double));
+  tileHaloTemp = (double *) calloc((size_t)nColumns_image * (size_t)std::max(nRows_tileHalo, 1), 
+  									sizeof(double));
+  if ((psf_in_tile == NULL) || (psf_fft_tile == NULL) || (tileBandOutput == NULL)
+  		|| (tileHaloRows == NULL) || (tileHaloTemp == NULL)) {
+    fprintf(stderr, "*** WARNING: Convolver::DoFullSetup: memory allocation failure!\n");
+	return -2;
+  }
+  tileVectorsAllocated = true;
+
+  // Tiles are processed in parallel via OpenMP, so the plans themselves should be
+  // single-threaded; plans are created using temporary arrays (since FFTW_MEASURE
+  // overwrites them), and then executed on per-thread arrays with the new-array
+  // execute functions, which is thread-safe
+#ifdef FFTW_THREADING
+  fftw_plan_with_nthreads(1);
+#endif  // FFTW_THREADING
+  tempIn = (double*) fftw_malloc(sizeof(double) * nPixels_tile);
+  tempOut = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_tile_complex);
+  plan_tileForward = fftw_plan_dft_r2c_2d(nRows_tile, nColumns_tile, tempIn, tempOut, fftwFlags);
+  plan_tileInverse = fftw_plan_dft_c2r_2d(nRows_tile, nColumns_tile, tempOut, tempIn, fftwFlags);
+  fftw_free(tempIn);
+  fftw_free(tempOut);
+  tilePlansCreated = true;
+
+  // Generate the Fourier transform of the (normalized) PSF at tile size
+  for (long k = 0; k < nPixels_tile; k++)
+    psf_in_tile[k] = 0.0;
+  ShiftAndWrapPSF(psf_in_tile, nColumns_tile, nRows_tile);
+  fftw_execute_dft_r2c(plan_tileForward, psf_in_tile, psf_fft_tile);
+  
+  return 0;
+}
+
+
+/* ---------------- CheckPSFSeparability ------------------------------- */
+/// Determines whether the (normalized) PSF is the outer product of a column
+/// vector and a row vector, to within SEPARABLE_PSF_TOLERANCE; if so, the row
+/// and column kernels are stored in psfRowKernels and psfColumnKernels and true
+/// is returned.
+bool Convolver::CheckPSFSeparability( )
+{
+  int  i, j, iPeak = 0, jPeak = 0;
+  long  k;
+  double  peakVal = 0.0;
+  
+  for (k = 0; k < nPixels_psf; k++) {
+    if (fabs(psfPixels[k]) > fabs(peakVal)) {
+      peakVal = psfPixels[k];
+      iPeak = (int)(k / nColumns_psf);
+      jPeak = (int)(k % nColumns_psf);
+    }
+  }
+  if (peakVal == 0.0)
+    return false;
+  
+  psfRowKernels = (double *) calloc((size_t)nColumns_psf, sizeof(double));
+  psfColumnKernels = (double *) calloc((size_t)nRows_psf, sizeof(double));
+  // PSF ~ psfColumnKernels[i] * psfRowKernels[j], using row and column through peak
+  for (j = 0; j < nColumns_psf; j++)
+    psfRowKernels[j] = psfPixels[(long)iPeak*nColumns_psf + j];
+  for (i = 0; i < nRows_psf; i++)
+    psfColumnKernels[i] = psfPixels[(long)i*nColumns_psf + jPeak] / peakVal;
+  
+  for (i = 0; i < nRows_psf; i++) {
+    for (j = 0; j < nColumns_psf; j++) {
+      double  diff = psfPixels[(long)i*nColumns_psf + j] - psfColumnKernels[i]*psfRowKernels[j];
+      if (fabs(diff) > SEPARABLE_PSF_TOLERANCE*fabs(peakVal)) {
+        free(psfRowKernels);
+        free(psfColumnKernels);
+        return false;
+      }
+    }
+  }
+  if (debugStatus >= 1)
+    printf("PSF is separable\n");
+  return true;
+}
+
+
+/* ---------------- ComputeLowRankPSF ---------------------------------- */
+/// Approximates the (normalized) PSF as a sum of separable terms, using the
+/// singular value decomposition PSF = sum_n s_n u_n v_n^T: terms are kept (in
+/// order of decreasing s_n) until the Frobenius norm of the remainder is
+/// <= lowRankTolerance times that of the PSF. Column kernels (s_n u_n) and row
+/// kernels (v_n) are stored in psfColumnKernels and psfRowKernels; the L1 norm
+/// of the residual PSF relative to the L1 norm of the PSF is stored in
+/// lowRankResidual. (Since |conv(image, residual)| <= L1(residual) * max|image|,
+/// this bounds the error of the convolved image relative to the exact convolution.)
+/// Returns the number of terms kept, or -1 if the PSF is all zeros.
+int Convolver::ComputeLowRankPSF( )
+{
+  int  i, j, n, nTerms;
+  int  nSV = nColumns_psf;
+  double  totalSq = 0.0, discardedSq, psfL1 = 0.0, residualL1 = 0.0;
+  double  *U = (double *) calloc((size_t)nPixels_psf, sizeof(double));
+  double  *V = (double *) calloc((size_t)nColumns_psf * nColumns_psf, sizeof(double));
+  double  *sigma = (double *) calloc((size_t)nSV, sizeof(double));
+  vector<int>  order(nSV);
+  
+  for (long k = 0; k < nPixels_psf; k++)
+    U[k] = psfPixels[k];
+  JacobiSVD(U, nRows_psf, nColumns_psf, sigma, V);
+  
+  // sort singular values in decreasing order
+  for (n = 0; n < nSV; n++)
+    order[n] = n;
+  std::sort(order.begin(), order.end(), [sigma](int a, int b) { return sigma[a] > sigma[b]; });
+  for (n = 0; n < nSV; n++)
+    totalSq += sigma[n]*sigma[n];
+  if (totalSq <= 0.0) {
+    fprintf(stderr, "*** ERROR: Convolver::DoFullSetup: PSF image is all zeros!\n");
+    free(U);
+    free(V);
+    free(sigma);
+    return -1;
+  }
+  
+  // find smallest number of terms satisfying the tolerance
+  discardedSq = totalSq;
+  for (nTerms = 0; nTerms < nSV; nTerms++) {
+    if (sqrt(discardedSq) <= lowRankTolerance*sqrt(totalSq))
+      break;
+    discardedSq -= sigma[order[nTerms]]*sigma[order[nTerms]];
+  }
+  nTerms = std::max(nTerms, 1);
+
+  nSeparableTerms = nTerms;
+  psfRowKernels = (double *) calloc((size_t)nTerms * nColumns_psf, sizeof(double));
+  psfColumnKernels = (double *) calloc((size_t)nTerms * nRows_psf, sizeof(double));
+  for (n = 0; n < nTerms; n++) {
+    int  m = order[n];
+    for (j = 0; j < nColumns_psf; j++)
+      psfRowKernels[(long)n*nColumns_psf + j] = V[(long)j*nColumns_psf + m];
+    for (i = 0; i < nRows_psf; i++)
+      psfColumnKernels[(long)n*nRows_psf + i] = sigma[m] * U[(long)i*nColumns_psf + m];
+  }
+  
+  // residual of approximation, relative to PSF
+  for (i = 0; i < nRows_psf; i++) {
+    for (j = 0; j < nColumns_psf; j++) {
+      double  approxVal = 0.0;
+      for (n = 0; n < nTerms; n++)
+        approxVal += psfColumnKernels[(long)n*nRows_psf + i] * psfRowKernels[(long)n*nColumns_psf + j];
+      psfL1 += fabs(psfPixels[(long)i*nColumns_psf + j]);
+      residualL1 += fabs(psfPixels[(long)i*nColumns_psf + j] - approxVal);
+    }
+  }
+  lowRankResidual = residualL1 / psfL1;
+  if (debugStatus >= 1)
+    printf("Low-rank PSF: %d separable terms (of %d); relative residual = %g\n", 
+    		nTerms, std::min(nRows_psf, nColumns_psf), lowRankResidual);
+
+  free(U);
+  free(V);
+  free(sigma);
+  return nTerms;
+}
+
+
+/* ---------------- ChooseConvolutionMethod ---------------------------- */
+/// Returns CONVOLVE_DIRECT or CONVOLVE_FFT, whichever has the lower estimated
+/// cost (see the cost-model constants at the top of this file). The full-image
+/// FFT requires two transforms of the padded image per convolution; direct
+/// convolution requires one multiply-add per PSF pixel per output pixel (or per
+/// row-kernel + column-kernel element, if the PSF is separable).
+int Convolver::ChooseConvolutionMethod( )
+{
+  double  nPixPadded, nPixOutput, nRowsNeeded, fftCost, directCost;
+  
+  nPixPadded = (double)(nColumns_image + nColumns_psf - 1) * (nRows_image + nRows_psf - 1);
+  fftCost = 2.0*FFT_COST_FACTOR*nPixPadded*log2(nPixPadded) + FFT_PIXEL_COST*nPixPadded;
+  
+  nPixOutput = (double)nColumns_output * nRows_output;
+  if (nSeparableTerms > 0) {
+    nRowsNeeded = std::min(nRows_output + nRows_psf - 1, nRows_image);
+    directCost = nRowsNeeded*nColumns_output*nColumns_psf + nPixOutput*nRows_psf;
+  }
+  else
+    directCost = nPixOutput*nColumns_psf*nRows_psf;
+
+  if (debugStatus >= 1)
+    printf("Convolution cost estimates: FFT = %g, direct%s = %g\n", fftCost,
+    		(nSeparableTerms > 0) ? " (separable)" : "", directCost);
+  if (directCost < fftCost)
+    return CONVOLVE_DIRECT;
+  else
+    return CONVOLVE_FFT;
+}
+
+
+/* ---------------- SetupDirect ---------------------------------------- */
+/// Setup for direct-space convolution (CONVOLVE_DIRECT, CONVOLVE_LOWRANK): 
+/// allocates the output buffer (non-separable PSF) or the intermediate 
+/// row-convolved images, one per separable term.
+int Convolver::SetupDirect( )
+{
+  if (debugStatus >= 1)
+    printf("Using direct convolution (%d separable terms)\n", nSeparableTerms);
+  
+  directOutput = NULL;
+  directTemp = NULL;
+  if (nSeparableTerms > 0)
+    directTemp = (double *) calloc((size_t)nSeparableTerms * (size_t)nColumns_output 
+    								* (size_t)nRows_image, sizeof(double));
+  else
+    directOutput = (double *) calloc((size_t)nColumns_output * (size_t)nRows_output, sizeof(double));
+  if ((directTemp == NULL) && (directOutput == NULL)) {
+    fprintf(stderr, "*** WARNING: Convolver::DoFullSetup: memory allocation failure!\n");
+	return -2;
+  }
+  directVectorsAllocated = true;
+  return 0;
+}
+
+
 /* ---------------- ConvolveImage -------------------------------------- */
 /// Given an input image (pointer to its pixel vector), convolve it with the PSF
 /// by: 1) Copying image to image_in_padded array (with zero-padding); 
 /// 2) Taking FFT of image; 3) Multiplying transform of image by transform of PSF; 
 /// 4) Taking inverse FFT of product; 5) Copying (and rescaling) result back into 
 ///    input image.
+/// (When profiling, steps 1--2 are timed as PROFILE_FFT_FORWARD and 3--5 as
+/// PROFILE_FFT_INVERSE.)
 void Convolver::ConvolveImage( double *pixelVector )
 {
   int  ii, jj;
   long  z;
   double  a, b, c, d, rawValue;
+  ProfileTimer  convolutionTimer(PROFILE_CONVOLUTION);
   
+  ProfileCount(PROFILE_N_CONVOLUTIONS);
+  if (convolutionMethod == CONVOLVE_FFT_TILED) {
+    ConvolveImage_tiled(pixelVector);
+    return;
+  }
+  if ((convolutionMethod == CONVOLVE_DIRECT) || (convolutionMethod == CONVOLVE_LOWRANK)) {
+    ProfileTimer  directTimer(PROFILE_DIRECT_CONVOLUTION);
+    if (nSeparableTerms > 0)
+      ConvolveImage_separable(pixelVector);
+    else
+      ConvolveImage_direct(pixelVector);
+    return;
+  }
+
+  ProfileTimer  forwardTimer(PROFILE_FFT_FORWARD);
   // Populate padded input image array for FFT
   //   First, zero the array to ensure zero-padding *is* zero
   for (z = 0; z < nPixels_padded; z++)
@@ -359,11 +796,13 @@ void Convolver::ConvolveImage( double *pixelVector )
   if (debugStatus >= 2)
     printf("Performing FFT of input image ...\n");
   fftw_execute(plan_inputImage);
+  forwardTimer.Stop();
   if (debugStatus >= 3) {
     printf("The (modulus of the) transform of the input image [image_fft_cmplx], row by row:\n");
     PrintComplexImage_Absolute(image_fft_cmplx, nColumns_padded, nRows_padded);
   }
   
+  ProfileTimer  inverseTimer(PROFILE_FFT_INVERSE);
   // Multiply transformed arrays:
   for (z = 0; z < nPixels_padded_complex; z++) {
     a = image_fft_cmplx[z][0];   // real part
@@ -411,10 +850,411 @@ void Convolver::ConvolveImage( double *pixelVector )
 
 
 
+/* ---------------- SetupBatchFFT -------------------------------------- */
+/// Allocates arrays and creates FFTW "many" plans for transforming up to nImages
+/// (zero-padded) images at once, with the batch size limited by MAX_FFT_BATCH_IMAGES
+/// and MAX_FFT_BATCH_BYTES. Existing batch arrays and plans are reused if they have
+/// the right size. Returns the batch size (1 = no batching, or allocation failure).
+int Convolver::SetupBatchFFT( int nImages )
+{
+  double  bytesPerImage;
+  int  nBatch, dims[2];
+
+  bytesPerImage = sizeof(double)*(double)nPixels_padded 
+  				+ sizeof(fftw_complex)*(double)nPixels_padded_complex;
+  nBatch = std::min(nImages, MAX_FFT_BATCH_IMAGES);
+  nBatch = std::min(nBatch, (int)(MAX_FFT_BATCH_BYTES / bytesPerImage));
+  if (nBatch < 2)
+    return 1;
+  if (batchVectorsAllocated) {
+    if (nBatch == nBatchImages)
+      return nBatch;
+    fftw_destroy_plan(plan_batchForward);
+    fftw_destroy_plan(plan_batchInverse);
+    fftw_free(batch_in_padded);
+    fftw_free(batch_fft_cmplx);
+    batchVectorsAllocated = false;
+  }
+
+  batch_in_padded = (double*) fftw_malloc(sizeof(double) * nPixels_padded * nBatch);
+  batch_fft_cmplx = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_padded_complex * nBatch);
+  if ((batch_in_padded == NULL) || (batch_fft_cmplx == NULL)) {
+    fprintf(stderr, "*** WARNING: Convolver::SetupBatchFFT: memory allocation failure;");
+    fprintf(stderr, " images will be convolved one at a time.\n");
+    fftw_free(batch_in_padded);
+    fftw_free(batch_fft_cmplx);
+    return 1;
+  }
+  // the images in each batch are stored one after the other in the arrays
+  dims[0] = nRows_padded;
+  dims[1] = nColumns_padded;
+#ifdef FFTW_THREADING
+  fftw_plan_with_nthreads(nFFTWThreads);
+#endif  // FFTW_THREADING
+  plan_batchForward = fftw_plan_many_dft_r2c(2, dims, nBatch, batch_in_padded, NULL, 1, 
+  								nPixels_padded, batch_fft_cmplx, NULL, 1, nPixels_padded_complex,
+  								fftwPlanFlags);
+  plan_batchInverse = fftw_plan_many_dft_c2r(2, dims, nBatch, batch_fft_cmplx, NULL, 1, 
+  								nPixels_padded_complex, batch_in_padded, NULL, 1, nPixels_padded,
+  								fftwPlanFlags);
+  nBatchImages = nBatch;
+  batchVectorsAllocated = true;
+  return nBatch;
+}
+
+
+/* ---------------- ConvolveImages ------------------------------------- */
+/// Convolves each of nImages input images (pointers to their pixel vectors) with
+/// the PSF, replacing the input. With CONVOLVE_FFT, the images are copied into
+/// consecutive zero-padded arrays and transformed in batches (one FFTW plan
+/// execution per batch for the forward and inverse transforms), with each transform
+/// multiplied by the single stored PSF transform; the results are the same as
+/// calling ConvolveImage for each image. Other methods convolve one image at a time.
+void Convolver::ConvolveImages( double **pixelVectors, int nImages )
+{
+  int  nBatch, nInBatch;
+  int  n = 0;
+
+  if (convolutionMethod == CONVOLVE_FFT)
+    nBatch = SetupBatchFFT(nImages);
+  else
+    nBatch = 1;
+
+  // whole batches
+  for (n = 0; (nBatch > 1) && (n + nBatch <= nImages); n += nBatch) {
+    nInBatch = nBatch;
+    ProfileTimer  convolutionTimer(PROFILE_CONVOLUTION);
+    ProfileTimer  forwardTimer(PROFILE_FFT_FORWARD);
+    ProfileCount(PROFILE_N_CONVOLUTIONS, nInBatch);
+#pragma omp parallel for schedule (static, 1)
+    for (int b = 0; b < nInBatch; b++) {
+      double  *padded = batch_in_padded + (long)b*nPixels_padded;
+      const double  *input = pixelVectors[n + b];
+      for (long z = 0; z < nPixels_padded; z++)
+        padded[z] = 0.0;
+      for (long ii = 0; ii < nRows_image; ii++)
+        for (long jj = 0; jj < nColumns_image; jj++)
+          padded[ii*nColumns_padded + jj] = input[ii*nColumns_image + jj];
+    }
+
+    fftw_execute(plan_batchForward);
+    forwardTimer.Stop();
+
+    ProfileTimer  inverseTimer(PROFILE_FFT_INVERSE);
+#pragma omp parallel for schedule (static, 1)
+    for (int b = 0; b < nInBatch; b++) {
+      fftw_complex  *imageFFT = batch_fft_cmplx + (long)b*nPixels_padded_complex;
+      double  a, bb, c, d;
+      for (long z = 0; z < nPixels_padded_complex; z++) {
+        a = imageFFT[z][0];
+        bb = imageFFT[z][1];
+        c = psf_fft_cmplx[z][0];
+        d = psf_fft_cmplx[z][1];
+        imageFFT[z][0] = a*c - bb*d;
+        imageFFT[z][1] = bb*c + a*d;
+      }
+    }
+
+    fftw_execute(plan_batchInverse);
+
+#pragma omp parallel for schedule (static, 1)
+    for (int b = 0; b < nInBatch; b++) {
+      const double  *padded = batch_in_padded + (long)b*nPixels_padded;
+      double  *output = pixelVectors[n + b];
+      for (long ii = 0; ii < nRows_image; ii++)
+        for (long jj = 0; jj < nColumns_image; jj++)
+          output[ii*nColumns_image + jj] = rescaleFactor * padded[ii*nColumns_padded + jj];
+    }
+  }
+
+  // leftover images (or all images, if not batching)
+  for ( ; n < nImages; n++)
+    ConvolveImage(pixelVectors[n]);
+}
+
+
+/* ---------------- ConvolveImageInBands ------------------------------- */
+/// Convolves the image in place, as ConvolveImage does, calling bandFunc(rowStart,
+/// rowEnd, bandData) whenever output rows rowStart to rowEnd - 1 (within the output
+/// region, if one was set) are final. With CONVOLVE_FFT_TILED, this happens after
+/// each band of tiles, and if bandFunc returns false, the remaining bands are
+/// skipped; with the other methods, bandFunc is called once, after the whole image
+/// has been convolved. Returns the value returned by the last call to bandFunc.
+bool Convolver::ConvolveImageInBands( double *pixelVector, ConvolverBandFunction bandFunc,
+									void *bandData )
+{
+  int  rowStart = 0, rowEnd = nRows_image;
+  
+  if (convolutionMethod == CONVOLVE_FFT_TILED) {
+    ProfileTimer  convolutionTimer(PROFILE_CONVOLUTION);
+    ProfileCount(PROFILE_N_CONVOLUTIONS);
+    return ConvolveImage_tiled(pixelVector, bandFunc, bandData);
+  }
+  ConvolveImage(pixelVector);
+  if (outputRegionSet) {
+    rowStart = y0_output;
+    rowEnd = y0_output + nRows_output;
+  }
+  return bandFunc(rowStart, rowEnd, bandData);
+}
+
+
+/* ---------------- ConvolveImage_tiled -------------------------------- */
+/// Overlap-save convolution: the output region is divided into blocks of
+/// nColumns_tileValid x nRows_tileValid pixels; for each block, the corresponding
+/// input region (the block plus a PSF-sized margin, with zeros outside the image)
+/// is copied into a tile, Fourier-transformed, multiplied by the tile-sized PSF
+/// transform, and inverse-transformed. Output pixels which are not affected by
+/// wrap-around are then copied into the output image.
+///
+/// Since the convolution is done in place, the blocks are processed one row of
+/// blocks ("band") at a time, from the bottom up: tiles within a band are done in
+/// parallel (each thread using its own tile-sized work arrays), with their output
+/// going into a band-sized buffer which is copied into the image once the whole
+/// band is done. The input rows just below the current band have already been
+/// overwritten by then, so their original values are kept in tileHaloRows.
+///
+/// If bandFunc is non-NULL, it is called (from a single thread) after each band has
+/// been copied into the image; if it returns false, the remaining bands are skipped
+/// and this function returns false.
+bool Convolver::ConvolveImage_tiled( double *pixelVector, ConvolverBandFunction bandFunc,
+									void *bandData )
+{
+  // offset of the output block within its input tile
+  int  offsetX = nColumns_psf - 1 - nColumns_psf/2;
+  int  offsetY = nRows_tileHalo;
+  int  nTilesX = (nColumns_output + nColumns_tileValid - 1) / nColumns_tileValid;
+  int  haloStart = y0_output - offsetY;
+  bool  bandsStopped = false;
+  
+#pragma omp parallel
+  {
+  int  ii, jj, x0_block, nColsValid, imageRow, imageCol;
+  int  y0_block, y0_next, nRowsValid;
+  double  a, b, c, d;
+  double  *tileIn = (double*) fftw_malloc(sizeof(double) * nPixels_tile);
+  double  *tileOut = (double*) fftw_malloc(sizeof(double) * nPixels_tile);
+  fftw_complex  *tile_cmplx = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_tile_complex);
+
+  for (y0_block = 0; (y0_block < nRows_output) && (! bandsStopped); y0_block = y0_next) {
+    nRowsValid = std::min(nRows_tileValid, nRows_output - y0_block);
+    y0_next = y0_block + nRowsValid;
+
+    #pragma omp for schedule (dynamic, 1)
+    for (int t = 0; t < nTilesX; t++) {
+      // left edge of output block, relative to output region
+      x0_block = t * nColumns_tileValid;
+      nColsValid = std::min(nColumns_tileValid, nColumns_output - x0_block);
+    
+      // copy input region into tile, zero-padding outside the image; rows which
+      // are part of earlier (already convolved) bands come from the halo buffer
+      for (ii = 0; ii < nRows_tile; ii++) {
+        imageRow = y0_output + y0_block - offsetY + ii;
+        double  *tileRow = tileIn + (long)ii*nColumns_tile;
+        if ((imageRow < 0) || (imageRow >= nRows_image)) {
+          for (jj = 0; jj < nColumns_tile; jj++)
+            tileRow[jj] = 0.0;
+          continue;
+        }
+        double  *imageRowPtr;
+        if ((y0_block > 0) && (imageRow < y0_output + y0_block))
+          imageRowPtr = tileHaloRows + (long)(imageRow - haloStart)*nColumns_image;
+        else
+          imageRowPtr = pixelVector + (long)imageRow*nColumns_image;
+        for (jj = 0; jj < nColumns_tile; jj++) {
+          imageCol = x0_output + x0_block - offsetX + jj;
+          if ((imageCol < 0) || (imageCol >= nColumns_image))
+            tileRow[jj] = 0.0;
+          else
+            tileRow[jj] = imageRowPtr[imageCol];
+        }
+      }
+    
+      fftw_execute_dft_r2c(plan_tileForward, tileIn, tile_cmplx);
+      for (long z = 0; z < nPixels_tile_complex; z++) {
+        a = tile_cmplx[z][0];   // real part
+        b = tile_cmplx[z][1];   // imaginary part
+        c = psf_fft_tile[z][0];
+        d = psf_fft_tile[z][1];
+        tile_cmplx[z][0] = a*c - b*d;
+        tile_cmplx[z][1] = b*c + a*d;
+      }
+      fftw_execute_dft_c2r(plan_tileInverse, tile_cmplx, tileOut);
+    
+      // copy (and rescale) the non-wrapped part of the tile into the band buffer
+      for (ii = 0; ii < nRowsValid; ii++) {
+        double  *tileRow = tileOut + (long)(ii + offsetY)*nColumns_tile + offsetX;
+        double  *outRow = tileBandOutput + (long)ii*nColumns_output + x0_block;
+        for (jj = 0; jj < nColsValid; jj++)
+          outRow[jj] = tileRescaleFactor * tileRow[jj];
+      }
+    }   // implicit barrier: band is complete
+
+    #pragma omp single
+    {
+    // save original values of the input rows the next band needs from this one
+    // (or from the current halo, if the band is shorter than the halo)
+    if (y0_next < nRows_output) {
+      int  newHaloStart = y0_output + y0_next - offsetY;
+      for (int k = 0; k < offsetY; k++) {
+        int  row = newHaloStart + k;
+        if ((row < 0) || (row >= nRows_image))
+          continue;
+        double  *dest = tileHaloTemp + (long)k*nColumns_image;
+        double  *src;
+        if ((y0_block > 0) && (row < y0_output + y0_block))
+          src = tileHaloRows + (long)(row - haloStart)*nColumns_image;
+        else
+          src = pixelVector + (long)row*nColumns_image;
+        for (int m = 0; m < nColumns_image; m++)
+          dest[m] = src[m];
+      }
+      double  *swapTemp = tileHaloRows;
+      tileHaloRows = tileHaloTemp;
+      tileHaloTemp = swapTemp;
+      haloStart = newHaloStart;
+    }
+
+    // copy convolved band into the image
+    for (int m = 0; m < nRowsValid; m++) {
+      double  *outRow = tileBandOutput + (long)m*nColumns_output;
+      double  *imageRowPtr = pixelVector + (long)(y0_output + y0_block + m)*nColumns_image + x0_output;
+      for (int n = 0; n < nColumns_output; n++)
+        imageRowPtr[n] = outRow[n];
+    }
+    if ((bandFunc != NULL) && (! bandFunc(y0_output + y0_block, y0_output + y0_next, bandData)))
+      bandsStopped = true;
+    }   // end omp single (implicit barrier)
+  }
+  
+  fftw_free(tileIn);
+  fftw_free(tileOut);
+  fftw_free(tile_cmplx);
+  } // end omp parallel section
+  
+  return (! bandsStopped);
+}
+
+
+
+/* ---------------- ConvolveImage_direct ------------------------------- */
+/// Direct-space convolution with the full 2D PSF, for pixels in the output
+/// region (with zeros assumed outside the image, as for the FFT methods).
+/// Each output row is accumulated as a sum of shifted, weighted input rows, so
+/// that the innermost loop runs over contiguous pixels (and can be vectorized
+/// by the compiler); output rows are divided among OpenMP threads.
+void Convolver::ConvolveImage_direct( double *pixelVector )
+{
+  int  centerX_psf = nColumns_psf / 2;
+  int  centerY_psf = nRows_psf / 2;
+  int  ii, jj, psfRow, psfCol, imageRow, shift, jStart, jEnd;
+  double  w;
+  double  *outRow, *srcRow;
+  
+#pragma omp parallel private(ii,jj,psfRow,psfCol,imageRow,shift,jStart,jEnd,w,outRow,srcRow)
+  {
+  #pragma omp for schedule (static)
+  for (ii = 0; ii < nRows_output; ii++) {
+    outRow = directOutput + (long)ii*nColumns_output;
+    for (jj = 0; jj < nColumns_output; jj++)
+      outRow[jj] = 0.0;
+    for (psfRow = 0; psfRow < nRows_psf; psfRow++) {
+      imageRow = y0_output + ii - psfRow + centerY_psf;
+      if ((imageRow < 0) || (imageRow >= nRows_image))
+        continue;
+      srcRow = pixelVector + (long)imageRow*nColumns_image;
+      for (psfCol = 0; psfCol < nColumns_psf; psfCol++) {
+        w = psfPixels[(long)psfRow*nColumns_psf + psfCol];
+        // output-region column jj uses input column jj + shift
+        shift = x0_output + centerX_psf - psfCol;
+        jStart = std::max(0, -shift);
+        jEnd = std::min(nColumns_output, nColumns_image - shift);
+        for (jj = jStart; jj < jEnd; jj++)
+          outRow[jj] += w * srcRow[jj + shift];
+      }
+    }
+  }
+  } // end omp parallel section
+
+  // copy convolved output region back into input image
+  for (ii = 0; ii < nRows_output; ii++) {
+    outRow = directOutput + (long)ii*nColumns_output;
+    double  *imageRowPtr = pixelVector + (long)(y0_output + ii)*nColumns_image + x0_output;
+    for (jj = 0; jj < nColumns_output; jj++)
+      imageRowPtr[jj] = outRow[jj];
+  }
+}
+
+
+/* ---------------- ConvolveImage_separable ---------------------------- */
+/// Direct-space convolution with a PSF which is the sum of nSeparableTerms
+/// separable terms: first convolve the needed image rows with each term's row
+/// kernel (storing the output-region columns in directTemp), then convolve the
+/// columns of the results with the corresponding column kernels, summing the
+/// terms and writing directly into the output region of the image.
+void Convolver::ConvolveImage_separable( double *pixelVector )
+{
+  int  centerX_psf = nColumns_psf / 2;
+  int  centerY_psf = nRows_psf / 2;
+  int  rowStart = std::max(0, y0_output - (nRows_psf - 1 - centerY_psf));
+  int  rowEnd = std::min(nRows_image, y0_output + nRows_output + centerY_psf);
+  long  nPixels_temp = (long)nColumns_output * (long)nRows_image;
+  int  ii, jj, r, k, n, shift, jStart, jEnd;
+  double  w;
+  double  *tempRow, *srcRow, *rowKernel, *columnKernel;
+  
+#pragma omp parallel private(ii,jj,r,k,n,shift,jStart,jEnd,w,tempRow,srcRow,rowKernel,columnKernel)
+  {
+  // 1. Row pass: directTemp[n][r][jj] = sum_k rowKernel_n[k]*image[r][x0_output + jj - k + centerX]
+  #pragma omp for schedule (static)
+  for (r = rowStart; r < rowEnd; r++) {
+    srcRow = pixelVector + (long)r*nColumns_image;
+    for (n = 0; n < nSeparableTerms; n++) {
+      rowKernel = psfRowKernels + (long)n*nColumns_psf;
+      tempRow = directTemp + n*nPixels_temp + (long)r*nColumns_output;
+      for (jj = 0; jj < nColumns_output; jj++)
+        tempRow[jj] = 0.0;
+      for (k = 0; k < nColumns_psf; k++) {
+        w = rowKernel[k];
+        shift = x0_output + centerX_psf - k;
+        jStart = std::max(0, -shift);
+        jEnd = std::min(nColumns_output, nColumns_image - shift);
+        for (jj = jStart; jj < jEnd; jj++)
+          tempRow[jj] += w * srcRow[jj + shift];
+      }
+    }
+  }
+  
+  // 2. Column pass (implicit barrier at end of previous loop ensures directTemp is
+  // complete); all input pixels needed are now in directTemp, so we can write
+  // directly into the image
+  #pragma omp for schedule (static)
+  for (ii = 0; ii < nRows_output; ii++) {
+    double  *outRow = pixelVector + (long)(y0_output + ii)*nColumns_image + x0_output;
+    for (jj = 0; jj < nColumns_output; jj++)
+      outRow[jj] = 0.0;
+    for (n = 0; n < nSeparableTerms; n++) {
+      columnKernel = psfColumnKernels + (long)n*nRows_psf;
+      for (k = 0; k < nRows_psf; k++) {
+        r = y0_output + ii - k + centerY_psf;
+        if ((r < 0) || (r >= nRows_image))
+          continue;
+        w = columnKernel[k];
+        tempRow = directTemp + n*nPixels_temp + (long)r*nColumns_output;
+        for (jj = 0; jj < nColumns_output; jj++)
+          outRow[jj] += w * tempRow[jj];
+      }
+    }
+  }
+  } // end omp parallel section
+}
+
+
+
 /// Takes the input PSF (assumed to be centered in the central pixel
-/// of the image) and copy it into the (padded) image, with the
+/// of the image) and copy it into the (padded) destination image, with the
 /// PSF wrapped into the corners, suitable for convolutions.
-void Convolver::ShiftAndWrapPSF( )
+void Convolver::ShiftAndWrapPSF( double *destPixels, int nColumns_dest, int nRows_dest )
 {
   int  centerX_psf, centerY_psf;
   int  psfCol, psfRow, destCol, destRow;
@@ -428,16 +1268,105 @@ void Convolver::ShiftAndWrapPSF( )
       psfCol = j;
       psfRow = i;
       pos_in_psf = (long)i*nColumns_psf + j;
-      destCol = (nColumns_padded - centerX_psf + psfCol) % nColumns_padded;
-      destRow = (nRows_padded - centerY_psf + psfRow) % nRows_padded;
-      pos_in_dest = (long)destRow * (long)nColumns_padded + destCol;
-      psf_in_padded[pos_in_dest] = psfPixels[pos_in_psf];
+      destCol = (nColumns_dest - centerX_psf + psfCol) % nColumns_dest;
+      destRow = (nRows_dest - centerY_psf + psfRow) % nRows_dest;
+      pos_in_dest = (long)destRow * (long)nColumns_dest + destCol;
+      destPixels[pos_in_dest] = psfPixels[pos_in_psf];
     }
   }
 }
 
 
 
+/// Singular value decomposition of the nRows x nColumns matrix A (stored by rows)
+/// via one-sided Jacobi rotations. On output, A has been replaced by U*diag(sigma)
+/// with unit-normalized columns (i.e., the columns of A are the left singular
+/// vectors, except where sigma = 0), and V (nColumns x nColumns, stored by rows)
+/// holds the right singular vectors as columns. Singular values are *not* sorted.
+/// (Meant for small matrices such as PSF images; cost is ~ nRows * nColumns^2
+/// per sweep.)
+void JacobiSVD( double *A, int nRows, int nColumns, double *sigma, double *V )
+{
+  int  i, p, q, sweep;
+  double  alpha, beta, gamma, zeta, t, c, s, tempP, tempQ, maxOffDiag;
+  const double  epsilon = 1.0e-15;
+  
+  for (p = 0; p < nColumns; p++)
+    for (q = 0; q < nColumns; q++)
+      V[(long)p*nColumns + q] = (p == q) ? 1.0 : 0.0;
+  
+  for (sweep = 0; sweep < MAX_JACOBI_SWEEPS; sweep++) {
+    maxOffDiag = 0.0;
+    for (p = 0; p < nColumns - 1; p++) {
+      for (q = p + 1; q < nColumns; q++) {
+        alpha = beta = gamma = 0.0;
+        for (i = 0; i < nRows; i++) {
+          tempP = A[(long)i*nColumns + p];
+          tempQ = A[(long)i*nColumns + q];
+          alpha += tempP*tempP;
+          beta += tempQ*tempQ;
+          gamma += tempP*tempQ;
+        }
+        if ((alpha == 0.0) || (beta == 0.0) || (fabs(gamma) <= epsilon*sqrt(alpha*beta)))
+          continue;
+        maxOffDiag = std::max(maxOffDiag, fabs(gamma)/sqrt(alpha*beta));
+        // rotation which orthogonalizes columns p and q
+        zeta = (beta - alpha) / (2.0*gamma);
+        t = ((zeta >= 0.0) ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1.0 + zeta*zeta));
+        c = 1.0 / sqrt(1.0 + t*t);
+        s = c*t;
+        for (i = 0; i < nRows; i++) {
+          tempP = A[(long)i*nColumns + p];
+          tempQ = A[(long)i*nColumns + q];
+          A[(long)i*nColumns + p] = c*tempP - s*tempQ;
+          A[(long)i*nColumns + q] = s*tempP + c*tempQ;
+        }
+        for (i = 0; i < nColumns; i++) {
+          tempP = V[(long)i*nColumns + p];
+          tempQ = V[(long)i*nColumns + q];
+          V[(long)i*nColumns + p] = c*tempP - s*tempQ;
+          V[(long)i*nColumns + q] = s*tempP + c*tempQ;
+        }
+      }
+    }
+    if (maxOffDiag < epsilon)
+      break;
+  }
+  
+  for (p = 0; p < nColumns; p++) {
+    alpha = 0.0;
+    for (i = 0; i < nRows; i++)
+      alpha += A[(long)i*nColumns + p]*A[(long)i*nColumns + p];
+    sigma[p] = sqrt(alpha);
+    if (sigma[p] > 0.0)
+      for (i = 0; i < nRows; i++)
+        A[(long)i*nColumns + p] /= sigma[p];
+  }
+}
+
+
+/// Returns the smallest integer >= n whose only prime factors are 2, 3, 5, and 7
+/// (sizes for which FFTW is most efficient).
+int GoodFFTSize( int n )
+{
+  int  m, k;
+  
+  for (m = std::max(n, 1); ; m++) {
+    k = m;
+    while (k % 2 == 0)
+      k /= 2;
+    while (k % 3 == 0)
+      k /= 3;
+    while (k % 5 == 0)
+      k /= 5;
+    while (k % 7 == 0)
+      k /= 7;
+    if (k == 1)
+      return m;
+  }
+}
+
+
 /// For debugging purposes: prints the a real-valued image to the console.
 void PrintRealImage( double *image, int nColumns, int nRows )
 {
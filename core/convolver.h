@@ -10,10 +10,17 @@
 #include <vector>
 
 #include "fftw3.h"
+#include "definitions.h"
 
 using namespace std;
 
 
+/// Returns smallest integer >= n with no prime factors larger than 7 (efficient FFT size)
+int GoodFFTSize( int n );
+
+/// Singular value decomposition (one-sided Jacobi) of a small matrix, such as a PSF image
+void JacobiSVD( double *A, int nRows, int nColumns, double *sigma, double *V );
+
 /// For debugging use: print a real-valued image to stdout
 void PrintRealImage( double *image, int nColumns, int nRows );
 
@@ -23,6 +30,10 @@ void PrintComplexImage_RealPart( fftw_complex *image_cmplx, int nColumns, int nR
 /// For debugging use: print absolute value of complex-valued image to stdout
 void PrintComplexImage_Absolute( fftw_complex *image_cmplx, int nColumns, int nRows );
 
+/// Function called by Convolver::ConvolveImageInBands once rows rowStart to rowEnd - 1
+/// of the output image are final; returning false stops the convolution
+typedef bool (*ConvolverBandFunction)( int rowStart, int rowEnd, void *bandData );
+
 
 
 // NOTE: The following class is used in PyImfit
@@ -40,6 +51,31 @@ class Convolver
     /// Set maximum number of FFTW threads
     void SetMaxThreads( int maximumThreadNumber );
     
+    /// Specify convolution method (CONVOLVE_FFT [default], CONVOLVE_FFT_TILED,
+    /// CONVOLVE_DIRECT, CONVOLVE_LOWRANK, or CONVOLVE_AUTO)
+    int SetConvolutionMethod( int method );
+
+    /// Return the convolution method in use (after DoFullSetup, CONVOLVE_AUTO
+    /// will have been replaced by the method actually chosen)
+    int GetConvolutionMethod( ) { return convolutionMethod; };
+
+    /// Set size of FFT tiles for CONVOLVE_FFT_TILED (0 = choose automatically)
+    void SetFFTTileSize( int nColumns, int nRows );
+
+    /// Set tolerance for CONVOLVE_LOWRANK (max. fractional Frobenius norm of discarded terms)
+    void SetLowRankTolerance( double tolerance );
+
+    /// Number of separable terms used for direct convolution (0 = PSF not separable)
+    int GetNSeparableTerms( ) { return nSeparableTerms; };
+
+    /// Sum of |PSF - low-rank approximation| relative to sum of |PSF| (bound on
+    /// the relative error of the convolved image)
+    double GetLowRankResidual( ) { return lowRankResidual; };
+
+    /// Restrict output of CONVOLVE_FFT_TILED, CONVOLVE_DIRECT, and CONVOLVE_LOWRANK
+    /// to a subsection of the image
+    void SetOutputRegion( int x0, int y0, int nColumns, int nRows );
+
     /// Supply PSF image to Convolver object
     void SetupPSF( double *psfPixels_input, int nColumns, int nRows,
     				bool normalize=true );
@@ -52,10 +88,39 @@ class Convolver
     /// Replace input model image (pixelVector) with convolution using stored PSF
     void ConvolveImage( double *pixelVector );
 
+    /// Same as ConvolveImage, but calls bandFunc as each band of rows of the output
+    /// is finished (CONVOLVE_FFT_TILED; for other methods, once for all rows);
+    /// returns false if bandFunc stopped the convolution (output is then incomplete)
+    bool ConvolveImageInBands( double *pixelVector, ConvolverBandFunction bandFunc,
+    							void *bandData );
+
+    /// Replace each of nImages input model images with its convolution; for
+    /// CONVOLVE_FFT, images are transformed in batches which share the PSF transform
+    void ConvolveImages( double **pixelVectors, int nImages );
+
 
   private:
   // Private member functions:
-  void ShiftAndWrapPSF( );
+  void ShiftAndWrapPSF( double *destPixels, int nColumns_dest, int nRows_dest );
+  
+  int SetupTiledFFT( unsigned fftwFlags );
+
+  int SetupBatchFFT( int nImages );
+
+  bool ConvolveImage_tiled( double *pixelVector, ConvolverBandFunction bandFunc=NULL,
+  							void *bandData=NULL );
+
+  bool CheckPSFSeparability( );
+
+  int ComputeLowRankPSF( );
+
+  int ChooseConvolutionMethod( );
+
+  int SetupDirect( );
+
+  void ConvolveImage_direct( double *pixelVector );
+
+  void ConvolveImage_separable( double *pixelVector );
   
   // Data members:
   long  nPixels_image, nPixels_psf, nPixels_padded;
@@ -72,8 +137,37 @@ class Convolver
   fftw_complex  *multiplied_cmplx;
   fftw_plan  plan_inputImage, plan_psf, plan_inverse;
   bool  psfInfoSet, imageInfoSet, fftVectorsAllocated, fftPlansCreated;
+  unsigned  fftwPlanFlags;
+  int  nFFTWThreads;
+  // batched transforms of several images (ConvolveImages with CONVOLVE_FFT)
+  int  nBatchImages;
+  double  *batch_in_padded;
+  fftw_complex  *batch_fft_cmplx;
+  fftw_plan  plan_batchForward, plan_batchInverse;
+  bool  batchVectorsAllocated;
   bool  normalizePSF;
   int  debugStatus;
+  int  convolutionMethod;
+  // output region (for CONVOLVE_FFT_TILED and CONVOLVE_DIRECT)
+  int  x0_output, y0_output, nColumns_output, nRows_output;
+  bool  outputRegionSet;
+  // tiles for CONVOLVE_FFT_TILED
+  int  nColumns_tile, nRows_tile, nColumns_tileValid, nRows_tileValid;
+  int  nColumns_tileRequested, nRows_tileRequested;
+  long  nPixels_tile, nPixels_tile_complex;
+  double  tileRescaleFactor;
+  double  *psf_in_tile;
+  int  nRows_tileHalo;
+  double  *tileBandOutput, *tileHaloRows, *tileHaloTemp;
+  fftw_complex  *psf_fft_tile;
+  fftw_plan  plan_tileForward, plan_tileInverse;
+  bool  tileVectorsAllocated, tilePlansCreated;
+  // direct convolution (CONVOLVE_DIRECT, CONVOLVE_LOWRANK)
+  int  nSeparableTerms;
+  double  *psfRowKernels, *psfColumnKernels;
+  double  lowRankTolerance, lowRankResidual;
+  double  *directOutput, *directTemp;
+  bool  directVectorsAllocated;
 };
 
 
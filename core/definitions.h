@@ -54,6 +54,10 @@ const int FITSTAT_CHISQUARE_USER    =      12;   /// chi^2, per-pixel errors are
 
 const double DEFAULT_FTOL = 1.0e-8;
 
+/* CHECKPOINTING (DE SOLVER, MCMC): */
+const int DEFAULT_DE_CHECKPOINT_INTERVAL    =    10;   /// generations between DE checkpoints
+const int DEFAULT_MCMC_CHECKPOINT_INTERVAL  =  1000;   /// generations between DREAM checkpoints
+
 
 
 /* SOLVER OPTIONS: */
@@ -64,6 +68,22 @@ const int NMSIMPLEX_SOLVER     =     3;
 const int ALT_SOLVER           =     4;
 const int GENERIC_NLOPT_SOLVER =     5;
 
+/* PSF CONVOLUTION METHODS: */
+const int CONVOLVE_AUTO        =     0;   /// choose CONVOLVE_FFT or CONVOLVE_DIRECT via cost model
+const int CONVOLVE_FFT         =     1;   /// FFT of the full (zero-padded) image
+const int CONVOLVE_FFT_TILED   =     2;   /// overlap-save FFT convolution, using fixed-size tiles
+const int CONVOLVE_DIRECT      =     3;   /// direct-space convolution (separable if possible)
+const int CONVOLVE_LOWRANK     =     4;   /// sum of separable terms from SVD of PSF
+
+/* BOOTSTRAP-RESAMPLING REPRESENTATIONS: */
+const int BOOTSTRAP_INDICES      =   0;   /// list of resampled pixel indices
+const int BOOTSTRAP_MULTINOMIAL  =   1;   /// per-pixel counts (same samples as BOOTSTRAP_INDICES)
+const int BOOTSTRAP_POISSON      =   2;   /// per-pixel Poisson(1) counts ("Poisson bootstrap")
+
+/* RANDOM-NUMBER GENERATORS (DE SOLVER, BOOTSTRAP RESAMPLING): */
+const int RNG_MERSENNE_TWISTER   =   0;   /// single global Mersenne Twister sequence
+const int RNG_PHILOX             =   1;   /// counter-based streams keyed by (seed, iteration)
+
 /* TYPE OF INPUT ERROR/WEIGHT IMAGE */
 const int  WEIGHTS_ARE_SIGMAS    =  100;  /// "weight image" pixel value = sigma
 const int  WEIGHTS_ARE_VARIANCES =  110;  /// "weight image" pixel value = variance (sigma^2)
@@ -74,6 +94,18 @@ const int  MASK_ZERO_IS_BAD  =       20;  /// alternate input mask format (good
 
 
 
+/* How a parameter value changes when the image pixel scale changes by a factor f
+ * (e.g., for block-averaged images in coarse-to-fine fitting; see block_average.cpp);
+ * specified for each parameter by the FunctionObject subclasses */
+const int PARAM_SCALING_UNKNOWN    =  -1;   /// not specified by the function object
+const int PARAM_SCALING_NONE       =   0;   /// unchanged (angles, shapes, surface brightnesses)
+const int PARAM_SCALING_POSITION   =   1;   /// pixel coordinate (X0, Y0)
+const int PARAM_SCALING_LENGTH     =   2;   /// length in pixels: divided by f
+const int PARAM_SCALING_TOTAL_FLUX =   3;   /// total flux: divided by f^2
+const int PARAM_SCALING_INV_LENGTH =   4;   /// per-pixel quantity (luminosity density, sky slope): multiplied by f
+
+
+
 /* STRING DEFINITIONS FOR PARAMETER NAMES */
 const std::string  X0_string("X0");
 const std::string  Y0_string("Y0");
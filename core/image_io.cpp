@@ -371,6 +371,82 @@ int SaveVectorAsImage( double *pixelVector, const std::string filename, int nCol
 
 
 
+/* ---------------- FUNCTION: SaveVectorsAsMultiExtensionImage --------- */
+///    Saves several 1D arrays (each representing an image with size nColumns x
+/// nRows) in specified filename as a multi-extension FITS file: the primary HDU
+/// has no image data, and has the strings in comments vector written as comments
+/// to its header; image i is written to extension i + 1, with EXTNAME = 
+/// extensionNames[i] and with extensionComments[i] (if non-empty) written as a 
+/// comment to that extension's header.
+///
+///    Returns 0 for successful operation, -1 if a CFITSIO-related error occurred.
+int SaveVectorsAsMultiExtensionImage( std::vector<double *> pixelVectors, 
+						const std::string filename, int nColumns, int nRows, 
+						std::vector<std::string> comments, 
+						std::vector<std::string> extensionNames, 
+						std::vector<std::string> extensionComments )
+{
+  fitsfile  *imfile_ptr;
+  std::string  finalFilename = "!";   // starting filename with "!" ==> clobber any existing file
+  int  status = 0;
+  int  problems = 0;
+  long  naxes[2];
+  long  nPixels;
+  long  firstPixel[2] = {1, 1};
+
+  // Check for bad input
+  if ((extensionNames.size() != pixelVectors.size()) 
+  		|| (extensionComments.size() != pixelVectors.size())) {
+    fprintf(stderr, "\n*** WARNING: inconsistent numbers of images and extension names/comments");
+    fprintf(stderr, " for SaveVectorsAsMultiExtensionImage!\n");
+    return -2;
+  }
+  for (int n = 0; n < (int)pixelVectors.size(); n++) {
+    if (pixelVectors[n] == NULL) {
+      fprintf(stderr, "\n*** WARNING: input image array to SaveVectorsAsMultiExtensionImage is NULL!\n");
+      return -2;
+    }
+  }
+  
+  naxes[0] = nColumns;
+  naxes[1] = nRows;
+  nPixels = (long)nColumns * (long)nRows;
+  
+  /* Create the FITS file, with empty primary HDU: */
+  finalFilename += filename;
+  fits_create_file(&imfile_ptr, finalFilename.c_str(), &status);
+  fits_create_img(imfile_ptr, FLOAT_IMG, 0, naxes, &status);
+  for (int i = 0; i < (int)comments.size(); i++)
+    fits_write_comment(imfile_ptr, comments[i].c_str(), &status);
+  fits_write_date(imfile_ptr, &status);
+
+  /* Add one image extension per input image */
+  for (int n = 0; n < (int)pixelVectors.size(); n++) {
+    fits_create_img(imfile_ptr, FLOAT_IMG, 2, naxes, &status);
+    fits_write_key_str(imfile_ptr, "EXTNAME", extensionNames[n].c_str(), NULL, &status);
+    if (! extensionComments[n].empty())
+      fits_write_comment(imfile_ptr, extensionComments[n].c_str(), &status);
+    problems = fits_write_pix(imfile_ptr, TDOUBLE, firstPixel, nPixels, pixelVectors[n],
+                              &status);
+    if ( problems ) {
+      fprintf(stderr, "\n*** WARNING: Problems writing pixel data to FITS file \"%s\"!\n    FITSIO error messages follow:", filename.c_str());
+      PrintError(status);
+      return -1;
+    }
+  }
+
+  problems = fits_close_file(imfile_ptr, &status);
+  if ( problems ) {
+    fprintf(stderr, "\n*** WARNING: Problems closing FITS file \"%s\"!\n    FITSIO error messages follow:", filename.c_str());
+    PrintError(status);
+    return -1;
+  }
+  
+  return 0;
+}
+
+
+
 /* ---------------- FUNCTION: PrintError --------------------------- */
 
 static void PrintError( int status )
@@ -31,6 +31,14 @@ double * ReadImageAsVector( const std::string filename, int *nColumns, int *nRow
 int SaveVectorAsImage( double *pixelVector, const std::string filename, int nColumns,
                          int nRows, std::vector<std::string> comments );
 
+/// \brief Saves several images (1D arrays, logical dimensions nColumns x nRows) as
+///        extensions of a single FITS file, with comments added to primary header
+int SaveVectorsAsMultiExtensionImage( std::vector<double *> pixelVectors, 
+						const std::string filename, int nColumns, int nRows, 
+						std::vector<std::string> comments, 
+						std::vector<std::string> extensionNames, 
+						std::vector<std::string> extensionComments );
+
 int CountHeaderDataUnits( fitsfile  *imfile_ptr );
 
 #endif  // _IMAGE_IO_H
@@ -60,6 +60,8 @@
 #include "dispatch_solver.h"
 #include "levmar_fit.h"
 #include "diff_evoln_fit.h"
+#include "multistart_fit.h"
+#include "multires_fit.h"
 #ifndef NO_NLOPT
 #include "nmsimplex_fit.h"
 #include "nlopt_fit.h"
@@ -69,6 +71,7 @@
 #include "config_file_parser.h"
 #include "print_results.h"
 #include "estimate_memory.h"
+#include "profile_counters.h"
 #include "sample_configs.h"
 
 using namespace std;
@@ -83,6 +86,8 @@ static string  kExpTimeString = "EXPTIME";
 static string  kNCombinedString = "NCOMBINED";
 static string  kOriginalSkyString = "ORIGINAL_SKY";
 
+static string  DEFAULT_CHECKPOINT_FILENAME = "imfit_checkpoint.bin";
+
 
 #ifdef USE_OPENMP
 #define VERSION_STRING      "1.8.0 (OpenMP-enabled)"
@@ -156,6 +161,8 @@ int main(int argc, char *argv[])
   // ** Define default options, then process the command line
   options = make_shared<ImfitOptions>();
   ProcessInput(argc, argv, options);
+  if (options->profileReport)
+    EnableProfileCounters(true);
 
   // (Appropriate error messages regarding any missing files will be printed
   // to stderr by RequestedFilesPresent)
@@ -341,6 +348,10 @@ int main(int argc, char *argv[])
       paramsVect[i] = parameterList[i];
   }
   
+  // Optional report on spatial culling of compact components
+  if ((options->cullingThreshold > 0.0) && (options->verbose > 0))
+    theModel->PrintCullingSummary(paramsVect);
+  
   
   // ** OK, now we either print chi^2 value for the input parameters and quit, or
   // else call one of the solvers!
@@ -361,11 +372,37 @@ int main(int argc, char *argv[])
       printf("chi^2 (model-based errors):\n");
     else
       printf("chi^2 (data-based errors):\n");
+    CheckpointSettings  checkpointSettings;
+    checkpointSettings.filename = options->checkpointFileName;
+    checkpointSettings.interval = options->checkpointInterval;
+    checkpointSettings.resume = options->resume;
+    if ((checkpointSettings.filename != "") && (options->solver != DIFF_EVOLN_SOLVER))
+      printf("* Checkpointing is only available for the DE solver; ignoring.\n");
+    if ((options->nMultiResLevels > 0) && (checkpointSettings.filename != "")) {
+      printf("* Checkpointing is not available with multi-resolution fitting; ignoring.\n");
+      checkpointSettings.filename = "";
+    }
+    if ((options->nMultiStarts > 0) && (options->solver == DIFF_EVOLN_SOLVER)) {
+      printf("* Multi-start fitting is only available for local solvers (LM, N-M simplex, NLopt); ignoring.\n");
+      options->nMultiStarts = 0;
+    }
     gettimeofday(&timer_start_fit, NULL);
-    fitStatus = DispatchToSolver(options->solver, nParamsTot, nFreeParams, nPixels_tot, 
+    if (options->nMultiResLevels > 0)
+      fitStatus = MultiResolutionFit(options->nMultiResLevels, options, theModel, nColumns, nRows,
+      							psfPixels, nColumns_psf, nRows_psf, functionList, functionLabelList,
+      							functionSetIndices, optionalParamsMap, nParamsTot, nFreeParams,
+      							paramsVect, parameterInfo, paramLimitsExist, &resultsFromSolver);
+    else if (options->nMultiStarts > 0)
+      fitStatus = MultiStartFit(options->nMultiStarts, options->solver, nParamsTot, nFreeParams,
+      							nPixels_tot, paramsVect, parameterInfo, theModel, options->ftol,
+      							paramLimitsExist, options->verbose, &resultsFromSolver,
+      							options->nloptSolverName, options->rngSeed, options->rngType);
+    else
+      fitStatus = DispatchToSolver(options->solver, nParamsTot, nFreeParams, nPixels_tot, 
     							paramsVect, parameterInfo, theModel, options->ftol, paramLimitsExist, 
     							options->verbose, &resultsFromSolver, options->nloptSolverName,
-    							options->rngSeed, options->useLHS);
+    							options->rngSeed, options->useLHS, options->rngType,
+    							&checkpointSettings);
     gettimeofday(&timer_end_fit, NULL);
     							
     PrintResults(paramsVect, theModel, nFreeParams, fitStatus, resultsFromSolver);
@@ -382,11 +419,12 @@ int main(int argc, char *argv[])
     
     printf("\nNow doing bootstrap resampling (%d iterations) to estimate errors...\n",
            options->bootstrapIterations);
+    theModel->SetBootstrapMode(options->bootstrapMode);
     gettimeofday(&timer_start_bootstrap, NULL);
     nSucessfulIterations = BootstrapErrors(paramsVect, parameterInfo, paramLimitsExist, 
     									theModel, options->ftol, options->bootstrapIterations, 
     									nFreeParams, theModel->WhichFitStatistic(), 
-    									bootstrapSaveFile_ptr, options->rngSeed);
+    									bootstrapSaveFile_ptr, options->rngSeed, options->rngType);
     gettimeofday(&timer_end_bootstrap, NULL);
     if (options->saveBootstrap) {
       if (nSucessfulIterations > 0)
@@ -447,6 +485,28 @@ int main(int argc, char *argv[])
   }
 
 
+  // Optional report on where the time went
+  if (options->profileReport) {
+    vector<string>  componentNames;
+    vector<double>  componentTimes;
+    vector<long>  componentPixels;
+    struct timeval  timer_now;
+    gettimeofday(&timer_now, NULL);
+    double  time_elapsed = timer_now.tv_sec - timer_start_all.tv_sec 
+    						+ (timer_now.tv_usec - timer_start_all.tv_usec)/1e6;
+    theModel->GetComponentProfile(componentNames, componentTimes, componentPixels);
+    if (options->profileReportFileName == "")
+      PrintProfileReport(stdout, time_elapsed, componentNames, componentTimes, componentPixels);
+    else {
+      printf("Saving profile report in file \"%s\"\n", options->profileReportFileName.c_str());
+      status = WriteProfileReportJSON(options->profileReportFileName, time_elapsed, 
+      								componentNames, componentTimes, componentPixels);
+      if (status != 0)
+        fprintf(stderr, "\n*** WARNING: Failure saving profile report!\n\n");
+    }
+  }
+
+
   // Free up memory
   fftw_free(allPixels);                 // allocated externally, in ReadImageAsVector()
   if (errorPixels_allocated)
@@ -548,9 +608,15 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
 #endif
   optParser->AddUsageLine("     --de                     Use differential evolution solver");
   optParser->AddUsageLine("     --de-lhs                 Use differential evolution solver (with Latin hypercube sampling)");
+  optParser->AddUsageLine("     --checkpoint <filename>  Periodically save DE solver state to specified file");
+  optParser->AddUsageLine("     --checkpoint-interval <int>        Generations between DE checkpoints [default = 10]");
+  optParser->AddUsageLine("     --resume                 Resume DE fit from checkpoint file [default = imfit_checkpoint.bin]");
+  optParser->AddUsageLine("     --multistart <int>       Run this many local fits from Latin-hypercube starting points, keep best");
+  optParser->AddUsageLine("     --multires <int>         Fit block-averaged images (2^N, ..., 2x) first, then full-resolution image");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --bootstrap <int>        Do this many iterations of bootstrap resampling to estimate errors");
   optParser->AddUsageLine("     --save-bootstrap <filename>        Save all bootstrap best-fit parameters to specified file");
+  optParser->AddUsageLine("     --bootstrap-mode <mode>  Bootstrap resample representation: \"indices\" (default), \"multinomial\", or \"poisson\"");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --chisquare-only         Print fit statistic (e.g., chi^2) of input model and quit (no fitting done)");
   optParser->AddUsageLine("     --fitstat-only           Same as --chisquare-only");
@@ -562,7 +628,14 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
   optParser->AddUsageLine("     --max-threads <int>      Maximum number of threads to use");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --seed <int>             RNG seed (for testing purposes)");
+  optParser->AddUsageLine("     --rng <name>             Random-number generator for DE and bootstrap: \"mt\" (default) or \"philox\"");
   optParser->AddUsageLine("     --no-subsampling         Turn off pixel subsampling near centers of functions");
+  optParser->AddUsageLine("     --culling-threshold <value>  Evaluate compact functions only where they are > value x peak");
+  optParser->AddUsageLine("     --convolution <method>       PSF convolution: \"fft\" (default), \"auto\", \"tiled-fft\", \"direct\", or \"lowrank\"");
+  optParser->AddUsageLine("     --lowrank-tolerance <value>  Tolerance for \"lowrank\" convolution (default = 1e-6)");
+  optParser->AddUsageLine("");
+  optParser->AddUsageLine("     --profile-report         Print timings of model-image, convolution, solver, etc. phases at end");
+  optParser->AddUsageLine("     --profile-report-json <output-file>   Save same timings to file as JSON instead");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("EXAMPLES:");
   optParser->AddUsageLine("   imfit -c model_config_n100a.dat ngc100.fits");
@@ -594,6 +667,11 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
 #endif
   optParser->AddFlag("de");
   optParser->AddFlag("de-lhs");
+  optParser->AddFlag("resume");
+  optParser->AddOption("checkpoint");
+  optParser->AddOption("checkpoint-interval");
+  optParser->AddOption("multistart");
+  optParser->AddOption("multires");
   optParser->AddFlag("quiet");
   optParser->AddFlag("silent");
   optParser->AddFlag("loud");
@@ -615,9 +693,16 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
   optParser->AddOption("ftol");
   optParser->AddOption("bootstrap");
   optParser->AddOption("save-bootstrap");
+  optParser->AddOption("bootstrap-mode");
   optParser->AddOption("config", "c");
   optParser->AddOption("max-threads");
+  optParser->AddOption("culling-threshold");
+  optParser->AddOption("convolution");
+  optParser->AddOption("lowrank-tolerance");
   optParser->AddOption("seed");
+  optParser->AddOption("rng");
+  optParser->AddFlag("profile-report");
+  optParser->AddOption("profile-report-json");
 
   // Comment this out if you want unrecognized (e.g., mis-spelled) flags and options
   // to be ignored only, rather than causing program to exit
@@ -703,7 +788,7 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
     if (! ValidNLOptSolverName(theOptions->nloptSolverName)) {
       fprintf(stderr, "*** ERROR: \"%s\" is not a valid NLOpt solver name!\n", 
       			theOptions->nloptSolverName.c_str());
-      fprintf(stderr, "    (valid names for --nlopt: COBYLA, BOBYQA, NEWUOA, PRAXIS, NM, SBPLX)\n");
+      fprintf(stderr, "    (valid names for --nlopt: COBYLA, BOBYQA, NEWUOA, PRAXIS, NM, SBPLX,\n                              LBFGS, MMA, SLSQP, TNEWTON)\n");
       delete optParser;
       exit(1);
     }
@@ -719,6 +804,42 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
   	theOptions->solver = DIFF_EVOLN_SOLVER;
   	theOptions->useLHS = true;
   }
+  if (optParser->OptionSet("checkpoint")) {
+    theOptions->checkpointFileName = optParser->GetTargetString("checkpoint");
+    printf("\tDE checkpoint file = %s\n", theOptions->checkpointFileName.c_str());
+  }
+  if (optParser->OptionSet("checkpoint-interval")) {
+    if (NotANumber(optParser->GetTargetString("checkpoint-interval").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: checkpoint interval should be a positive integer!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->checkpointInterval = atol(optParser->GetTargetString("checkpoint-interval").c_str());
+  }
+  if (optParser->FlagSet("resume")) {
+    theOptions->resume = true;
+    if (theOptions->checkpointFileName == "")
+      theOptions->checkpointFileName = DEFAULT_CHECKPOINT_FILENAME;
+    printf("\tDE fit will resume from checkpoint file %s\n", theOptions->checkpointFileName.c_str());
+  }
+  if (optParser->OptionSet("multistart")) {
+    if (NotANumber(optParser->GetTargetString("multistart").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: number of multi-start fits should be a positive integer!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->nMultiStarts = atol(optParser->GetTargetString("multistart").c_str());
+    printf("\tMulti-start fitting: %d local fits\n", theOptions->nMultiStarts);
+  }
+  if (optParser->OptionSet("multires")) {
+    if (NotANumber(optParser->GetTargetString("multires").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: number of multi-resolution levels should be a positive integer!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->nMultiResLevels = atol(optParser->GetTargetString("multires").c_str());
+    printf("\tMulti-resolution fitting: %d block-averaged levels\n", theOptions->nMultiResLevels);
+  }
   if (optParser->FlagSet("no-normalize")) {
     theOptions->normalizePSF = false;
   }
@@ -891,6 +1012,20 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
     theOptions->saveBootstrap = true;
     printf("\tbootstrap best-fit parameters to be saved in %s\n", theOptions->outputBootstrapFileName.c_str());
   }
+  if (optParser->OptionSet("bootstrap-mode")) {
+    string  modeName = optParser->GetTargetString("bootstrap-mode");
+    if (modeName == "indices")
+      theOptions->bootstrapMode = BOOTSTRAP_INDICES;
+    else if (modeName == "multinomial")
+      theOptions->bootstrapMode = BOOTSTRAP_MULTINOMIAL;
+    else if (modeName == "poisson")
+      theOptions->bootstrapMode = BOOTSTRAP_POISSON;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized bootstrap mode (\"%s\")!\n\n", modeName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
   if (optParser->OptionSet("max-threads")) {
     if (NotANumber(optParser->GetTargetString("max-threads").c_str(), 0, kPosInt)) {
       fprintf(stderr, "*** ERROR: max-threads should be a positive integer!\n\n");
@@ -900,6 +1035,45 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
     theOptions->maxThreads = atol(optParser->GetTargetString("max-threads").c_str());
     theOptions->maxThreadsSet = true;
   }
+  if (optParser->OptionSet("culling-threshold")) {
+    if (NotANumber(optParser->GetTargetString("culling-threshold").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: culling threshold should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->cullingThreshold = atof(optParser->GetTargetString("culling-threshold").c_str());
+    if (theOptions->cullingThreshold >= 1.0) {
+      fprintf(stderr, "*** ERROR: culling threshold should be < 1!\n\n");
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("convolution")) {
+    string  methodName = optParser->GetTargetString("convolution");
+    if (methodName == "auto")
+      theOptions->convolutionMethod = CONVOLVE_AUTO;
+    else if (methodName == "fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT;
+    else if (methodName == "tiled-fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT_TILED;
+    else if (methodName == "direct")
+      theOptions->convolutionMethod = CONVOLVE_DIRECT;
+    else if (methodName == "lowrank")
+      theOptions->convolutionMethod = CONVOLVE_LOWRANK;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized convolution method (\"%s\")!\n\n", methodName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("lowrank-tolerance")) {
+    if (NotANumber(optParser->GetTargetString("lowrank-tolerance").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: lowrank tolerance should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->lowRankTolerance = atof(optParser->GetTargetString("lowrank-tolerance").c_str());
+  }
   if (optParser->OptionSet("seed")) {
     if (NotANumber(optParser->GetTargetString("seed").c_str(), 0, kPosInt)) {
       printf("*** WARNING: RNG seed should be a positive integer!\n");
@@ -909,6 +1083,24 @@ void ProcessInput( int argc, char *argv[], shared_ptr<ImfitOptions> theOptions )
     theOptions->rngSeed = atol(optParser->GetTargetString("seed").c_str());
     printf("\tRNG seed = %ld\n", theOptions->rngSeed);
   }
+  if (optParser->OptionSet("rng")) {
+    string  rngName = optParser->GetTargetString("rng");
+    if (rngName == "mt")
+      theOptions->rngType = RNG_MERSENNE_TWISTER;
+    else if (rngName == "philox")
+      theOptions->rngType = RNG_PHILOX;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized random-number generator (\"%s\")!\n\n", rngName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->FlagSet("profile-report"))
+    theOptions->profileReport = true;
+  if (optParser->OptionSet("profile-report-json")) {
+    theOptions->profileReport = true;
+    theOptions->profileReportFileName = optParser->GetTargetString("profile-report-json");
+  }
 
   delete optParser;
 
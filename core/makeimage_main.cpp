@@ -56,6 +56,7 @@
 #include "sample_configs.h"
 #include "psf_oversampling_info.h"
 #include "setup_model_object.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -115,15 +116,20 @@ int main( int argc, char *argv[] )
   shared_ptr<MakeimageOptions> options;
   configOptions  userConfigOptions;
   bool  printFluxesOnly = false;
+  struct timeval  timer_start_all;
   
   string  progName = "makeimage ";
   progName += VERSION_STRING;
 
   
   
+  gettimeofday(&timer_start_all, NULL);
+
   /* Process command line and parse config file: */
   options = make_shared<MakeimageOptions>();    
   ProcessInput(argc, argv, options);
+  if (options->profileReport)
+    EnableProfileCounters(true);
 
 #ifdef USE_LOGGING
   if (options->loggingOn) {
@@ -232,6 +238,12 @@ int main( int argc, char *argv[] )
   nColumnsRowsVect.push_back(nColumns_psf);
   nColumnsRowsVect.push_back(nRows_psf);
 
+  // The expanded model image is only fully convolved by the full-image FFT
+  if ((options->saveExpandedImage) && (options->convolutionMethod != CONVOLVE_FFT)) {
+    printf("* Using FFT convolution, since expanded model image is to be saved\n");
+    options->convolutionMethod = CONVOLVE_FFT;
+  }
+
   theModel = SetupModelObject(options, nColumnsRowsVect, NULL, psfPixels, NULL, NULL,
   								psfOversamplingInfoVect);
 
@@ -268,8 +280,12 @@ int main( int argc, char *argv[] )
     if (options->loggingOn)
       LOG_F(INFO, "Creating model image...");
 #endif
-    // OK, we're generating a normal model image
-    theModel->CreateModelImage(paramsVect);
+    // OK, we're generating a normal model image (PrintCullingSummary also
+    // generates the model image, as part of estimating flux lost to culling)
+    if ((options->cullingThreshold > 0.0) && (options->verbose > 0))
+      theModel->PrintCullingSummary(paramsVect);
+    else
+      theModel->CreateModelImage(paramsVect);
   
     // TESTING (remove later)
     if (options->printImages)
@@ -300,38 +316,75 @@ int main( int argc, char *argv[] )
     }
   
     // Save individual-function images, if requested
-    if ((options->saveImage) && (options->saveAllFunctions)) {
+    if ((options->saveImage) && ((options->saveAllFunctions) || (options->saveFunctionsMEF))) {
       vector<string> functionNames;
       vector<string> functionLabels;
+      vector<string> extensionNames;
+      vector<string> extensionComments;
+      vector<double *> functionImages;
+      string  headerString;
       int  nFuncs = theModel->GetNFunctions();
+      long  nPixels = (long)nColumns * (long)nRows;
       theModel->GetFunctionNames(functionNames);
       theModel->GetFunctionLabels(functionLabels);
+      // Generate all the single-function images in one pass (exit if that failed -- 
+      // e.g., due to memory allocation failure)
       for (int i = 0; i < nFuncs; i++) {
-        // Generate single-function image (exit if that failed -- e.g., due to
-        // memory allocation failure)
-        string currentFilename, headerString;
-        singleFunctionImage = theModel->GetSingleFunctionImage(paramsVect, i);
+        singleFunctionImage = (double *) calloc((size_t)nPixels, sizeof(double));
         if (singleFunctionImage == NULL) {
-          fprintf(stderr, "\n*** ERROR: Unable to generate single-function image #%d!\n\n", i);
+          fprintf(stderr, "\n*** ERROR: Unable to allocate memory for single-function image #%d!\n\n", i);
           exit(-1);
         }
-        currentFilename = PrintToString("%s%d_%s.fits", options->functionRootName.c_str(),
-        								i + 1, functionNames[i].c_str());
-        printf("%s\n", currentFilename.c_str());
-        // Add comments for FITS header, describing this function
+        functionImages.push_back(singleFunctionImage);
+      }
+      status = theModel->GetAllSingleFunctionImages(paramsVect, functionImages.data());
+      if (status < 0) {
+        fprintf(stderr, "\n*** ERROR: Unable to generate single-function images!\n\n");
+        exit(-1);
+      }
+      // Comments for FITS headers, describing each function
+      for (int i = 0; i < nFuncs; i++) {
+        extensionNames.push_back(PrintToString("%d_%s", i + 1, functionNames[i].c_str()));
         headerString = PrintToString("FUNCTION %s", functionNames[i].c_str());
         if (! functionLabels[i].empty())
           headerString = PrintToString("%s # LABEL %s", headerString.c_str(), 
           								functionLabels[i].c_str());
-        imageCommentsList.push_back(headerString);
-        status = SaveVectorAsImage(singleFunctionImage, currentFilename, nColumns, nRows, 
-        							imageCommentsList);
+        extensionComments.push_back(headerString);
+      }
+
+      if (options->saveAllFunctions) {
+        // One file per function; files are written in parallel if the CFITSIO
+        // library is thread-safe
+        vector<string> filenames;
+        for (int i = 0; i < nFuncs; i++) {
+          filenames.push_back(PrintToString("%s%s.fits", options->functionRootName.c_str(),
+          								extensionNames[i].c_str()));
+          printf("%s\n", filenames[i].c_str());
+        }
+#pragma omp parallel for schedule (dynamic, 1) if (fits_is_reentrant())
+        for (int i = 0; i < nFuncs; i++) {
+          vector<string>  fileComments = imageCommentsList;
+          fileComments.push_back(extensionComments[i]);
+          if (SaveVectorAsImage(functionImages[i], filenames[i], nColumns, nRows, 
+          						fileComments) != 0) {
+            fprintf(stderr,  "\n*** WARNING: Unable to save output single-function image file \"%s\"!\n\n", 
+            			filenames[i].c_str());
+          }
+        }
+      }
+      if (options->saveFunctionsMEF) {
+        printf("\nSaving individual-function images as extensions of \"%s\" ...\n", 
+        		options->functionsMEFName.c_str());
+        status = SaveVectorsAsMultiExtensionImage(functionImages, options->functionsMEFName, 
+        						nColumns, nRows, imageCommentsList, extensionNames, 
+        						extensionComments);
         if (status != 0) {
-          fprintf(stderr,  "\n*** WARNING: Unable to save output single-function image file \"%s\"!\n\n", 
-          			currentFilename.c_str());
+          fprintf(stderr,  "\n*** WARNING: Unable to save output multi-extension file \"%s\"!\n\n", 
+          			options->functionsMEFName.c_str());
         }
-        imageCommentsList.pop_back();
       }
+      for (int i = 0; i < nFuncs; i++)
+        free(functionImages[i]);
     }
   }
   
@@ -359,6 +412,27 @@ int main( int argc, char *argv[] )
     		options->timingIterations, time_per_iteration);
   }
 
+  // Optional report on where the time went
+  if (options->profileReport) {
+    vector<string>  componentNames;
+    vector<double>  componentTimes;
+    vector<long>  componentPixels;
+    struct timeval  timer_now;
+    gettimeofday(&timer_now, NULL);
+    double  time_elapsed = timer_now.tv_sec - timer_start_all.tv_sec 
+    						+ (timer_now.tv_usec - timer_start_all.tv_usec)/1e6;
+    theModel->GetComponentProfile(componentNames, componentTimes, componentPixels);
+    if (options->profileReportFileName == "")
+      PrintProfileReport(stdout, time_elapsed, componentNames, componentTimes, componentPixels);
+    else {
+      printf("Saving profile report in file \"%s\"\n", options->profileReportFileName.c_str());
+      status = WriteProfileReportJSON(options->profileReportFileName, time_elapsed, 
+      								componentNames, componentTimes, componentPixels);
+      if (status != 0)
+        fprintf(stderr, "\n*** WARNING: Failure saving profile report!\n\n");
+    }
+  }
+
   
   printf("Done!\n\n");
 
@@ -415,9 +489,13 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
   optParser->AddUsageLine("     --ncols <number-of-columns>         x-size of output image");
   optParser->AddUsageLine("     --nrows <number-of-rows>            y-size of output image");
   optParser->AddUsageLine("     --no-subsampling                    Do *not* do pixel subsampling near centers");
+  optParser->AddUsageLine("     --culling-threshold <value>         Evaluate compact functions only where they are > value x peak");
+  optParser->AddUsageLine("     --convolution <method>              PSF convolution: \"fft\" (default), \"auto\", \"tiled-fft\", \"direct\", or \"lowrank\"");
+  optParser->AddUsageLine("     --lowrank-tolerance <value>         Tolerance for \"lowrank\" convolution (default = 1e-6)");
 //  optParser->AddUsageLine("     --printimage             Print out images (for debugging)");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --output-functions <root-name>      Output individual-function images");
+  optParser->AddUsageLine("     --output-functions-mef <filename>   Output individual-function images as extensions of single file");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --print-fluxes           Estimate total component fluxes (& magnitudes, if zero point is given)");
   optParser->AddUsageLine(EST_SIZE_HELP_STRING);
@@ -427,6 +505,8 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
   optParser->AddUsageLine("     --nosave                 Do *not* save image (for testing, or for use with --print-fluxes)");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --timing <int>           Generate image specified number of times and estimate average creation time");
+  optParser->AddUsageLine("     --profile-report         Print timings of model-image, convolution, etc. phases at end");
+  optParser->AddUsageLine("     --profile-report-json <output-file>   Save same timings to file as JSON instead");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --max-threads <int>      Maximum number of threads to use");
   optParser->AddUsageLine("");
@@ -465,8 +545,14 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
   optParser->AddOption("estimation-size");
   optParser->AddOption("save-fluxes");
   optParser->AddOption("output-functions");
+  optParser->AddOption("output-functions-mef");
   optParser->AddOption("timing");
+  optParser->AddFlag("profile-report");
+  optParser->AddOption("profile-report-json");
   optParser->AddOption("max-threads");
+  optParser->AddOption("culling-threshold");
+  optParser->AddOption("convolution");
+  optParser->AddOption("lowrank-tolerance");
   optParser->AddOption("debug");
 #ifdef USE_LOGGING
   optParser->AddFlag("logging");
@@ -628,6 +714,10 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
     theOptions->functionRootName = optParser->GetTargetString("output-functions");
     theOptions->saveAllFunctions = true;
   }
+  if (optParser->OptionSet("output-functions-mef")) {
+    theOptions->functionsMEFName = optParser->GetTargetString("output-functions-mef");
+    theOptions->saveFunctionsMEF = true;
+  }
   if (optParser->OptionSet("timing")) {
     if (NotANumber(optParser->GetTargetString("timing").c_str(), 0, kPosInt)) {
       fprintf(stderr, "*** ERROR: timing should be a positive integer!\n\n");
@@ -646,6 +736,45 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
     theOptions->maxThreads = atol(optParser->GetTargetString("max-threads").c_str());
     theOptions->maxThreadsSet = true;
   }
+  if (optParser->OptionSet("culling-threshold")) {
+    if (NotANumber(optParser->GetTargetString("culling-threshold").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: culling threshold should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->cullingThreshold = atof(optParser->GetTargetString("culling-threshold").c_str());
+    if (theOptions->cullingThreshold >= 1.0) {
+      fprintf(stderr, "*** ERROR: culling threshold should be < 1!\n\n");
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("convolution")) {
+    string  methodName = optParser->GetTargetString("convolution");
+    if (methodName == "auto")
+      theOptions->convolutionMethod = CONVOLVE_AUTO;
+    else if (methodName == "fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT;
+    else if (methodName == "tiled-fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT_TILED;
+    else if (methodName == "direct")
+      theOptions->convolutionMethod = CONVOLVE_DIRECT;
+    else if (methodName == "lowrank")
+      theOptions->convolutionMethod = CONVOLVE_LOWRANK;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized convolution method (\"%s\")!\n\n", methodName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("lowrank-tolerance")) {
+    if (NotANumber(optParser->GetTargetString("lowrank-tolerance").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: lowrank tolerance should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->lowRankTolerance = atof(optParser->GetTargetString("lowrank-tolerance").c_str());
+  }
   if (optParser->OptionSet("debug")) {
     if (NotANumber(optParser->GetTargetString("debug").c_str(), 0, kAnyInt)) {
       fprintf(stderr, "*** ERROR: debug should be an integer!\n");
@@ -654,6 +783,12 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MakeimageOptions> theOptio
     }
     theOptions->debugLevel = atol(optParser->GetTargetString("debug").c_str());
   }
+  if (optParser->FlagSet("profile-report"))
+    theOptions->profileReport = true;
+  if (optParser->OptionSet("profile-report-json")) {
+    theOptions->profileReport = true;
+    theOptions->profileReportFileName = optParser->GetTargetString("profile-report-json");
+  }
 #ifdef USE_LOGGING
   if (optParser->FlagSet("logging")) {
     theOptions->loggingOn = true;
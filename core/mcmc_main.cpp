@@ -94,6 +94,8 @@ void HandleConfigFileOptions( configOptions *configFileOptions,
 
 double LikelihoodFuncForDREAM( int chain, int gen, const double* state, 
 								const void* extraData, bool recalc );
+double BoundedLikelihoodFuncForDREAM( int chain, int gen, const double* state, 
+								const void* extraData, double minLik );
 void MakeMCMCOutputHeader( vector<string> *headerLines, const string& programName, 
 						const int argc, char *argv[] );
 
@@ -364,6 +366,10 @@ int main(int argc, char *argv[])
       paramsVect[i] = parameterList[i];
   }
   
+  // Optional report on spatial culling of compact components
+  if ((options->cullingThreshold > 0.0) && (options->verbose > 0))
+    theModel->PrintCullingSummary(paramsVect);
+  
   
   // Stuff for dream_pars
   string *paramNames = new string[nParamsTot];
@@ -401,6 +407,10 @@ int main(int argc, char *argv[])
 
   // Set up various things in dream_pars struct
   dreamPars.outputRootname = options->outputFileRoot;
+  if (options->resume && options->appendToOutput) {
+    printf("* --resume and --append are mutually exclusive; ignoring --append.\n");
+    options->appendToOutput = false;
+  }
   if (options->appendToOutput)
     dreamPars.appendFile = 1;
   dreamPars.numChains = options->nChains;
@@ -430,6 +440,22 @@ int main(int argc, char *argv[])
   SetHeaderDreamParams(&dreamPars, programHeader);
   
   dreamPars.fun = &LikelihoodFuncForDREAM;
+  // our likelihood (-chi^2/2 or equivalent) is a deterministic function of the
+  // parameters, so DREAM never needs to recompute it for an already-evaluated state
+  dreamPars.deterministicLik = 1;
+  dreamPars.historyWindow = options->historyWindow;
+  if (options->resume && (options->checkpointFileName == ""))
+    options->checkpointFileName = options->outputFileRoot + ".checkpoint.bin";
+  dreamPars.checkpointFile = options->checkpointFileName;
+  dreamPars.checkpointInterval = options->checkpointInterval;
+  dreamPars.resume = options->resume;
+  if (options->earlyRejection) {
+    if (theModel->CanTerminateFitStatEarly()) {
+      dreamPars.earlyRejection = 1;
+      dreamPars.boundedFun = &BoundedLikelihoodFuncForDREAM;
+    } else
+      printf("* Early rejection of MCMC proposals is not possible with this model or fit statistic; ignoring.\n");
+  }
   // Assign extra "data" that will be passed to likelihood function
   dreamPars.extraData = theModel;
 
@@ -534,6 +560,12 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
   optParser->AddUsageLine("     --gelman-rubin-limit <float> Gelman-Rubin scale reduction factor limit [default = 1.01])");
   optParser->AddUsageLine("     --uniform-offset <float>     MCMC uniform-offset term [boundary for uniform offsets of scaling; default = 0.01]");
   optParser->AddUsageLine("     --gaussian-offset <float>    MCMC b^star term [sigma for absolute Gaussian offsets; default = 1.0e-6]");
+  optParser->AddUsageLine("     --early-rejection            Stop computing a proposal's likelihood once it is certain to be rejected");
+  optParser->AddUsageLine("                                  (with --psf, only saves time with --convolution tiled-fft)");
+  optParser->AddUsageLine("     --history-window <int>       Keep only the most recent N generations in memory (older ones go to disk)");
+  optParser->AddUsageLine("     --checkpoint <filename>      Periodically save complete sampler state to specified file");
+  optParser->AddUsageLine("     --checkpoint-interval <int>  Generations between checkpoints [default = 1000]");
+  optParser->AddUsageLine("     --resume                     Restart (exactly) from checkpoint file [default = <output-root>.checkpoint.bin]");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --quiet                  Turn off printing of updates during the fit");
   optParser->AddUsageLine("     --silent                 Turn off ALL printouts (except fatal errors)");
@@ -543,6 +575,9 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
   optParser->AddUsageLine("");
   optParser->AddUsageLine("     --seed <int>             RNG seed (for testing purposes)");
   optParser->AddUsageLine("     --no-subsampling         Turn off pixel subsampling near centers of functions");
+  optParser->AddUsageLine("     --culling-threshold <value>  Evaluate compact functions only where they are > value x peak");
+  optParser->AddUsageLine("     --convolution <method>       PSF convolution: \"fft\" (default), \"auto\", \"tiled-fft\", \"direct\", or \"lowrank\"");
+  optParser->AddUsageLine("     --lowrank-tolerance <value>  Tolerance for \"lowrank\" convolution (default = 1e-6)");
   optParser->AddUsageLine("");
   optParser->AddUsageLine("EXAMPLES:");
   optParser->AddUsageLine("   imfit-mcmc -c model_config_n100a.dat ngc100.fits -o n100a_mcmc_chain");
@@ -582,7 +617,12 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
   optParser->AddOption("config", "c");
   optParser->AddOption("output", "o");
   optParser->AddFlag("append");
+  optParser->AddFlag("early-rejection");
+  optParser->AddFlag("resume");
+  optParser->AddOption("checkpoint");
+  optParser->AddOption("checkpoint-interval");
   optParser->AddOption("nchains");
+  optParser->AddOption("history-window");
   optParser->AddOption("max-chain-length");
   optParser->AddOption("burnin-length");
   optParser->AddOption("gelman-evals");
@@ -590,6 +630,9 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
   optParser->AddOption("uniform-offset");
   optParser->AddOption("gaussian-offset");
   optParser->AddOption("max-threads");
+  optParser->AddOption("culling-threshold");
+  optParser->AddOption("convolution");
+  optParser->AddOption("lowrank-tolerance");
   optParser->AddOption("seed");
 
   // Comment this out if you want unrecognized (e.g., mis-spelled) flags and options
@@ -784,6 +827,9 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
   if (optParser->OptionSet("output")) {
     theOptions->outputFileRoot = optParser->GetTargetString("output");
   }
+  if (optParser->FlagSet("early-rejection")) {
+    theOptions->earlyRejection = true;
+  }
   if (optParser->FlagSet("append")) {
     printf("\t Current state will be loaded from output files; extended chains will be appended\n");
     theOptions->appendToOutput = true;
@@ -806,6 +852,31 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
     theOptions->maxEvals = atol(optParser->GetTargetString("max-chain-length").c_str());
     printf("\tMaximum number of likelihood evaluations per chain = %d\n", theOptions->maxEvals);
   }
+  if (optParser->OptionSet("checkpoint")) {
+    theOptions->checkpointFileName = optParser->GetTargetString("checkpoint");
+    printf("\tCheckpoint file = %s\n", theOptions->checkpointFileName.c_str());
+  }
+  if (optParser->OptionSet("checkpoint-interval")) {
+    if (NotANumber(optParser->GetTargetString("checkpoint-interval").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: checkpoint interval should be a positive integer!\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->checkpointInterval = atol(optParser->GetTargetString("checkpoint-interval").c_str());
+  }
+  if (optParser->FlagSet("resume")) {
+    printf("\t Sampler state will be restored from checkpoint file\n");
+    theOptions->resume = true;
+  }
+  if (optParser->OptionSet("history-window")) {
+    if (NotANumber(optParser->GetTargetString("history-window").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: history window should be a positive integer!\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->historyWindow = atol(optParser->GetTargetString("history-window").c_str());
+    printf("\tNumber of generations kept in memory = %d\n", theOptions->historyWindow);
+  }
   if (optParser->OptionSet("burnin-length")) {
     if (NotANumber(optParser->GetTargetString("burnin-length").c_str(), 0, kPosInt)) {
       printf("*** WARNING: number of burn-in evaluations should be a positive integer!\n");
@@ -860,6 +931,45 @@ void ProcessInput( int argc, char *argv[], shared_ptr<MCMCOptions> theOptions )
     theOptions->maxThreads = atol(optParser->GetTargetString("max-threads").c_str());
     theOptions->maxThreadsSet = true;
   }
+  if (optParser->OptionSet("culling-threshold")) {
+    if (NotANumber(optParser->GetTargetString("culling-threshold").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: culling threshold should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->cullingThreshold = atof(optParser->GetTargetString("culling-threshold").c_str());
+    if (theOptions->cullingThreshold >= 1.0) {
+      fprintf(stderr, "*** ERROR: culling threshold should be < 1!\n\n");
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("convolution")) {
+    string  methodName = optParser->GetTargetString("convolution");
+    if (methodName == "auto")
+      theOptions->convolutionMethod = CONVOLVE_AUTO;
+    else if (methodName == "fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT;
+    else if (methodName == "tiled-fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT_TILED;
+    else if (methodName == "direct")
+      theOptions->convolutionMethod = CONVOLVE_DIRECT;
+    else if (methodName == "lowrank")
+      theOptions->convolutionMethod = CONVOLVE_LOWRANK;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized convolution method (\"%s\")!\n\n", methodName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->OptionSet("lowrank-tolerance")) {
+    if (NotANumber(optParser->GetTargetString("lowrank-tolerance").c_str(), 0, kPosReal)) {
+      fprintf(stderr, "*** ERROR: lowrank tolerance should be a positive real number!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->lowRankTolerance = atof(optParser->GetTargetString("lowrank-tolerance").c_str());
+  }
   if (optParser->OptionSet("seed")) {
     if (NotANumber(optParser->GetTargetString("seed").c_str(), 0, kPosInt)) {
       printf("*** WARNING: RNG seed should be a positive integer!\n");
@@ -1017,6 +1127,22 @@ double LikelihoodFuncForDREAM( int chain, int gen, const double* state,
 }
 
 
+/* ---------------- FUNCTION: BoundedLikelihoodFuncForDREAM() ------------ */
+/// Same as LikelihoodFuncForDREAM, except that model-image computation stops
+/// early if the likelihood is certain to be < minLik (in which case the returned
+/// value is < minLik, but is otherwise only an upper bound on the likelihood).
+double BoundedLikelihoodFuncForDREAM( int chain, int gen, const double* state, 
+								const void* extraData, double minLik )
+{
+  double  *params = (double *)state;
+  ModelObject *theModel = (ModelObject *)extraData;
+  double  chi2;
+  
+  chi2 = theModel->GetFitStatisticBounded(params, -2.0*minLik);
+  return -chi2/2.0;
+}
+
+
 
 
 /* ---------------- FUNCTION: MakeMCMCOutputHeader() --------------------- */
@@ -108,6 +108,25 @@ void init_by_array( unsigned long init_key[], int key_length )
 }
 
 
+/* copies the current generator state (for checkpointing); state must have room
+ * for MT_STATE_SIZE values */
+void get_genrand_state( unsigned long state[], int *position )
+{
+  for (int k = 0; k < N; k++)
+    state[k] = mt[k];
+  *position = mti;
+}
+
+
+/* restores a generator state saved with get_genrand_state */
+void set_genrand_state( const unsigned long state[], int position )
+{
+  for (int k = 0; k < N; k++)
+    mt[k] = state[k];
+  mti = position;
+}
+
+
 /* generates a random number on [0,0xffffffff]-interval */
 unsigned long genrand_int32( )
 {
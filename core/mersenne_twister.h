@@ -14,6 +14,12 @@ void init_genrand( unsigned long s );
 /*    initialize with an array */
 void init_by_array( unsigned long init_key[], int key_length );
 
+/* Saving and restoring the generator state (e.g., for checkpoints): */
+/*    number of words in the state vector */
+const int MT_STATE_SIZE = 624;
+void get_genrand_state( unsigned long state[], int *position );
+void set_genrand_state( const unsigned long state[], int position );
+
 /* Integer rngs: */
 /* generates a random number on [0,0xffffffff]-interval */
 unsigned long genrand_int32( );
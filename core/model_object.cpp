@@ -62,8 +62,10 @@ using namespace std;
 #include "mersenne_twister.h"
 #include "definitions.h"
 #include "function_object.h"
+#include "helper_funcs.h"
 #include "model_object.h"
 #include "oversampled_region.h"
+#include "profile_counters.h"
 #include "psf_oversampling_info.h"
 #include "psf_interpolators.h"
 #include "mp_enorm.h"
@@ -89,6 +91,16 @@ const int  DOUBLE_SIZE = 8;
 // Core i7 in MacBook Pro, under Mac OS X 10.6 and 10.7)
 #define DEFAULT_OPENMP_CHUNK_SIZE  10
 
+// default tile size for CreateModelImage: 64 x 32 pixels = 16 KB for each of the
+// per-thread accumulation and Kahan-compensation buffers, so both stay in L1/L2
+// cache while each function object is evaluated over the whole tile
+#define DEFAULT_TILE_COLUMNS  64
+#define DEFAULT_TILE_ROWS  32
+
+// maximum number of functions whose (full-size) images are computed and convolved
+// together by GetAllSingleFunctionImages
+#define SINGLE_FUNCTION_IMAGE_GROUP  16
+
 
 // for use in ModelObject::AddFunction()
 map<string, int> interpolationMap{ {string("bicubic"), kInterpolator_bicubic}, 
@@ -117,6 +129,8 @@ ModelObject::ModelObject( )
   residualVector = maskVector = deviatesVector = NULL;
   outputModelVector = extraCashTermsVector = NULL;
   bootstrapIndices = NULL;
+  bootstrapMultiplicities = NULL;
+  bootstrapWeightVector = NULL;
   fsetStartFlags = NULL;
 
   localPsfPixels = nullptr;
@@ -143,6 +157,8 @@ ModelObject::ModelObject( )
   poissonMLR = false;
   doBootstrap = false;
   bootstrapIndicesAllocated = false;
+  bootstrapWeightsAllocated = false;
+  bootstrapMode = BOOTSTRAP_INDICES;
 
   modelImageSetupDone = false;
   
@@ -153,6 +169,13 @@ ModelObject::ModelObject( )
   oversampledRegionsExist = false;
   zeroPointSet = false;
   pointSourcesPresent = false;
+  fittingSetupDone = false;
+  frozenFunctionsExist = false;
+  frozenModelComputed = false;
+  computingFrozenImage = false;
+  nFrozenFunctions = 0;
+  bandFitStat = bandMaxFitStat = 0.0;
+  bandRowStart = bandRowEnd = 0;
   
   nFunctions = 0;
   nFunctionSets = 0;
@@ -172,6 +195,11 @@ ModelObject::ModelObject( )
   
   maxRequestedThreads = 0;   // default value --> use all available processors/cores
   ompChunkSize = DEFAULT_OPENMP_CHUNK_SIZE;
+  nTileColumns = DEFAULT_TILE_COLUMNS;
+  nTileRows = DEFAULT_TILE_ROWS;
+  cullingThreshold = 0.0;   // default = no spatial culling
+  convolutionMethod = CONVOLVE_FFT;
+  lowRankTolerance = 0.0;   // 0 = use Convolver's default
   
   nDataVals = nDataColumns = nDataRows = 0;
   nModelVals = nModelColumns = nModelRows = 0;
@@ -227,6 +255,11 @@ ModelObject::~ModelObject()
     free(bootstrapIndices);
     bootstrapIndicesAllocated = false;
   }
+  if (bootstrapWeightsAllocated) {
+    free(bootstrapMultiplicities);
+    free(bootstrapWeightVector);
+    bootstrapWeightsAllocated = false;
+  }
 }
 
 
@@ -274,6 +307,65 @@ void ModelObject::SetOMPChunkSize( int chunkSize )
 }
 
 
+/* ---------------- PUBLIC METHOD: SetTileSize ------------------------- */
+/// Sets the size (in pixels) of the tiles used by CreateModelImage; each
+/// function object is evaluated over a full tile before moving on to the next
+/// function object.
+void ModelObject::SetTileSize( int nColumns, int nRows )
+{
+  assert( (nColumns >= 1) && (nRows >= 1) );
+  nTileColumns = nColumns;
+  nTileRows = nRows;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetCullingThreshold ----------------- */
+/// Turns on spatial culling: function objects which can report a bounding box
+/// (via FunctionObject::GetBoundingBox) are evaluated by CreateModelImage only
+/// for pixels inside the box, outside of which they are < relThreshold times
+/// their central intensity. relThreshold = 0 turns culling off (the default).
+/// Returns 0 on success, -1 if relThreshold is not in the range [0,1).
+int ModelObject::SetCullingThreshold( double relThreshold )
+{
+  if ((relThreshold < 0.0) || (relThreshold >= 1.0)) {
+    fprintf(stderr, "*** ERROR: culling threshold must be >= 0 and < 1 (%g was supplied)!\n",
+    		relThreshold);
+    return -1;
+  }
+  cullingThreshold = relThreshold;
+  return 0;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetConvolutionMethod ---------------- */
+/// Specifies the method used for PSF convolution (CONVOLVE_FFT [default], 
+/// CONVOLVE_AUTO, CONVOLVE_FFT_TILED, CONVOLVE_DIRECT, or CONVOLVE_LOWRANK; see 
+/// definitions.h). Except for CONVOLVE_FFT, only the data-image region of the 
+/// (expanded) model image is convolved, so the image returned by
+/// GetExpandedModelImageVector() will *not* be convolved outside that region.
+/// Returns 0 on success, -1 if method is not recognized.
+int ModelObject::SetConvolutionMethod( int method )
+{
+  if ((method != CONVOLVE_AUTO) && (method != CONVOLVE_FFT) && (method != CONVOLVE_FFT_TILED)
+  		&& (method != CONVOLVE_DIRECT) && (method != CONVOLVE_LOWRANK)) {
+    fprintf(stderr, "*** ERROR: ModelObject::SetConvolutionMethod: unrecognized method (%d)!\n",
+    		method);
+    return -1;
+  }
+  convolutionMethod = method;
+  return 0;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetLowRankTolerance ----------------- */
+/// Specifies the tolerance for CONVOLVE_LOWRANK convolution (see 
+/// Convolver::SetLowRankTolerance).
+void ModelObject::SetLowRankTolerance( double tolerance )
+{
+  lowRankTolerance = tolerance;
+}
+
+
 /* ---------------- PUBLIC METHOD: AddFunction ------------------------- */
 /// Adds a FunctionObject subclass to the model
 int ModelObject::AddFunction( FunctionObject *newFunctionObj_ptr )
@@ -285,6 +377,9 @@ int ModelObject::AddFunction( FunctionObject *newFunctionObj_ptr )
   nNewParams = newFunctionObj_ptr->GetNParams();
   paramSizes.push_back(nNewParams);
   nFunctionParams += nNewParams;
+  if (modelImageSetupDone)
+    newFunctionObj_ptr->SetImageExtent(1 - nPSFColumns, nModelColumns - nPSFColumns,
+    								1 - nPSFRows, nModelRows - nPSFRows);
   
   // handle optional case of PointSource function
   if (newFunctionObj_ptr->IsPointSource()) {
@@ -401,6 +496,7 @@ void ModelObject::AddParameterInfo( mp_par  *inputParameterInfo )
     paramStruct.limits[1] = inputParameterInfo[i].limits[1];
     parameterInfoVect.push_back(paramStruct);
   }
+  IdentifyFrozenFunctions();
 }
 
 void ModelObject::AddParameterInfo( vector<mp_par> inputParameterInfo )
@@ -415,6 +511,7 @@ void ModelObject::AddParameterInfo( vector<mp_par> inputParameterInfo )
     paramStruct.limits[1] = inputParameterInfo[i].limits[1];
     parameterInfoVect.push_back(paramStruct);
   }
+  IdentifyFrozenFunctions();
 }
 
 
@@ -459,11 +556,22 @@ int ModelObject::SetupModelImage( int nImageColumns, int nImageRows )
     nModelColumns = nDataColumns + 2*nPSFColumns;
     nModelRows = nDataRows + 2*nPSFRows;
     psfConvolver->SetupImage(nModelColumns, nModelRows);
+    psfConvolver->SetConvolutionMethod(convolutionMethod);
+    if (lowRankTolerance > 0.0)
+      psfConvolver->SetLowRankTolerance(lowRankTolerance);
+    // Unless the caller has explicitly chosen some other method, the full expanded
+    // image is convolved (so that GetExpandedModelImageVector returns a fully
+    // convolved image); otherwise, only the data-image region is needed
+    if (convolutionMethod != CONVOLVE_FFT)
+      psfConvolver->SetOutputRegion(nPSFColumns, nPSFRows, nDataColumns, nDataRows);
     result = psfConvolver->DoFullSetup(debugLevel);
     if (result < 0) {
       fprintf(stderr, "*** Error returned from Convolver::DoFullSetup!\n");
       return result;
     }
+    if ((convolutionMethod == CONVOLVE_LOWRANK) && (verboseLevel >= 0))
+      printf("PSF approximated by %d separable terms (max. relative convolution error = %g)\n",
+      		psfConvolver->GetNSeparableTerms(), psfConvolver->GetLowRankResidual());
     nModelVals = (long)nModelColumns * (long)nModelRows;
   }
   else {
@@ -484,6 +592,11 @@ int ModelObject::SetupModelImage( int nImageColumns, int nImageRows )
   }
   modelVectorAllocated = true;
   modelImageSetupDone = true;
+  // tell function objects the range of pixel coordinates used in ComputeModelTiles
+  // (nPSFColumns = nPSFRows = 0 if not doing PSF convolution)
+  for (int n = 0; n < nFunctions; n++)
+    functionObjects[n]->SetImageExtent(1 - nPSFColumns, nModelColumns - nPSFColumns,
+    								1 - nPSFRows, nModelRows - nPSFRows);
   return 0;
 }
 
@@ -923,6 +1036,9 @@ int ModelObject::AddOversampledPsfInfo( PsfOversamplingInfo *oversampledPsfInfo
 //       data vector
 //    Finally, applies mask vector to weight vector and does final vetting of
 //       unmasked data values.
+//    Functions whose parameters are all fixed are identified, so they can be computed
+//       once and cached (this requires the parameter info, so it's done here or in
+//       AddParameterInfo, whichever is called last).
 int ModelObject::FinalSetupForFitting( )
 {
   long  nNonFinitePixels = 0;
@@ -1034,6 +1150,9 @@ int ModelObject::FinalSetupForFitting( )
     returnStatus = -3;
   }
 
+  fittingSetupDone = true;
+  IdentifyFrozenFunctions();
+
   return returnStatus;
 }
 
@@ -1043,10 +1162,74 @@ int ModelObject::FinalSetupForFitting( )
 
 void ModelObject::CreateModelImage( double params[] )
 {
-  double  x0, y0, x, y, newValSum;
-  long  i, j;
+  int  n;
+  ProfileTimer  modelTimer(PROFILE_MODEL_IMAGE);
+  
+  ProfileCount(PROFILE_N_MODEL_IMAGES);
+
+  // 0. Pass parameters to the individual function objects
+  SetupFunctionObjects(params);
+  
+  
+  // 0.B Determine which pixels each function needs to be evaluated for
+  ComputeBoundingBoxes();
+
+  // 0.C (Re)compute the cached image of functions with all parameters fixed, if needed
+  if (frozenFunctionsExist)
+    UpdateFrozenModelImage(params);
+
+
+  // 1. OK, populate modelVector with the model image -- standard pixel scaling
+  // (if there are frozen functions and no PSF convolution, this includes adding
+  // the cached frozen-function image)
+  ComputeModelTiles(false);
+  
+  
+  // 2. Do PSF convolution (using standard pixel scale), if requested
+  if (doConvolution)
+    psfConvolver->ConvolveImage(modelVector);
+  
+  
+  // 2.B Add flux from PointSource functions, if present 
+  // (must be done *after* PSF convolution!)
+  if (pointSourcesPresent) {
+    // Re-assign psfInterpolator object (bcs. calls made to
+    // OversampledRegion::ComputeRegionAndDownsample result in PointSource objects 
+    // getting assigned alternate psfInterpolators), so we have to reset PointSource 
+    // objects to use the standard-resolution psfInterpolator object held by ModelObject
+    for (FunctionObject *funcObj : functionObjects)
+      if (funcObj->IsPointSource())
+        funcObj->AddPsfInterpolator(psfInterpolator);
+    
+    ComputeModelTiles(true);
+  }
+  
+  // 2.C Add the cached (PSF-convolved) image of frozen functions
+  if (frozenFunctionsExist && doConvolution)
+    for (long z = 0; z < nModelVals; z++)
+      modelVector[z] += frozenModelVector[z];
+  
+  
+  // 3. Optional generation of oversampled sub-image and convolution with oversampled PSF
+  if (oversampledRegionsExist)
+    for (n = 0; n < nOversampledRegions; n++)
+      oversampledRegionsVect[n]->ComputeRegionAndDownsample(modelVector, functionObjects, nFunctions);
+  
+  // [4. Possible location for charge-diffusion and other post-pixelization processing]
+  
+  modelImageComputed = true;
+}
+
+
+/* ---------------- PROTECTED METHOD: SetupFunctionObjects ------------- */
+/// Checks the parameter vector, then separates out the individual-component
+/// parameters and passes them to the function objects (via their Setup methods).
+void ModelObject::SetupFunctionObjects( double params[] )
+{
+  double  x0, y0;
   int  n;
   int  offset = 0;
+  ProfileTimer  setupTimer(PROFILE_FUNCTION_SETUP);
   
   // Check parameter values for sanity
   if (! CheckParamVector(nParamsTot, params)) {
@@ -1060,7 +1243,7 @@ void ModelObject::CreateModelImage( double params[] )
   }
 
 
-  // 0. Separate out the individual-component parameters and tell the associated
+  // Separate out the individual-component parameters and tell the associated
   // function objects to do setup work.
   // The first component's parameters start at params[0]; the second's start at
   // params[paramSizes[0]], the third at params[paramSizes[0] + paramSizes[1]], and so forth...
@@ -1074,99 +1257,566 @@ void ModelObject::CreateModelImage( double params[] )
     functionObjects[n]->Setup(params, offset, x0, y0);
     offset += paramSizes[n];
   }
-  
-  
-  // 1. OK, populate modelVector with the model image -- standard pixel scaling
-  double  tempSum, adjVal, storedError;
-  
+}
+
+
+/* ---------------- PROTECTED METHOD: ComputeModelTiles ---------------- */
+/// Computes the sum of the (already Setup) function objects, storing the result
+/// in modelVector. If pointSourcePass is false, then all non-PointSource
+/// functions are summed and the result overwrites modelVector; if true, then
+/// only PointSource functions are summed and the result is *added* to modelVector
+/// (for use after PSF convolution).
+///
+/// The image is divided into tiles of nTileColumns x nTileRows pixels; within
+/// each tile, each function object is evaluated over all the tile's pixels before
+/// the next function object is called, with per-pixel Kahan summation into a
+/// tile-sized buffer. (Functions are summed in the same order as in a simple
+/// pixel-by-pixel loop, so the output is identical.) Function values are computed
+/// a row segment at a time via GetRowValues(), so that function objects with
+/// batched (vectorized) implementations can use them. Functions in the same function
+/// set with identical elliptical geometry (see AssignGeometryGroups) get their
+/// pixel radii from a per-tile pre-pass, which is computed once for each such group
+/// and shared among its members. Tiles are handed out to
+/// threads dynamically, since tiles covering the centers of subsampled components
+/// can be much more expensive than the rest.
+///
+/// Each function is only evaluated for pixels inside its bounding box, as computed
+/// by ComputeBoundingBoxes.
+///
+/// If frozen functions (all parameters fixed) exist, they are skipped -- unless
+/// computingFrozenImage is true, in which case *only* they are evaluated. When
+/// there is no PSF convolution, the non-PointSource pass starts each tile from the
+/// cached frozen-function image instead of zero.
+///
+/// While profiling is enabled, the (thread-summed) time spent on each function and
+/// the number of pixels it is evaluated for are added to componentProfileTimes and
+/// componentProfilePixels.
+///
+/// If partialFitStat is non-NULL (only allowed when CanTerminateFitStatEarly() is
+/// true and there is no PSF convolution, so that each model pixel is final as soon
+/// as its tile is done), the fit
+/// statistic for each finished tile is added to a running total; once that exceeds
+/// maxFitStat, all remaining tiles are skipped. (Since every per-pixel term of the
+/// statistic is >= 0, the full statistic must then also exceed maxFitStat.)
+/// The running total is stored in partialFitStat; returns false if tiles were
+/// skipped (leaving modelVector incomplete), true otherwise.
+bool ModelObject::ComputeModelTiles( bool pointSourcePass, double maxFitStat,
+									double *partialFitStat )
+{
+  int  nTilesX = (nModelColumns + nTileColumns - 1) / nTileColumns;
+  int  nTilesY = (nModelRows + nTileRows - 1) / nTileRows;
+  long  nTiles = (long)nTilesX * (long)nTilesY;
+  long  nTilePixels = (long)nTileColumns * (long)nTileRows;
+  long  i, j, i_start, i_end, j_start, j_end, i_lo, i_hi, j_lo, j_hi, t;
+  int  n, g, nColsInTile;
+  int  nGroups = AssignGeometryGroups(pointSourcePass);
+  double  x, y, tempSum, adjVal;
+  double  *tileSum, *tileError, *rowSum, *rowError, *modelRow, *rowValues;
+  double  *groupRadii, *radiiRow;
+  double  tileFitStat, runningFitStat;
+  double  funcStartTime, funcTime;
+  long  nFuncPixels;
+  bool  profiling = ProfilingEnabled();
+  double  *compTimes;
+  long  *compPixels;
+  bool  trackFitStat = (partialFitStat != NULL);
+  bool  thresholdExceeded = false;
+  bool  addFrozenImage = frozenFunctionsExist && (! computingFrozenImage) 
+  						&& (! doConvolution) && (! pointSourcePass);
+  FunctionObject  *funcObj;
+  ProfileTimer  pixelTimer(PROFILE_PIXEL_EVALUATION);
+
+  if (profiling && ((int)componentProfileTimes.size() != nFunctions)) {
+    componentProfileTimes.assign(nFunctions, 0.0);
+    componentProfilePixels.assign(nFunctions, 0);
+  }
+  compTimes = componentProfileTimes.data();
+  compPixels = componentProfilePixels.data();
+
 // Note that we cannot specify modelVector as shared [or private] bcs it is part
 // of a class (not an independent variable); happily, by default all references in
 // an omp-parallel section are shared unless specified otherwise
-#pragma omp parallel private(i,j,n,x,y,newValSum,tempSum,adjVal,storedError)
+  runningFitStat = 0.0;
+#pragma omp parallel private(i,j,i_start,i_end,j_start,j_end,i_lo,i_hi,j_lo,j_hi,t,n,g,nColsInTile,x,y,tempSum,adjVal,tileSum,tileError,rowSum,rowError,modelRow,rowValues,groupRadii,radiiRow,funcObj,tileFitStat,funcStartTime,funcTime,nFuncPixels)
   {
-  #pragma omp for schedule (static, ompChunkSize)
-//   for (i = 0; i < nModelRows; i++) {   // step by row number = y
-//     y = (double)(i - nPSFRows + 1);              // Iraf counting: first row = 1 
-//                                                  // (note that nPSFRows = 0 if not doing PSF convolution)
-//     for (j = 0; j < nModelColumns; j++) {   // step by column number = x
-//       x = (double)(j - nPSFColumns + 1);                 // Iraf counting: first column = 1
-//                                                          // (note that nPSFColumns = 0 if not doing PSF convolution)
-  // single-loop code which is ~ same in general case as double-loop, and
-  // faster for case of small image + many cores (André Luiz de Amorim suggestion)
-  for (long k = 0; k < nModelVals; k++) {
-    j = k % nModelColumns;
-    i = k / nModelColumns;
-    y = (double)(i - nPSFRows + 1);              // Iraf counting: first row = 1
+  // per-thread tile buffers for the running sums and Kahan compensation terms,
+  // plus a buffer for one row's worth of function values and tile-sized buffers
+  // for the radii of each shared-geometry group
+  tileSum = (double *)malloc((size_t)nTilePixels*sizeof(double));
+  tileError = (double *)malloc((size_t)nTilePixels*sizeof(double));
+  rowValues = (double *)malloc((size_t)nTileColumns*sizeof(double));
+  groupRadii = NULL;
+  if (nGroups > 0)
+    groupRadii = (double *)malloc((size_t)nGroups*nTilePixels*sizeof(double));
+
+  #pragma omp for schedule (dynamic, 1)
+  for (t = 0; t < nTiles; t++) {
+    if (trackFitStat) {
+      bool  skipTile;
+      #pragma omp atomic read
+      skipTile = thresholdExceeded;
+      if (skipTile)
+        continue;
+    }
+    i_start = (t / nTilesX) * nTileRows;
+    i_end = min(i_start + nTileRows, (long)nModelRows);
+    j_start = (t % nTilesX) * nTileColumns;
+    j_end = min(j_start + nTileColumns, (long)nModelColumns);
+    nColsInTile = (int)(j_end - j_start);
+    for (long m = 0; m < (i_end - i_start)*nColsInTile; m++)
+      tileSum[m] = tileError[m] = 0.0;
+    if (addFrozenImage) {
+      for (i = i_start; i < i_end; i++) {
+        rowSum = tileSum + (i - i_start)*nColsInTile;
+        modelRow = frozenModelVector.data() + i*nModelColumns + j_start;
+        for (j = 0; j < nColsInTile; j++)
+          rowSum[j] = modelRow[j];
+      }
+    }
+
+    // pre-pass: radii for each shared-geometry group, over the part of the tile
+    // inside the union of its members' bounding boxes
+    for (g = 0; g < nGroups; g++) {
+      i_lo = max(i_start, groupRowStart[g]);
+      i_hi = min(i_end, groupRowEnd[g]);
+      j_lo = max(j_start, groupColStart[g]);
+      j_hi = min(j_end, groupColEnd[g]);
+      for (i = i_lo; i < i_hi; i++) {
+        y = (double)(i - nPSFRows + 1);
+        x = (double)(j_lo - nPSFColumns + 1);
+        radiiRow = groupRadii + g*nTilePixels + (i - i_start)*nColsInTile + (j_lo - j_start);
+        EllipticalRadii(x, y, (int)(j_hi - j_lo), groupGeometry[5*g], groupGeometry[5*g + 1],
+        				groupGeometry[5*g + 2], groupGeometry[5*g + 3], groupGeometry[5*g + 4],
+        				radiiRow);
+      }
+    }
+
+    for (n = 0; n < nFunctions; n++) {
+      funcObj = functionObjects[n];
+      if (funcObj->IsPointSource() != pointSourcePass)
+        continue;
+      if (frozenFunctionsExist && (functionFrozen[n] != computingFrozenImage))
+        continue;
+      // restrict evaluation to the part of the tile inside the function's bounding box
+      i_lo = max(i_start, boxRowStart[n]);
+      i_hi = min(i_end, boxRowEnd[n]);
+      j_lo = max(j_start, boxColStart[n]);
+      j_hi = min(j_end, boxColEnd[n]);
+      if ((i_lo >= i_hi) || (j_lo >= j_hi))
+        continue;
+      if (profiling)
+        funcStartTime = ProfileClock();
+      for (i = i_lo; i < i_hi; i++) {   // step by row number = y
+        y = (double)(i - nPSFRows + 1);          // Iraf counting: first row = 1
                                                  // (note that nPSFRows = 0 if not doing PSF convolution)
-    x = (double)(j - nPSFColumns + 1);           // Iraf counting: first column = 1
+        rowSum = tileSum + (i - i_start)*nColsInTile + (j_lo - j_start);
+        rowError = tileError + (i - i_start)*nColsInTile + (j_lo - j_start);
+        x = (double)(j_lo - nPSFColumns + 1);    // Iraf counting: first column = 1
                                                  // (note that nPSFColumns = 0 if not doing PSF convolution)
-    newValSum = 0.0;
-    storedError = 0.0;
-    for (n = 0; n < nFunctions; n++) {
-      if (! functionObjects[n]->IsPointSource()) {
-        // Kahan summation algorithm
-        adjVal = functionObjects[n]->GetValue(x, y) - storedError;
-        tempSum = newValSum + adjVal;
-        storedError = (tempSum - newValSum) - adjVal;
-        newValSum = tempSum;
+        g = geometryGroup[n];
+        if (g >= 0) {
+          radiiRow = groupRadii + g*nTilePixels + (i - i_start)*nColsInTile + (j_lo - j_start);
+          funcObj->GetRowValuesFromRadii(x, y, (int)(j_hi - j_lo), radiiRow, rowValues);
+        }
+        else
+          funcObj->GetRowValues(x, y, (int)(j_hi - j_lo), rowValues);
+        for (j = 0; j < j_hi - j_lo; j++) {   // step by column number = x
+          // Kahan summation algorithm
+          adjVal = rowValues[j] - rowError[j];
+          tempSum = rowSum[j] + adjVal;
+          rowError[j] = (tempSum - rowSum[j]) - adjVal;
+          rowSum[j] = tempSum;
+        }
+      }
+      if (profiling) {
+        funcTime = ProfileClock() - funcStartTime;
+        nFuncPixels = (i_hi - i_lo)*(j_hi - j_lo);
+        #pragma omp atomic
+        compTimes[n] += funcTime;
+        #pragma omp atomic
+        compPixels[n] += nFuncPixels;
+        ProfileCount(PROFILE_N_PIXELS, nFuncPixels);
+      }
+    }
+
+    for (i = i_start; i < i_end; i++) {
+      rowSum = tileSum + (i - i_start)*nColsInTile;
+      modelRow = modelVector + i*nModelColumns + j_start;
+      if (pointSourcePass) {
+        for (j = 0; j < nColsInTile; j++)
+          modelRow[j] += rowSum[j];
+      } else {
+        for (j = 0; j < nColsInTile; j++)
+          modelRow[j] = rowSum[j];
+      }
+    }
+
+    if (trackFitStat) {
+      tileFitStat = TileFitStatistic(i_start, i_end, j_start, j_end);
+      double  newTotal;
+      #pragma omp atomic capture
+      { runningFitStat += tileFitStat; newTotal = runningFitStat; }
+      if (newTotal > maxFitStat) {
+        #pragma omp atomic write
+        thresholdExceeded = true;
       }
     }
-    modelVector[i*nModelColumns + j] = newValSum;
   }
+
+  free(tileSum);
+  free(tileError);
+  free(rowValues);
+  free(groupRadii);
   } // end omp parallel section
+
+  if (trackFitStat)
+    *partialFitStat = runningFitStat;
+  return (! thresholdExceeded);
+}
+
+
+/* ---------------- PROTECTED METHOD: TileFitStatistic ----------------- */
+/// Returns the contribution to the fit statistic (chi^2 or Poisson MLR) from the
+/// model-image pixels in rows i_start to i_end - 1 and columns j_start to j_end - 1,
+/// all of which must lie within the data-image region of the model image (with
+/// PSF convolution, the model image is larger than the data image by nPSFRows and
+/// nPSFColumns on each side).
+double ModelObject::TileFitStatistic( long i_start, long i_end, long j_start, long j_end )
+{
+  long  i, j, z, zModel;
+  double  dev, modVal, dataVal, logModel;
+  double  fitStat = 0.0;
+  
+  for (i = i_start; i < i_end; i++) {
+    z = (i - nPSFRows)*nDataColumns + (j_start - nPSFColumns);
+    zModel = i*nModelColumns + j_start;
+    for (j = j_start; j < j_end; j++, z++, zModel++) {
+      if (poissonMLR) {
+        modVal = effectiveGain*(modelVector[zModel] + originalSky);
+        dataVal = effectiveGain*(dataVector[z] + originalSky);
+        if (modVal <= 0)
+          logModel = LOG_SMALL_VALUE;
+        else
+          logModel = log(modVal);
+        fitStat += 2.0*weightVector[z] * (modVal - dataVal*logModel + extraCashTermsVector[z]);
+      } else {
+        dev = weightVector[z] * (dataVector[z] - modelVector[zModel]);
+        fitStat += dev*dev;
+      }
+    }
+  }
+  return fitStat;
+}
+
+
+/* ---------------- PROTECTED METHOD: AddBandFitStatistic ------------- */
+/// Called by Convolver::ConvolveImageInBands (with modelObject = the ModelObject
+/// instance) once model-image rows rowStart to rowEnd - 1 have been convolved:
+/// adds the cached frozen-function image to those rows (if needed), then adds
+/// their contribution to the fit statistic to bandFitStat. Returns false (stopping
+/// the convolution) once bandFitStat exceeds bandMaxFitStat.
+bool ModelObject::AddBandFitStatistic( int rowStart, int rowEnd, void *modelObject )
+{
+  ModelObject  *theModel = (ModelObject *)modelObject;
+  long  i_start, i_end;
   
+  if (theModel->bandRowEnd <= theModel->bandRowStart)
+    theModel->bandRowStart = rowStart;
+  theModel->bandRowEnd = rowEnd;
+  if (theModel->frozenFunctionsExist) {
+    for (long z = (long)rowStart*theModel->nModelColumns; 
+    			z < (long)rowEnd*theModel->nModelColumns; z++)
+      theModel->modelVector[z] += theModel->frozenModelVector[z];
+  }
   
-  // 2. Do PSF convolution (using standard pixel scale), if requested
-  if (doConvolution)
-    psfConvolver->ConvolveImage(modelVector);
+  i_start = max((long)rowStart, (long)theModel->nPSFRows);
+  i_end = min((long)rowEnd, (long)(theModel->nPSFRows + theModel->nDataRows));
+  if (i_start < i_end)
+    theModel->bandFitStat += theModel->TileFitStatistic(i_start, i_end, theModel->nPSFColumns,
+    										theModel->nPSFColumns + theModel->nDataColumns);
+  return (theModel->bandFitStat <= theModel->bandMaxFitStat);
+}
+
+
+/* ---------------- PROTECTED METHOD: ComputeBoundingBoxes ------------- */
+/// Determines, for each (already Setup) function object, the range of model-image
+/// rows and columns it must be evaluated over. This is the full model image unless
+/// spatial culling is turned on and the function can report a bounding box (see
+/// SetCullingThreshold). Stores the results as half-open index ranges in
+/// boxRowStart/boxRowEnd and boxColStart/boxColEnd.
+void ModelObject::ComputeBoundingBoxes( )
+{
+  double  xMin, xMax, yMin, yMax;
   
+  if ((int)boxRowStart.size() != nFunctions) {
+    boxRowStart.resize(nFunctions);
+    boxRowEnd.resize(nFunctions);
+    boxColStart.resize(nFunctions);
+    boxColEnd.resize(nFunctions);
+  }
   
-  // 2.B Add flux from PointSource functions, if present 
-  // (must be done *after* PSF convolution!)
+  for (int n = 0; n < nFunctions; n++) {
+    boxRowStart[n] = boxColStart[n] = 0;
+    boxRowEnd[n] = nModelRows;
+    boxColEnd[n] = nModelColumns;
+    if ((cullingThreshold > 0.0) 
+    		&& functionObjects[n]->GetBoundingBox(cullingThreshold, xMin, xMax, yMin, yMax)
+    		&& isfinite(xMin) && isfinite(xMax) && isfinite(yMin) && isfinite(yMax)) {
+      // convert from image coordinates to (clipped) model-image row & column indices
+      // (inverse of x = j - nPSFColumns + 1, y = i - nPSFRows + 1)
+      xMin = max(0.0, floor(xMin + nPSFColumns - 1));
+      xMax = min((double)nModelColumns, ceil(xMax + nPSFColumns - 1) + 1.0);
+      yMin = max(0.0, floor(yMin + nPSFRows - 1));
+      yMax = min((double)nModelRows, ceil(yMax + nPSFRows - 1) + 1.0);
+      boxColStart[n] = (long)min(xMin, (double)nModelColumns);
+      boxColEnd[n] = max(boxColStart[n], (long)max(xMax, 0.0));
+      boxRowStart[n] = (long)min(yMin, (double)nModelRows);
+      boxRowEnd[n] = max(boxRowStart[n], (long)max(yMax, 0.0));
+    }
+  }
+}
+
+
+/* ---------------- PROTECTED METHOD: AssignGeometryGroups ------------- */
+/// Identifies groups of two or more functions -- among those which the current
+/// ComputeModelTiles pass will evaluate -- which belong to the same function set
+/// and report identical elliptical geometry (center, PA, axis ratio) via
+/// GetEllipticalGeometry (e.g., bulge + disk + bar components with tied PA and
+/// ellipticity). Members of a group get their pixel radii from a single shared
+/// calculation per tile. Stores each function's group index in geometryGroup
+/// (-1 = not in a group), plus each group's geometry and the union of its members'
+/// bounding boxes. (Must be called after ComputeBoundingBoxes.) Returns the number
+/// of groups.
+int ModelObject::AssignGeometryGroups( bool pointSourcePass )
+{
+  double  geometry[5];
+  int  g, nGroups = 0, nShared = 0, fsetFirstGroup = 0;
+  vector<int>  nMembers, newIndex;
+  FunctionObject  *funcObj;
+  
+  geometryGroup.assign(nFunctions, -1);
+  groupGeometry.clear();
+  groupRowStart.clear();
+  groupRowEnd.clear();
+  groupColStart.clear();
+  groupColEnd.clear();
+  
+  for (int n = 0; n < nFunctions; n++) {
+    // only functions in the same function set can share a group
+    if (fsetStartFlags[n])
+      fsetFirstGroup = nGroups;
+    funcObj = functionObjects[n];
+    if (funcObj->IsPointSource() != pointSourcePass)
+      continue;
+    if (frozenFunctionsExist && (functionFrozen[n] != computingFrozenImage))
+      continue;
+    if ((boxRowStart[n] >= boxRowEnd[n]) || (boxColStart[n] >= boxColEnd[n]))
+      continue;
+    if (! funcObj->GetEllipticalGeometry(geometry[0], geometry[1], geometry[2], 
+    									geometry[3], geometry[4]))
+      continue;
+    for (g = fsetFirstGroup; g < nGroups; g++) {
+      if ((groupGeometry[5*g] == geometry[0]) && (groupGeometry[5*g + 1] == geometry[1])
+      		&& (groupGeometry[5*g + 2] == geometry[2]) && (groupGeometry[5*g + 3] == geometry[3])
+      		&& (groupGeometry[5*g + 4] == geometry[4]))
+        break;
+    }
+    if (g == nGroups) {
+      for (int k = 0; k < 5; k++)
+        groupGeometry.push_back(geometry[k]);
+      groupRowStart.push_back(boxRowStart[n]);
+      groupRowEnd.push_back(boxRowEnd[n]);
+      groupColStart.push_back(boxColStart[n]);
+      groupColEnd.push_back(boxColEnd[n]);
+      nMembers.push_back(0);
+      nGroups++;
+    } else {
+      groupRowStart[g] = min(groupRowStart[g], boxRowStart[n]);
+      groupRowEnd[g] = max(groupRowEnd[g], boxRowEnd[n]);
+      groupColStart[g] = min(groupColStart[g], boxColStart[n]);
+      groupColEnd[g] = max(groupColEnd[g], boxColEnd[n]);
+    }
+    geometryGroup[n] = g;
+    nMembers[g] += 1;
+  }
+  
+  // single-member groups gain nothing from sharing, so drop them and renumber
+  newIndex.assign(nGroups, -1);
+  for (g = 0; g < nGroups; g++) {
+    if (nMembers[g] < 2)
+      continue;
+    for (int k = 0; k < 5; k++)
+      groupGeometry[5*nShared + k] = groupGeometry[5*g + k];
+    groupRowStart[nShared] = groupRowStart[g];
+    groupRowEnd[nShared] = groupRowEnd[g];
+    groupColStart[nShared] = groupColStart[g];
+    groupColEnd[nShared] = groupColEnd[g];
+    newIndex[g] = nShared;
+    nShared++;
+  }
+  for (int n = 0; n < nFunctions; n++) {
+    if (geometryGroup[n] >= 0)
+      geometryGroup[n] = newIndex[geometryGroup[n]];
+  }
+  groupGeometry.resize(5*nShared);
+  groupRowStart.resize(nShared);
+  groupRowEnd.resize(nShared);
+  groupColStart.resize(nShared);
+  groupColEnd.resize(nShared);
+  
+  return nShared;
+}
+
+
+/* ---------------- PROTECTED METHOD: IdentifyFrozenFunctions ---------- */
+/// Identifies functions whose parameters -- including the X0,Y0 of their function
+/// set -- are all fixed. Such functions contribute the same (PSF-convolved) image
+/// to every model evaluation during a fit, so UpdateFrozenModelImage computes
+/// that image once, and CreateModelImage adds it as a constant term.
+/// Does nothing until both FinalSetupForFitting and AddParameterInfo have been
+/// called.
+void ModelObject::IdentifyFrozenFunctions( )
+{
+  int  offset = 0;
+  int  fsetOffset = 0;
+  int  lastFrozenFsetOffset = -1;
+  bool  allFixed;
+  
+  frozenFunctionsExist = frozenModelComputed = false;
+  nFrozenFunctions = 0;
+  functionFrozen.assign(nFunctions, false);
+  frozenParamIndices.clear();
+  if ((! fittingSetupDone) || ((int)parameterInfoVect.size() < nParamsTot) 
+  		|| (Dimensionality() != 2))
+    return;
+
+  // same parameter bookkeeping as in SetupFunctionObjects
+  for (int n = 0; n < nFunctions; n++) {
+    if (fsetStartFlags[n] == true) {
+      fsetOffset = offset;
+      offset += 2;
+    }
+    allFixed = (parameterInfoVect[fsetOffset].fixed == 1) 
+    			&& (parameterInfoVect[fsetOffset + 1].fixed == 1);
+    for (int i = offset; i < offset + paramSizes[n]; i++)
+      if (parameterInfoVect[i].fixed != 1)
+        allFixed = false;
+    if (allFixed) {
+      functionFrozen[n] = true;
+      nFrozenFunctions++;
+      if (fsetOffset != lastFrozenFsetOffset) {
+        frozenParamIndices.push_back(fsetOffset);
+        frozenParamIndices.push_back(fsetOffset + 1);
+        lastFrozenFsetOffset = fsetOffset;
+      }
+      for (int i = offset; i < offset + paramSizes[n]; i++)
+        frozenParamIndices.push_back(i);
+    }
+    offset += paramSizes[n];
+  }
+  
+  if (nFrozenFunctions > 0) {
+    frozenFunctionsExist = true;
+    frozenParamValues.assign(frozenParamIndices.size(), 0.0);
+    frozenModelVector.assign(nModelVals, 0.0);
+    if (verboseLevel > 0)
+      printf("ModelObject: %d function(s) with all parameters fixed will be computed once and cached\n",
+      		nFrozenFunctions);
+  }
+}
+
+
+/* ---------------- PROTECTED METHOD: UpdateFrozenModelImage ----------- */
+/// Computes the summed image of the frozen functions (including PSF convolution
+/// and PointSource functions) and stores it in frozenModelVector -- but only if it
+/// hasn't already been computed with the same (fixed) parameter values.
+/// Function objects must already be Setup with params. Uses modelVector as
+/// workspace.
+void ModelObject::UpdateFrozenModelImage( double params[] )
+{
+  bool  needsUpdate = (! frozenModelComputed);
+  
+  for (int k = 0; k < (int)frozenParamIndices.size(); k++) {
+    if (params[frozenParamIndices[k]] != frozenParamValues[k]) {
+      frozenParamValues[k] = params[frozenParamIndices[k]];
+      needsUpdate = true;
+    }
+  }
+  if (! needsUpdate)
+    return;
+  
+  computingFrozenImage = true;
+  ComputeModelTiles(false);
+  if (doConvolution)
+    psfConvolver->ConvolveImage(modelVector);
   if (pointSourcesPresent) {
-    // Re-assign psfInterpolator object (bcs. calls made to
-    // OversampledRegion::ComputeRegionAndDownsample result in PointSource objects 
-    // getting assigned alternate psfInterpolators), so we have to reset PointSource 
-    // objects to use the standard-resolution psfInterpolator object held by ModelObject
     for (FunctionObject *funcObj : functionObjects)
       if (funcObj->IsPointSource())
         funcObj->AddPsfInterpolator(psfInterpolator);
-    
-#pragma omp parallel private(i,j,n,x,y,newValSum,tempSum,adjVal,storedError)
+    ComputeModelTiles(true);
+  }
+  for (long z = 0; z < nModelVals; z++)
+    frozenModelVector[z] = modelVector[z];
+  computingFrozenImage = false;
+  frozenModelComputed = true;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetNFrozenFunctions ----------------- */
+
+int ModelObject::GetNFrozenFunctions( )
+{
+  return nFrozenFunctions;
+}
+
+
+/* ---------------- PUBLIC METHOD: PrintCullingSummary ----------------- */
+/// Prints a summary of the bounding boxes used for spatial culling with the
+/// specified parameter vector, including the fraction of each component's flux
+/// (within the model image) which is lost by not evaluating it outside its box.
+/// This requires evaluating culled components over the full model image, so it
+/// is meant to be called only once (e.g., at the start of a fit).
+void ModelObject::PrintCullingSummary( double params[] )
+{
+  long  nBoxPixels;
+  double  x, y, newVal, totalSum, outsideSum;
+  
+  if (cullingThreshold <= 0.0)
+    return;
+  
+  CreateModelImage(params);
+  
+  printf("Spatial culling of components (relative threshold = %g):\n", cullingThreshold);
+  for (int n = 0; n < nFunctions; n++) {
+    nBoxPixels = (boxRowEnd[n] - boxRowStart[n]) * (boxColEnd[n] - boxColStart[n]);
+    if (nBoxPixels == nModelVals) {
+      printf("   %s (function %d): evaluated over full image\n", 
+      		functionObjects[n]->GetShortName().c_str(), n + 1);
+      continue;
+    }
+    totalSum = outsideSum = 0.0;
+    #pragma omp parallel private(x,y,newVal) reduction(+:totalSum,outsideSum)
     {
     #pragma omp for schedule (static, ompChunkSize)
-    for (long k = 0; k < nModelVals; k++) {
-      j = k % nModelColumns;
-      i = k / nModelColumns;
-      y = (double)(i - nPSFRows + 1);              // Iraf counting: first row = 1
-                                                   // (note that nPSFRows = 0 if not doing PSF convolution)
-      x = (double)(j - nPSFColumns + 1);           // Iraf counting: first column = 1
-                                                   // (note that nPSFColumns = 0 if not doing PSF convolution)
-      newValSum = 0.0;
-      storedError = 0.0;
-      for (n = 0; n < nFunctions; n++) {
-        // Use Kahan summation algorithm
-        if (functionObjects[n]->IsPointSource()) {
-          adjVal = functionObjects[n]->GetValue(x, y) - storedError;
-          tempSum = newValSum + adjVal;
-          storedError = (tempSum - newValSum) - adjVal;
-          newValSum = tempSum;
-        }
+    for (long i = 0; i < nModelRows; i++) {
+      y = (double)(i - nPSFRows + 1);
+      for (long j = 0; j < nModelColumns; j++) {
+        x = (double)(j - nPSFColumns + 1);
+        newVal = functionObjects[n]->GetValue(x, y);
+        totalSum += newVal;
+        if ((i < boxRowStart[n]) || (i >= boxRowEnd[n]) || (j < boxColStart[n]) || (j >= boxColEnd[n]))
+          outsideSum += newVal;
       }
-      modelVector[i*nModelColumns + j] += newValSum;
     }
     } // end omp parallel section
+    printf("   %s (function %d): evaluated over %ld x %ld pixels (%.2f%% of image);",
+    		functionObjects[n]->GetShortName().c_str(), n + 1, boxColEnd[n] - boxColStart[n],
+    		boxRowEnd[n] - boxRowStart[n], 100.0*nBoxPixels/nModelVals);
+    if (totalSum != 0.0)
+      printf(" fraction of flux outside box = %.2e\n", fabs(outsideSum/totalSum));
+    else
+      printf(" (component has zero flux)\n");
   }
-  
-  
-  // 3. Optional generation of oversampled sub-image and convolution with oversampled PSF
-  if (oversampledRegionsExist)
-    for (n = 0; n < nOversampledRegions; n++)
-      oversampledRegionsVect[n]->ComputeRegionAndDownsample(modelVector, functionObjects, nFunctions);
-  
-  // [4. Possible location for charge-diffusion and other post-pixelization processing]
-  
-  modelImageComputed = true;
 }
 
 
@@ -1277,6 +1927,109 @@ double * ModelObject::GetSingleFunctionImage( double params[], int functionIndex
 }
 
 
+/* ---------------- PUBLIC METHOD: GetAllSingleFunctionImages ---------- */
+/// Generates separate images for all the FunctionObjects, using the input parameter
+/// vector, and stores them in outputImages[0], ..., outputImages[nFunctions - 1]
+/// (each of which must have room for nDataVals pixels). The results are the same
+/// as those of calling GetSingleFunctionImage for each function (apart from
+/// rounding differences for functions with vectorized GetRowValues), but the
+/// function objects are set up once, each row of every image is computed in the
+/// same (parallel) pass, and the PSF convolutions are batched (see
+/// Convolver::ConvolveImages). To limit memory use, functions are processed in
+/// groups of SINGLE_FUNCTION_IMAGE_GROUP.
+/// Returns 0 on success, -1 if memory allocation failed.
+int ModelObject::GetAllSingleFunctionImages( double params[], double **outputImages )
+{
+  double  x, y;
+  int  nGroup, nInGroup, nToConvolve;
+  int  iDataRow, iDataCol;
+  long  i, z, zModel;
+  vector<double *>  groupImages, imagesToConvolve;
+  vector<FunctionObject *>  singleFuncObjVector(1);
+  
+  // Check parameter values for sanity
+  if (! CheckParamVector(nParamsTot, params)) {
+    fprintf(stderr, "** ModelObject::GetAllSingleFunctionImages -- non-finite values detected in parameter vector!\n");
+    fprintf(stderr, "Exiting ...\n\n");
+    exit(-1);
+  }
+  SetupFunctionObjects(params);
+  // (see comments in CreateModelImage for why we need to do this)
+  for (FunctionObject *funcObj : functionObjects)
+    if (funcObj->IsPointSource())
+      funcObj->AddPsfInterpolator(psfInterpolator);
+
+  nGroup = std::min(nFunctions, SINGLE_FUNCTION_IMAGE_GROUP);
+  groupImages.resize(nGroup, NULL);
+  imagesToConvolve.resize(nGroup);
+  for (int k = 0; k < nGroup; k++) {
+    groupImages[k] = (double *) calloc((size_t)nModelVals, sizeof(double));
+    if (groupImages[k] == NULL) {
+      fprintf(stderr, "*** ERROR: Unable to allocate memory for single-function images!\n");
+      for (int kk = 0; kk < k; kk++)
+        free(groupImages[kk]);
+      return -1;
+    }
+  }
+
+  for (int start = 0; start < nFunctions; start += nGroup) {
+    nInGroup = std::min(nGroup, nFunctions - start);
+
+    // 1. Compute the images, a row at a time for all functions in the group
+#pragma omp parallel private(i,x,y)
+    {
+    #pragma omp for schedule (static, ompChunkSize)
+    for (i = 0; i < nModelRows; i++) {
+      y = (double)(i - nPSFRows + 1);              // Iraf counting: first row = 1
+      x = (double)(1 - nPSFColumns);               // Iraf counting: first column = 1
+      for (int k = 0; k < nInGroup; k++)
+        functionObjects[start + k]->GetRowValues(x, y, nModelColumns, 
+        										groupImages[k] + i*nModelColumns);
+    }
+    } // end omp parallel section
+
+    // 2. PSF convolution of all non-PointSource images in the group
+    if (doConvolution) {
+      nToConvolve = 0;
+      for (int k = 0; k < nInGroup; k++)
+        if (! functionObjects[start + k]->IsPointSource())
+          imagesToConvolve[nToConvolve++] = groupImages[k];
+      psfConvolver->ConvolveImages(imagesToConvolve.data(), nToConvolve);
+    }
+
+    // 3. Optional oversampled sub-images (one function at a time)
+    if (oversampledRegionsExist)
+      for (int k = 0; k < nInGroup; k++) {
+        singleFuncObjVector[0] = functionObjects[start + k];
+        for (int n = 0; n < nOversampledRegions; n++)
+          oversampledRegionsVect[n]->ComputeRegionAndDownsample(groupImages[k], 
+          												singleFuncObjVector, 1);
+      }
+
+    // 4. Copy images to output (extracting the data-sized subimage if PSF
+    // convolution was done)
+    for (int k = 0; k < nInGroup; k++) {
+      if (doConvolution) {
+        for (z = 0; z < nDataVals; z++) {
+          iDataRow = z / nDataColumns;
+          iDataCol = z - (long)iDataRow * (long)nDataColumns;
+          zModel = (long)nModelColumns * (long)(nPSFRows + iDataRow) + nPSFColumns + iDataCol;
+          outputImages[start + k][z] = groupImages[k][zModel];
+        }
+      }
+      else {
+        for (z = 0; z < nDataVals; z++)
+          outputImages[start + k][z] = groupImages[k][z];
+      }
+    }
+  }
+
+  for (int k = 0; k < nGroup; k++)
+    free(groupImages[k]);
+  return 0;
+}
+
+
 /* ---------------- PUBLIC METHOD: UpdateWeightVector ------------------ */
 /* This function computes new error-based weights using the current model
  * image and the Gaussian approximation to Poisson statistics. Used if we
@@ -1324,7 +2077,7 @@ void ModelObject::UpdateWeightVector(  )
 
 
 /* ---------------- PRIVATE METHOD: ComputePoissonMLRDeviate ----------- */
-double ModelObject::ComputePoissonMLRDeviate( long i, long i_model )
+double ModelObject::ComputePoissonMLRDeviate( long i, long i_model, const double *weights )
 {
   double   modVal, dataVal, logModel, extraTerms, deviateVal;
   
@@ -1337,7 +2090,7 @@ double ModelObject::ComputePoissonMLRDeviate( long i, long i_model )
   extraTerms = extraCashTermsVector[i];
   // Note use of fabs(), to ensure that possible tiny negative values (due to
   // rounding errors when modVal =~ dataVal) don't turn into NaN
-  deviateVal = sqrt(2.0 * weightVector[i] * fabs(modVal - dataVal*logModel + extraTerms));
+  deviateVal = sqrt(2.0 * weights[i] * fabs(modVal - dataVal*logModel + extraTerms));
   return deviateVal;
 }
 
@@ -1355,6 +2108,8 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
 {
   int  iDataRow, iDataCol;
   long  z, zModel, b, bModel;
+  double  *weights = weightVector;
+  bool  gatherBootstrap = (doBootstrap && (bootstrapMode == BOOTSTRAP_INDICES));
   
 #ifdef DEBUG
   printf("ComputeDeviates: Input parameters: ");
@@ -1364,14 +2119,23 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
 #endif
 
   CreateModelImage(params);
+  ProfileTimer  statTimer(PROFILE_FIT_STATISTIC);
+  ProfileCount(PROFILE_N_FIT_STATISTICS);
   if (modelErrors)
     UpdateWeightVector();
+  if (doBootstrap && (! gatherBootstrap)) {
+    if (modelErrors)
+      FoldBootstrapWeights();
+    weights = bootstrapWeightVector;
+  }
 
 
   // In standard case, z = index into dataVector, weightVector, and yResults; it comes 
   // from linearly stepping through (0, ..., nDataVals).
-  // In the bootstrap case, z = index into yResults and bootstrapIndices vector;
-  // b = bootstrapIndices[z] = index into dataVector and weightVector
+  // In the (index-list) bootstrap case, z = index into yResults and bootstrapIndices 
+  // vector; b = bootstrapIndices[z] = index into dataVector and weightVector.
+  // In the multiplicity-bootstrap case, the standard loops are used, with each
+  // pixel's weight multiplied by sqrt(multiplicity) [chi^2] or multiplicity [PMLR]
   
   // NOTE: in the doConvolution case, the algorithm is sufficiently complicated that
   // it makes sense to keep it in the current form, with PMLR or chi^2 calculation
@@ -1381,14 +2145,14 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
     // Step through model image so that we correctly match its pixels with corresponding
     // pixels in data and weight images (excluding the outer borders of the model image,
     // which are only for ensuring proper PSF convolution)
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       for (z = 0; z < nValidDataVals; z++) {
         b = bootstrapIndices[z];
         iDataRow = b / nDataColumns;
         iDataCol = b - (long)iDataRow * (long)nDataColumns;
         bModel = (long)nModelColumns * (long)(nPSFRows + iDataRow) + nPSFColumns + iDataCol;
         if (poissonMLR)
-          yResults[z] = ComputePoissonMLRDeviate(b, bModel);
+          yResults[z] = ComputePoissonMLRDeviate(b, bModel, weightVector);
         else   // standard chi^2 term
           yResults[z] = weightVector[b] * (dataVector[b] - modelVector[bModel]);
       }
@@ -1399,9 +2163,9 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
         iDataCol = z - (long)iDataRow * (long)nDataColumns;
         zModel = (long)nModelColumns * (long)(nPSFRows + iDataRow) + nPSFColumns + iDataCol;
         if (poissonMLR)
-          yResults[z] = ComputePoissonMLRDeviate(z, zModel);
+          yResults[z] = ComputePoissonMLRDeviate(z, zModel, weights);
         else   // standard chi^2 term
-          yResults[z] = weightVector[z] * (dataVector[z] - modelVector[zModel]);
+          yResults[z] = weights[z] * (dataVector[z] - modelVector[zModel]);
       }
     }
   }   // end if convolution case
@@ -1411,11 +2175,11 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
   // compiler to auto-vectorize the loops in the chi^2 case)
   else {
     // No convolution, so model image is same size & shape as data and weight images
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       if (poissonMLR)
         for (z = 0; z < nValidDataVals; z++) {
           b = bootstrapIndices[z];
-          yResults[z] = ComputePoissonMLRDeviate(b, b);
+          yResults[z] = ComputePoissonMLRDeviate(b, b, weightVector);
         } else {   // standard chi^2 term
         for (z = 0; z < nValidDataVals; z++) {
           b = bootstrapIndices[z];
@@ -1426,10 +2190,10 @@ void ModelObject::ComputeDeviates( double yResults[], double params[] )
     else {
       if (poissonMLR)
         for (z = 0; z < nDataVals; z++)
-          yResults[z] = ComputePoissonMLRDeviate(z, z);
+          yResults[z] = ComputePoissonMLRDeviate(z, z, weights);
       else   // standard chi^2 term
         for (z = 0; z < nDataVals; z++)
-          yResults[z] = weightVector[z] * (dataVector[z] - modelVector[z]);
+          yResults[z] = weights[z] * (dataVector[z] - modelVector[z]);
     }
     
   }  // end else (non-convolution case)
@@ -1567,29 +2331,124 @@ double ModelObject::GetFitStatistic( double params[] )
 }
 
 
+/* ---------------- PUBLIC METHOD: CanTerminateFitStatEarly ----------- */
+/// Returns true if GetFitStatisticBounded can stop computing the model image
+/// partway through: this requires that each pixel of the model image be final
+/// as soon as its tile (or, with PSF convolution, its band of convolved rows) is
+/// computed (no point sources or oversampled regions), and that every pixel's
+/// contribution to the fit statistic be >= 0 (chi^2 with data-based errors or
+/// Poisson MLR; no bootstrap resampling).
+bool ModelObject::CanTerminateFitStatEarly( )
+{
+  if (Dimensionality() != 2)
+    return false;
+  if (pointSourcesPresent || oversampledRegionsExist)
+    return false;
+  if (modelErrors || doBootstrap)
+    return false;
+  if (useCashStatistic && (! poissonMLR))
+    return false;
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetFitStatisticBounded -------------- */
+/// Same as GetFitStatistic, except that if CanTerminateFitStatEarly() is true, the
+/// model image is computed tile by tile while accumulating the fit statistic, and
+/// computation stops as soon as the running total exceeds maxFitStat (e.g., for
+/// MCMC proposals which will certainly be rejected).
+/// With PSF convolution, the whole unconvolved model image is computed, and the
+/// test is applied after each band of rows is convolved; this only saves time
+/// with the tiled FFT convolution method (the other methods produce all rows
+/// at once).
+/// If the computation stopped early, the return value is the partial sum (which
+/// is > maxFitStat, but is otherwise a lower bound on the actual fit statistic);
+/// otherwise, the return value is identical to that from GetFitStatistic.
+double ModelObject::GetFitStatisticBounded( double params[], double maxFitStat )
+{
+  double  partialFitStat = 0.0;
+  
+  if (! CanTerminateFitStatEarly())
+    return GetFitStatistic(params);
+  
+  ProfileTimer  modelTimer(PROFILE_MODEL_IMAGE);
+  ProfileCount(PROFILE_N_MODEL_IMAGES);
+  SetupFunctionObjects(params);
+  ComputeBoundingBoxes();
+  if (frozenFunctionsExist)
+    UpdateFrozenModelImage(params);
+  if (doConvolution) {
+    ComputeModelTiles(false);
+    bandFitStat = 0.0;
+    bandMaxFitStat = maxFitStat;
+    bandRowStart = bandRowEnd = 0;
+    if (! psfConvolver->ConvolveImageInBands(modelVector, &AddBandFitStatistic, this)) {
+      modelImageComputed = false;
+      ProfileCount(PROFILE_N_FIT_STATISTICS);
+      return bandFitStat;
+    }
+    // add frozen-function image to rows outside the convolved region
+    if (frozenFunctionsExist) {
+      for (long z = 0; z < (long)bandRowStart*nModelColumns; z++)
+        modelVector[z] += frozenModelVector[z];
+      for (long z = (long)bandRowEnd*nModelColumns; z < nModelVals; z++)
+        modelVector[z] += frozenModelVector[z];
+    }
+  }
+  else if (! ComputeModelTiles(false, maxFitStat, &partialFitStat)) {
+    modelImageComputed = false;
+    ProfileCount(PROFILE_N_FIT_STATISTICS);
+    return partialFitStat;
+  }
+  modelImageComputed = true;
+  modelTimer.Stop();
+  if (useCashStatistic)
+    return CashStatisticFromModel();
+  else
+    return ChiSquaredFromModel();
+}
+
+
 /* ---------------- PUBLIC METHOD: ChiSquared -------------------------- */
 /* Function for calculating chi^2 value for a model.
  *
  */
 double ModelObject::ChiSquared( double params[] )
+{
+  CreateModelImage(params);
+  return ChiSquaredFromModel();
+}
+
+
+/* ---------------- PROTECTED METHOD: ChiSquaredFromModel -------------- */
+/// Computes chi^2 using the current (already computed) model image.
+double ModelObject::ChiSquaredFromModel( )
 {
   int  iDataRow, iDataCol;
   long  z, zModel, b, bModel;
   double  chi;
+  double  *weights = weightVector;
+  bool  gatherBootstrap = (doBootstrap && (bootstrapMode == BOOTSTRAP_INDICES));
+  ProfileTimer  statTimer(PROFILE_FIT_STATISTIC);
   
+  ProfileCount(PROFILE_N_FIT_STATISTICS);
   if (! deviatesVectorAllocated) {
     deviatesVector = (double *) calloc((size_t)nDataVals, sizeof(double));
     deviatesVectorAllocated = true;
   }
   
-  CreateModelImage(params);
   if (modelErrors)
     UpdateWeightVector();
+  if (doBootstrap && (! gatherBootstrap)) {
+    if (modelErrors)
+      FoldBootstrapWeights();
+    weights = bootstrapWeightVector;   // weights include sqrt(multiplicity)
+  }
   
   if (doConvolution) {
     // Step through model image so that we correctly match its pixels with corresponding
     // pixels in data and weight images
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       for (z = 0; z < nValidDataVals; z++) {
         b = bootstrapIndices[z];
         iDataRow = b / nDataColumns;
@@ -1602,12 +2461,12 @@ double ModelObject::ChiSquared( double params[] )
         iDataRow = z / nDataColumns;
         iDataCol = z - (long)iDataRow * (long)nDataColumns;
         zModel = (long)nModelColumns * (long)(nPSFRows + iDataRow) + nPSFColumns + iDataCol;
-        deviatesVector[z] = weightVector[z] * (dataVector[z] - modelVector[zModel]);
+        deviatesVector[z] = weights[z] * (dataVector[z] - modelVector[zModel]);
       }
     }
   }
   else {   // Model image is same size & shape as data and weight images
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       for (z = 0; z < nValidDataVals; z++) {
         b = bootstrapIndices[z];
         deviatesVector[z] = weightVector[b] * (dataVector[b] - modelVector[b]);
@@ -1615,13 +2474,13 @@ double ModelObject::ChiSquared( double params[] )
     } else {
       // Note: this loop is auto-vectorized when compiling with -O3 and -sse2 (g++-7)
       for (z = 0; z < nDataVals; z++) {
-        deviatesVector[z] = weightVector[z] * (dataVector[z] - modelVector[z]);
+        deviatesVector[z] = weights[z] * (dataVector[z] - modelVector[z]);
       }
     }
   }
   
   // mp_enorm returns sqrt( Sum_i(chi_i^2) ) = sqrt( Sum_i(deviatesVector[i]^2) )
-  if (doBootstrap)
+  if (gatherBootstrap)
     chi = mp_enorm(nValidDataVals, deviatesVector);
   else
     chi = mp_enorm(nDataVals, deviatesVector);
@@ -1642,18 +2501,33 @@ double ModelObject::ChiSquared( double params[] )
 // classical Cash statistic).
 //
 double ModelObject::CashStatistic( double params[] )
+{
+  CreateModelImage(params);
+  return CashStatisticFromModel();
+}
+
+
+/* ---------------- PROTECTED METHOD: CashStatisticFromModel ----------- */
+/// Computes the Cash (or Poisson MLR) statistic using the current (already
+/// computed) model image.
+double ModelObject::CashStatisticFromModel( )
 {
   int  iDataRow, iDataCol;
   long  z, zModel, b, bModel;
   double  modVal, dataVal, logModel, extraTerms;
   double  cashStat = 0.0;
+  double  *weights = weightVector;
+  bool  gatherBootstrap = (doBootstrap && (bootstrapMode == BOOTSTRAP_INDICES));
+  ProfileTimer  statTimer(PROFILE_FIT_STATISTIC);
   
-  CreateModelImage(params);
+  ProfileCount(PROFILE_N_FIT_STATISTICS);
+  if (doBootstrap && (! gatherBootstrap))
+    weights = bootstrapWeightVector;   // weights include multiplicity
   
   if (doConvolution) {
     // Step through model image so that we correctly match its pixels with corresponding
     // pixels in data and weight images
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       for (z = 0; z < nValidDataVals; z++) {
         b = bootstrapIndices[z];
         iDataRow = b / nDataColumns;
@@ -1681,12 +2555,12 @@ double ModelObject::CashStatistic( double params[] )
         else
           logModel = log(modVal);
         extraTerms = extraCashTermsVector[z];   // = 0 for Cash stat
-        cashStat += weightVector[z] * (modVal - dataVal*logModel + extraTerms);
+        cashStat += weights[z] * (modVal - dataVal*logModel + extraTerms);
       }
     }
   }
   else {   // Model image is same size & shape as data and weight images
-    if (doBootstrap) {
+    if (gatherBootstrap) {
       for (z = 0; z < nValidDataVals; z++) {
         b = bootstrapIndices[z];
         modVal = effectiveGain*(modelVector[b] + originalSky);
@@ -1707,7 +2581,7 @@ double ModelObject::CashStatistic( double params[] )
         else
           logModel = log(modVal);
         extraTerms = extraCashTermsVector[z];   // = 0 for Cash stat
-        cashStat += weightVector[z] * (modVal - dataVal*logModel + extraTerms);
+        cashStat += weights[z] * (modVal - dataVal*logModel + extraTerms);
       }
     }
   }
@@ -1748,6 +2622,31 @@ void ModelObject::GetFunctionLabels( vector<string>& functionLabels )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetComponentProfile ---------------- */
+/// Stores the name (with label, if any) of each image function, plus the time
+/// spent evaluating it and the number of pixels it was evaluated for (in the main
+/// image, while profiling was enabled), in the input vectors.
+void ModelObject::GetComponentProfile( vector<string>& componentNames, 
+							vector<double>& componentTimes, vector<long>& componentPixels )
+{
+  string  label;
+
+  componentNames.clear();
+  componentTimes.assign(nFunctions, 0.0);
+  componentPixels.assign(nFunctions, 0);
+  for (int n = 0; n < nFunctions; n++) {
+    componentNames.push_back(functionObjects[n]->GetShortName());
+    label = functionObjects[n]->GetLabel();
+    if (label.size() > 0)
+      componentNames[n] += " (" + label + ")";
+    if (n < (int)componentProfileTimes.size()) {
+      componentTimes[n] = componentProfileTimes[n];
+      componentPixels[n] = componentProfilePixels[n];
+    }
+  }
+}
+
+
 /* ---------------- PUBLIC METHOD: PrintModelParamsToStrings ---------- */
 /// Like PrintModelParams, but appends lines of output as strings to the input
 /// vector of string. 
@@ -1941,13 +2840,49 @@ string ModelObject::GetParamHeader( )
 }
 
 
+/* ---------------- PUBLIC METHOD: SetBootstrapMode -------------------- */
+/// Specifies how bootstrap resamples are represented (must be called before
+/// UseBootstrap):
+///    BOOTSTRAP_INDICES [default] -- list of nValidDataVals randomly chosen pixel
+/// indices, which the fit-statistic loops gather data, weight, and model values through;
+///    BOOTSTRAP_MULTINOMIAL -- the same resample (same random numbers), stored as
+/// the number of times each pixel was chosen, folded into a resampled weight
+/// vector so that the fit-statistic loops remain sequential;
+///    BOOTSTRAP_POISSON -- independent Poisson(1) multiplicity for each valid 
+/// pixel ("Poisson bootstrap"), also folded into the weight vector.
+/// Returns 0 on success, -1 if mode is not recognized.
+int ModelObject::SetBootstrapMode( int mode )
+{
+  if ((mode != BOOTSTRAP_INDICES) && (mode != BOOTSTRAP_MULTINOMIAL) 
+  		&& (mode != BOOTSTRAP_POISSON)) {
+    fprintf(stderr, "*** ERROR: ModelObject::SetBootstrapMode: unrecognized mode (%d)!\n", mode);
+    return -1;
+  }
+  bootstrapMode = mode;
+  return 0;
+}
+
+
+// Uniform deviate on [0,1) for bootstrap resampling, from the counter-based stream
+// if one is supplied, otherwise from the global Mersenne Twister sequence
+static inline double BootstrapUniform( RNGStream *rngStream )
+{
+  if (rngStream != NULL)
+    return rngStream->Uniform();
+  return genrand_real2();
+}
+
+
 /* ---------------- PUBLIC METHOD: UseBootstrap ------------------------ */
 /// Tells ModelObject1d object that from now on we'll operate in bootstrap
-/// resampling mode, so that bootstrapIndices vector is used to access the
-/// data and model values (and weight values, if any).
+/// resampling mode, so that bootstrapIndices vector (or the resampled weight
+/// vector, depending on bootstrapMode) is used to access the data and model 
+/// values (and weight values, if any).
+/// The initial sample is drawn from rngStream, if supplied (so that this can be
+/// called from multiple threads), or else from the global Mersenne Twister.
 /// Returns the status from MakeBootstrapSample(), which will be -1 if memory
 /// allocation for the bootstrap-indices vector failed.
-int ModelObject::UseBootstrap( )
+int ModelObject::UseBootstrap( RNGStream *rngStream )
 {
   int  status = 0;
   
@@ -1956,21 +2891,66 @@ int ModelObject::UseBootstrap( )
   // a bootstrap sample right now, since we will call MakeBootstrapSample directly
   // later on, every time we need a new sample. But calling this now *does* force
   // allocation of the bootstrapIndices array....
-  status = MakeBootstrapSample();
+  status = MakeBootstrapSample(rngStream);
   return status;
 }
 
 
 /* ---------------- PUBLIC METHOD: MakeBootstrapSample ----------------- */
 /// Generate a new bootstrap resampling of the data (more precisely, this generate a
-/// bootstrap resampling of the data *indices*)
+/// bootstrap resampling of the data *indices*, or of per-pixel multiplicities)
+/// If rngStream is non-NULL, random numbers are drawn from it; otherwise, the
+/// global Mersenne Twister sequence is used.
 /// Returns -1 if memory allocation for the bootstrap indices vector failed,
 /// otherwise returns 0.
-int ModelObject::MakeBootstrapSample( )
+int ModelObject::MakeBootstrapSample( RNGStream *rngStream )
 {
   long  n;
   bool  badIndex;
   
+  if (bootstrapMode != BOOTSTRAP_INDICES) {
+    if (! bootstrapWeightsAllocated) {
+      bootstrapMultiplicities = (double *) calloc((size_t)nDataVals, sizeof(double));
+      bootstrapWeightVector = (double *) calloc((size_t)nDataVals, sizeof(double));
+      if ((bootstrapMultiplicities == NULL) || (bootstrapWeightVector == NULL)) {
+        fprintf(stderr, "*** ERROR: Unable to allocate memory for bootstrap-resampling weights!\n");
+        fprintf(stderr, "    (Requested vector size was %ld pixels)\n", nDataVals);
+        return -1;
+      }
+      bootstrapWeightsAllocated = true;
+    }
+    for (long z = 0; z < nDataVals; z++)
+      bootstrapMultiplicities[z] = 0.0;
+    if (bootstrapMode == BOOTSTRAP_MULTINOMIAL) {
+      // same sequence of random draws as for BOOTSTRAP_INDICES, below
+      for (long i = 0; i < nValidDataVals; i++) {
+        badIndex = true;
+        do {
+          n = (long)floor( BootstrapUniform(rngStream)*nDataVals );
+          if (weightVector[n] > 0.0)
+            badIndex = false;
+        } while (badIndex);
+        bootstrapMultiplicities[n] += 1.0;
+      }
+    } else {
+      // Poisson(1) deviate for each unmasked pixel (Knuth's multiplication method)
+      double  expMinusOne = exp(-1.0);
+      for (long z = 0; z < nDataVals; z++) {
+        if (weightVector[z] > 0.0) {
+          int  k = 0;
+          double  prod = BootstrapUniform(rngStream);
+          while (prod > expMinusOne) {
+            k++;
+            prod *= BootstrapUniform(rngStream);
+          }
+          bootstrapMultiplicities[z] = (double)k;
+        }
+      }
+    }
+    FoldBootstrapWeights();
+    return 0;
+  }
+
   if (! bootstrapIndicesAllocated) {
     bootstrapIndices = (long *) calloc((size_t)nValidDataVals, sizeof(long));
     if (bootstrapIndices == NULL) {
@@ -1985,7 +2965,7 @@ int ModelObject::MakeBootstrapSample( )
     // reject masked pixels
     badIndex = true;
     do {
-      n = (long)floor( genrand_real2()*nDataVals );
+      n = (long)floor( BootstrapUniform(rngStream)*nDataVals );
       if (weightVector[n] > 0.0)
         badIndex = false;
     } while (badIndex);
@@ -1995,6 +2975,24 @@ int ModelObject::MakeBootstrapSample( )
 }
 
 
+/* ---------------- PROTECTED METHOD: FoldBootstrapWeights ------------- */
+/// Combines the current bootstrap multiplicities with the weight vector to produce
+/// bootstrapWeightVector. For chi^2, weights multiply the deviates (which are then
+/// squared), so the multiplicities enter as sqrt(multiplicity); for the Cash and
+/// Poisson-MLR statistics, weights multiply the per-pixel terms directly.
+/// (Must be called again whenever weightVector changes, e.g. with model-based errors.)
+void ModelObject::FoldBootstrapWeights( )
+{
+  if ((useCashStatistic) || (poissonMLR)) {
+    for (long z = 0; z < nDataVals; z++)
+      bootstrapWeightVector[z] = bootstrapMultiplicities[z] * weightVector[z];
+  } else {
+    for (long z = 0; z < nDataVals; z++)
+      bootstrapWeightVector[z] = sqrt(bootstrapMultiplicities[z]) * weightVector[z];
+  }
+}
+
+
 
 
 /* ---------------- PUBLIC METHOD: PrintImage ------------------------- */
@@ -2072,6 +3070,7 @@ void ModelObject::PrintWeights( )
 
 
 /* ---------------- PUBLIC METHOD: PopulateParameterNames -------------- */
+/// Also stores the parameter-scaling types (see GetParameterScaling).
 /// Note that this is usually called by AddFunctions() in add_functions.cpp.
 
 void ModelObject::PopulateParameterNames( )
@@ -2083,8 +3082,11 @@ void ModelObject::PopulateParameterNames( )
       // start of new function set: extract x0,y0
       parameterLabels.push_back("X0");
       parameterLabels.push_back("Y0");
+      parameterScalings.push_back(PARAM_SCALING_POSITION);
+      parameterScalings.push_back(PARAM_SCALING_POSITION);
     }
     functionObjects[n]->GetParameterNames(parameterLabels);
+    functionObjects[n]->GetParameterScalings(parameterScalings);
   }
 }
 
@@ -2101,6 +3103,20 @@ string& ModelObject::GetParameterName( int i )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetParameterScaling ----------------- */
+/// Returns the PARAM_SCALING_xxx type of parameter i (how its value changes with
+/// the pixel scale), or PARAM_SCALING_UNKNOWN if i is out of range or the image
+/// function did not specify it.
+
+int ModelObject::GetParameterScaling( int i )
+{
+  if ((i >= 0) && (i < (int)parameterScalings.size()))
+    return parameterScalings[i];
+  else
+    return PARAM_SCALING_UNKNOWN;
+}
+
+
 /* ---------------- PUBLIC METHOD: GetNFunctions ----------------------- */
 /// Prints the total number of image functions (instances of FunctionObject 
 /// subclasses) making up the model.
@@ -2135,6 +3151,19 @@ long ModelObject::GetNValidPixels( )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetNDeviates ------------------------ */
+/// Returns the number of values computed by ComputeDeviates (= length of the
+/// deviates vector needed by the L-M solver): nValidDataVals when doing index-list
+/// bootstrap resampling, otherwise nDataVals (masked pixels have deviates = 0).
+long ModelObject::GetNDeviates( )
+{
+  if ((doBootstrap) && (bootstrapMode == BOOTSTRAP_INDICES))
+    return nValidDataVals;
+  else
+    return nDataVals;
+}
+
+
 /* ---------------- PUBLIC METHOD: HasPSF ------------------------------ */
 /// Returns true if the model has a PSF image
 bool ModelObject::HasPSF( )
@@ -2201,7 +3230,9 @@ double * ModelObject::GetModelImageVector( )
 
 /// This differs from GetModelImageVector() in that it always returns the full
 /// model image, even in the case of PSF convolution (where the full model
-/// image will be larger than the data image!)
+/// image will be larger than the data image!). Note that the region outside
+/// the data image is only convolved if the convolution method is CONVOLVE_FFT
+/// (the default).
 double * ModelObject::GetExpandedModelImageVector( )
 {
 
@@ -2271,7 +3302,9 @@ double * ModelObject::GetWeightImageVector( )
     return NULL;
   }
   
-  standardWeightVector = (double *) calloc((size_t)nDataVals, sizeof(double));
+  // re-use output vector from previous call, if any
+  if (! standardWeightVectorAllocated)
+    standardWeightVector = (double *) calloc((size_t)nDataVals, sizeof(double));
   if (standardWeightVector == NULL) {
     fprintf(stderr, "*** ERROR: Unable to allocate memory for output weight image!\n");
     fprintf(stderr, "    (Requested image size was %ld pixels)\n", nDataVals);
@@ -2299,6 +3332,19 @@ double * ModelObject::GetDataVector( )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetMaskVector ----------------------- */
+/// Returns a pointer to the internal mask vector (1 = valid pixel, 0 = masked),
+/// which is only complete after FinalSetupForFitting has been called.
+double * ModelObject::GetMaskVector( )
+{
+  if (! maskExists) {
+    fprintf(stderr, "* ModelObject::GetMaskVector -- Mask vector has not yet been created!\n\n");
+    return NULL;
+  }
+  return maskVector;
+}
+
+
 /* ---------------- PUBLIC METHOD: FindTotalFluxes --------------------- */
 /// Estimate total fluxes for individual components (and entire model) by integrating
 /// over a very large image, with each component/function centered in the image.
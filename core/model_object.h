@@ -23,6 +23,7 @@
 #include "oversampled_region.h"
 #include "psf_oversampling_info.h"
 #include "param_struct.h"
+#include "rng_streams.h"
 
 using namespace std;
 
@@ -50,6 +51,17 @@ class ModelObject
     void SetMaxThreads( int maxThreadNumber );
 
     void SetOMPChunkSize( int chunkSize );
+
+    void SetTileSize( int nColumns, int nRows );
+
+    // 2D only
+    int SetCullingThreshold( double relThreshold );
+
+    // 2D only; must be called before SetupModelImage
+    int SetConvolutionMethod( int method );
+
+    // 2D only; must be called before SetupModelImage
+    void SetLowRankTolerance( double tolerance );
     
     
     // Adds a new FunctionObject pointer to the internal vector
@@ -131,8 +143,11 @@ class ModelObject
     // 2D only
     void UpdateWeightVector( );
 
+    // 2D only
+    void FoldBootstrapWeights( );
+
      // common, not specialized (currently not specialized or used by ModelObject1d)
-    virtual double ComputePoissonMLRDeviate( long i, long i_model );
+    virtual double ComputePoissonMLRDeviate( long i, long i_model, const double *weights );
 
     // Specialized by ModelObject1D
     virtual void ComputeDeviates( double yResults[], double params[] );
@@ -152,6 +167,10 @@ class ModelObject
     virtual double ChiSquared( double params[] );
     
     virtual double CashStatistic( double params[] );
+
+    bool CanTerminateFitStatEarly( );
+
+    virtual double GetFitStatisticBounded( double params[], double maxFitStat );
     
     
     // common, but specialized by ModelObject1D
@@ -197,6 +216,8 @@ class ModelObject
 
     string& GetParameterName( int i );
 
+    int GetParameterScaling( int i );
+
     int GetNFunctions( );
 
     int GetNParams( );
@@ -207,6 +228,8 @@ class ModelObject
     // Returns total number of *non-masked* data values
     virtual long GetNValidPixels( );
 
+    long GetNDeviates( );
+
 	// 2D only
     bool HasPSF( );
     bool HasOversampledPSF( );
@@ -227,14 +250,34 @@ class ModelObject
 	// 2D only
     double * GetDataVector( );
 
+	// 2D only
+    double * GetMaskVector( );
+
 	// 2D only
     double FindTotalFluxes(double params[], int xSize, int ySize, 
     											double individualFluxes[] );
 
+    // 2D only
+    void PrintCullingSummary( double params[] );
+
+    // 2D only; returns the number of functions whose parameters are all fixed
+    // (computed once and cached during fitting)
+    int GetNFrozenFunctions( );
+
     // Generate a model image using *one* of the FunctionObjects (the one indicated by
     // functionIndex) and the input parameter vector; returns pointer to modelVector.
     double * GetSingleFunctionImage( double params[], int functionIndex );
 
+    // Generate separate images for all the FunctionObjects in a single pass, storing
+    // them in outputImages[0 ... nFunctions - 1] (each with nDataVals pixels)
+    int GetAllSingleFunctionImages( double params[], double **outputImages );
+
+    // 2D only; returns name (+ label) of each function, plus the (thread-summed)
+    // time spent evaluating it and the number of pixels it was evaluated for in
+    // the main image, accumulated while profiling is enabled (see profile_counters.h)
+    void GetComponentProfile( vector<string>& componentNames, vector<double>& componentTimes,
+    						vector<long>& componentPixels );
+
     // 1D only
     virtual int GetModelVector( double *profileVector ) { return -1; };
 
@@ -243,9 +286,11 @@ class ModelObject
     virtual int GetNImages( ) { return 1; };
 
 
-    virtual int UseBootstrap( );
+    int SetBootstrapMode( int mode );
+
+    virtual int UseBootstrap( RNGStream *rngStream=NULL );
     
-    virtual int MakeBootstrapSample( );
+    virtual int MakeBootstrapSample( RNGStream *rngStream=NULL );
 
 
   protected:
@@ -255,6 +300,34 @@ class ModelObject
     
     bool VetDataVector( );
 
+    // 2D only
+    bool ComputeModelTiles( bool pointSourcePass, double maxFitStat=0.0,
+    						double *partialFitStat=NULL );
+
+    // 2D only
+    double TileFitStatistic( long i_start, long i_end, long j_start, long j_end );
+
+    // 2D only; ConvolverBandFunction used by GetFitStatisticBounded
+    static bool AddBandFitStatistic( int rowStart, int rowEnd, void *modelObject );
+
+    void SetupFunctionObjects( double params[] );
+
+    double ChiSquaredFromModel( );
+
+    double CashStatisticFromModel( );
+
+    // 2D only
+    void ComputeBoundingBoxes( );
+
+    // 2D only
+    int AssignGeometryGroups( bool pointSourcePass );
+
+    // 2D only
+    void IdentifyFrozenFunctions( );
+
+    // 2D only
+    void UpdateFrozenModelImage( double params[] );
+
 
 
   private:
@@ -269,6 +342,32 @@ class ModelObject
 	double  readNoise_adu_squared;
     int  debugLevel, verboseLevel;
     int  maxRequestedThreads, ompChunkSize;
+    int  nTileColumns, nTileRows;
+    double  cullingThreshold;
+    int  convolutionMethod;
+    double  lowRankTolerance;
+    vector<long>  boxRowStart, boxRowEnd, boxColStart, boxColEnd;
+    // functions in the same function set with identical elliptical geometry, which
+    // share one set of per-tile radius calculations (see AssignGeometryGroups)
+    vector<int>  geometryGroup;
+    vector<double>  groupGeometry;   // x0, y0, cosPA, sinPA, q for each group
+    vector<long>  groupRowStart, groupRowEnd, groupColStart, groupColEnd;
+    // functions with all parameters fixed (only used for fitting); their summed,
+    // PSF-convolved image is stored in frozenModelVector
+    bool  fittingSetupDone, frozenFunctionsExist, frozenModelComputed;
+    bool  computingFrozenImage;
+    int  nFrozenFunctions;
+    vector<bool>  functionFrozen;
+    vector<int>  frozenParamIndices;
+    vector<double>  frozenParamValues;
+    vector<double>  frozenModelVector;
+    // running fit statistic and model-image rows done so far, for
+    // GetFitStatisticBounded with PSF convolution (see AddBandFitStatistic)
+    double  bandFitStat, bandMaxFitStat;
+    int  bandRowStart, bandRowEnd;
+    // per-function evaluation times and pixel counts (only updated when profiling)
+    vector<double>  componentProfileTimes;
+    vector<long>  componentProfilePixels;
     bool  dataValsSet;
     bool  modelVectorAllocated, weightVectorAllocated, maskVectorAllocated;
     bool  standardWeightVectorAllocated;
@@ -295,10 +394,14 @@ class ModelObject
     double  *extraCashTermsVector;
     double  *localPsfPixels;
     long  *bootstrapIndices;
+    int  bootstrapMode;
+    double  *bootstrapMultiplicities, *bootstrapWeightVector;
+    bool  bootstrapWeightsAllocated;
     bool  *fsetStartFlags;
     vector<FunctionObject *> functionObjects;
     vector<int> paramSizes;
     vector<string>  parameterLabels;
+    vector<int>  parameterScalings;
     vector<SimpleParameterInfo> parameterInfoVect;
     int  imageOffset_X0, imageOffset_Y0;
     
@@ -0,0 +1,214 @@
+/* FILE: multires_fit.cpp ---------------------------------------------- */
+/*
+ * Coarse-to-fine fitting: most of the function evaluations of a global (DE) or
+ * multi-start search are done on block-averaged copies of the data, which are
+ * 4--64 times smaller than the original image. Each level's solution seeds the
+ * fit at the next finer level; only the final (local) fit is done at full
+ * resolution.
+ *
+ * Block-averaged images are statistically equivalent to averages of f^2 images
+ * (f = block size), so:
+ *    chi^2 with fixed (data-based or user-supplied) errors: the weights are
+ *       propagated directly to a block-averaged weight image;
+ *    model-based errors, Cash, Poisson-MLR: ncombined is multiplied by f^2.
+ * Parameter values and limits are converted between the pixel scales with the
+ * functions in block_average.cpp.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "definitions.h"
+#include "model_object.h"
+#include "param_struct.h"   // for mp_par structure
+#include "options_imfit.h"
+#include "setup_model_object.h"
+#include "add_functions.h"
+#include "block_average.h"
+#include "dispatch_solver.h"
+#include "multistart_fit.h"
+#include "multires_fit.h"
+#include "solver_results.h"
+
+using namespace std;
+
+
+// block-averaged images smaller than this (in either dimension) are not used
+const int  MULTIRES_MIN_IMAGE_SIZE = 16;
+
+
+// Local solver used for levels after the first: same as the user-requested solver
+// unless that was DE (L-M, or N-M simplex for the Cash statistic)
+static int RefinementSolver( int solverID, bool cashStatistic )
+{
+  if (solverID != DIFF_EVOLN_SOLVER)
+    return solverID;
+  if (! cashStatistic)
+    return MPFIT_SOLVER;
+#ifndef NO_NLOPT
+  return NMSIMPLEX_SOLVER;
+#else
+  return DIFF_EVOLN_SOLVER;
+#endif
+}
+
+
+
+int MultiResolutionFit( int nLevels, shared_ptr<ImfitOptions> options, ModelObject *theModel,
+					int nColumns, int nRows, double *psfPixels, int nColumns_psf, int nRows_psf,
+					vector<string>& functionList, vector<string>& functionLabelList,
+					vector<int>& functionSetIndices, vector< map<string, string> >& optionalParamsMap,
+					int nParamsTot, int nFreeParams, double *paramVector,
+					vector<mp_par>& parameterInfo, bool paramLimitsExist,
+					SolverResults *solverResults )
+{
+  double  *dataPixels = theModel->GetDataVector();
+  double  *maskPixels = theModel->GetMaskVector();
+  double  *weightPixels = NULL;
+  bool  fixedErrors;
+  int  refinementSolver = RefinementSolver(options->solver, options->useCashStatistic);
+  int  solverID, status;
+  int  nLevelsDone = 0;
+  vector<int>  scalingTypes(nParamsTot);
+  vector<double>  coarseParams(nParamsTot);
+
+  // For chi^2 with fixed errors, we propagate the full-resolution weights
+  fixedErrors = (! options->useCashStatistic) && (! options->usePoissonMLR)
+  				&& (! options->useModelForErrors);
+  if (fixedErrors)
+    weightPixels = theModel->GetWeightImageVector();
+
+  for (int i = 0; i < nParamsTot; i++) {
+    scalingTypes[i] = theModel->GetParameterScaling(i);
+    if (scalingTypes[i] == PARAM_SCALING_UNKNOWN) {
+      fprintf(stderr, "*** ERROR: multi-resolution fitting is not possible, since the image function\n");
+      fprintf(stderr, "    for parameter \"%s\" does not specify how it scales with pixel size!\n\n",
+      		theModel->GetParameterName(i).c_str());
+      return -1;
+    }
+  }
+
+  for (int level = nLevels; level >= 1; level--) {
+    int  blockSize = 1 << level;
+    int  nColumns_coarse = BlockAveragedSize(nColumns, blockSize);
+    int  nRows_coarse = BlockAveragedSize(nRows, blockSize);
+    int  nColumns_psf_coarse = 0, nRows_psf_coarse = 0;
+    long  nPixels_coarse = (long)nColumns_coarse * (long)nRows_coarse;
+    if ((nColumns_coarse < MULTIRES_MIN_IMAGE_SIZE) || (nRows_coarse < MULTIRES_MIN_IMAGE_SIZE)) {
+      printf("* Skipping multi-resolution level with %dx%d block-averaging (image would be too small).\n",
+      		blockSize, blockSize);
+      continue;
+    }
+
+    // Make block-averaged data, mask, weight, and PSF images
+    vector<double>  coarseData(nPixels_coarse), coarseMask(nPixels_coarse);
+    vector<double>  coarseWeights;
+    vector<double>  coarsePsf;
+    if (weightPixels != NULL)
+      coarseWeights.resize(nPixels_coarse);
+    BlockAverageImage(dataPixels, maskPixels, weightPixels, nColumns, nRows, blockSize,
+    				coarseData.data(), coarseMask.data(),
+    				(weightPixels != NULL) ? coarseWeights.data() : NULL);
+    if (options->psfImagePresent) {
+      nColumns_psf_coarse = BlockAveragedPsfSize(nColumns_psf, blockSize);
+      nRows_psf_coarse = BlockAveragedPsfSize(nRows_psf, blockSize);
+      coarsePsf.resize((long)nColumns_psf_coarse*nRows_psf_coarse);
+      BlockAveragePsf(psfPixels, nColumns_psf, nRows_psf, blockSize, coarsePsf.data());
+    }
+
+    // Set up the ModelObject for this level
+    shared_ptr<ImfitOptions>  coarseOptions = make_shared<ImfitOptions>(*options);
+    coarseOptions->psfOversampling = false;
+    coarseOptions->maskImagePresent = true;
+    coarseOptions->maskFormat = MASK_ZERO_IS_BAD;
+    if (weightPixels != NULL) {
+      coarseOptions->noiseImagePresent = true;
+      coarseOptions->errorType = WEIGHTS_ARE_WEIGHTS;
+    } else {
+      coarseOptions->noiseImagePresent = false;
+      coarseOptions->nCombined = options->nCombined*blockSize*blockSize;
+    }
+    vector<int>  nColumnsRowsVect;
+    nColumnsRowsVect.push_back(nColumns_coarse);
+    nColumnsRowsVect.push_back(nRows_coarse);
+    nColumnsRowsVect.push_back(nColumns_psf_coarse);
+    nColumnsRowsVect.push_back(nRows_psf_coarse);
+    ModelObject  *coarseModel = SetupModelObject(coarseOptions, nColumnsRowsVect,
+    							coarseData.data(), options->psfImagePresent ? coarsePsf.data() : NULL,
+    							coarseMask.data(), (weightPixels != NULL) ? coarseWeights.data() : NULL);
+    status = AddFunctions(coarseModel, functionList, functionLabelList, functionSetIndices,
+  						options->subsamplingFlag, 0, optionalParamsMap);
+    if (status < 0) {
+      fprintf(stderr, "*** ERROR: Failure in AddFunctions (multi-resolution fitting)!\n\n");
+      delete coarseModel;
+      return -1;
+    }
+    status = coarseModel->FinalSetupForFitting();
+    if (status < 0) {
+      fprintf(stderr, "*** ERROR: Failure in ModelObject::FinalSetupForFitting (multi-resolution fitting)!\n\n");
+      delete coarseModel;
+      return -1;
+    }
+
+    // Convert parameters and limits to this level's pixel scale
+    vector<mp_par>  coarseParameterInfo = parameterInfo;
+    for (int i = 0; i < nParamsTot; i++) {
+      coarseParams[i] = BlockAverageParameter(paramVector[i], scalingTypes[i], blockSize);
+      coarseParameterInfo[i].limits[0] = BlockAverageParameter(parameterInfo[i].limits[0],
+      										scalingTypes[i], blockSize);
+      coarseParameterInfo[i].limits[1] = BlockAverageParameter(parameterInfo[i].limits[1],
+      										scalingTypes[i], blockSize);
+    }
+    coarseModel->AddParameterInfo(coarseParameterInfo);
+
+    SolverResults  levelResults;
+    solverID = (nLevelsDone == 0) ? options->solver : refinementSolver;
+    printf("\nMulti-resolution level: %dx%d block-averaging (%d x %d pixels)\n", blockSize,
+    		blockSize, nColumns_coarse, nRows_coarse);
+    if ((nLevelsDone == 0) && (options->nMultiStarts > 0) && (solverID != DIFF_EVOLN_SOLVER))
+      status = MultiStartFit(options->nMultiStarts, solverID, nParamsTot, nFreeParams,
+      						nPixels_coarse, coarseParams.data(), coarseParameterInfo, coarseModel,
+      						options->ftol, paramLimitsExist, options->verbose, &levelResults,
+      						options->nloptSolverName, options->rngSeed, options->rngType);
+    else
+      status = DispatchToSolver(solverID, nParamsTot, nFreeParams, nPixels_coarse,
+      						coarseParams.data(), coarseParameterInfo, coarseModel, options->ftol,
+      						paramLimitsExist, options->verbose, &levelResults,
+      						options->nloptSolverName, options->rngSeed, options->useLHS,
+      						options->rngType);
+    printf("   level fit statistic = %.10g (status = %d)\n",
+    		coarseModel->GetFitStatistic(coarseParams.data()), status);
+
+    // Convert solution back to the full-resolution pixel scale (staying within limits,
+    // since the conversion can be slightly inexact due to rounding)
+    for (int i = 0; i < nParamsTot; i++) {
+      if (parameterInfo[i].fixed == 1)
+        continue;
+      paramVector[i] = UnBlockAverageParameter(coarseParams[i], scalingTypes[i], blockSize);
+      if ((parameterInfo[i].limited[0] == 1) && (paramVector[i] < parameterInfo[i].limits[0]))
+        paramVector[i] = parameterInfo[i].limits[0];
+      if ((parameterInfo[i].limited[1] == 1) && (paramVector[i] > parameterInfo[i].limits[1]))
+        paramVector[i] = parameterInfo[i].limits[1];
+    }
+    delete coarseModel;
+    nLevelsDone++;
+  }
+
+  // Final fit at full resolution
+  solverID = (nLevelsDone == 0) ? options->solver : refinementSolver;
+  printf("\nMulti-resolution level: full resolution (%d x %d pixels)\n", nColumns, nRows);
+  status = DispatchToSolver(solverID, nParamsTot, nFreeParams, (long)nColumns*nRows,
+  						paramVector, parameterInfo, theModel, options->ftol, paramLimitsExist,
+  						options->verbose, solverResults, options->nloptSolverName,
+  						options->rngSeed, options->useLHS, options->rngType);
+  return status;
+}
+
+
+
+/* END OF FILE: multires_fit.cpp --------------------------------------- */
@@ -0,0 +1,44 @@
+/** @file
+ * \brief Public function for coarse-to-fine (multi-resolution) fitting with imfit
+ *
+ *   Fits block-averaged (2x, 4x, ...) copies of the data, weight, and PSF images,
+ * using each level's solution as the starting point for the next finer level, and
+ * finishes with a fit to the full-resolution image.
+ */
+
+#ifndef _MULTIRES_FIT_H_
+#define _MULTIRES_FIT_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "param_struct.h"   // for mp_par structure
+#include "model_object.h"
+#include "options_imfit.h"
+#include "solver_results.h"
+
+using namespace std;
+
+
+/*! \brief Runs the multi-resolution fit; returns the status of the final
+    (full-resolution) fit, as returned by DispatchToSolver
+
+    theModel is the full-resolution ModelObject (FinalSetupForFitting must already
+    have been called); the block-averaged ModelObjects are set up internally from
+    its data, mask and weight vectors, plus the PSF image and function
+    specifications. nLevels coarse levels are fit, with block sizes 2^nLevels, ..., 2
+    (levels whose images would be smaller than MULTIRES_MIN_IMAGE_SIZE are skipped).
+    The coarsest level uses options->solver (or multi-start fitting, if
+    options->nMultiStarts > 0); later levels use a local solver. */
+int MultiResolutionFit( int nLevels, shared_ptr<ImfitOptions> options, ModelObject *theModel,
+					int nColumns, int nRows, double *psfPixels, int nColumns_psf, int nRows_psf,
+					vector<string>& functionList, vector<string>& functionLabelList,
+					vector<int>& functionSetIndices, vector< map<string, string> >& optionalParamsMap,
+					int nParamsTot, int nFreeParams, double *paramVector,
+					vector<mp_par>& parameterInfo, bool paramLimitsExist,
+					SolverResults *solverResults );
+
+
+#endif  // _MULTIRES_FIT_H_
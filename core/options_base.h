@@ -70,6 +70,9 @@ class OptionsBase
       solver = MPFIT_SOLVER;
 
       subsamplingFlag = true;
+      cullingThreshold = 0.0;   // 0 = evaluate all functions over full image
+      convolutionMethod = CONVOLVE_FFT;
+      lowRankTolerance = 0.0;   // 0 = use default tolerance
 
       rngSeed = 0;           // 0 = get seed value from system clock
   
@@ -80,6 +83,9 @@ class OptionsBase
       debugLevel = 0;
 
       loggingOn = false;
+
+      profileReport = false;
+      profileReportFileName = "";
     };
 
     // Data members:
@@ -113,6 +119,9 @@ class OptionsBase
     int  maskFormat;
   
     bool  subsamplingFlag;
+    double  cullingThreshold;
+    int  convolutionMethod;
+    double  lowRankTolerance;
 
     bool  gainSet;
     double  gain;
@@ -140,6 +149,9 @@ class OptionsBase
     int  verbose;
 
     bool  loggingOn;
+
+    bool  profileReport;   // collect per-phase timing counters (see profile_counters.h)
+    string  profileReportFileName;   // JSON output file for the counters ("" = print table)
 };
 
 
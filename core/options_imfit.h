@@ -52,6 +52,13 @@ class ImfitOptions : public OptionsBase
       bootstrapIterations = 0;
       saveBootstrap = false;
       outputBootstrapFileName = "";
+      bootstrapMode = BOOTSTRAP_INDICES;
+      rngType = RNG_MERSENNE_TWISTER;
+      checkpointFileName = "";
+      checkpointInterval = DEFAULT_DE_CHECKPOINT_INTERVAL;
+      resume = false;
+      nMultiStarts = 0;
+      nMultiResLevels = 0;
     };
 
     // Extra data members (in addition to those in options_base.h):  
@@ -79,6 +86,13 @@ class ImfitOptions : public OptionsBase
     int  bootstrapIterations;
     bool  saveBootstrap;
     string  outputBootstrapFileName;
+    int  bootstrapMode;
+    int  rngType;
+    string  checkpointFileName;
+    int  checkpointInterval;
+    bool  resume;
+    int  nMultiStarts;
+    int  nMultiResLevels;
     
 };
 
@@ -27,6 +27,7 @@ class MakeimageOptions : public OptionsBase
       noOutputImageName = true;
       outputImageName = DEFAULT_MAKEIMAGE_OUTPUT_FILENAME;
       functionRootName = "";
+      functionsMEFName = "";
       noRefImage = true;
       referenceImageName = "";
   
@@ -42,6 +43,7 @@ class MakeimageOptions : public OptionsBase
       saveImage = true;
       saveExpandedImage = false;
       saveAllFunctions = false;
+      saveFunctionsMEF = false;
 
       printFluxes = false;
       estimationImageSize = DEFAULT_ESTIMATION_IMAGE_SIZE;
@@ -55,6 +57,7 @@ class MakeimageOptions : public OptionsBase
     string  outputImageName;
 
     string  functionRootName;
+    string  functionsMEFName;
     bool  noRefImage;
     string  referenceImageName;
 
@@ -70,6 +73,7 @@ class MakeimageOptions : public OptionsBase
     bool  saveImage;
     bool  saveExpandedImage;
     bool  saveAllFunctions;  // save individual-function images
+    bool  saveFunctionsMEF;  // save individual-function images in one multi-extension file
 
     bool  printFluxes;
     int  estimationImageSize;
@@ -78,6 +78,11 @@ class MCMCOptions : public OptionsBase
                         	 // 0.01 seems to work well for (small) image fits
       mcmc_bstar = 1.0e-6;   // b^star parameter in DREAM (sigma for epsilon)
                              // 1.0e-6 to 1.0e-3 seem to work ~ equally well; 0.01 is worse  
+      earlyRejection = false;
+      historyWindow = 0;     // 0 = keep all generations in memory
+      checkpointFileName = "";
+      checkpointInterval = DEFAULT_MCMC_CHECKPOINT_INTERVAL;
+      resume = false;
     };
 
     // Extra data members (in addition to those in options_base.h):  
@@ -103,6 +108,11 @@ class MCMCOptions : public OptionsBase
     double  GRScaleReductionLimit;
     double  mcmcNoise;
     double  mcmc_bstar;
+    bool  earlyRejection;
+    int  historyWindow;
+    string  checkpointFileName;
+    int  checkpointInterval;
+    bool  resume;
 
 };
 
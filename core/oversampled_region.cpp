@@ -76,6 +76,7 @@
 #include "function_objects/function_object.h"
 #include "oversampled_region.h"
 #include "downsample.h"
+#include "profile_counters.h"
 #include "utilities_pub.h"
 #ifdef DEBUG
 #include "image_io.h"
@@ -288,6 +289,9 @@ void OversampledRegion::ComputeRegionAndDownsample( double *mainImageVector,
   double  x, y, newValSum, tempSum, adjVal, storedError;
   bool pointSourcesPresent = false;
   string  outputName;
+  ProfileTimer  regionTimer(PROFILE_OVERSAMPLED_REGIONS);
+
+  ProfileCount(PROFILE_N_OVERSAMPLED_PIXELS, nModelVals);
 
 // Compute oversampled-region image, using OpenMP for speed
 // (possibly slower if sub-region is really small, but in that case this whole
@@ -424,6 +428,7 @@ void OversampledRegion::ComputeRegionAndDownsample( double *mainImageVector,
   LOG_F(2, "OversampledRegion (%s): Calling DownsampleAndReplace", 
   		regionLabel.c_str());
 #endif
+  ProfileTimer  downsampleTimer(PROFILE_DOWNSAMPLING);
   DownsampleAndReplace(modelVector, nModelColumns,nModelRows,nPSFColumns,nPSFRows, 
   						mainImageVector, nMainImageColumns,nMainImageRows,nMainPSFColumns,
   						nMainPSFRows, x1_region,y1_region, oversamplingScale, debugLevel);
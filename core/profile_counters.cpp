@@ -0,0 +1,207 @@
+/* FILE: profile_counters.cpp ------------------------------------------ */
+/*
+ * Enabling, resetting, and reporting the per-phase timing counters defined in
+ * profile_counters.h (text table or JSON file).
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "profile_counters.h"
+
+using namespace std;
+
+
+/// Name, JSON key, and nesting depth for each phase (in enum order, which is also
+/// the order in which they are reported); a phase with depth > 0 is included in
+/// the time of the closest preceding phase with smaller depth
+typedef struct {
+  const char  *name;
+  const char  *key;
+  int  depth;
+} phaseInfo;
+
+static const phaseInfo  PROFILE_PHASE_INFO[N_PROFILE_PHASES] = {
+  {"model image",                 "model_image",          0},
+  {"function setup",              "function_setup",       1},
+  {"pixel evaluation",            "pixel_evaluation",     1},
+  {"PSF convolution",             "convolution",          1},
+  {"forward FFT",                 "fft_forward",          2},
+  {"PSF multiply + inverse FFT",  "fft_inverse",          2},
+  {"direct convolution",          "direct_convolution",   2},
+  {"oversampled regions",         "oversampled_regions",  1},
+  {"downsampling",                "downsampling",         2},
+  {"fit statistic",               "fit_statistic",        0},
+  {"Jacobian (L-M)",              "jacobian",             0},
+  {"solver",                      "solver",               0},
+  {"solver overhead",             "solver_overhead",      1}
+};
+
+static const char  *PROFILE_COUNT_NAMES[N_PROFILE_COUNTS][2] = {
+  {"model images",                "model_images"},
+  {"fit-statistic evaluations",   "fit_statistics"},
+  {"pixels evaluated",            "pixels"},
+  {"subsampled pixels",           "subsampled_pixels"},
+  {"oversampled-region pixels",   "oversampled_pixels"},
+  {"PSF convolutions",            "convolutions"},
+  {"Jacobians",                   "jacobians"}
+};
+
+
+static string JsonString( const string& inputString );
+
+
+
+/* ---------------- FUNCTION: EnableProfileCounters -------------------- */
+/// Turns collection of profiling data on or off (counters are not reset).
+void EnableProfileCounters( bool enable )
+{
+  GlobalProfileCounters().enabled = enable;
+}
+
+
+/* ---------------- FUNCTION: ResetProfileCounters --------------------- */
+/// Sets all times and counts to zero.
+void ResetProfileCounters( )
+{
+  profileCounterValues&  counters = GlobalProfileCounters();
+
+  for (int n = 0; n < N_PROFILE_PHASES; n++) {
+    counters.phaseTimes[n] = 0.0;
+    counters.phaseCalls[n] = 0;
+  }
+  for (int n = 0; n < N_PROFILE_COUNTS; n++)
+    counters.counts[n] = 0;
+}
+
+
+/* ---------------- FUNCTION: PrintProfileReport ----------------------- */
+/// Prints a table of times for all phases which were used, plus times for the
+/// individual model components and the event counts. elapsedTime is the total
+/// time to compare the phases to (if <= 0, percentages are not printed).
+/// Component times are summed over all threads (so with multiple threads they
+/// can be larger than the pixel-evaluation wall-clock time).
+void PrintProfileReport( FILE *outFile, double elapsedTime, const vector<string>& componentNames,
+						const vector<double>& componentTimes, const vector<long>& componentPixels )
+{
+  profileCounterValues&  counters = GlobalProfileCounters();
+  double  totalComponentTime = 0.0;
+  string  phaseName;
+
+  fprintf(outFile, "\nProfile report (wall-clock times; indented phases are included in the one above):\n");
+  fprintf(outFile, "   %-32s %10s %12s %8s %12s\n", "phase", "calls", "time (s)", "%", "ms/call");
+  for (int n = 0; n < N_PROFILE_PHASES; n++) {
+    if (counters.phaseCalls[n] == 0)
+      continue;
+    phaseName = string(2*PROFILE_PHASE_INFO[n].depth, ' ') + PROFILE_PHASE_INFO[n].name;
+    fprintf(outFile, "   %-32s %10ld %12.4f ", phaseName.c_str(), counters.phaseCalls[n],
+    		counters.phaseTimes[n]);
+    if (elapsedTime > 0.0)
+      fprintf(outFile, "%8.1f ", 100.0*counters.phaseTimes[n]/elapsedTime);
+    else
+      fprintf(outFile, "%8s ", "--");
+    fprintf(outFile, "%12.4f\n", 1.0e3*counters.phaseTimes[n]/counters.phaseCalls[n]);
+  }
+  if (elapsedTime > 0.0)
+    fprintf(outFile, "   %-32s %10s %12.4f\n", "(total elapsed time)", "", elapsedTime);
+
+  for (int n = 0; n < (int)componentTimes.size(); n++)
+    totalComponentTime += componentTimes[n];
+  if (totalComponentTime > 0.0) {
+    fprintf(outFile, "\nPixel evaluation by component (thread-summed times):\n");
+    fprintf(outFile, "   %-32s %14s %12s %8s %10s\n", "component", "pixels", "time (s)", "%", "ns/pixel");
+    for (int n = 0; n < (int)componentTimes.size(); n++) {
+      fprintf(outFile, "   %2d %-29s %14ld %12.4f %8.1f ", n + 1, componentNames[n].c_str(),
+      		componentPixels[n], componentTimes[n], 100.0*componentTimes[n]/totalComponentTime);
+      if (componentPixels[n] > 0)
+        fprintf(outFile, "%10.1f\n", 1.0e9*componentTimes[n]/componentPixels[n]);
+      else
+        fprintf(outFile, "%10s\n", "--");
+    }
+  }
+
+  fprintf(outFile, "\nCounts:\n");
+  for (int n = 0; n < N_PROFILE_COUNTS; n++)
+    fprintf(outFile, "   %-32s %14ld\n", PROFILE_COUNT_NAMES[n][0], counters.counts[n]);
+  fprintf(outFile, "\n");
+}
+
+
+/* ---------------- FUNCTION: WriteProfileReportJSON ------------------- */
+/// Writes the same information as PrintProfileReport to a JSON file (all phases
+/// are included, with "parent" giving the key of the enclosing phase, if any).
+/// Returns 0 on success, -1 if the file could not be written.
+int WriteProfileReportJSON( const string& fileName, double elapsedTime,
+						const vector<string>& componentNames, const vector<double>& componentTimes,
+						const vector<long>& componentPixels )
+{
+  profileCounterValues&  counters = GlobalProfileCounters();
+  FILE  *outputFile;
+  int  parent;
+
+  outputFile = fopen(fileName.c_str(), "w");
+  if (outputFile == NULL) {
+    fprintf(stderr, "*** ERROR: Unable to open profile-report file \"%s\"!\n", fileName.c_str());
+    return -1;
+  }
+
+  fprintf(outputFile, "{\n");
+  fprintf(outputFile, "  \"elapsed_time\": %.6f,\n", elapsedTime);
+  fprintf(outputFile, "  \"phases\": [\n");
+  for (int n = 0; n < N_PROFILE_PHASES; n++) {
+    parent = -1;
+    for (int m = n - 1; m >= 0; m--) {
+      if (PROFILE_PHASE_INFO[m].depth < PROFILE_PHASE_INFO[n].depth) {
+        parent = m;
+        break;
+      }
+    }
+    fprintf(outputFile, "    {\"name\": \"%s\", \"parent\": ", PROFILE_PHASE_INFO[n].key);
+    if (parent >= 0)
+      fprintf(outputFile, "\"%s\", ", PROFILE_PHASE_INFO[parent].key);
+    else
+      fprintf(outputFile, "null, ");
+    fprintf(outputFile, "\"calls\": %ld, \"time\": %.6f}%s\n", counters.phaseCalls[n],
+    		counters.phaseTimes[n], (n < N_PROFILE_PHASES - 1) ? "," : "");
+  }
+  fprintf(outputFile, "  ],\n");
+  fprintf(outputFile, "  \"components\": [\n");
+  for (int n = 0; n < (int)componentTimes.size(); n++) {
+    fprintf(outputFile, "    {\"index\": %d, \"name\": %s, \"pixels\": %ld, \"time\": %.6f}%s\n",
+    		n + 1, JsonString(componentNames[n]).c_str(), componentPixels[n], componentTimes[n],
+    		(n < (int)componentTimes.size() - 1) ? "," : "");
+  }
+  fprintf(outputFile, "  ],\n");
+  fprintf(outputFile, "  \"counts\": {\n");
+  for (int n = 0; n < N_PROFILE_COUNTS; n++)
+    fprintf(outputFile, "    \"%s\": %ld%s\n", PROFILE_COUNT_NAMES[n][1], counters.counts[n],
+    		(n < N_PROFILE_COUNTS - 1) ? "," : "");
+  fprintf(outputFile, "  }\n");
+  fprintf(outputFile, "}\n");
+
+  if (fclose(outputFile) != 0) {
+    fprintf(stderr, "*** ERROR: Unable to write profile-report file \"%s\"!\n", fileName.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+
+/* ---------------- FUNCTION: JsonString ------------------------------- */
+// Returns inputString as a quoted JSON string (escaping quotes and backslashes).
+static string JsonString( const string& inputString )
+{
+  string  outputString = "\"";
+
+  for (int i = 0; i < (int)inputString.size(); i++) {
+    if ((inputString[i] == '"') || (inputString[i] == '\\'))
+      outputString += '\\';
+    outputString += inputString[i];
+  }
+  return outputString + "\"";
+}
+
+
+/* END OF FILE: profile_counters.cpp ----------------------------------- */
@@ -0,0 +1,167 @@
+// Lightweight per-phase timing counters for model-image generation and fitting
+// (enabled at run time, e.g. with imfit's --profile-report option).
+//
+// The counters are always compiled in; when profiling is disabled (the default),
+// each ProfileTimer and ProfileCount costs one load and one branch. When enabled,
+// each timed phase adds its wall-clock time (via a monotonic clock) to a global
+// total. Phases can be nested: e.g., "pixel evaluation" and "PSF convolution" are
+// both parts of "model image". Timers are meant to be used outside of OpenMP
+// parallel regions (so their times are wall-clock times); ProfileCount can be
+// called from inside them.
+//
+// Per-component (per-function) times are kept by ModelObject itself, since they
+// are specific to each model; see ModelObject::GetComponentProfile.
+//
+// Everything needed by the instrumented code is inline in this header, so that
+// function objects and the solvers can use it without extra link dependencies;
+// the report functions are in profile_counters.cpp.
+
+#ifndef _PROFILE_COUNTERS_H_
+#define _PROFILE_COUNTERS_H_
+
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// atomic update for counters which can be incremented from inside OpenMP parallel
+// regions (defined as nothing when not compiling with OpenMP, to avoid warnings
+// about unknown pragmas in files which otherwise don't use OpenMP)
+#ifdef _OPENMP
+#define PROFILE_ATOMIC _Pragma("omp atomic")
+#else
+#define PROFILE_ATOMIC
+#endif
+
+
+/// Timed phases; see PROFILE_PHASE_INFO in profile_counters.cpp for the nesting
+enum profilePhase {
+  PROFILE_MODEL_IMAGE = 0,      ///< all model-image computation (inclusive)
+  PROFILE_FUNCTION_SETUP,       ///< FunctionObject::Setup calls for each parameter vector
+  PROFILE_PIXEL_EVALUATION,     ///< function evaluation over the main image (tiles)
+  PROFILE_CONVOLUTION,          ///< PSF convolution, all methods (inclusive)
+  PROFILE_FFT_FORWARD,          ///< zero-padding + forward FFT of image
+  PROFILE_FFT_INVERSE,          ///< multiplication by PSF transform + inverse FFT
+  PROFILE_DIRECT_CONVOLUTION,   ///< direct or separable (low-rank) convolution
+  PROFILE_OVERSAMPLED_REGIONS,  ///< oversampled sub-regions (inclusive)
+  PROFILE_DOWNSAMPLING,         ///< downsampling oversampled regions into main image
+  PROFILE_FIT_STATISTIC,        ///< chi^2/Cash/PMLR statistic or deviates from model
+  PROFILE_JACOBIAN,             ///< finite-difference Jacobian (L-M solver; inclusive)
+  PROFILE_SOLVER,               ///< solver calls (inclusive)
+  PROFILE_SOLVER_OVERHEAD,      ///< solver time not spent on model images or statistics
+  N_PROFILE_PHASES
+};
+
+/// Event counters
+enum profileCount {
+  PROFILE_N_MODEL_IMAGES = 0,   ///< model-image computations
+  PROFILE_N_FIT_STATISTICS,     ///< fit-statistic (or deviates) computations
+  PROFILE_N_PIXELS,             ///< function-pixel evaluations in main image
+  PROFILE_N_SUBSAMPLED_PIXELS,  ///< function-pixel evaluations using subsampling
+  PROFILE_N_OVERSAMPLED_PIXELS, ///< pixels computed in oversampled regions
+  PROFILE_N_CONVOLUTIONS,       ///< PSF convolutions (of single images)
+  PROFILE_N_JACOBIANS,          ///< Jacobian computations
+  N_PROFILE_COUNTS
+};
+
+
+/// Global counter values
+typedef struct {
+  bool  enabled;
+  double  phaseTimes[N_PROFILE_PHASES];   // seconds
+  long  phaseCalls[N_PROFILE_PHASES];
+  long  counts[N_PROFILE_COUNTS];
+} profileCounterValues;
+
+
+/// Returns the single global set of counters (statically zero-initialized, so
+/// profiling starts out disabled)
+inline profileCounterValues& GlobalProfileCounters( )
+{
+  static profileCounterValues  counters;
+  return counters;
+}
+
+inline bool ProfilingEnabled( )
+{
+  return GlobalProfileCounters().enabled;
+}
+
+/// Returns current time in seconds from a monotonic clock
+inline double ProfileClock( )
+{
+  struct timespec  now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + 1.0e-9*now.tv_nsec;
+}
+
+inline void AddProfileTime( profilePhase phase, double seconds )
+{
+  profileCounterValues&  counters = GlobalProfileCounters();
+  PROFILE_ATOMIC
+  counters.phaseTimes[phase] += seconds;
+  PROFILE_ATOMIC
+  counters.phaseCalls[phase] += 1;
+}
+
+/// Adds n to the specified counter, if profiling is enabled (safe to call from
+/// inside OpenMP parallel regions)
+inline void ProfileCount( profileCount which, long n=1 )
+{
+  profileCounterValues&  counters = GlobalProfileCounters();
+  if (counters.enabled) {
+    PROFILE_ATOMIC
+    counters.counts[which] += n;
+  }
+}
+
+
+/// Scoped timer: adds the time between construction and destruction (or Stop())
+/// to the specified phase, if profiling was enabled at construction
+class ProfileTimer
+{
+  public:
+    ProfileTimer( profilePhase whichPhase )
+    {
+      phase = whichPhase;
+      running = ProfilingEnabled();
+      if (running)
+        startTime = ProfileClock();
+    }
+
+    ~ProfileTimer( ) { Stop(); }
+
+    void Stop( )
+    {
+      if (running) {
+        AddProfileTime(phase, ProfileClock() - startTime);
+        running = false;
+      }
+    }
+
+  private:
+    profilePhase  phase;
+    bool  running;
+    double  startTime;
+};
+
+
+
+// Functions in profile_counters.cpp:
+
+void EnableProfileCounters( bool enable );
+
+void ResetProfileCounters( );
+
+void PrintProfileReport( FILE *outFile, double elapsedTime, const vector<string>& componentNames,
+						const vector<double>& componentTimes, const vector<long>& componentPixels );
+
+int WriteProfileReportJSON( const string& fileName, double elapsedTime,
+						const vector<string>& componentNames, const vector<double>& componentTimes,
+						const vector<long>& componentPixels );
+
+
+#endif  // _PROFILE_COUNTERS_H_
@@ -0,0 +1,217 @@
+/* FILE: rng_streams.cpp ----------------------------------------------- */
+/*
+ * Counter-based random-number streams, using the Philox4x32-10 bijection from
+ *    Salmon, Moraes, Dror, & Shaw 2011, "Parallel Random Numbers: As Easy as
+ *    1, 2, 3", Proceedings of SC11 (Random123 library).
+ *
+ * The 128-bit counter is (64-bit block counter, 64-bit stream ID); the 64-bit key
+ * is the user-supplied seed. Each call to Philox4x32 yields four 32-bit random
+ * words, and depends only on its inputs, so streams can be created, rewound, and
+ * evaluated in any order (or in parallel) with identical results.
+ */
+
+#include <math.h>
+
+#include "rng_streams.h"
+
+
+const uint32_t  PHILOX_M0 = 0xD2511F53;
+const uint32_t  PHILOX_M1 = 0xCD9E8D57;
+const uint32_t  PHILOX_W0 = 0x9E3779B9;   // golden ratio
+const uint32_t  PHILOX_W1 = 0xBB67AE85;   // sqrt(3) - 1
+const int  PHILOX_N_ROUNDS = 10;
+
+const double  TWO_PI = 6.283185307179586477;
+const double  INV_TWO_POW_53 = 1.0/9007199254740992.0;
+
+
+
+/* ---------------- FUNCTION: Philox4x32 ------------------------------- */
+/// Applies the 10-round Philox4x32 bijection to counter, using key; the result
+/// (four 32-bit random words) is stored in output.
+void Philox4x32( const uint32_t counter[4], const uint32_t key[2], uint32_t output[4] )
+{
+  uint32_t  c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t  k0 = key[0], k1 = key[1];
+
+  for (int r = 0; r < PHILOX_N_ROUNDS; r++) {
+    uint64_t  prod0 = (uint64_t)PHILOX_M0 * c0;
+    uint64_t  prod1 = (uint64_t)PHILOX_M1 * c2;
+    uint32_t  hi0 = (uint32_t)(prod0 >> 32), lo0 = (uint32_t)prod0;
+    uint32_t  hi1 = (uint32_t)(prod1 >> 32), lo1 = (uint32_t)prod1;
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  output[0] = c0;
+  output[1] = c1;
+  output[2] = c2;
+  output[3] = c3;
+}
+
+
+// Converts two 32-bit words to a double on [0,1) with 53-bit resolution
+// (same recipe as genrand_res53 in mersenne_twister.cpp)
+static inline double WordsToUniform( uint32_t a, uint32_t b )
+{
+  return ((a >> 5)*67108864.0 + (b >> 6)) * INV_TWO_POW_53;
+}
+
+
+
+/* ---------------- CONSTRUCTOR ---------------------------------------- */
+
+RNGStream::RNGStream( unsigned long theSeed, unsigned long theStreamID )
+{
+  SetSeed(theSeed, theStreamID);
+}
+
+
+/* ---------------- PUBLIC METHOD: SetSeed ----------------------------- */
+
+void RNGStream::SetSeed( unsigned long theSeed, unsigned long theStreamID )
+{
+  seed = theSeed;
+  key[0] = (uint32_t)((uint64_t)seed);
+  key[1] = (uint32_t)((uint64_t)seed >> 32);
+  SetStream(theStreamID);
+}
+
+
+/* ---------------- PUBLIC METHOD: SetStream --------------------------- */
+
+void RNGStream::SetStream( unsigned long theStreamID )
+{
+  streamID = theStreamID;
+  blockCounter = 0;
+  bufferPos = 4;   // buffer is empty
+  haveSpareNormal = false;
+  spareNormal = 0.0;
+}
+
+
+/* ---------------- PRIVATE METHOD: NextBlock -------------------------- */
+/// Generates the next four 32-bit words of the stream into buffer.
+void RNGStream::NextBlock( )
+{
+  uint32_t  counter[4];
+
+  counter[0] = (uint32_t)blockCounter;
+  counter[1] = (uint32_t)(blockCounter >> 32);
+  counter[2] = (uint32_t)((uint64_t)streamID);
+  counter[3] = (uint32_t)((uint64_t)streamID >> 32);
+  Philox4x32(counter, key, buffer);
+  blockCounter++;
+  bufferPos = 0;
+}
+
+
+/* ---------------- PUBLIC METHOD: UInt32 ------------------------------ */
+
+uint32_t RNGStream::UInt32( )
+{
+  if (bufferPos >= 4)
+    NextBlock();
+  return buffer[bufferPos++];
+}
+
+
+/* ---------------- PUBLIC METHOD: Uniform ----------------------------- */
+
+double RNGStream::Uniform( )
+{
+  uint32_t  a = UInt32();
+  uint32_t  b = UInt32();
+  return WordsToUniform(a, b);
+}
+
+
+/* ---------------- PUBLIC METHOD: Normal ------------------------------ */
+/// Box-Muller transform; the second deviate of each pair is saved for the next call.
+double RNGStream::Normal( )
+{
+  double  u1, u2, r;
+
+  if (haveSpareNormal) {
+    haveSpareNormal = false;
+    return spareNormal;
+  }
+  u1 = 1.0 - Uniform();   // (0,1], so log(u1) is finite
+  u2 = Uniform();
+  r = sqrt(-2.0*log(u1));
+  spareNormal = r*sin(TWO_PI*u2);
+  haveSpareNormal = true;
+  return r*cos(TWO_PI*u2);
+}
+
+
+/* ---------------- PUBLIC METHOD: FillUniform ------------------------- */
+/// Fills outputVector with n uniform deviates on [0,1). The output is identical
+/// to n successive calls to Uniform(), but whole Philox blocks are generated
+/// directly into the output vector, with no per-value buffer bookkeeping; since
+/// the blocks are independent, the main loop can be vectorized by the compiler.
+void RNGStream::FillUniform( double *outputVector, long n )
+{
+  long  i = 0;
+
+  if ((bufferPos % 2) != 0) {
+    // buffer not aligned on a pair of words (after an odd number of UInt32 calls)
+    for (i = 0; i < n; i++)
+      outputVector[i] = Uniform();
+    return;
+  }
+  // use up anything left in the buffer
+  while ((i < n) && (bufferPos < 4))
+    outputVector[i++] = Uniform();
+
+  long  nBlocks = (n - i) / 2;
+  uint32_t  stream0 = (uint32_t)((uint64_t)streamID);
+  uint32_t  stream1 = (uint32_t)((uint64_t)streamID >> 32);
+  double  *outputBlocks = outputVector + i;
+  for (long j = 0; j < nBlocks; j++) {
+    uint64_t  blockNumber = blockCounter + (uint64_t)j;
+    uint32_t  counter[4] = {(uint32_t)blockNumber, (uint32_t)(blockNumber >> 32),
+                            stream0, stream1};
+    uint32_t  words[4];
+    Philox4x32(counter, key, words);
+    outputBlocks[2*j] = WordsToUniform(words[0], words[1]);
+    outputBlocks[2*j + 1] = WordsToUniform(words[2], words[3]);
+  }
+  blockCounter += (uint64_t)nBlocks;
+  i += 2*nBlocks;
+
+  if (i < n)
+    outputVector[i] = Uniform();
+}
+
+
+/* ---------------- PUBLIC METHOD: FillNormal -------------------------- */
+/// Fills outputVector with n Normal deviates; the output is identical to n
+/// successive calls to Normal().
+void RNGStream::FillNormal( double *outputVector, long n )
+{
+  long  i = 0;
+
+  if ((n > 0) && (haveSpareNormal)) {
+    outputVector[0] = spareNormal;
+    haveSpareNormal = false;
+    i = 1;
+  }
+  long  nPairs = (n - i) / 2;
+  double  *pairs = outputVector + i;
+  FillUniform(pairs, 2*nPairs);
+  for (long j = 0; j < nPairs; j++) {
+    double  u1 = 1.0 - pairs[2*j];
+    double  u2 = pairs[2*j + 1];
+    double  r = sqrt(-2.0*log(u1));
+    pairs[2*j] = r*cos(TWO_PI*u2);
+    pairs[2*j + 1] = r*sin(TWO_PI*u2);
+  }
+  i += 2*nPairs;
+
+  if (i < n)
+    outputVector[i] = Normal();
+}
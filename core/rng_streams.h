@@ -0,0 +1,69 @@
+/** @file
+ * \brief Counter-based pseudo-random-number streams (Philox4x32-10)
+ */
+
+/* Header file for RNGStream, a counter-based random-number generator using the
+ * Philox4x32-10 bijection of Salmon et al. (2011, "Parallel Random Numbers: As
+ * Easy as 1, 2, 3", Proc. SC11).
+ *
+ * Unlike the (global-state) Mersenne Twister functions in mersenne_twister.h,
+ * each output block is a pure function of (seed, stream ID, block counter), so
+ * any number of independent streams -- e.g., one per bootstrap iteration, or one
+ * per DE candidate per generation -- can be created cheaply and in any order,
+ * and results do not depend on how the work is divided among threads.
+ */
+
+#ifndef _RNG_STREAMS_H_
+#define _RNG_STREAMS_H_
+
+#include <stdint.h>
+
+
+/// Philox4x32-10 bijection: encrypts the 128-bit counter with the 64-bit key
+void Philox4x32( const uint32_t counter[4], const uint32_t key[2], uint32_t output[4] );
+
+
+/// \brief Independent, reproducible random-number stream keyed by (seed, stream ID)
+class RNGStream
+{
+  public:
+    RNGStream( unsigned long seed=0, unsigned long streamID=0 );
+
+    /// Sets seed *and* stream ID, and rewinds the stream to its beginning
+    void SetSeed( unsigned long seed, unsigned long streamID=0 );
+
+    /// Switches to a different stream (same seed) and rewinds it to its beginning
+    void SetStream( unsigned long streamID );
+
+    unsigned long GetSeed( ) { return seed; };
+    unsigned long GetStream( ) { return streamID; };
+
+    /// Random number on [0,0xffffffff]-interval
+    uint32_t UInt32( );
+
+    /// Random number on [0,1)-real-interval, with 53-bit resolution
+    double Uniform( );
+
+    /// Random number from Normal distribution with mean = 0, sigma = 1
+    double Normal( );
+
+    /// Fills vector with n random numbers on [0,1); same sequence as n calls to Uniform()
+    void FillUniform( double *outputVector, long n );
+
+    /// Fills vector with n Normal deviates; same sequence as n calls to Normal()
+    void FillNormal( double *outputVector, long n );
+
+  private:
+    void NextBlock( );
+
+    unsigned long  seed, streamID;
+    uint64_t  blockCounter;
+    uint32_t  key[2];
+    uint32_t  buffer[4];
+    int  bufferPos;
+    bool  haveSpareNormal;
+    double  spareNormal;
+};
+
+
+#endif /* _RNG_STREAMS_H_ */
@@ -50,6 +50,22 @@ ModelObject* SetupModelObject( std::shared_ptr<OptionsBase> options, vector<int>
   if (options->maxThreadsSet)
     newModelObj->SetMaxThreads(options->maxThreads);
   newModelObj->SetDebugLevel(options->debugLevel);
+  if (options->cullingThreshold > 0.0) {
+    status = newModelObj->SetCullingThreshold(options->cullingThreshold);
+    if (status < 0) {
+      fprintf(stderr, "*** ERROR: Failure in ModelObject::SetCullingThreshold!\n\n");
+      exit(-1);
+    }
+  }
+  if (options->convolutionMethod != CONVOLVE_FFT) {
+    status = newModelObj->SetConvolutionMethod(options->convolutionMethod);
+    if (status < 0) {
+      fprintf(stderr, "*** ERROR: Failure in ModelObject::SetConvolutionMethod!\n\n");
+      exit(-1);
+    }
+  }
+  if (options->lowRankTolerance > 0.0)
+    newModelObj->SetLowRankTolerance(options->lowRankTolerance);
 
 
   // Add PSF image vector, if present (needs to be added prior to image data or
@@ -32,7 +32,9 @@ python/imfit_funcs.py
 # header files in core/
 source_header_files_core = """
 add_functions
+block_average
 bootstrap_errors
+checkpoint
 commandline_parser
 config_file_parser
 convolver
@@ -44,6 +46,7 @@ image_io
 mersenne_twister
 model_object
 mp_enorm
+multires_fit
 options_base
 options_imfit
 options_makeimage
@@ -51,7 +54,9 @@ options_mcmc
 oversampled_region
 param_struct
 print_results
+profile_counters
 psf_oversampling_info
+rng_streams
 sample_configs
 setup_model_object
 statistics
@@ -69,6 +74,7 @@ include/rng/MKLRng
 include/rng/MKLStream
 include/rng/Rng
 include/rng/RngStream
+running_stats
 """
                       
 
@@ -76,7 +82,9 @@ include/rng/RngStream
 
 source_files_core = """
 add_functions
+block_average
 bootstrap_errors
+checkpoint
 commandline_parser 
 config_file_parser
 convolver
@@ -90,9 +98,12 @@ mcmc_main
 mersenne_twister
 model_object
 mp_enorm
+multires_fit
 oversampled_region
 print_results
+profile_counters
 psf_oversampling_info
+rng_streams
 setup_model_object
 statistics
 utilities 
@@ -107,6 +118,8 @@ nmsimplex_fit
 nlopt_fit
 dispatch_solver
 solver_results
+multistart_fit
+multistart_monitor
 """
 
 source_files_mcmc ="""
@@ -117,6 +130,13 @@ dream_pars
 gelman_rubin
 gen_CR
 restore_state
+running_stats
+"""
+
+# header-only files in function_objects/ (headers for the files in
+# source_files_funcobj are added automatically)
+source_header_files_funcobj = """
+simd_math
 """
 
 source_files_funcobj = """
@@ -152,11 +172,55 @@ func_flatbar
 func_pointsource
 helper_funcs
 helper_funcs_3d
+helper_funcs_bessel
+radial_lookup_table
 integrator
 psf_interpolators
 """
 
 
+# profilefit (unsupported 1D profile fitting) -- files in profile_fitting/ and
+# function_objects_1d/
+source_header_files_profilefit = """
+add_functions_1d
+batch_fit_1d
+bootstrap_errors_1d
+convolver1d
+model_object_1d
+read_profile_pub
+"""
+
+source_files_profilefit = """
+add_functions_1d
+batch_fit_1d
+bootstrap_errors_1d
+convolver1d
+model_object_1d
+profilefit_main
+read_profile
+"""
+
+source_files_funcobj1d = """
+func1d_gaussian
+func1d_gaussian_linear
+func1d_exp
+func1d_sersic
+func1d_core-sersic
+func1d_broken-exp
+func1d_moffat
+func1d_delta
+func1d_sech
+func1d_sech2
+func1d_vdksech
+func1d_gaussian2side
+func1d_nuker
+func1d_spline
+func1d_n1543majmin_circbulge
+func1d_n1543majmin
+func1d_n1543majmin2
+func1d_gauss-hermite
+"""
+
 example_files = """
 config_exponential_ic3478_256.dat
 config_sersic_ic3478_256.dat
@@ -176,6 +240,7 @@ do_makeimage_tests
 python_files = """
 py_startup_test.py
 check_speedup.py
+compare_benchmarks.py
 compare_fits_files.py
 compare_imfit_printouts.py
 diff_printouts.py
@@ -0,0 +1,1092 @@
+// Benchmark suite for imfit: times the main computational pieces of the code on
+// reproducible workloads (built from the images and config files in tests/), for a
+// range of OpenMP thread counts, and writes the results to a JSON file so that runs
+// from different versions of the code (or different machines) can be compared
+// (e.g., with python/compare_benchmarks.py).
+//
+// Benchmarks:
+//    getvalue/<function>         FunctionObject::GetValue over a 256x256 image
+//    model_image/<workload>      ModelObject::CreateModelImage (with and without PSF
+//                                convolution and oversampled-PSF regions)
+//    convolver/<method>/<size>   Convolver::ConvolveImage for square images of
+//                                several sizes (FFT and direct convolution)
+//    fit_statistic/<statistic>   ModelObject::ChiSquared and CashStatistic
+//    lm_fit/<workload>           complete Levenberg-Marquardt fit
+//    de_generation/<workload>    Differential Evolution generations
+//    dream_generation/<workload> DREAM (MCMC) generations
+//
+// Each benchmark is set up (not timed) separately for each thread count, then run
+// repeatedly: the number of runs per batch is chosen so that each batch takes at
+// least a minimum time, and the median and minimum time per run over several
+// batches are reported.
+//
+// Usage: benchmark [options]   (use "benchmark --help" for the list of options)
+
+
+
+/* ------------------------ Include Files (Header Files )--------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>   // for timing-related functions and structs
+#include <string>
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <algorithm>
+
+#ifdef USE_OPENMP
+#include "omp.h"
+#endif
+
+#include "fftw3.h"
+
+#include "definitions.h"
+#include "image_io.h"
+#include "getimages.h"
+#include "model_object.h"
+#include "convolver.h"
+#include "add_functions.h"
+#include "setup_model_object.h"
+#include "options_base.h"
+#include "psf_oversampling_info.h"
+#include "param_struct.h"
+#include "commandline_parser.h"
+#include "config_file_parser.h"
+#include "utilities_pub.h"
+#include "levmar_fit.h"
+#include "DESolver.h"
+#include "dream.h"
+#include "dream_params.h"
+#include "rng/GSLStream.h"
+
+using namespace std;
+
+
+/* ---------------- Definitions ---------------------------------------- */
+
+#define VERSION_STRING      "1.8.0"
+#define BENCHMARK_FORMAT_VERSION   1
+
+#define DEFAULT_TESTS_DIR         "tests"
+#define DEFAULT_OUTPUT_FILENAME   "benchmark_results.json"
+
+// timing: each batch of runs lasts at least MIN_BATCH_TIME seconds
+#define MIN_BATCH_TIME          0.2
+#define N_BATCHES               5
+#define MIN_BATCH_TIME_QUICK    0.05
+#define N_BATCHES_QUICK         3
+#define MAX_RUNS_PER_BATCH      1000000
+
+#define GETVALUE_IMAGE_SIZE     256
+#define LM_FTOL                 1.0e-8
+#define DE_GENERATIONS          20
+#define DE_POP_SIZE_PER_PARAMETER   8   /* same as in diff_evoln_fit.cpp */
+#define DREAM_GENERATIONS       20
+#define RNG_SEED                1234
+
+static string  kGainString = "GAIN";
+static string  kReadNoiseString = "READNOISE";
+static string  kExpTimeString = "EXPTIME";
+static string  kNCombinedString = "NCOMBINED";
+static string  kOriginalSkyString = "ORIGINAL_SKY";
+
+
+typedef struct {
+  string  testsDir;
+  string  outputFileName;
+  vector<int>  threadCounts;
+  bool  quickMode;
+  string  nameFilter;
+} benchmarkOptions;
+
+
+// Description of a workload: data image, config file, and optional PSF, mask, and
+// oversampled PSF (file names are relative to the tests directory; "" = not used)
+typedef struct {
+  const char  *name;
+  const char  *imageFile;
+  const char  *configFile;
+  const char  *psfFile;
+  const char  *maskFile;
+  const char  *oversampledPsfFile;
+  int  oversamplingScale;
+  const char  *oversampleRegions;   // space-separated list of regions
+} workloadSpec;
+
+static const workloadSpec  WORKLOAD_SPECS[] = {
+  {"ic3478", "ic3478rss_64x64.fits", "imfit_reference/imfit_config_ic3478_64x64b.dat",
+   "", "", "", 0, ""},
+  {"n3073_psf", "n3073rss_small.fits", "imfit_reference/imfit_config_n3073.dat",
+   "psf_moffat_35_n4699z.fits", "n3073rss_small_mask.fits", "", 0, ""},
+  {"2gauss_psf_oversampled", "twogaussian_psf+2osamp_noisy.fits",
+   "imfit_reference/config_imfit_2gauss_small.dat", "psf_moffat_35.fits", "",
+   "psf_moffat_35_oversamp3.fits", 3, "35:45,35:45 10:20,5:15"}
+};
+static const int  N_WORKLOADS = sizeof(WORKLOAD_SPECS) / sizeof(workloadSpec);
+
+
+// Image functions timed by the getvalue benchmarks, with parameter values (after
+// x0,y0) for a GETVALUE_IMAGE_SIZE x GETVALUE_IMAGE_SIZE image
+typedef struct {
+  const char  *name;
+  int  nParams;
+  double  params[8];
+} functionSpec;
+
+static const functionSpec  FUNCTION_SPECS[] = {
+  {"Exponential", 4, {30.0, 0.3, 100.0, 20.0}},
+  {"Sersic", 5, {30.0, 0.3, 4.0, 10.0, 40.0}},
+  {"Gaussian", 4, {30.0, 0.3, 100.0, 15.0}},
+  {"Moffat", 5, {30.0, 0.3, 100.0, 8.0, 2.5}},
+  {"ModifiedKing", 6, {30.0, 0.3, 100.0, 5.0, 100.0, 2.0}},
+  {"BrokenExponential", 7, {30.0, 0.3, 100.0, 30.0, 10.0, 60.0, 1.0}},
+  {"Core-Sersic", 8, {30.0, 0.3, 4.0, 10.0, 40.0, 2.0, 5.0, 0.1}},
+  {"GaussianRing", 5, {30.0, 0.3, 100.0, 50.0, 5.0}},
+  {"EdgeOnDisk", 5, {30.0, 1.0, 20.0, 1.0, 5.0}},
+  {"FerrersBar2D", 6, {30.0, 0.5, 0.5, 2.0, 100.0, 60.0}},
+  {"Sersic_GenEllipse", 6, {30.0, 0.3, 0.5, 2.0, 10.0, 40.0}}
+};
+static const int  N_FUNCTIONS = sizeof(FUNCTION_SPECS) / sizeof(functionSpec);
+
+// Image sizes and methods for the convolver benchmarks
+static const int  CONVOLVER_SIZES[] = {128, 256, 512, 1024};
+static const int  N_CONVOLVER_SIZES = sizeof(CONVOLVER_SIZES) / sizeof(int);
+static const int  N_CONVOLVER_SIZES_QUICK = 2;
+#define CONVOLVER_PSF_FILE     "psf_moffat_35.fits"
+#define CONVOLVER_IMAGE_FILE   "n3073rss_small.fits"
+
+
+
+// A workload's images, parameters, and options (everything needed to create a
+// ModelObject for it)
+class Workload
+{
+  public:
+    Workload( ) : dataPixels(NULL), psfPixels(NULL), maskPixels(NULL),
+    				nColumns(0), nRows(0), nColumns_psf(0), nRows_psf(0), nFreeParams(0),
+    				paramLimitsExist(false), options(new OptionsBase()) { ; }
+    ~Workload( );
+
+    string  name, description;
+    double  *dataPixels, *psfPixels, *maskPixels;
+    int  nColumns, nRows, nColumns_psf, nRows_psf;
+    int  nFreeParams;
+    vector<string>  functionList, functionLabelList;
+    vector<double>  parameterList;
+    vector<mp_par>  parameterInfo;
+    vector<int>  functionSetIndices;
+    bool  paramLimitsExist;
+    vector<PsfOversamplingInfo *>  psfOversamplingInfoVect;
+    std::shared_ptr<OptionsBase>  options;
+};
+
+
+// Summary of repeated runs of a benchmark with a given number of threads
+typedef struct {
+  int  nThreads;
+  int  nRuns;            // total number of timed runs
+  double  medianTime;    // median over batches of the mean time per run (seconds)
+  double  minTime;       // minimum over batches of the mean time per run (seconds)
+} benchmarkTiming;
+
+
+
+/* ------------------- Function Prototypes ----------------------------- */
+
+class BenchmarkTask;
+
+void ProcessInput( int argc, char *argv[], benchmarkOptions *theOptions );
+double GetWallTime( );
+string JsonString( const string &inputString );
+void ApplyConfigFileOptions( configOptions &configFileOptions,
+							std::shared_ptr<OptionsBase> options );
+Workload * LoadWorkload( const string &testsDir, const workloadSpec &spec );
+ModelObject * CreateWorkloadModel( Workload *workload, int nThreads, bool useCash );
+void TimeTask( BenchmarkTask *task, int nBatches, double minBatchTime,
+				benchmarkTiming *timing );
+
+
+
+/* ------------------------ Benchmark Classes -------------------------- */
+
+/// Base class for benchmarks: Setup() prepares the workload for a given number of
+/// threads (not timed), Run() does the work being timed, and Cleanup() frees whatever
+/// Setup() allocated. Times are reported as (seconds per Run()) * unitFactor.
+class BenchmarkTask
+{
+  public:
+    BenchmarkTask( const string &taskName, const string &taskWorkload,
+    				const string &taskUnit, double factor )
+    	: name(taskName), workload(taskWorkload), unit(taskUnit), unitFactor(factor) { ; }
+    virtual ~BenchmarkTask( ) { ; }
+
+    virtual int Setup( int nThreads ) = 0;
+    virtual void Run( ) = 0;
+    virtual void Cleanup( ) = 0;
+
+    string  name, workload, unit;
+    double  unitFactor;
+};
+
+
+// getvalue/<function>: GetValue for every pixel of an image (no PSF convolution)
+class GetValueTask : public BenchmarkTask
+{
+  public:
+    GetValueTask( const functionSpec &spec )
+    	: BenchmarkTask(string("getvalue/") + spec.name,
+    					PrintToString("%s, %dx%d image, no PSF", spec.name,
+    								GETVALUE_IMAGE_SIZE, GETVALUE_IMAGE_SIZE),
+    					"ns/pixel", 1.0e9/(GETVALUE_IMAGE_SIZE*GETVALUE_IMAGE_SIZE)),
+    	  functionName(spec.name), theModel(NULL)
+    {
+      params.push_back(0.5*GETVALUE_IMAGE_SIZE);
+      params.push_back(0.5*GETVALUE_IMAGE_SIZE);
+      for (int i = 0; i < spec.nParams; i++)
+        params.push_back(spec.params[i]);
+    }
+
+    int Setup( int nThreads )
+    {
+      vector<string>  functionList(1, functionName);
+      vector<string>  labelList(1, "");
+      vector<int>  setIndices(1, 0);
+
+      theModel = new ModelObject();
+      theModel->SetMaxThreads(nThreads);
+      if (AddFunctions(theModel, functionList, labelList, setIndices, true) < 0)
+        return -1;
+      if (theModel->GetNParams() != (int)params.size()) {
+        fprintf(stderr, "*** ERROR: wrong number of parameters for %s benchmark!\n",
+        		functionName.c_str());
+        return -1;
+      }
+      return theModel->SetupModelImage(GETVALUE_IMAGE_SIZE, GETVALUE_IMAGE_SIZE);
+    }
+
+    void Run( ) { theModel->GetSingleFunctionImage(params.data(), 0); }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    string  functionName;
+    vector<double>  params;
+    ModelObject  *theModel;
+};
+
+
+// model_image/<workload>: CreateModelImage for the workload's initial parameters
+class ModelImageTask : public BenchmarkTask
+{
+  public:
+    ModelImageTask( Workload *inputWorkload )
+    	: BenchmarkTask("model_image/" + inputWorkload->name, inputWorkload->description,
+    					"ms", 1.0e3),
+    	  theWorkload(inputWorkload), theModel(NULL) { ; }
+
+    int Setup( int nThreads )
+    {
+      theModel = CreateWorkloadModel(theWorkload, nThreads, false);
+      return (theModel == NULL) ? -1 : 0;
+    }
+
+    void Run( ) { theModel->CreateModelImage(theWorkload->parameterList.data()); }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    Workload  *theWorkload;
+    ModelObject  *theModel;
+};
+
+
+// convolver/<method>/<size>: convolution of a square image (tiled copies of a
+// data image) with a PSF
+class ConvolverTask : public BenchmarkTask
+{
+  public:
+    ConvolverTask( int imageSize, int method, const string &methodName,
+    				double *inputPsfPixels, int nColumns_psf, int nRows_psf,
+    				double *inputImagePixels, int nColumns_image, int nRows_image )
+    	: BenchmarkTask(PrintToString("convolver/%s/%d", methodName.c_str(), imageSize),
+    					PrintToString("%dx%d image (tiled %s), %dx%d PSF (%s), %s", imageSize,
+    								imageSize, CONVOLVER_IMAGE_FILE, nColumns_psf, nRows_psf,
+    								CONVOLVER_PSF_FILE, methodName.c_str()),
+    					"ms", 1.0e3),
+    	  size(imageSize), convolutionMethod(method), psfPixels(inputPsfPixels),
+    	  nColumnsPsf(nColumns_psf), nRowsPsf(nRows_psf), theConvolver(NULL)
+    {
+      // fill the image with periodic copies of the input image
+      imagePixels.resize((long)size*size);
+      for (int i = 0; i < size; i++)
+        for (int j = 0; j < size; j++)
+          imagePixels[(long)i*size + j] = inputImagePixels[(i % nRows_image)*nColumns_image
+          													+ (j % nColumns_image)];
+    }
+
+    int Setup( int nThreads )
+    {
+      theConvolver = new Convolver();
+      theConvolver->SetMaxThreads(nThreads);
+      if (theConvolver->SetConvolutionMethod(convolutionMethod) < 0)
+        return -1;
+      theConvolver->SetupPSF(psfPixels, nColumnsPsf, nRowsPsf);
+      theConvolver->SetupImage(size, size);
+      return theConvolver->DoFullSetup();
+    }
+
+    // (the image is convolved in place each time, which doesn't affect the timing)
+    void Run( ) { theConvolver->ConvolveImage(imagePixels.data()); }
+
+    void Cleanup( )
+    {
+      delete theConvolver;
+      theConvolver = NULL;
+    }
+
+  private:
+    int  size, convolutionMethod;
+    double  *psfPixels;
+    int  nColumnsPsf, nRowsPsf;
+    vector<double>  imagePixels;
+    Convolver  *theConvolver;
+};
+
+
+// fit_statistic/<statistic>: chi^2 (with data-based errors) or Cash statistic for
+// the workload's initial parameters
+class FitStatisticTask : public BenchmarkTask
+{
+  public:
+    FitStatisticTask( Workload *inputWorkload, bool useCashStatistic )
+    	: BenchmarkTask(useCashStatistic ? "fit_statistic/cash" : "fit_statistic/chi_squared",
+    					inputWorkload->description, "ms", 1.0e3),
+    	  theWorkload(inputWorkload), useCash(useCashStatistic), theModel(NULL) { ; }
+
+    int Setup( int nThreads )
+    {
+      theModel = CreateWorkloadModel(theWorkload, nThreads, useCash);
+      return (theModel == NULL) ? -1 : 0;
+    }
+
+    void Run( )
+    {
+      double  *params = theWorkload->parameterList.data();
+      if (useCash)
+        theModel->CashStatistic(params);
+      else
+        theModel->ChiSquared(params);
+    }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    Workload  *theWorkload;
+    bool  useCash;
+    ModelObject  *theModel;
+};
+
+
+// lm_fit/<workload>: complete L-M fit, starting from the workload's initial parameters
+class LevMarFitTask : public BenchmarkTask
+{
+  public:
+    LevMarFitTask( Workload *inputWorkload )
+    	: BenchmarkTask("lm_fit/" + inputWorkload->name, inputWorkload->description,
+    					"ms", 1.0e3),
+    	  theWorkload(inputWorkload), theModel(NULL) { ; }
+
+    int Setup( int nThreads )
+    {
+      theModel = CreateWorkloadModel(theWorkload, nThreads, false);
+      return (theModel == NULL) ? -1 : 0;
+    }
+
+    void Run( )
+    {
+      vector<double>  params(theWorkload->parameterList);
+      LevMarFit((int)params.size(), theWorkload->nFreeParams, (int)theModel->GetNValidPixels(),
+      			params.data(), theWorkload->parameterInfo, theModel, LM_FTOL,
+      			theWorkload->paramLimitsExist, 0);
+    }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    Workload  *theWorkload;
+    ModelObject  *theModel;
+};
+
+
+// Minimal DESolver subclass using ModelObject::GetFitStatistic (as in ImfitSolver)
+class BenchmarkDESolver : public DESolver
+{
+  public:
+    BenchmarkDESolver( int dim, int popSize, ModelObject *inputModel )
+    	: DESolver(dim, popSize), theModel(inputModel) { ; }
+
+    double EnergyFunction( double *trial, bool &bAtSolution )
+    {
+      return theModel->GetFitStatistic(trial);
+    }
+
+  private:
+    ModelObject  *theModel;
+};
+
+
+// de_generation/<workload>: DE_GENERATIONS generations of DE (tolerance = 0 disables
+// the convergence test); includes evaluation of the initial population
+class DEGenerationTask : public BenchmarkTask
+{
+  public:
+    DEGenerationTask( Workload *inputWorkload )
+    	: BenchmarkTask("de_generation/" + inputWorkload->name,
+    					PrintToString("%s; population = %d x (# free parameters)",
+    								inputWorkload->description.c_str(),
+    								DE_POP_SIZE_PER_PARAMETER),
+    					"ms/generation", 1.0e3/DE_GENERATIONS),
+    	  theWorkload(inputWorkload), theModel(NULL)
+    {
+      int  nParams = (int)theWorkload->parameterList.size();
+      for (int i = 0; i < nParams; i++) {
+        if (theWorkload->parameterInfo[i].fixed == 1) {
+          minParamValues.push_back(theWorkload->parameterList[i]);
+          maxParamValues.push_back(theWorkload->parameterList[i]);
+        } else {
+          minParamValues.push_back(theWorkload->parameterInfo[i].limits[0]);
+          maxParamValues.push_back(theWorkload->parameterInfo[i].limits[1]);
+        }
+      }
+    }
+
+    int Setup( int nThreads )
+    {
+      theModel = CreateWorkloadModel(theWorkload, nThreads, false);
+      return (theModel == NULL) ? -1 : 0;
+    }
+
+    void Run( )
+    {
+      BenchmarkDESolver  solver((int)minParamValues.size(),
+      						DE_POP_SIZE_PER_PARAMETER*theWorkload->nFreeParams, theModel);
+      solver.Setup(minParamValues.data(), maxParamValues.data(), stRand1Exp, 0.85, 1.0, 0.0,
+      				RNG_SEED, false, RNG_MERSENNE_TWISTER);
+      solver.Solve(DE_GENERATIONS, 0);
+    }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    Workload  *theWorkload;
+    ModelObject  *theModel;
+    vector<double>  minParamValues, maxParamValues;
+};
+
+
+double LikelihoodFuncForBenchmark( int chain, int gen, const double* state,
+								const void* extraData, bool recalc )
+{
+  // (GetFitStatistic won't accept const double*)
+  double  *params = (double *)state;
+  ModelObject *theModel = (ModelObject *)extraData;
+
+  return -theModel->GetFitStatistic(params)/2.0;
+}
+
+
+// dream_generation/<workload>: DREAM_GENERATIONS generations of DREAM (all in
+// burn-in, so there are no convergence tests), with one chain per free parameter;
+// chain output goes to temporary files, which are deleted after each run
+class DreamGenerationTask : public BenchmarkTask
+{
+  public:
+    DreamGenerationTask( Workload *inputWorkload )
+    	: BenchmarkTask("dream_generation/" + inputWorkload->name,
+    					PrintToString("%s; %d chains", inputWorkload->description.c_str(),
+    								inputWorkload->nFreeParams),
+    					"ms/generation", 1.0e3/DREAM_GENERATIONS),
+    	  theWorkload(inputWorkload), theModel(NULL)
+    {
+      int  nParams = (int)theWorkload->parameterList.size();
+      for (int i = 0; i < nParams; i++) {
+        if (theWorkload->parameterInfo[i].fixed == 1) {
+          lockFlags.push_back(1);
+          lowValues.push_back(theWorkload->parameterList[i]);
+          highValues.push_back(theWorkload->parameterList[i]);
+        } else {
+          lockFlags.push_back(0);
+          lowValues.push_back(theWorkload->parameterInfo[i].limits[0]);
+          highValues.push_back(theWorkload->parameterInfo[i].limits[1]);
+        }
+      }
+      outputRootname = PrintToString("%s/imfit_benchmark_dream_%d", P_tmpdir, (int)getpid());
+    }
+
+    int Setup( int nThreads )
+    {
+      theModel = CreateWorkloadModel(theWorkload, nThreads, false);
+      if (theModel == NULL)
+        return -1;
+      paramNames.clear();
+      for (int i = 0; i < (int)lockFlags.size(); i++)
+        paramNames.push_back(theModel->GetParameterName(i));
+      return 0;
+    }
+
+    void Run( )
+    {
+      dream_pars  dreamPars;
+      rng::GSLStream  rng;
+      int  nParams = (int)lockFlags.size();
+
+      SetupDreamParams(&dreamPars, nParams, theWorkload->parameterList.data(),
+      				paramNames.data(), lockFlags.data(), lowValues.data(), highValues.data());
+      dreamPars.outputRootname = outputRootname;
+      dreamPars.numChains = theWorkload->nFreeParams;
+      dreamPars.maxEvals = DREAM_GENERATIONS;
+      dreamPars.burnIn = DREAM_GENERATIONS;
+      dreamPars.verboseLevel = 0;
+      for (int i = 0; i < nParams; i++)
+        dreamPars.parameterNames.push_back(paramNames[i]);
+      dreamPars.fun = &LikelihoodFuncForBenchmark;
+      dreamPars.deterministicLik = 1;
+      dreamPars.extraData = theModel;
+      rng.alloc(RNG_SEED);
+
+      dream(&dreamPars, &rng);
+
+      FreeVarsDreamParams(&dreamPars);
+      for (int i = 0; i < theWorkload->nFreeParams; i++)
+        remove(PrintToString("%s.%d.txt", outputRootname.c_str(), i + 1).c_str());
+    }
+
+    void Cleanup( )
+    {
+      delete theModel;
+      theModel = NULL;
+    }
+
+  private:
+    Workload  *theWorkload;
+    ModelObject  *theModel;
+    vector<int>  lockFlags;
+    vector<double>  lowValues, highValues;
+    vector<string>  paramNames;
+    string  outputRootname;
+};
+
+
+
+/* ---------------- MAIN ----------------------------------------------- */
+
+int main( int argc, char *argv[] )
+{
+  benchmarkOptions  options;
+  vector<Workload *>  workloads;
+  vector<BenchmarkTask *>  allTasks, tasks;
+  vector< vector<benchmarkTiming> >  allTimings;
+  double  *psfPixels, *imagePixels;
+  int  nColumns_psf, nRows_psf, nColumns_image, nRows_image;
+  int  nHardwareThreads = 1;
+  int  nBatches, nConvolverSizes;
+  double  minBatchTime;
+  char  dateString[64], hostName[256];
+  time_t  now;
+  FILE  *outputFile;
+
+#ifdef USE_OPENMP
+  nHardwareThreads = omp_get_num_procs();
+#endif
+  options.testsDir = DEFAULT_TESTS_DIR;
+  options.outputFileName = DEFAULT_OUTPUT_FILENAME;
+  options.quickMode = false;
+  options.nameFilter = "";
+  ProcessInput(argc, argv, &options);
+  if (options.threadCounts.empty()) {
+    // default: 1, 2, 4, ..., plus the number of hardware threads
+    for (int n = 1; n < nHardwareThreads; n *= 2)
+      options.threadCounts.push_back(n);
+    options.threadCounts.push_back(nHardwareThreads);
+  }
+#ifndef USE_OPENMP
+  if ((options.threadCounts.size() > 1) || (options.threadCounts[0] != 1)) {
+    printf("* OpenMP not enabled: timing with 1 thread only.\n");
+    options.threadCounts.assign(1, 1);
+  }
+#endif
+  if (options.quickMode) {
+    minBatchTime = MIN_BATCH_TIME_QUICK;
+    nBatches = N_BATCHES_QUICK;
+    nConvolverSizes = N_CONVOLVER_SIZES_QUICK;
+  } else {
+    minBatchTime = MIN_BATCH_TIME;
+    nBatches = N_BATCHES;
+    nConvolverSizes = N_CONVOLVER_SIZES;
+  }
+
+  // Load workloads and set up benchmarks
+  for (int i = 0; i < N_WORKLOADS; i++) {
+    Workload  *newWorkload = LoadWorkload(options.testsDir, WORKLOAD_SPECS[i]);
+    if (newWorkload == NULL)
+      exit(-1);
+    workloads.push_back(newWorkload);
+  }
+  std::tie(psfPixels, nColumns_psf, nRows_psf, std::ignore) =
+  					GetPsfImage(options.testsDir + "/" + CONVOLVER_PSF_FILE);
+  imagePixels = ReadImageAsVector(options.testsDir + "/" + CONVOLVER_IMAGE_FILE,
+  								&nColumns_image, &nRows_image);
+  if ((psfPixels == NULL) || (imagePixels == NULL)) {
+    fprintf(stderr, "\n*** ERROR: Unable to read images for convolver benchmarks!\n\n");
+    exit(-1);
+  }
+
+  for (int i = 0; i < N_FUNCTIONS; i++)
+    allTasks.push_back(new GetValueTask(FUNCTION_SPECS[i]));
+  for (int i = 0; i < N_WORKLOADS; i++)
+    allTasks.push_back(new ModelImageTask(workloads[i]));
+  for (int i = 0; i < nConvolverSizes; i++) {
+    allTasks.push_back(new ConvolverTask(CONVOLVER_SIZES[i], CONVOLVE_FFT, "fft",
+    					psfPixels, nColumns_psf, nRows_psf, imagePixels, nColumns_image,
+    					nRows_image));
+    allTasks.push_back(new ConvolverTask(CONVOLVER_SIZES[i], CONVOLVE_DIRECT, "direct",
+    					psfPixels, nColumns_psf, nRows_psf, imagePixels, nColumns_image,
+    					nRows_image));
+  }
+  // workloads[1] = n3073 (PSF + mask); workloads[0] = ic3478 (parameter limits for
+  // all parameters, needed by DE and DREAM)
+  allTasks.push_back(new FitStatisticTask(workloads[1], false));
+  allTasks.push_back(new FitStatisticTask(workloads[1], true));
+  allTasks.push_back(new LevMarFitTask(workloads[0]));
+  allTasks.push_back(new DEGenerationTask(workloads[0]));
+  allTasks.push_back(new DreamGenerationTask(workloads[0]));
+  for (int i = 0; i < (int)allTasks.size(); i++) {
+    if (allTasks[i]->name.find(options.nameFilter) != string::npos)
+      tasks.push_back(allTasks[i]);
+  }
+  if (tasks.empty()) {
+    fprintf(stderr, "\n*** ERROR: No benchmarks match \"%s\"!\n\n", options.nameFilter.c_str());
+    exit(-1);
+  }
+
+  // Run benchmarks
+  printf("\nRunning %d benchmarks with %d thread count(s)", (int)tasks.size(),
+  		(int)options.threadCounts.size());
+  printf(" (%d hardware threads) ...\n", nHardwareThreads);
+  allTimings.resize(tasks.size());
+  for (int n = 0; n < (int)tasks.size(); n++) {
+    for (int k = 0; k < (int)options.threadCounts.size(); k++) {
+      benchmarkTiming  timing;
+      int  nThreads = options.threadCounts[k];
+#ifdef USE_OPENMP
+      omp_set_num_threads(nThreads);
+#endif
+      if (tasks[n]->Setup(nThreads) < 0) {
+        fprintf(stderr, "\n*** ERROR: Failure setting up benchmark %s!\n\n",
+        		tasks[n]->name.c_str());
+        exit(-1);
+      }
+      TimeTask(tasks[n], nBatches, minBatchTime, &timing);
+      tasks[n]->Cleanup();
+      timing.nThreads = nThreads;
+      allTimings[n].push_back(timing);
+      printf("%-34s %3d thread(s): %12.4f %-14s (%d runs)\n", tasks[n]->name.c_str(),
+      		nThreads, timing.medianTime*tasks[n]->unitFactor, tasks[n]->unit.c_str(),
+      		timing.nRuns);
+    }
+  }
+
+  // Write results
+  now = time(NULL);
+  strftime(dateString, sizeof(dateString), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+  if (gethostname(hostName, sizeof(hostName)) != 0)
+    strcpy(hostName, "unknown");
+  hostName[sizeof(hostName) - 1] = '\0';
+  outputFile = fopen(options.outputFileName.c_str(), "w");
+  if (outputFile == NULL) {
+    fprintf(stderr, "\n*** ERROR: Unable to open output file \"%s\"!\n\n",
+    		options.outputFileName.c_str());
+    exit(-1);
+  }
+  fprintf(outputFile, "{\n");
+  fprintf(outputFile, "  \"format_version\": %d,\n", BENCHMARK_FORMAT_VERSION);
+  fprintf(outputFile, "  \"program\": \"benchmark\",\n");
+  fprintf(outputFile, "  \"version\": \"%s\",\n", VERSION_STRING);
+  fprintf(outputFile, "  \"date\": \"%s\",\n", dateString);
+  fprintf(outputFile, "  \"host\": %s,\n", JsonString(hostName).c_str());
+  fprintf(outputFile, "  \"hardware_threads\": %d,\n", nHardwareThreads);
+#ifdef USE_OPENMP
+  fprintf(outputFile, "  \"openmp\": true,\n");
+#else
+  fprintf(outputFile, "  \"openmp\": false,\n");
+#endif
+  fprintf(outputFile, "  \"quick_mode\": %s,\n", options.quickMode ? "true" : "false");
+  fprintf(outputFile, "  \"benchmarks\": [\n");
+  for (int n = 0; n < (int)tasks.size(); n++) {
+    BenchmarkTask  *task = tasks[n];
+    double  baseTime = allTimings[n][0].medianTime;
+    int  baseThreads = allTimings[n][0].nThreads;
+    fprintf(outputFile, "    {\n");
+    fprintf(outputFile, "      \"name\": %s,\n", JsonString(task->name).c_str());
+    fprintf(outputFile, "      \"group\": %s,\n",
+    		JsonString(task->name.substr(0, task->name.find('/'))).c_str());
+    fprintf(outputFile, "      \"workload\": %s,\n", JsonString(task->workload).c_str());
+    fprintf(outputFile, "      \"unit\": %s,\n", JsonString(task->unit).c_str());
+    fprintf(outputFile, "      \"results\": [\n");
+    for (int k = 0; k < (int)allTimings[n].size(); k++) {
+      benchmarkTiming  *timing = &allTimings[n][k];
+      double  speedup = baseTime / timing->medianTime;
+      fprintf(outputFile, "        {\"threads\": %d, \"time\": %.6g, \"time_min\": %.6g, ",
+      		timing->nThreads, timing->medianTime*task->unitFactor,
+      		timing->minTime*task->unitFactor);
+      fprintf(outputFile, "\"runs\": %d, \"speedup\": %.4f, \"efficiency\": %.4f}%s\n",
+      		timing->nRuns, speedup, speedup*baseThreads/timing->nThreads,
+      		(k < (int)allTimings[n].size() - 1) ? "," : "");
+    }
+    fprintf(outputFile, "      ]\n");
+    fprintf(outputFile, "    }%s\n", (n < (int)tasks.size() - 1) ? "," : "");
+  }
+  fprintf(outputFile, "  ]\n");
+  fprintf(outputFile, "}\n");
+  fclose(outputFile);
+  printf("\nResults saved in \"%s\"\n\n", options.outputFileName.c_str());
+
+  // Free up memory
+  for (int i = 0; i < (int)allTasks.size(); i++)
+    delete allTasks[i];
+  for (int i = 0; i < (int)workloads.size(); i++)
+    delete workloads[i];
+  fftw_free(psfPixels);                 // allocated externally, in ReadImageAsVector()
+  fftw_free(imagePixels);
+
+  return 0;
+}
+
+
+
+/* ---------------- FUNCTION: TimeTask --------------------------------- */
+/// Times nBatches batches of runs of task (after one untimed warm-up run); the number
+/// of runs per batch is chosen so that each batch takes at least minBatchTime seconds.
+void TimeTask( BenchmarkTask *task, int nBatches, double minBatchTime,
+				benchmarkTiming *timing )
+{
+  vector<double>  batchTimes;
+  double  startTime, runTime;
+  int  nRunsPerBatch;
+
+  startTime = GetWallTime();
+  task->Run();
+  runTime = GetWallTime() - startTime;
+  nRunsPerBatch = 1;
+  if (runTime < minBatchTime)
+    nRunsPerBatch = (int)std::min(ceil(minBatchTime / fmax(runTime, 1.0e-9)),
+    								(double)MAX_RUNS_PER_BATCH);
+
+  for (int b = 0; b < nBatches; b++) {
+    startTime = GetWallTime();
+    for (int r = 0; r < nRunsPerBatch; r++)
+      task->Run();
+    batchTimes.push_back((GetWallTime() - startTime) / nRunsPerBatch);
+  }
+  std::sort(batchTimes.begin(), batchTimes.end());
+  timing->nRuns = nBatches*nRunsPerBatch;
+  timing->minTime = batchTimes[0];
+  if ((nBatches % 2) == 1)
+    timing->medianTime = batchTimes[nBatches/2];
+  else
+    timing->medianTime = 0.5*(batchTimes[nBatches/2 - 1] + batchTimes[nBatches/2]);
+}
+
+
+
+/* ---------------- FUNCTION: GetWallTime ------------------------------ */
+/// Returns the current wall-clock time in seconds.
+double GetWallTime( )
+{
+  struct timeval  currentTime;
+
+  gettimeofday(&currentTime, NULL);
+  return currentTime.tv_sec + currentTime.tv_usec/1e6;
+}
+
+
+
+/* ---------------- FUNCTION: JsonString ------------------------------- */
+/// Returns inputString as a quoted JSON string (with quotes and backslashes escaped).
+string JsonString( const string &inputString )
+{
+  string  outputString = "\"";
+
+  for (int i = 0; i < (int)inputString.size(); i++) {
+    if ((inputString[i] == '"') || (inputString[i] == '\\'))
+      outputString += '\\';
+    outputString += inputString[i];
+  }
+  return outputString + "\"";
+}
+
+
+
+/* ---------------- FUNCTION: ApplyConfigFileOptions ------------------- */
+/// Copies image characteristics (GAIN, etc.) from the config file into options.
+void ApplyConfigFileOptions( configOptions &configFileOptions,
+							std::shared_ptr<OptionsBase> options )
+{
+  for (int i = 0; i < configFileOptions.nOptions; i++) {
+    const char  *value = configFileOptions.optionValues[i].c_str();
+    if (configFileOptions.optionNames[i] == kGainString)
+      options->gain = strtod(value, NULL);
+    else if (configFileOptions.optionNames[i] == kReadNoiseString)
+      options->readNoise = strtod(value, NULL);
+    else if (configFileOptions.optionNames[i] == kExpTimeString)
+      options->expTime = strtod(value, NULL);
+    else if (configFileOptions.optionNames[i] == kNCombinedString)
+      options->nCombined = atoi(value);
+    else if (configFileOptions.optionNames[i] == kOriginalSkyString)
+      options->originalSky = strtod(value, NULL);
+  }
+}
+
+
+
+/* ---------------- FUNCTION: LoadWorkload ----------------------------- */
+/// Reads the images and config file for a workload; returns NULL on failure.
+Workload * LoadWorkload( const string &testsDir, const workloadSpec &spec )
+{
+  Workload  *workload = new Workload();
+  std::shared_ptr<OptionsBase>  options = workload->options;
+  configOptions  userConfigOptions;
+  string  configFileName = testsDir + "/" + spec.configFile;
+  int  status;
+
+  workload->name = spec.name;
+  workload->description = PrintToString("%s, %s", spec.imageFile, spec.configFile);
+  status = ReadConfigFile(configFileName, true, workload->functionList,
+  						workload->functionLabelList, workload->parameterList,
+  						workload->parameterInfo, workload->functionSetIndices,
+  						workload->paramLimitsExist, userConfigOptions);
+  if (status != 0) {
+    fprintf(stderr, "\n*** ERROR: Failure reading configuration file \"%s\"!\n\n",
+    		configFileName.c_str());
+    delete workload;
+    return NULL;
+  }
+  options->useModelForErrors = false;
+  options->useCashStatistic = false;
+  options->usePoissonMLR = false;
+  options->solver = DIFF_EVOLN_SOLVER;   // (so that the Cash statistic is allowed)
+  ApplyConfigFileOptions(userConfigOptions, options);
+  workload->nFreeParams = 0;
+  for (int i = 0; i < (int)workload->parameterInfo.size(); i++) {
+    if (workload->parameterInfo[i].fixed == 0)
+      workload->nFreeParams++;
+  }
+
+  workload->dataPixels = ReadImageAsVector(testsDir + "/" + spec.imageFile,
+  										&workload->nColumns, &workload->nRows);
+  if (workload->dataPixels == NULL) {
+    fprintf(stderr, "\n*** ERROR: Unable to read image file \"%s/%s\"!\n\n",
+    		testsDir.c_str(), spec.imageFile);
+    delete workload;
+    return NULL;
+  }
+  if (strlen(spec.psfFile) > 0) {
+    options->psfImagePresent = true;
+    options->psfFileName = testsDir + "/" + spec.psfFile;
+    std::tie(workload->psfPixels, workload->nColumns_psf, workload->nRows_psf, status) =
+    					GetPsfImage(options->psfFileName);
+    if (status < 0) {
+      delete workload;
+      return NULL;
+    }
+    workload->description += PrintToString(", PSF %s", spec.psfFile);
+  }
+  if (strlen(spec.maskFile) > 0) {
+    int  nColumns_mask, nRows_mask;
+    options->maskImagePresent = true;
+    options->maskFileName = testsDir + "/" + spec.maskFile;
+    workload->maskPixels = ReadImageAsVector(options->maskFileName, &nColumns_mask,
+    										&nRows_mask);
+    if ((workload->maskPixels == NULL) || (nColumns_mask != workload->nColumns)
+    		|| (nRows_mask != workload->nRows)) {
+      fprintf(stderr, "\n*** ERROR: Unable to read mask image \"%s\" (or wrong size)!\n\n",
+      		options->maskFileName.c_str());
+      delete workload;
+      return NULL;
+    }
+    workload->description += PrintToString(", mask %s", spec.maskFile);
+  }
+  if (strlen(spec.oversampledPsfFile) > 0) {
+    options->psfOversampling = true;
+    options->psfOversampledImagePresent = true;
+    options->psfOversampledFileNames.push_back(testsDir + "/" + spec.oversampledPsfFile);
+    options->psfOversamplingScales.push_back(spec.oversamplingScale);
+    SplitString(spec.oversampleRegions, options->psfOversampleRegions);
+    options->nOversampleRegions = (int)options->psfOversampleRegions.size();
+    options->oversampleRegionSet = true;
+    status = GetOversampledPsfInfo(options, 0, 0, workload->psfOversamplingInfoVect);
+    if (status < 0) {
+      delete workload;
+      return NULL;
+    }
+    workload->description += PrintToString(", oversampled PSF %s (x%d) for %d region(s)",
+    						spec.oversampledPsfFile, spec.oversamplingScale,
+    						options->nOversampleRegions);
+  }
+
+  return workload;
+}
+
+
+
+/* ---------------- FUNCTION: CreateWorkloadModel ---------------------- */
+/// Creates and sets up a ModelObject instance for fitting workload's image with
+/// nThreads threads; returns NULL on failure.
+ModelObject * CreateWorkloadModel( Workload *workload, int nThreads, bool useCash )
+{
+  ModelObject  *theModel;
+  vector<int>  nColumnsRowsVect;
+  int  status;
+
+  workload->options->maxThreads = nThreads;
+  workload->options->maxThreadsSet = true;
+  workload->options->useCashStatistic = useCash;
+  nColumnsRowsVect.push_back(workload->nColumns);
+  nColumnsRowsVect.push_back(workload->nRows);
+  nColumnsRowsVect.push_back(workload->nColumns_psf);
+  nColumnsRowsVect.push_back(workload->nRows_psf);
+  theModel = SetupModelObject(workload->options, nColumnsRowsVect, workload->dataPixels,
+  							workload->psfPixels, workload->maskPixels, NULL,
+  							workload->psfOversamplingInfoVect);
+  // AddMaskVector converts the mask in place to good = 1, bad = 0, which is how
+  // later models for this workload must interpret it
+  workload->options->maskFormat = MASK_ZERO_IS_BAD;
+
+  status = AddFunctions(theModel, workload->functionList, workload->functionLabelList,
+  						workload->functionSetIndices, true);
+  if ((status < 0) || (theModel->GetNParams() != (int)workload->parameterList.size())) {
+    fprintf(stderr, "*** ERROR: Failure adding functions for workload %s!\n\n",
+    		workload->name.c_str());
+    delete theModel;
+    return NULL;
+  }
+  if (theModel->FinalSetupForFitting() < 0) {
+    fprintf(stderr, "*** ERROR: Failure in ModelObject::FinalSetupForFitting!\n\n");
+    delete theModel;
+    return NULL;
+  }
+  theModel->AddParameterInfo(workload->parameterInfo);
+
+  return theModel;
+}
+
+
+
+/* ---------------- DESTRUCTOR: Workload ------------------------------- */
+
+Workload::~Workload( )
+{
+  // images were allocated in ReadImageAsVector()
+  if (dataPixels != NULL)
+    fftw_free(dataPixels);
+  if (psfPixels != NULL)
+    fftw_free(psfPixels);
+  if (maskPixels != NULL)
+    fftw_free(maskPixels);
+  for (int i = 0; i < (int)psfOversamplingInfoVect.size(); i++)
+    delete psfOversamplingInfoVect[i];
+}
+
+
+
+/* ---------------- FUNCTION: ProcessInput ----------------------------- */
+
+void ProcessInput( int argc, char *argv[], benchmarkOptions *theOptions )
+{
+  CLineParser *optParser = new CLineParser();
+  vector<string>  threadStrings;
+
+  /* SET THE USAGE/HELP   */
+  optParser->AddUsageLine("Usage: ");
+  optParser->AddUsageLine("   benchmark [options]");
+  optParser->AddUsageLine(" -h  --help                   Prints this help");
+  optParser->AddUsageLine("     --tests-dir <dir>        Directory with test images and config files [default = tests]");
+  optParser->AddUsageLine(" -o  --output <file.json>     Output file for results [default = benchmark_results.json]");
+  optParser->AddUsageLine("     --threads <n1,n2,...>    Comma-separated list of thread counts");
+  optParser->AddUsageLine("                              [default = 1,2,4,... up to # of hardware threads]");
+  optParser->AddUsageLine("     --only <string>          Only run benchmarks whose names contain string");
+  optParser->AddUsageLine("                              (e.g., \"convolver\", \"getvalue/Sersic\")");
+  optParser->AddUsageLine("     --quick                  Fewer and shorter runs (and fewer convolver sizes)");
+  optParser->AddUsageLine("");
+
+  optParser->AddFlag("help", "h");
+  optParser->AddFlag("quick");
+  optParser->AddOption("tests-dir");
+  optParser->AddOption("output", "o");
+  optParser->AddOption("threads");
+  optParser->AddOption("only");
+
+  /* parse the command line:  */
+  optParser->ParseCommandLine( argc, argv );
+
+  if (optParser->FlagSet("help")) {
+    optParser->PrintUsage();
+    delete optParser;
+    exit(1);
+  }
+  if (optParser->FlagSet("quick"))
+    theOptions->quickMode = true;
+  if (optParser->OptionSet("tests-dir"))
+    theOptions->testsDir = optParser->GetTargetString("tests-dir");
+  if (optParser->OptionSet("output"))
+    theOptions->outputFileName = optParser->GetTargetString("output");
+  if (optParser->OptionSet("only"))
+    theOptions->nameFilter = optParser->GetTargetString("only");
+  if (optParser->OptionSet("threads")) {
+    SplitString(optParser->GetTargetString("threads"), threadStrings, ",");
+    for (int i = 0; i < (int)threadStrings.size(); i++) {
+      if (NotANumber(threadStrings[i].c_str(), 0, kPosInt)) {
+        fprintf(stderr, "*** ERROR: threads should be a list of positive integers!\n");
+        delete optParser;
+        exit(1);
+      }
+      theOptions->threadCounts.push_back(atoi(threadStrings[i].c_str()));
+    }
+    if (theOptions->threadCounts.empty()) {
+      fprintf(stderr, "*** ERROR: no thread counts supplied!\n");
+      delete optParser;
+      exit(1);
+    }
+  }
+
+  delete optParser;
+}
+
+
+
+/* END OF FILE: benchmark_main.cpp ------------------------------------- */
@@ -0,0 +1,115 @@
+// Code for timing the overhead of the Differential Evolution solver itself (trial
+// generation, bounds handling, and selection), using a trivial energy function
+// (the sphere function) so that the solver's own work dominates.
+//
+// Times the (candidate-at-a-time) trial generation with both the Mersenne Twister
+// and Philox RNGs.
+//
+// Usage: de_timing [nDim] [nGenerations]
+
+
+
+/* ------------------------ Include Files (Header Files )--------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>   // for timing-related functions and structs
+
+#include "definitions.h"
+#include "DESolver.h"
+
+
+/* ---------------- Definitions ---------------------------------------- */
+
+#define DEFAULT_N_DIM           30
+#define DEFAULT_N_GENERATIONS   1000
+#define RNG_SEED                1234
+
+
+
+/* ------------------- Function Prototypes ----------------------------- */
+
+double TimeSolver( int nDim, int nGenerations, int rngType, double *finalEnergy );
+
+
+
+// Minimal DESolver subclass: sum of squares (minimum = 0 at the origin)
+class SphereSolver : public DESolver
+{
+public:
+  SphereSolver( int dim, int popSize ) : DESolver(dim, popSize) { ; }
+
+  double EnergyFunction( double *trial, bool &bAtSolution )
+  {
+    double  sum = 0.0;
+    for (int i = 0; i < nDim; i++)
+      sum += trial[i]*trial[i];
+    return sum;
+  }
+};
+
+
+
+/* ---------------- MAIN ----------------------------------------------- */
+
+int main( int argc, char *argv[] )
+{
+  int  nDim = DEFAULT_N_DIM;
+  int  nGenerations = DEFAULT_N_GENERATIONS;
+  double  microsecsPerGen, finalEnergy;
+  const char  *rngNames[2] = {"Mersenne Twister", "Philox"};
+
+  if (argc > 1)
+    nDim = atoi(argv[1]);
+  if (argc > 2)
+    nGenerations = atoi(argv[2]);
+  if ((nDim < 2) || (nGenerations < 1)) {
+    fprintf(stderr, "Usage: de_timing [nDim] [nGenerations]\n");
+    exit(1);
+  }
+
+  printf("DE solver overhead: nDim = %d, population = %d, %d generations\n\n", nDim,
+  		10*nDim, nGenerations);
+  printf("%-18s %14s %16s\n", "RNG", "usec/gen", "final energy");
+  for (int rngType = RNG_MERSENNE_TWISTER; rngType <= RNG_PHILOX; rngType++) {
+    microsecsPerGen = TimeSolver(nDim, nGenerations, rngType, &finalEnergy);
+    printf("%-18s %14.3f %16.6e\n", rngNames[rngType], microsecsPerGen, finalEnergy);
+  }
+
+  return 0;
+}
+
+
+
+/* ---------------- FUNCTION: TimeSolver ------------------------------- */
+/// Runs the solver for exactly nGenerations (tolerance = 0 disables the convergence
+/// test) and returns the mean time per generation in microseconds.
+double TimeSolver( int nDim, int nGenerations, int rngType, double *finalEnergy )
+{
+  struct timeval  timer_start, timer_end;
+  double  *minBounds = new double[nDim];
+  double  *maxBounds = new double[nDim];
+  double  time_elapsed;
+
+  for (int i = 0; i < nDim; i++) {
+    minBounds[i] = -5.0;
+    maxBounds[i] = 5.0;
+  }
+  SphereSolver  solver(nDim, 10*nDim);
+  solver.Setup(minBounds, maxBounds, stRand1Exp, 0.85, 1.0, 0.0, RNG_SEED, false, rngType);
+
+  gettimeofday(&timer_start, NULL);
+  solver.Solve(nGenerations, 0);
+  gettimeofday(&timer_end, NULL);
+  time_elapsed = (timer_end.tv_sec - timer_start.tv_sec)*1e6
+  				+ (timer_end.tv_usec - timer_start.tv_usec);
+  *finalEnergy = solver.Energy();
+
+  delete [] minBounds;
+  delete [] maxBounds;
+  return time_elapsed/nGenerations;
+}
+
+
+
+/* END OF FILE: de_timing_main.cpp ------------------------------------- */
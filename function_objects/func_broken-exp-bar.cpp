@@ -46,6 +46,7 @@
 #include <string>
 
 #include "func_broken-exp-bar.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -53,6 +54,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 7;
 const char  PARAM_LABELS[][20] = {"PA", "I_0", "h1", "h2", "r_break", "alpha", "sigma"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_INV_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Broken-Exponential-Bar function";
 //const char  SHORT_FUNCTION_NAME[] = "BrokenExponentialBar";
 const double  DEG2RAD = 0.017453292519943295;
@@ -75,6 +79,7 @@ BrokenExponentialBar::BrokenExponentialBar( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -151,6 +156,7 @@ double BrokenExponentialBar::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
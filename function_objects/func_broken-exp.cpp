@@ -45,6 +45,7 @@
 #include <string>
 
 #include "func_broken-exp.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -52,6 +53,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 7;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "h1", "h2", "r_break", "alpha"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_INV_LENGTH};
 const char  FUNCTION_NAME[] = "Broken-Exponential function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -73,6 +77,7 @@ BrokenExponential::BrokenExponential( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -105,6 +110,34 @@ void BrokenExponential::Setup( double params[], int offsetIndex, double xc, doub
   double  S = pow( (1.0 + exp(-alpha*r_b)), (-exponent) );
   I_0_times_S = I_0 * S;
   delta_Rb_scaled = r_b/h2 - r_b/h1;
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &BrokenExponential::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool BrokenExponential::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int BrokenExponential::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -146,6 +179,7 @@ double BrokenExponential::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -166,6 +200,8 @@ double BrokenExponential::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
@@ -26,6 +26,7 @@
 // CLASS BrokenExponential:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 /// Class for image function with elliptical isophotes and broken-exponential profile
@@ -40,6 +41,8 @@ class BrokenExponential : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -55,6 +58,7 @@ class BrokenExponential : public FunctionObject
     double  x0, y0, PA, ell, I_0, h1, h2, r_b, alpha;   // parameters
     double  q, PA_rad, cosPA, sinPA;   // other useful quantities
     double  exponent, I_0_times_S, delta_Rb_scaled;   // other useful quantities
+    RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
 
 #endif   // _FUNC_BROKENEXP_H_
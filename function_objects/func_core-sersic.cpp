@@ -49,6 +49,7 @@
 
 #include "func_core-sersic.h"
 #include "helper_funcs.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -56,6 +57,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 8;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "n", "I_b", "r_e", "r_b", "alpha", "gamma"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "Core-Sersic function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -81,6 +85,7 @@ CoreSersic::CoreSersic( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -111,6 +116,34 @@ void CoreSersic::Setup( double params[], int offsetIndex, double xc, double yc )
   bn = Calculate_bn(n);
   invn = 1.0 / n;
   Iprime = I_b * pow(2.0, -gamma/alpha) * exp( bn * pow( pow(2.0, 1.0/alpha) * r_b/r_e, (1.0/n) ));
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &CoreSersic::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool CoreSersic::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int CoreSersic::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -154,6 +187,7 @@ double CoreSersic::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -174,6 +208,8 @@ double CoreSersic::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
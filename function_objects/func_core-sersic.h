@@ -24,6 +24,7 @@
 // CLASS CoreSersic:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 
@@ -39,6 +40,8 @@ class CoreSersic : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -54,4 +57,5 @@ class CoreSersic : public FunctionObject
   double  x0, y0, PA, ell, n, I_b, r_e, r_b, alpha, gamma;   // parameters
   double  bn, invn, Iprime;
   double  q, PA_rad, cosPA, sinPA;   // other useful (shape-related) quantities
+  RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
@@ -46,6 +46,7 @@
 
 #include "func_double-broken-exp.h"
 #include "helper_funcs.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -54,6 +55,10 @@ using namespace std;
 const int   N_PARAMS = 10;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "h1", "h2", "h3",
 								"r_break1", "r_break2", "alpha1", "alpha2"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_INV_LENGTH,
+				PARAM_SCALING_INV_LENGTH};
 const char  FUNCTION_NAME[] = "Double-Broken-Exponential function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -79,6 +84,7 @@ DoubleBrokenExponential::DoubleBrokenExponential( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -116,6 +122,34 @@ void DoubleBrokenExponential::Setup( double params[], int offsetIndex, double xc
   I_0_times_S = I_0 * S;
   delta_Rb1_scaled = r_b1/h2 - r_b1/h1;
   delta_Rb2_scaled = r_b2/h3 - r_b2/h2;
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &DoubleBrokenExponential::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool DoubleBrokenExponential::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int DoubleBrokenExponential::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -170,6 +204,7 @@ double DoubleBrokenExponential::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -190,6 +225,8 @@ double DoubleBrokenExponential::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
@@ -25,6 +25,7 @@
 // CLASS DoubleBrokenExponential:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 /// Class for image function with elliptical isophotes and broken-exponential profile
@@ -39,6 +40,8 @@ class DoubleBrokenExponential : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -54,4 +57,5 @@ class DoubleBrokenExponential : public FunctionObject
     double  x0, y0, PA, ell, I_0, h1, h2, h3, r_b1, r_b2, alpha1, alpha2;   // parameters
     double  q, PA_rad, cosPA, sinPA;   // other useful quantities
     double  exponent2, exponent3, I_0_times_S, delta_Rb1_scaled, delta_Rb2_scaled;   // other useful quantities
+    RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
@@ -42,6 +42,9 @@
  * convert it to radians] relative to +x axis.
  *
  *   MODIFICATION HISTORY:
+ *     [v0.4]  Oct 2026: Radial term now uses the tabulated x*K_1(x) approximation in
+ * helper_funcs_bessel.cpp instead of gsl_sf_bessel_K1; sech^alpha computed
+ * without pow() for n = 1 and n = 2.
  *     [v0.3]  28 Oct 2012: Changed input parameters to use n instead of alpha,
  * to better match original van der Kruit specification; internally, we still
  * use alpha = 2/n.
@@ -77,7 +80,8 @@
 #include <string>
 
 #include "func_edge-on-disk.h"
-#include "gsl/gsl_sf_bessel.h"
+#include "helper_funcs_bessel.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -85,6 +89,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "L_0", "h", "n", "z_0"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_INV_LENGTH,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_NONE, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Edge-on Disk function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -108,6 +114,7 @@ EdgeOnDisk::EdgeOnDisk( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -146,19 +153,24 @@ void EdgeOnDisk::Setup( double params[], int offsetIndex, double xc, double yc )
 // NOTE: This function requires that both r and z be *non-negative*!
 double EdgeOnDisk::CalculateIntensity( double r, double z )
 {
-  double  verticalScaling, sech, I_radial;
+  double  verticalScaling, sech, expTerm, I_radial;
   
-  // special case of r = 0, to short-circuit 0*infty problem
-  if (r == 0.0)
-    I_radial = Sigma_00;
-  else {
-    double  scaledR = r/h;
-    I_radial = Sigma_00 * scaledR * gsl_sf_bessel_K1(scaledR);
-  }
+  // (XTimesBesselK1 handles the r = 0 case [x*K_1(x) --> 1])
+  I_radial = Sigma_00 * XTimesBesselK1(r/h);
 
-  // if combination of n*z/z_0 is large enough, switch to simple exponential,
-  // otherwise the cosh function will eventually overflow
-  if ((z/scaledZ0) > COSH_LIMIT)
+  // For the common cases of n = 1 (sech^2) and n = 2 (sech), write sech in terms
+  // of exp(-z/scaledZ0), which avoids the pow() call and can't overflow;
+  // otherwise, if combination of n*z/z_0 is large enough, switch to simple
+  // exponential, since the cosh function will eventually overflow
+  if (alpha == 2.0) {
+    expTerm = exp(-2.0*z/scaledZ0);
+    verticalScaling = 4.0*expTerm / ((1.0 + expTerm)*(1.0 + expTerm));
+  }
+  else if (alpha == 1.0) {
+    expTerm = exp(-z/scaledZ0);
+    verticalScaling = 2.0*expTerm / (1.0 + expTerm*expTerm);
+  }
+  else if ((z/scaledZ0) > COSH_LIMIT)
     verticalScaling = two_to_alpha * exp(-z/z_0);
   else {
     sech = 1.0 / cosh(z/scaledZ0);
@@ -187,6 +199,7 @@ double EdgeOnDisk::GetValue( double x, double y )
 
   nSubsamples = CalculateSubsamples(R, z);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
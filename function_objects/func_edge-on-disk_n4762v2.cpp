@@ -50,6 +50,7 @@
 #include <string>
 
 #include "func_edge-on-disk_n4762v2.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -57,6 +58,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 7;
 const char  PARAM_LABELS[][20] = {"PA", "I_0", "h2", "a_rb", "b_rb", "alpha", "h_z"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_NONE,
+				PARAM_SCALING_INV_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Edge-on Disk (NGC 4762 variant 2) function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -78,6 +82,7 @@ EdgeOnDiskN4762v2::EdgeOnDiskN4762v2( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -150,6 +155,7 @@ double EdgeOnDiskN4762v2::GetValue( double x, double y )
 
   nSubsamples = CalculateSubsamples(R, z);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -49,6 +49,7 @@
 #include <string>
 
 #include "func_edge-on-ring.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -56,6 +57,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "I_0", "r", "sigma_r", "sigma_z"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Edge-on Ring function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -77,6 +80,7 @@ EdgeOnRing::EdgeOnRing( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -144,6 +148,7 @@ double EdgeOnRing::GetValue( double x, double y )
 
   nSubsamples = CalculateSubsamples(R, z);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
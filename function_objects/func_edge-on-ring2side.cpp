@@ -47,6 +47,7 @@
 #include <string>
 
 #include "func_edge-on-ring2side.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -54,6 +55,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "I_0", "r", "sigma_r_in", "sigma_r_out", "sigma_z"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Edge-on Ring function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -75,6 +79,7 @@ EdgeOnRing2Side::EdgeOnRing2Side( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -162,6 +167,7 @@ double EdgeOnRing2Side::GetValue( double x, double y )
 
   nSubsamples = CalculateSubsamples(R, z);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
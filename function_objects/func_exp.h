@@ -36,6 +36,13 @@ class Exponential : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    void  GetRowValues( double x, double y, int nValues, double *outputValues );
+    bool  GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+    							double& sin_PA, double& axisRatio );
+    void  GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+    							double *outputValues );
+    bool GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+    					double& yMin, double& yMax );
     bool CanCalculateTotalFlux(  );
     double TotalFlux( );
    // No destructor for now
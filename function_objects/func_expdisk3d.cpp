@@ -84,6 +84,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "inc", "J_0", "h", "n", "z_0"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_INV_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "ExponentialDisk3D function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -116,6 +119,7 @@ ExponentialDisk3D::ExponentialDisk3D( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
 
   // Stuff related to GSL integration  
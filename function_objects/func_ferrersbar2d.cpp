@@ -51,6 +51,7 @@
 
 #include "func_ferrersbar2d.h"
 #include "helper_funcs.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -58,6 +59,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "c0", "n", "I_0", "a_bar"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "2D version of Ferrers-ellipsoid function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -79,6 +82,7 @@ FerrersBar2D::FerrersBar2D( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -167,6 +171,7 @@ double FerrersBar2D::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -59,6 +59,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 8;
 const char  PARAM_LABELS[][20] = {"PA", "inc", "barPA", "J_0", "R_bar", "q", "q_z", "n"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_INV_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "FerrersBar3D function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -90,6 +93,7 @@ FerrersBar3D::FerrersBar3D( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
 
   // Stuff related to GSL integration  
@@ -35,6 +35,7 @@
 #include <string>
 
 #include "func_flat-exp.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -42,6 +43,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "h", "r_break", "alpha"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_INV_LENGTH};
 const char  FUNCTION_NAME[] = "FlatExponential function";
 //const char  SHORT_FUNCTION_NAME[] = "FlatExponential";
 const double  DEG2RAD = 0.017453292519943295;
@@ -64,6 +67,7 @@ FlatExponential::FlatExponential( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -134,6 +138,7 @@ double FlatExponential::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -47,6 +47,7 @@
 #include <tuple>
 
 #include "func_flatbar.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -55,6 +56,9 @@ using namespace std;
 const int   N_PARAMS = 8;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "deltaPA_max", "I_0", "h1", "h2", 
 									"r_break", "alpha"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_INV_LENGTH};
 const char  FUNCTION_NAME[] = "FlatBar function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -79,6 +83,7 @@ FlatBar::FlatBar( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -158,6 +163,7 @@ double FlatBar::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -40,6 +40,7 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 1;
 const char  PARAM_LABELS[][20] = {"I_sky"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "Flat sky background function";
 
 const char FlatSky::className[] = "FlatSky";
@@ -59,6 +60,7 @@ FlatSky::FlatSky( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
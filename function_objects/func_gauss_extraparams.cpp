@@ -43,6 +43,7 @@
 
 #include "utilities_pub.h"
 #include "func_gauss_extraparams.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -50,6 +51,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 4;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "sigma"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Elliptical Gaussian function [test ExtraParams version]";
 const double PI = 3.14159265358979;
 const double  DEG2RAD = 0.017453292519943295;
@@ -72,6 +75,7 @@ GaussianExtraParams::GaussianExtraParams( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -168,6 +172,7 @@ double GaussianExtraParams::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -46,6 +46,8 @@
 #include <string>
 
 #include "func_gaussian-ring-az.h"
+#include "simd_math.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -53,6 +55,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "A_maj", "A_min_rel", "R_ring", "sigma_r"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Gaussian Ring with azimuthal variation function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -74,6 +78,7 @@ GaussianRingAz::GaussianRingAz( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -141,6 +146,7 @@ double GaussianRingAz::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -170,6 +176,31 @@ double GaussianRingAz::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+// Batched version of GetValue() for the row segment of pixels (x,y), (x+1,y), ...,
+// using the vectorizable math functions in simd_math.h. (No subsampling is done
+// for this function, so there's no need to fall back to GetValue().)
+void GaussianRingAz::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  // local copies of data members, so the compiler can tell they aren't modified
+  // by writes to outputValues
+  double  x_0 = x0, y_diff = y - y0, cos_PA = cosPA, sin_PA = sinPA, q_ = q;
+  double  PA_rad_ = PA_rad, A_mid_ = A_mid, delta_A = deltaA, R_ring_ = R_ring;
+  double  twosigma_sq = twosigma_squared;
+  double  x_diff, xp, yp_scaled, r_diff, theta_ellipse, A;
+  
+  for (int j = 0; j < nValues; j++) {
+    x_diff = (x + j) - x_0;
+    xp = x_diff*cos_PA + y_diff*sin_PA;
+    yp_scaled = (-x_diff*sin_PA + y_diff*cos_PA)/q_;
+    r_diff = sqrt(xp*xp + yp_scaled*yp_scaled) - R_ring_;
+    theta_ellipse = PA_rad_ - SimdAtan2(y_diff, x_diff);
+    A = A_mid_ + delta_A*SimdCos(2*theta_ellipse);
+    outputValues[j] = A * SimdExp(-(r_diff*r_diff)/twosigma_sq);
+  }
+}
+
+
 /* ---------------- PROTECTED METHOD: CalculateSubsamples ------------------------- */
 // Function which determines the number of pixel subdivisions for sub-pixel integration,
 // given that the current pixel is a (scaled) distance of r away from the center of the
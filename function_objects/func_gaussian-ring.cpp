@@ -46,6 +46,7 @@
 #include <string>
 
 #include "func_gaussian-ring.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -53,6 +54,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "A", "R_ring", "sigma_r"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Gaussian Ring function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -74,6 +77,7 @@ GaussianRing::GaussianRing( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -133,6 +137,7 @@ double GaussianRing::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -48,6 +48,9 @@
 #include <string>
 
 #include "func_gaussian.h"
+#include "helper_funcs.h"
+#include "simd_math.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -55,6 +58,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 4;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "sigma"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Elliptical Gaussian function";
 const double PI = 3.14159265358979;
 const double  DEG2RAD = 0.017453292519943295;
@@ -77,6 +82,7 @@ Gaussian::Gaussian( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -136,6 +142,7 @@ double Gaussian::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -163,6 +170,56 @@ double Gaussian::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+// Batched version of GetValue() for the row segment of pixels (x,y), (x+1,y), ...
+// Radii are computed a block at a time and passed to GetRowValuesFromRadii().
+void Gaussian::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  double  rBlock[SIMD_MATH_BLOCK_SIZE];
+  int  nBlock;
+  
+  for (int start = 0; start < nValues; start += SIMD_MATH_BLOCK_SIZE) {
+    nBlock = min(SIMD_MATH_BLOCK_SIZE, nValues - start);
+    EllipticalRadii(x + start, y, nBlock, x0, y0, cosPA, sinPA, q, rBlock);
+    GetRowValuesFromRadii(x + start, y, nBlock, rBlock, outputValues + start);
+  }
+}
+
+
+/* ---------------- PUBLIC METHOD: GetEllipticalGeometry --------------- */
+// Returns the current center, orientation, and axis ratio (this function's
+// intensity depends only on the standard elliptical radius).
+bool Gaussian::GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+								double& sin_PA, double& axisRatio )
+{
+  xCenter = x0;
+  yCenter = y0;
+  cos_PA = cosPA;
+  sin_PA = sinPA;
+  axisRatio = q;
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetRowValuesFromRadii --------------- */
+// Computes intensities for the row segment of pixels (x,y), (x+1,y), ... given
+// their elliptical radii, using the vectorizable math functions in simd_math.h;
+// pixels which need subsampling are then recomputed via GetValue().
+void Gaussian::GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+								double *outputValues )
+{
+  // local copies of data members, so the compiler can tell they aren't modified
+  // by writes to outputValues
+  double  I_0_ = I_0, twosigma_sq = twosigma_squared;
+
+  for (int k = 0; k < nValues; k++)
+    outputValues[k] = I_0_ * SimdExp(-(radii[k]*radii[k])/twosigma_sq);
+  for (int k = 0; k < nValues; k++) {
+    if (CalculateSubsamples(radii[k]) > 1)
+      outputValues[k] = GetValue(x + k, y);
+  }
+}
+
 /* ---------------- PROTECTED METHOD: CalculateSubsamples ------------------------- */
 // Function which determines the number of pixel subdivisions for sub-pixel integration,
 // given that the current pixel is a distance of r away from the center of the
@@ -187,6 +244,23 @@ int Gaussian::CalculateSubsamples( double r )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetBoundingBox ---------------------- */
+// Returns bounding box of the ellipse outside of which the intensity is
+// < relThreshold times the central intensity.
+
+bool Gaussian::GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+							double& yMin, double& yMax )
+{
+  if ((relThreshold <= 0.0) || (relThreshold >= 1.0))
+    return false;
+  // I(r) = I_0 exp(-r^2 / 2 sigma^2) falls to relThreshold * I_0 at
+  // r = sigma * sqrt(2 ln(1/relThreshold))
+  double  r_max = sigma * sqrt(2.0*log(1.0/relThreshold));
+  EllipseBoundingBox(x0, y0, r_max, q, cosPA, sinPA, xMin, xMax, yMin, yMax);
+  return true;
+}
+
+
 /* ---------------- PUBLIC METHOD: CanCalculateTotalFlux --------------- */
 
 bool Gaussian::CanCalculateTotalFlux( )
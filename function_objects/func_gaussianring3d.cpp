@@ -63,6 +63,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 8;
 const char  PARAM_LABELS[][20] = {"PA", "inc", "PA_ring", "ell", "J_0", "a_ring", "sigma", "h_z"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_INV_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "GaussianRing3D function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -93,6 +96,7 @@ GaussianRing3D::GaussianRing3D( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
 
   // Stuff related to GSL integration
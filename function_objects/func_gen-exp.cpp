@@ -48,6 +48,7 @@
 #include <string>
 
 #include "func_gen-exp.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -55,6 +56,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "c0", "I_0", "h"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH};
 const char FUNCTION_NAME[] = "Generalized-ellipse exponential function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -76,6 +79,7 @@ GenExponential::GenExponential( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -102,6 +106,34 @@ void GenExponential::Setup( double params[], int offsetIndex, double xc, double
   // generalized ellipse exponents
   ellExp = c0 + 2.0;
   invEllExp = 1.0 / ellExp;
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &GenExponential::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool GenExponential::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int GenExponential::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -146,6 +178,7 @@ double GenExponential::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -164,6 +197,8 @@ double GenExponential::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
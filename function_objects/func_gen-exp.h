@@ -20,6 +20,7 @@
 // CLASS GenExponential:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 
@@ -35,6 +36,8 @@ class GenExponential : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -49,4 +52,5 @@ class GenExponential : public FunctionObject
     double  x0, y0, PA, ell, c0, I_0, h;   // parameters
     double  q, PA_rad, cosPA, sinPA;   // other useful quantities (basic geometry)
     double  ellExp, invEllExp;         // more useful quantities
+    RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
@@ -50,6 +50,8 @@
 
 #include "func_gen-sersic.h"
 #include "helper_funcs.h"
+#include "simd_math.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -57,6 +59,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "c0", "n", "I_e", "r_e"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Generalized-ellipse Sersic function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -78,6 +82,7 @@ GenSersic::GenSersic( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -160,6 +165,7 @@ double GenSersic::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -185,6 +191,41 @@ double GenSersic::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+// Batched version of GetValue() for the row segment of pixels (x,y), (x+1,y), ...
+// Radii and intensities are computed a block at a time using the vectorizable
+// math functions in simd_math.h; pixels which need subsampling are then recomputed
+// via GetValue().
+void GenSersic::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  // local copies of data members, so the compiler can tell they aren't modified
+  // by writes to outputValues
+  double  x_0 = x0, y_diff = y - y0, cos_PA = cosPA, sin_PA = sinPA, q_ = q;
+  double  ell_exp = ellExp, inv_ell_exp = invEllExp;
+  double  I_e_ = I_e, r_e_ = r_e, b_n = bn, inv_n = invn;
+  double  rBlock[SIMD_MATH_BLOCK_SIZE];
+  double  x_diff, xp, yp_scaled, powerSum, *values;
+  int  nBlock;
+  
+  for (int start = 0; start < nValues; start += SIMD_MATH_BLOCK_SIZE) {
+    nBlock = min(SIMD_MATH_BLOCK_SIZE, nValues - start);
+    values = outputValues + start;
+    for (int k = 0; k < nBlock; k++) {
+      x_diff = (x + (start + k)) - x_0;
+      xp = fabs(x_diff*cos_PA + y_diff*sin_PA);
+      yp_scaled = fabs((-x_diff*sin_PA + y_diff*cos_PA)/q_);
+      powerSum = SimdPowFast(xp, ell_exp) + SimdPowFast(yp_scaled, ell_exp);
+      rBlock[k] = SimdPowFast(powerSum, inv_ell_exp);
+      values[k] = I_e_ * SimdExp( -b_n * (SimdPowFast(rBlock[k]/r_e_, inv_n) - 1.0));
+    }
+    for (int k = 0; k < nBlock; k++) {
+      if (CalculateSubsamples(rBlock[k]) > 1)
+        values[k] = GetValue(x + (start + k), y);
+    }
+  }
+}
+
+
 /* ---------------- PROTECTED METHOD: CalculateSubsamples ------------------------- */
 // Function which determines the number of pixel subdivisions for sub-pixel integration,
 // given that the current pixel is a distance of r away from the center of the
@@ -36,6 +36,7 @@ class GenSersic : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    void  GetRowValues( double x, double y, int nValues, double *outputValues );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -23,6 +23,7 @@
 // CLASS ModifiedKing:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 #include <string>
 using namespace std;
 
@@ -39,6 +40,13 @@ class ModifiedKing : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
+    void  GetRowValues( double x, double y, int nValues, double *outputValues );
+    bool  GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+    							double& sin_PA, double& axisRatio );
+    void  GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+    							double *outputValues );
    // No destructor for now
 
     // class method for returning official short name of class
@@ -53,5 +61,6 @@ class ModifiedKing : public FunctionObject
     double  x0, y0, PA, ell, I_0, r_c, r_t, alpha;   // parameters
     double  q, PA_rad, cosPA, sinPA;   // other useful, geometry-related quantities
     double  I_1, one_over_alpha, one_over_rc, constantTerm;   // other useful, profile-related quantities
+    RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
 
@@ -48,14 +48,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <algorithm>
 
 #include "func_king2.h"
+#include "helper_funcs.h"
+#include "simd_math.h"
+#include "profile_counters.h"
 
 using namespace std;
 
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 6;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "r_c", "c", "alpha"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_NONE, PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "Modified King 2 function";
 const double  DEG2RAD = 0.017453292519943295;
 const double PI  =3.14159265358979;
@@ -78,6 +84,7 @@ ModifiedKing2::ModifiedKing2( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -111,6 +118,35 @@ void ModifiedKing2::Setup( double params[], int offsetIndex, double xc, double y
   one_over_rc = 1.0 / r_c;
   constantTerm = 1.0 / pow(1.0 + (r_t/r_c)*(r_t/r_c), one_over_alpha);
   I_1 = I_0 * pow(1.0 - constantTerm, -alpha);
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  // (only needed out to r_t, since intensity = 0 beyond that)
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &ModifiedKing2::CalculateIntensity,
+    				min(r_t, MaxImageRadius(x0, y0, cosPA, sinPA, q)), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool ModifiedKing2::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int ModifiedKing2::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -147,6 +183,7 @@ double ModifiedKing2::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -167,6 +204,8 @@ double ModifiedKing2::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
@@ -174,6 +213,83 @@ double ModifiedKing2::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+/// Batched version of GetValue() for the row segment of pixels (x,y), (x+1,y), ...
+/// Radii are computed a block at a time and passed to GetRowValuesFromRadii().
+void ModifiedKing2::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  double  rBlock[SIMD_MATH_BLOCK_SIZE];
+  int  nBlock;
+  
+  for (int start = 0; start < nValues; start += SIMD_MATH_BLOCK_SIZE) {
+    nBlock = min(SIMD_MATH_BLOCK_SIZE, nValues - start);
+    EllipticalRadii(x + start, y, nBlock, x0, y0, cosPA, sinPA, q, rBlock);
+    GetRowValuesFromRadii(x + start, y, nBlock, rBlock, outputValues + start);
+  }
+}
+
+
+/* ---------------- PUBLIC METHOD: GetEllipticalGeometry --------------- */
+/// Returns the current center, orientation, and axis ratio (this function's
+/// intensity depends only on the standard elliptical radius).
+bool ModifiedKing2::GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+								double& sin_PA, double& axisRatio )
+{
+  xCenter = x0;
+  yCenter = y0;
+  cos_PA = cosPA;
+  sin_PA = sinPA;
+  axisRatio = q;
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetRowValuesFromRadii --------------- */
+/// Computes intensities for the row segment of pixels (x,y), (x+1,y), ... given
+/// their elliptical radii, using the vectorizable math functions in simd_math.h;
+/// pixels which need subsampling are then recomputed via GetValue().
+void ModifiedKing2::GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+								double *outputValues )
+{
+  // local copies of data members, so the compiler can tell they aren't modified
+  // by writes to outputValues
+  double  I_1_ = I_1, r_t_ = r_t, inv_rc = one_over_rc, alpha_ = alpha;
+  double  inv_alpha = one_over_alpha, constant_term = constantTerm;
+  double  r_over_rc, variableTerm, intensity;
+  bool  insideRow = false;
+  
+  // skip the (expensive) intensity calculation if all pixels are outside r_t
+  for (int k = 0; k < nValues; k++) {
+    if (radii[k] < r_t_) {
+      insideRow = true;
+      break;
+    }
+  }
+  if (radialTable.IsActive()) {
+    // use the (optional) radial lookup table where possible
+    for (int k = 0; k < nValues; k++)
+      outputValues[k] = radialTable.Contains(radii[k]) ? radialTable.Interpolate(radii[k])
+      									: CalculateIntensity(radii[k]);
+  }
+  else if (insideRow) {
+    for (int k = 0; k < nValues; k++) {
+      r_over_rc = radii[k] * inv_rc;
+      variableTerm = 1.0 / SimdPowFast(1.0 + r_over_rc*r_over_rc, inv_alpha);
+      // (base of second pow is negative for r > r_t, but result is discarded)
+      intensity = I_1_ * SimdPowFast(variableTerm - constant_term, alpha_);
+      outputValues[k] = (radii[k] < r_t_) ? intensity : 0.0;
+    }
+  }
+  else {
+    for (int k = 0; k < nValues; k++)
+      outputValues[k] = 0.0;
+  }
+  for (int k = 0; k < nValues; k++) {
+    if (CalculateSubsamples(radii[k]) > 1)
+      outputValues[k] = GetValue(x + k, y);
+  }
+}
+
 /* ---------------- PROTECTED METHOD: CalculateSubsamples ------------------------- */
 /// Function which determines the number of pixel subdivisions for sub-pixel integration,
 /// given that the current pixel is a distance of r away from the center of the
@@ -56,6 +56,7 @@
 #include <string>
 
 #include "func_logspiral.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -63,6 +64,9 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int   N_PARAMS = 8;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "m", "i_wind", "I_0", "R_i", "sigma", "gamma"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "Logarithmic Spiral function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -85,6 +89,7 @@ LogSpiral::LogSpiral( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -160,6 +165,7 @@ double LogSpiral::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
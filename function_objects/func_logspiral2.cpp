@@ -60,6 +60,7 @@
 #include <string>
 
 #include "func_logspiral2.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -68,6 +69,9 @@ using namespace std;
 const int   N_PARAMS = 11;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "m", "i_pitch", "R_i", "sigma_az", "gamma",
 								"I_0", "h", "R_max", "sigma_trunc"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Logarithmic Spiral function (inner-Gaussian truncation)";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -90,6 +94,7 @@ LogSpiral2::LogSpiral2( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -188,6 +193,7 @@ double LogSpiral2::GetValue( double x, double y )
     phi = 0.0;
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -56,6 +56,7 @@
 #include <string>
 
 #include "func_logspiral_gauss.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -64,6 +65,9 @@ using namespace std;
 const int   N_PARAMS = 11;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "m", "i_wind", "I_0", "R_i", "sigma", "gamma",
 								"R_max", "sigma_max_in", "sigma_max_out"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Logarithmic Spiral function (2-sided Gaussian radial modulation)";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -86,6 +90,7 @@ LogSpiralGauss::LogSpiralGauss( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -172,6 +177,7 @@ double LogSpiralGauss::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
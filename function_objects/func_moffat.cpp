@@ -55,6 +55,8 @@
 #include <algorithm>
 
 #include "func_moffat.h"
+#include "helper_funcs.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -62,6 +64,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "I_0", "fwhm", "beta"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_LENGTH, PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "Moffat function";
 const double  DEG2RAD = 0.017453292519943295;
 const int  SUBSAMPLE_R = 10;
@@ -83,6 +87,7 @@ Moffat::Moffat( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -110,6 +115,34 @@ void Moffat::Setup( double params[], int offsetIndex, double xc, double yc )
   // compute alpha:
   double  exponent = pow(2.0, 1.0/beta);
   alpha = 0.5*fwhm/sqrt(exponent - 1.0);
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &Moffat::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool Moffat::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int Moffat::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -148,6 +181,7 @@ double Moffat::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -168,6 +202,8 @@ double Moffat::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
@@ -201,4 +237,21 @@ int Moffat::CalculateSubsamples( double r )
 
 
 
+/* ---------------- PUBLIC METHOD: GetBoundingBox ---------------------- */
+// Returns bounding box of the ellipse outside of which the intensity is
+// < relThreshold times the central intensity.
+
+bool Moffat::GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+							double& yMin, double& yMax )
+{
+  if ((relThreshold <= 0.0) || (relThreshold >= 1.0))
+    return false;
+  // I(r) = I_0 / [1 + (r/alpha)^2]^beta falls to relThreshold * I_0 at
+  // r = alpha * sqrt(relThreshold^(-1/beta) - 1)
+  double  r_max = alpha * sqrt(pow(relThreshold, -1.0/beta) - 1.0);
+  EllipseBoundingBox(x0, y0, r_max, q, cosPA, sinPA, xMin, xMax, yMin, yMax);
+  return true;
+}
+
+
 /* END OF FILE: func_moffat.cpp ---------------------------------------- */
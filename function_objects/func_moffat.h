@@ -18,6 +18,7 @@
 // CLASS Moffat:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 
@@ -33,6 +34,10 @@ class Moffat : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
+    bool GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+    					double& yMin, double& yMax );
     // No destructor for now
 
     // class method for returning official short name of class
@@ -48,4 +53,5 @@ class Moffat : public FunctionObject
     double  x0, y0, PA, ell, I_0, fwhm, beta;   // parameters
     double  alpha;
     double  q, PA_rad, cosPA, sinPA;   // other useful (shape-related) quantities
+    RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
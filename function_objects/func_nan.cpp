@@ -39,6 +39,7 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 1;
 const char  PARAM_LABELS[][20] = {"I_sky"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE};
 const char  FUNCTION_NAME[] = "NaN generator function";
 
 const char NaNFunc::className[] = "NaNFunc";
@@ -58,6 +59,7 @@ NaNFunc::NaNFunc( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
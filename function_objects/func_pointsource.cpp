@@ -55,6 +55,7 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 1;
 const char  PARAM_LABELS[][20] = {"I_tot"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_TOTAL_FLUX};
 const char  FUNCTION_NAME[] = "PointSource function";
 const double PI = 3.14159265358979;
 
@@ -75,6 +76,7 @@ PointSource::PointSource( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   oversamplingScale = 1;
@@ -52,6 +52,8 @@
 
 #include "func_sersic.h"
 #include "helper_funcs.h"
+#include "simd_math.h"
+#include "profile_counters.h"
 
 using namespace std;
 
@@ -59,6 +61,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 5;
 const char  PARAM_LABELS[][20] = {"PA", "ell", "n", "I_e", "r_e"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_NONE, PARAM_SCALING_NONE,
+				PARAM_SCALING_NONE, PARAM_SCALING_LENGTH};
 const char  FUNCTION_NAME[] = "Sersic function";
 const double  DEG2RAD = 0.017453292519943295;
 const double PI = 3.14159265358979;
@@ -80,6 +84,7 @@ Sersic::Sersic( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
@@ -106,6 +111,34 @@ void Sersic::Setup( double params[], int offsetIndex, double xc, double yc )
   sinPA = sin(PA_rad);
   bn = Calculate_bn(n);
   invn = 1.0 / n;
+
+  // optional lookup table for the radial profile, if requested via SetExtraParams
+  if (radialTable.IsRequested())
+    radialTable.Build(this, &Sersic::CalculateIntensity,
+    				MaxImageRadius(x0, y0, cosPA, sinPA, q), nImagePixels);
+}
+
+
+/* ---------------- PUBLIC METHOD: HasExtraParams ---------------------- */
+
+bool Sersic::HasExtraParams( )
+{
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// The only extra parameter is "radialTableTol" (see radial_lookup_table.h).
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int Sersic::SetExtraParams( map<string,string>& inputMap )
+{
+  int  status = radialTable.SetExtraParams(inputMap, shortFunctionName);
+
+  if (status > 0)
+    extraParamsSet = true;
+  return status;
 }
 
 
@@ -143,6 +176,7 @@ double Sersic::GetValue( double x, double y )
   
   nSubsamples = CalculateSubsamples(r);
   if (nSubsamples > 1) {
+    ProfileCount(PROFILE_N_SUBSAMPLED_PIXELS);
     // Do subsampling
     // start in center of leftmost/bottommost sub-pixel
     double deltaSubpix = 1.0 / nSubsamples;
@@ -163,6 +197,8 @@ double Sersic::GetValue( double x, double y )
     }
     totalIntensity = theSum / (nSubsamples*nSubsamples);
   }
+  else if (radialTable.Contains(r))
+    totalIntensity = radialTable.Interpolate(r);
   else
     totalIntensity = CalculateIntensity(r);
 
@@ -170,6 +206,64 @@ double Sersic::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+// Batched version of GetValue() for the row segment of pixels (x,y), (x+1,y), ...
+// Radii are computed a block at a time and passed to GetRowValuesFromRadii().
+void Sersic::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  double  rBlock[SIMD_MATH_BLOCK_SIZE];
+  int  nBlock;
+  
+  for (int start = 0; start < nValues; start += SIMD_MATH_BLOCK_SIZE) {
+    nBlock = min(SIMD_MATH_BLOCK_SIZE, nValues - start);
+    EllipticalRadii(x + start, y, nBlock, x0, y0, cosPA, sinPA, q, rBlock);
+    GetRowValuesFromRadii(x + start, y, nBlock, rBlock, outputValues + start);
+  }
+}
+
+
+/* ---------------- PUBLIC METHOD: GetEllipticalGeometry --------------- */
+// Returns the current center, orientation, and axis ratio (this function's
+// intensity depends only on the standard elliptical radius).
+bool Sersic::GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+								double& sin_PA, double& axisRatio )
+{
+  xCenter = x0;
+  yCenter = y0;
+  cos_PA = cosPA;
+  sin_PA = sinPA;
+  axisRatio = q;
+  return true;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetRowValuesFromRadii --------------- */
+// Computes intensities for the row segment of pixels (x,y), (x+1,y), ... given
+// their elliptical radii, using the vectorizable math functions in simd_math.h;
+// pixels which need subsampling are then recomputed via GetValue().
+void Sersic::GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+								double *outputValues )
+{
+  // local copies of data members, so the compiler can tell they aren't modified
+  // by writes to outputValues
+  double  I_e_ = I_e, r_e_ = r_e, b_n = bn, inv_n = invn;
+
+  if (radialTable.IsActive()) {
+    // use the (optional) radial lookup table where possible
+    for (int k = 0; k < nValues; k++)
+      outputValues[k] = radialTable.Contains(radii[k]) ? radialTable.Interpolate(radii[k])
+      				: I_e_ * SimdExp( -b_n * (SimdPowFast(radii[k]/r_e_, inv_n) - 1.0));
+  }
+  else {
+    for (int k = 0; k < nValues; k++)
+      outputValues[k] = I_e_ * SimdExp( -b_n * (SimdPowFast(radii[k]/r_e_, inv_n) - 1.0));
+  }
+  for (int k = 0; k < nValues; k++) {
+    if (CalculateSubsamples(radii[k]) > 1)
+      outputValues[k] = GetValue(x + k, y);
+  }
+}
+
 /* ---------------- PROTECTED METHOD: CalculateSubsamples ------------------------- */
 // Function which determines the number of pixel subdivisions for sub-pixel integration,
 // given that the current pixel is a distance of r away from the center of the
@@ -195,6 +289,23 @@ int Sersic::CalculateSubsamples( double r )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetBoundingBox ---------------------- */
+// Returns bounding box of the ellipse outside of which the intensity is
+// < relThreshold times the central intensity.
+
+bool Sersic::GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+							double& yMin, double& yMax )
+{
+  if ((relThreshold <= 0.0) || (relThreshold >= 1.0))
+    return false;
+  // I(r) = I_e exp(-b_n [(r/r_e)^(1/n) - 1]) falls to relThreshold * I(0) at
+  // r = r_e (ln(1/relThreshold) / b_n)^n
+  double  r_max = r_e * pow(log(1.0/relThreshold)/bn, n);
+  EllipseBoundingBox(x0, y0, r_max, q, cosPA, sinPA, xMin, xMax, yMin, yMax);
+  return true;
+}
+
+
 // Conditional compilation: if GSL library is *not* present, we don't have a
 // Gamma function, so we can't calculate the total flux.
 
@@ -20,6 +20,7 @@
 // CLASS Sersic:
 
 #include "function_object.h"
+#include "radial_lookup_table.h"
 
 
 /// Class for image function with elliptical isophotes and %Sersic profile
@@ -34,6 +35,15 @@ class Sersic : public FunctionObject
     // redefined method/member function:
     void  Setup( double params[], int offsetIndex, double xc, double yc );
     double  GetValue( double x, double y );
+    bool  HasExtraParams( );
+    int  SetExtraParams( map<string, string>& inputMap );
+    void  GetRowValues( double x, double y, int nValues, double *outputValues );
+    bool  GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+    							double& sin_PA, double& axisRatio );
+    void  GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+    							double *outputValues );
+    bool GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+    					double& yMin, double& yMax );
     bool CanCalculateTotalFlux(  );
     double TotalFlux( );
     // No destructor for now
@@ -51,4 +61,5 @@ class Sersic : public FunctionObject
   double  x0, y0, PA, ell, n, I_e, r_e;   // parameters
   double  bn, invn;
   double  q, PA_rad, cosPA, sinPA;   // other useful (shape-related) quantities
+  RadialLookupTable  radialTable;   // optional lookup table for CalculateIntensity()
 };
@@ -39,6 +39,8 @@ using namespace std;
 /* ---------------- Definitions ---------------------------------------- */
 const int  N_PARAMS = 3;
 const char  PARAM_LABELS[][20] = {"I_0", "m_x", "m_y"};
+const int  PARAM_SCALINGS[] = {PARAM_SCALING_NONE, PARAM_SCALING_INV_LENGTH,
+				PARAM_SCALING_INV_LENGTH};
 const char  FUNCTION_NAME[] = "Tilted sky-plane background function";
 
 const char TiltedSkyPlane::className[] = "TiltedSkyPlane";
@@ -58,6 +60,7 @@ TiltedSkyPlane::TiltedSkyPlane( )
   for (int i = 0; i < nParams; i++) {
     paramName = PARAM_LABELS[i];
     parameterLabels.push_back(paramName);
+    parameterScalings.push_back(PARAM_SCALINGS[i]);
   }
   
   doSubsampling = true;
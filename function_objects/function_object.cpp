@@ -44,6 +44,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include <map>
 #include <string>
 
@@ -64,6 +65,8 @@ FunctionObject::FunctionObject( )
   functionName = "Base (undefined) function";
   shortFunctionName = "BaseFunction";
   extraParamsSet = false;
+  imageXMin = imageXMax = imageYMin = imageYMax = 0.0;
+  nImagePixels = 0;
 }
 
 
@@ -91,6 +94,48 @@ void FunctionObject::SetLabel( string &userLabel )
 }
 
 
+/* ---------------- PUBLIC METHOD: SetImageExtent ---------------------- */
+/// Used to specify the range of pixel coordinates (pixel centers) which the function
+/// will be evaluated over, e.g. so that it can decide on the radius range and
+/// usefulness of radial lookup tables (2D functions only).
+void FunctionObject::SetImageExtent( double xMin, double xMax, double yMin, double yMax )
+{
+  imageXMin = xMin;
+  imageXMax = xMax;
+  imageYMin = yMin;
+  imageYMax = yMax;
+  nImagePixels = (long)(xMax - xMin + 1.0) * (long)(yMax - yMin + 1.0);
+}
+
+
+/* ---------------- PROTECTED METHOD: MaxImageRadius ------------------- */
+/// Returns the largest elliptical radius (for the specified center, orientation, and
+/// axis ratio) of any point in the image -- including the outer half of the edge
+/// pixels -- as specified by SetImageExtent; returns 0 if the extent is unknown.
+double FunctionObject::MaxImageRadius( double xc, double yc, double cos_PA, double sin_PA,
+									double axisRatio )
+{
+  double  xCorners[2] = {imageXMin - 0.5, imageXMax + 0.5};
+  double  yCorners[2] = {imageYMin - 0.5, imageYMax + 0.5};
+  double  x_diff, y_diff, xp, yp_scaled, rMax = 0.0;
+
+  if (nImagePixels <= 0)
+    return 0.0;
+  // the elliptical radius is a convex function of (x,y), so its maximum over the
+  // image is at one of the corners
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      x_diff = xCorners[i] - xc;
+      y_diff = yCorners[j] - yc;
+      xp = x_diff*cos_PA + y_diff*sin_PA;
+      yp_scaled = (-x_diff*sin_PA + y_diff*cos_PA)/axisRatio;
+      rMax = fmax(rMax, sqrt(xp*xp + yp_scaled*yp_scaled));
+    }
+  }
+  return rMax;
+}
+
+
 /* ---------------- PUBLIC METHOD: Setup ------------------------------- */
 /// Base method for 2D functions: pass current parameters into the function object,
 /// storing them for when GetValue() is called, and pre-compute useful quantities.
@@ -125,6 +170,30 @@ double FunctionObject::GetValue( double x, double y )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetRowValues ------------------------ */
+/// Base method for 2D functions: computes function values for a row segment of
+/// nValues pixels, starting at pixel coordinates (x,y) and incrementing x by 1.0
+/// for each successive pixel. Derived classes can override this with batched
+/// (vectorizable) versions; this version simply calls GetValue() for each pixel.
+void FunctionObject::GetRowValues( double x, double y, int nValues, double *outputValues )
+{
+  for (int j = 0; j < nValues; j++, x += 1.0)
+    outputValues[j] = GetValue(x, y);
+}
+
+
+/* ---------------- PUBLIC METHOD: GetRowValuesFromRadii --------------- */
+/// Base method for 2D functions: same as GetRowValues, except that the caller
+/// supplies the elliptical radius of each pixel (for use by derived classes which
+/// override GetEllipticalGeometry, so that components sharing the same geometry can
+/// share one set of radius calculations). This version ignores the radii.
+void FunctionObject::GetRowValuesFromRadii( double x, double y, int nValues, 
+											const double *radii, double *outputValues )
+{
+  GetRowValues(x, y, nValues, outputValues);
+}
+
+
 /* ---------------- PUBLIC METHOD: GetValue ---------------------------- */
 /// Base method for 1D functions: Compute and return actual function value at
 /// specified value of independent variable x.
@@ -171,6 +240,20 @@ void FunctionObject::GetParameterNames( vector<string> &paramNameList )
 }
 
 
+/* ---------------- PUBLIC METHOD: GetParameterScalings ---------------- */
+/// Add this function's parameter-scaling types (PARAM_SCALING_xxx) to a vector of 
+/// ints; if the derived class didn't specify them, PARAM_SCALING_UNKNOWN is used
+void FunctionObject::GetParameterScalings( vector<int> &paramScalingList )
+{
+  for (int i = 0; i < nParams; i++) {
+    if ((int)parameterScalings.size() == nParams)
+      paramScalingList.push_back(parameterScalings[i]);
+    else
+      paramScalingList.push_back(PARAM_SCALING_UNKNOWN);
+  }
+}
+
+
 /* ---------------- PUBLIC METHOD: GetNParams -------------------------- */
 /// Get number of parameters used by this function.
 int FunctionObject::GetNParams( )
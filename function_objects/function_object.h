@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 
+#include "definitions.h"   // for PARAM_SCALING_xxx
 #include "psf_interpolators.h"
 
 using namespace std;
@@ -59,6 +60,9 @@ class FunctionObject
     // probably no need to modify this
     virtual void SetLabel( string & userLabel );
 
+    // probably no need to modify this
+    virtual void SetImageExtent( double xMin, double xMax, double yMin, double yMax );
+
     // derived classes will almost certainly modify this, which
     // is used for pre-calculations and convolutions, if any:
     virtual void Setup( double params[], int offsetIndex, double xc, double yc );
@@ -72,6 +76,25 @@ class FunctionObject
     // all derived classes working with 1D data must override this:
     virtual double GetValue( double x );
 
+    // override in derived classes only if said class has a faster (e.g.,
+    // vectorized) way of computing many pixels at once
+    /// Computes values for the nValues pixels (x,y), (x+1,y), ... (x+nValues-1,y),
+    /// storing them in outputValues (default = calls GetValue for each pixel)
+    virtual void GetRowValues( double x, double y, int nValues, double *outputValues );
+
+    // override in derived classes only if said class has the standard elliptical
+    // geometry (intensity depends only on r = sqrt(xp^2 + (yp/q)^2), with xp,yp
+    // computed from x - x0, y - y0 by rotation through cosPA, sinPA)
+    /// Returns true (and the current geometry) if function uses the standard elliptical
+    /// radius, so that precomputed radii can be passed to GetRowValuesFromRadii
+    virtual bool GetEllipticalGeometry( double& xCenter, double& yCenter, double& cos_PA,
+    							double& sin_PA, double& axisRatio ) { return(false); }
+    /// Same as GetRowValues, but with the elliptical radius for each pixel supplied
+    /// in radii (computed by EllipticalRadii, using the GetEllipticalGeometry values)
+    /// (default = ignores radii and calls GetRowValues)
+    virtual void GetRowValuesFromRadii( double x, double y, int nValues, const double *radii,
+    							double *outputValues );
+
     // override in derived classes only if said class is a "background" object
     // which should *not* be used in total flux calculations
     /// Returns true if class can calculate total flux internally
@@ -83,6 +106,14 @@ class FunctionObject
     /// Returns total flux of image function, given most recent parameter values
     virtual double TotalFlux( ) { return -1.0; }
 
+    // override in derived classes only if said class is (effectively) confined to
+    // a finite region, so that it can be skipped for pixels outside that region
+    /// Returns true and sets xMin, etc., to the limits of a box outside of which
+    /// the function is < relThreshold times its peak value, given most recent
+    /// parameter values; returns false (default) if function has no such box
+    virtual bool GetBoundingBox( double relThreshold, double& xMin, double& xMax,
+    							double& yMin, double& yMax ) { return(false); }
+
     // no need to modify this:
     virtual string GetDescription( );
 
@@ -95,6 +126,9 @@ class FunctionObject
     // probably no need to modify this:
     virtual void GetParameterNames( vector<string> &paramNameList );
 
+    // probably no need to modify this (derived classes should fill in parameterScalings):
+    virtual void GetParameterScalings( vector<int> &paramScalingList );
+
     // probably no need to modify this:
     virtual int GetNParams( );
 
@@ -112,8 +146,16 @@ class FunctionObject
     bool  doSubsampling;
     bool  extraParamsSet;
     vector<string>  parameterLabels;
+    vector<int>  parameterScalings;   ///< PARAM_SCALING_xxx type for each parameter
     string  functionName, shortFunctionName, label;
     double  ZP;
+    // range of pixel coordinates the function will be evaluated over (set by
+    // ModelObject; nImagePixels = 0 if unknown)
+    double  imageXMin, imageXMax, imageYMin, imageYMax;
+    long  nImagePixels;
+
+    double MaxImageRadius( double xc, double yc, double cos_PA, double sin_PA,
+    						double axisRatio );
 
     // class member (constant char-vector string) which will hold name of
     // individual class in derived classes
@@ -59,6 +59,41 @@ double GeneralizedRadius( double deltaX, double deltaY, double cosPA, double sin
 }
 
 
+// Computes the radii in the same way (same order of operations) as the GetValue
+// methods of Sersic, Exponential, etc., so the results are identical
+void EllipticalRadii( double x, double y, int nValues, double x0, double y0,
+						double cosPA, double sinPA, double q, double *radii )
+{
+  double  y_diff = y - y0;
+  double  x_diff, xp, yp_scaled;
+
+  for (int k = 0; k < nValues; k++) {
+    x_diff = (x + k) - x0;
+    xp = x_diff*cosPA + y_diff*sinPA;
+    yp_scaled = (-x_diff*sinPA + y_diff*cosPA)/q;
+    radii[k] = sqrt(xp*xp + yp_scaled*yp_scaled);
+  }
+}
+
+
+// The half-widths of the box enclosing an ellipse with semi-axes a, b = q*a are
+// sqrt(a^2 cos^2 + b^2 sin^2) in x and sqrt(a^2 sin^2 + b^2 cos^2) in y. The extra
+// pixel of padding ensures that pixels whose centers lie just outside the ellipse
+// (but which overlap it, and may be subsampled) are still counted as inside the box.
+void EllipseBoundingBox( double x0, double y0, double a, double q, double cosPA,
+						double sinPA, double& xMin, double& xMax, double& yMin, double& yMax )
+{
+  double  b = q*a;
+  double  halfWidth_x = sqrt(a*a*cosPA*cosPA + b*b*sinPA*sinPA) + 1.0;
+  double  halfWidth_y = sqrt(a*a*sinPA*sinPA + b*b*cosPA*cosPA) + 1.0;
+  
+  xMin = x0 - halfWidth_x;
+  xMax = x0 + halfWidth_x;
+  yMin = y0 - halfWidth_y;
+  yMax = y0 + halfWidth_y;
+}
+
+
 double LinearInterp( double r, double r1, double r2, double c01, double c02 )
 {
   if (r < r1)
@@ -28,6 +28,20 @@ double GeneralizedRadius( double deltaX, double deltaY, double cosPA, double sin
 							double q, double ellExponent, double invEllExponent );
 
 
+/// Calculate standard elliptical radii r = sqrt(xp^2 + (yp/q)^2) for the row segment
+/// of nValues pixels (x,y), (x+1,y), ..., storing them in radii; xp and yp are
+/// rotated versions of (x - x0, y - y0), using cosPA and sinPA as for GeneralizedRadius
+void EllipticalRadii( double x, double y, int nValues, double x0, double y0,
+						double cosPA, double sinPA, double q, double *radii );
+
+
+/// Calculate bounding box (xMin, xMax, yMin, yMax) for an ellipse centered at
+/// (x0,y0) with semi-major axis a and axis ratio q, oriented as for
+/// GeneralizedRadius; the box is padded by one pixel on each side
+void EllipseBoundingBox( double x0, double y0, double a, double q, double cosPA,
+						double sinPA, double& xMin, double& xMax, double& yMin, double& yMax );
+
+
 
 // Experimental functions for interpolating c0 values
 
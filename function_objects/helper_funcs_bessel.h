@@ -0,0 +1,15 @@
+// Fast approximations to Bessel functions, for use by some of the FunctionObject
+// subclasses (e.g., EdgeOnDisk)
+
+#ifndef _BESSEL_HELPER_H_
+#define _BESSEL_HELPER_H_
+
+
+/// Calculate x*K_1(x), where K_1 is the modified Bessel function of the second kind,
+/// for x >= 0 [x*K_1(x) --> 1 as x --> 0]. Uses a power-series expansion for x <= 2 and
+/// a tabulated piecewise-Chebyshev approximation for 2 < x <= 700; relative error is
+/// < 1e-14 over that range. Returns 0 for x > 700 (where x*K_1(x) < 1e-300).
+double XTimesBesselK1( double x );
+
+
+#endif  // _BESSEL_HELPER_H_
@@ -0,0 +1,171 @@
+/* FILE: radial_lookup_table.cpp --------------------------------------- */
+/*
+ * Cubic-spline lookup tables for radial intensity profiles (see
+ * radial_lookup_table.h).
+ *
+ * The table starts at rMin (R_TABLE_MIN/2 < rMin <= R_TABLE_MIN, chosen so that
+ * rMax/rMin is a power of 2) and consists of nOctaves octaves [2^k rMin, 2^(k+1) rMin],
+ * each divided into nodesPerOctave intervals of equal width. A single cubic spline
+ * in r passes through all the nodes; its second derivatives M_i at the interior
+ * nodes satisfy the usual equations for unequal spacing h_i = r_{i+1} - r_i:
+ *    h_{i-1} M_{i-1} + 2 (h_{i-1} + h_i) M_i + h_i M_{i+1}
+ *                = 6 [(y_{i+1} - y_i)/h_i - (y_i - y_{i-1})/h_{i-1}] ,
+ * and at the end nodes are linearly extrapolated from their neighbors
+ * (M_0 = 2 M_1 - M_2, etc., since the spacing is uniform within the first and last
+ * octaves) -- which, unlike the "natural" M_0 = 0 condition, keeps the interpolation
+ * accurate near the ends of the table. Within each interval the spline is stored as
+ * a cubic polynomial in t = (r - r_i)/h_i.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "radial_lookup_table.h"
+#include "utilities_pub.h"
+
+using namespace std;
+
+
+/* ---------------- CONSTRUCTOR ---------------------------------------- */
+
+RadialLookupTable::RadialLookupTable( )
+{
+  tolerance = 0.0;
+  active = false;
+  nOctaves = nodesPerOctave = nIntervals = 0;
+  rMin = invRMin = 1.0;
+  rMaxTable = 0.0;
+}
+
+
+/* ---------------- PUBLIC METHOD: SetExtraParams ---------------------- */
+// Returns -1 if map is empty, 0 if map is not empty but no valid parameter
+// name is found. If map has valid parameter name, returns 1 if parameter
+// value is OK, -3 if not.
+int RadialLookupTable::SetExtraParams( map<string,string>& inputMap, const string& funcName )
+{
+  if (inputMap.empty())
+    return -1;
+  map<string,string>::iterator iter;
+  for (iter = inputMap.begin(); iter != inputMap.end(); iter++) {
+    if (iter->first == "radialTableTol") {
+      if ((! IsNumeric(iter->second.c_str())) || (strtod(iter->second.c_str(), NULL) < 0.0)) {
+        fprintf(stderr, "ERROR: radialTableTol for %s must be a number >= 0 (\"%s\")\n",
+        		funcName.c_str(), iter->second.c_str());
+        return -3;
+      }
+      tolerance = strtod(iter->second.c_str(), NULL);
+      printf("   %s::SetExtraParams -- setting radialTableTol = %g\n", funcName.c_str(),
+      		tolerance);
+      return 1;
+    }
+  }
+  fprintf(stderr, "ERROR: unrecognized extra-parameter name (\"%s\") ",
+  		inputMap.begin()->first.c_str());
+  fprintf(stderr, " in %s::SetExtraParams!\n", funcName.c_str());
+  return 0;
+}
+
+
+/* ---------------- PRIVATE METHOD: SetNodes --------------------------- */
+// Computes node radii for nPerOctave intervals per octave, with the table ending
+// at rMax, plus the midpoints between them.
+void RadialLookupTable::SetNodes( double rMax, int nPerOctave )
+{
+  double  octaveStart;
+  int  k;
+
+  nOctaves = (int)ceil(log2(rMax/R_TABLE_MIN));
+  nodesPerOctave = nPerOctave;
+  nIntervals = nOctaves*nodesPerOctave;
+  rMin = ldexp(rMax, -nOctaves);
+  invRMin = 1.0 / rMin;
+  nodeRadii.resize(nIntervals + 1);
+  nodeValues.resize(nIntervals + 1);
+  midpointRadii.resize(nIntervals);
+  coeffs.resize(4*nIntervals);
+  for (int octave = 0; octave < nOctaves; octave++) {
+    octaveStart = ldexp(rMin, octave);
+    for (int i = 0; i < nodesPerOctave; i++) {
+      k = octave*nodesPerOctave + i;
+      nodeRadii[k] = octaveStart*(1.0 + (double)i/nodesPerOctave);
+      midpointRadii[k] = octaveStart*(1.0 + (i + 0.5)/nodesPerOctave);
+    }
+  }
+  nodeRadii[nIntervals] = rMax;
+}
+
+
+/* ---------------- PRIVATE METHOD: ComputeCoefficients ---------------- */
+// Computes the spline coefficients for the current nodeValues.
+void RadialLookupTable::ComputeCoefficients( )
+{
+  int  n = nIntervals;
+  vector<double>  h(n), M(n + 1), lower(n), diag(n), upper(n), rhs(n);
+  const double  *y = nodeValues.data();
+  double  *c, factor;
+  int  i;
+
+  for (i = 0; i < n; i++)
+    h[i] = nodeRadii[i + 1] - nodeRadii[i];
+  // tridiagonal system for M_1 ... M_{n-1}
+  for (i = 1; i < n; i++) {
+    lower[i] = h[i - 1];
+    diag[i] = 2.0*(h[i - 1] + h[i]);
+    upper[i] = h[i];
+    rhs[i] = 6.0*((y[i + 1] - y[i])/h[i] - (y[i] - y[i - 1])/h[i - 1]);
+  }
+  // substitute the end conditions M_0 = 2 M_1 - M_2, M_n = 2 M_{n-1} - M_{n-2}
+  diag[1] += 2.0*lower[1];
+  upper[1] -= lower[1];
+  diag[n - 1] += 2.0*upper[n - 1];
+  lower[n - 1] -= upper[n - 1];
+  // Thomas algorithm: forward elimination, then back substitution
+  for (i = 2; i < n; i++) {
+    factor = lower[i]/diag[i - 1];
+    diag[i] -= factor*upper[i - 1];
+    rhs[i] -= factor*rhs[i - 1];
+  }
+  M[n - 1] = rhs[n - 1]/diag[n - 1];
+  for (i = n - 2; i >= 1; i--)
+    M[i] = (rhs[i] - upper[i]*M[i + 1])/diag[i];
+  M[0] = 2.0*M[1] - M[2];
+  M[n] = 2.0*M[n - 1] - M[n - 2];
+
+  for (i = 0; i < n; i++) {
+    c = &coeffs[4*i];
+    c[0] = y[i];
+    c[1] = (y[i + 1] - y[i]) - h[i]*h[i]*(2.0*M[i] + M[i + 1])/6.0;
+    c[2] = 0.5*h[i]*h[i]*M[i];
+    c[3] = h[i]*h[i]*(M[i + 1] - M[i])/6.0;
+  }
+}
+
+
+/* ---------------- PRIVATE METHOD: ErrorIsAcceptable ------------------ */
+// Returns true if the interpolated values at the midpoints between nodes match
+// the directly computed values (midpointValues) to within the tolerance.
+bool RadialLookupTable::ErrorIsAcceptable( const double *midpointValues )
+{
+  double  maxAbsValue = 0.0;
+  double  interpValue, scale;
+
+  for (int i = 0; i <= nIntervals; i++)
+    maxAbsValue = fmax(maxAbsValue, fabs(nodeValues[i]));
+  for (int i = 0; i < nIntervals; i++) {
+    if (! isfinite(midpointValues[i]))
+      return false;
+    interpValue = Interpolate(midpointRadii[i]);
+    scale = fmax(fabs(midpointValues[i]), TABLE_ERROR_FLOOR*maxAbsValue);
+    if (! (fabs(interpValue - midpointValues[i]) <= tolerance*scale))
+      return false;
+  }
+  return true;
+}
+
+
+/* END OF FILE: radial_lookup_table.cpp -------------------------------- */
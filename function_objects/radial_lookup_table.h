@@ -0,0 +1,150 @@
+// Optional lookup tables for the radial intensity profiles I(r) of FunctionObject
+// subclasses with elliptical isophotes (Sersic, Moffat, etc.), for use when the
+// profile is expensive to compute and the image has many more pixels than the table
+// has nodes.
+//
+// Tables are rebuilt by the function object's Setup() (i.e., once per parameter
+// vector), and cover radii from ~R_TABLE_MIN to the largest elliptical radius in
+// the image. The nodes are approximately logarithmically spaced: the radius range is
+// divided into octaves (factors of 2 in r), each of which has the same number of
+// evenly spaced nodes, so that finding a radius's interval only requires the exponent
+// and mantissa bits of r (no log() call). Within each octave, I(r) is interpolated
+// with a cubic spline. After each build, the interpolation is checked against direct
+// evaluation midway between all pairs of nodes; the number of nodes per octave is
+// doubled until the relative error is below the user's tolerance. If that requires
+// too many nodes (compared to the number of image pixels), the table is not used and
+// the function object falls back to computing I(r) directly.
+//
+// Tables are requested (and their tolerance set) with the "radialTableTol" extra
+// parameter for individual functions in the config file, e.g.
+//    FUNCTION Sersic
+//    ...
+//    OPTIONAL_PARAMS_START
+//    radialTableTol   1e-6
+//    OPTIONAL_PARAMS_END
+
+#ifndef _RADIAL_LOOKUP_TABLE_H_
+#define _RADIAL_LOOKUP_TABLE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "simd_math.h"
+
+using namespace std;
+
+
+/// Tables start at a radius between R_TABLE_MIN/2 and R_TABLE_MIN (smaller radii
+/// are computed directly)
+const double  R_TABLE_MIN = 0.5;
+const int  N_TABLE_NODES_PER_OCTAVE_START = 16;
+const int  N_TABLE_NODES_PER_OCTAVE_MAX = 256;
+/// Tables are only used if the image has at least this many pixels per function
+/// evaluation needed to build the table
+const int  MIN_PIXELS_PER_TABLE_EVALUATION = 16;
+/// When checking the interpolation error, intensities smaller than this fraction of
+/// the table's largest |I| are treated as being equal to this fraction
+const double  TABLE_ERROR_FLOOR = 1.0e-6;
+
+
+/// Cubic-spline lookup table for a radial intensity profile I(r)
+class RadialLookupTable
+{
+  public:
+    RadialLookupTable( );
+
+    /// Handles the "radialTableTol" extra parameter for function class funcName;
+    /// return values are the same as for FunctionObject::SetExtraParams
+    int SetExtraParams( map<string, string>& inputMap, const string& funcName );
+
+    /// Returns true if the user requested a table (nonzero tolerance)
+    bool IsRequested( ) { return (tolerance > 0.0); }
+
+    /// Returns true if the most recent Build() produced a usable table
+    bool IsActive( ) { return active; }
+
+    /// Rebuilds the table for the profile computed by (funcObj->*intensityFunc)(r),
+    /// for radii up to rMax; nPixels is the number of pixels in the image.
+    /// The table is left inactive if it would not meet the tolerance or would not
+    /// be worth its cost.
+    template <class F>
+    void Build( F *funcObj, double (F::*intensityFunc)( double ), double rMax, long nPixels );
+
+    /// Returns true if r is inside the range covered by an active table
+    bool Contains( double r ) const { return ((r >= rMin) && (r <= rMaxTable)); }
+
+    /// Returns interpolated intensity for r (which must satisfy Contains(r))
+    double Interpolate( double r ) const
+    {
+      // r/rMin = 2^octave * (1 + f), with 0 <= f < 1
+      uint64_t  bits = SimdBits(r*invRMin);
+      int  octave = (int)(bits >> 52) - 1023;
+      double  u = nodesPerOctave*(SimdFromBits((bits & 0x000fffffffffffffULL)
+      										| 0x3ff0000000000000ULL) - 1.0);
+      int  i = (int)u;
+      double  t = u - i;
+      i += octave*nodesPerOctave;
+      if (i < 0) {
+        i = 0;
+        t = 0.0;
+      }
+      else if (i >= nIntervals) {
+        i = nIntervals - 1;
+        t = 1.0;
+      }
+      const double  *c = &coeffs[4*i];
+      return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+    }
+
+
+  private:
+    void SetNodes( double rMax, int nPerOctave );
+    void ComputeCoefficients( );
+    bool ErrorIsAcceptable( const double *midpointValues );
+
+    double  tolerance;
+    bool  active;
+    int  nOctaves, nodesPerOctave, nIntervals;
+    double  rMin, invRMin, rMaxTable;
+    vector<double>  nodeRadii, midpointRadii, nodeValues;
+    vector<double>  coeffs;   // 4 polynomial coefficients per interval (in t = 0 to 1)
+};
+
+
+
+template <class F>
+void RadialLookupTable::Build( F *funcObj, double (F::*intensityFunc)( double ), double rMax,
+								long nPixels )
+{
+  vector<double>  midpointValues;
+  long  nEvaluations = 0;
+
+  // table is unused unless every step below succeeds
+  active = false;
+  rMin = 1.0;
+  rMaxTable = 0.0;
+  if ((tolerance <= 0.0) || (rMax <= 2.0*R_TABLE_MIN))
+    return;
+
+  for (int n = N_TABLE_NODES_PER_OCTAVE_START; n <= N_TABLE_NODES_PER_OCTAVE_MAX; n *= 2) {
+    SetNodes(rMax, n);
+    nEvaluations += 2*nIntervals + 1;
+    if (nEvaluations*MIN_PIXELS_PER_TABLE_EVALUATION > nPixels)
+      return;
+    for (int i = 0; i <= nIntervals; i++)
+      nodeValues[i] = (funcObj->*intensityFunc)(nodeRadii[i]);
+    ComputeCoefficients();
+    midpointValues.resize(nIntervals);
+    for (int i = 0; i < nIntervals; i++)
+      midpointValues[i] = (funcObj->*intensityFunc)(midpointRadii[i]);
+    if (ErrorIsAcceptable(midpointValues.data())) {
+      active = true;
+      rMaxTable = rMax;
+      return;
+    }
+  }
+}
+
+
+#endif  // _RADIAL_LOOKUP_TABLE_H_
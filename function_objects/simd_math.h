@@ -0,0 +1,466 @@
+/** @file
+    \brief Vectorizable versions of exp, log, pow, sin/cos, atan2, and sqrt, for
+           use in the batched (row-at-a-time) evaluation paths of FunctionObject
+           subclasses.
+ *
+ *   The scalar kernels (SimdExp, SimdLog, etc.) are branch-free: special cases
+ * are handled by selecting between values rather than by early returns, and
+ * integer/floating-point conversions are done with bit manipulation. This means
+ * that loops calling them over arrays of doubles can be auto-vectorized by the
+ * compiler (e.g., g++ -O3), which is not the case for calls to the standard
+ * library. The Vec* functions are the corresponding array-at-a-time loops.
+ * (With g++, the selections are only vectorized if -fno-trapping-math is used,
+ * and loops calling sqrt() only if -fno-math-errno is used; see SConstruct.)
+ *
+ *   The polynomial and rational approximations are those of FDLIBM (Sun
+ * Microsystems). Maximum differences from the standard library (glibc),
+ * as checked in unit_tests/unittest_funcs.t.h, are 1 ULP for SimdExp,
+ * SimdLog, SimdSin, SimdCos (|x| < 1e6), and SimdAtan2, and 2 ULP for SimdPow
+ * (which computes log(x) in extended precision internally, so that the error
+ * doesn't grow with |y log(x)|); SimdSqrt is the hardware instruction.
+ * Limitations:
+ *    SimdExp (and SimdPow) flush results smaller than ~3e-308 to zero;
+ *    SimdPow is only for x >= 0 (negative x gives NaN);
+ *    SimdSin, SimdCos lose accuracy for |x| > ~1e6;
+ *    SimdAtan2 assumes that x and y are not both infinite.
+ */
+
+#ifndef _SIMD_MATH_H_
+#define _SIMD_MATH_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+
+/// Number of values processed per block by the batched evaluation paths of
+/// FunctionObject subclasses (size of their stack-allocated work arrays)
+const int  SIMD_MATH_BLOCK_SIZE = 64;
+
+
+// Adding (then subtracting) this rounds a double with |x| < 2^51 to the nearest
+// integer; the integer value is then in the low bits of the sum's bit pattern
+const double  SIMD_ROUND_MAGIC = 6755399441055744.0;   // 1.5 * 2^52
+
+const double  SIMD_LN2_HI = 6.93147180369123816490e-01;   // upper 32 bits of ln(2)
+const double  SIMD_LN2_LO = 1.90821492927058770002e-10;   // ln(2) - SIMD_LN2_HI
+const double  SIMD_INV_LN2 = 1.44269504088896338700e+00;
+const double  SIMD_SQRT2 = 1.41421356237309504880;
+const double  SIMD_PI = 3.14159265358979311600e+00;
+const double  SIMD_PI_LO = 1.2246467991473531772e-16;
+const double  SIMD_PIO2 = 1.57079632679489655800e+00;
+const double  SIMD_2_OVER_PI = 6.36619772367581382433e-01;
+// pi/2 split into three parts (first two have 33 significant bits)
+const double  SIMD_PIO2_1 = 1.57079632673412561417e+00;
+const double  SIMD_PIO2_2 = 6.07710050630396597660e-11;
+const double  SIMD_PIO2_2T = 2.02226624879595063154e-21;
+
+
+
+/* ---------------- Bit-level helpers ---------------------------------- */
+
+inline uint64_t SimdBits( double x )
+{
+  uint64_t  i;
+  memcpy(&i, &x, sizeof(double));
+  return i;
+}
+
+inline double SimdFromBits( uint64_t i )
+{
+  double  x;
+  memcpy(&x, &i, sizeof(double));
+  return x;
+}
+
+/// Returns the high-order half of x (the low 27 bits of its significand cleared),
+/// so that products of two such halves are exact
+inline double SimdHighHalf( double x )
+{
+  return SimdFromBits(SimdBits(x) & 0xfffffffff8000000ULL);
+}
+
+/// Returns a*b as an unevaluated sum p + e (Dekker's algorithm; no FMA needed)
+inline void SimdTwoProduct( double a, double b, double &p, double &e )
+{
+  double  a_hi = SimdHighHalf(a), a_lo = a - a_hi;
+  double  b_hi = SimdHighHalf(b), b_lo = b - b_hi;
+
+  p = a*b;
+  e = ((a_hi*b_hi - p) + a_hi*b_lo + a_lo*b_hi) + a_lo*b_lo;
+}
+
+/// Returns a + b as an unevaluated sum s + e, assuming |a| >= |b| or a = 0
+/// (Dekker's "fast two-sum")
+inline void SimdFastTwoSum( double a, double b, double &s, double &e )
+{
+  s = a + b;
+  e = b - (s - a);
+}
+
+
+
+/* ---------------- exp ------------------------------------------------ */
+
+/// Returns exp(x + xlo), where |xlo| is at most ~ 1 ulp of x (xlo is the low-order
+/// part of an extended-precision argument; use xlo = 0 for plain exp)
+inline double SimdExpExtended( double x, double xlo )
+{
+  const double  P1 = 1.66666666666666019037e-01;
+  const double  P2 = -2.77777777770155933842e-03;
+  const double  P3 = 6.61375632143793436117e-05;
+  const double  P4 = -1.65339022054652515390e-06;
+  const double  P5 = 4.13813679705723846039e-08;
+  // x > UPPER_LIMIT overflows; x < LOWER_LIMIT (result < ~3e-308) is flushed to 0
+  const double  UPPER_LIMIT = 709.79;
+  const double  LOWER_LIMIT = -708.05;
+  double  xc, kd, hi, lo, r, z, c, result;
+
+  // argument reduction: x = k*ln(2) + r, |r| <= 0.5*ln(2); clamping x (which
+  // leaves NaN unchanged) keeps k within [-1021, 1024]
+  xc = (x < LOWER_LIMIT) ? LOWER_LIMIT : x;
+  xc = (xc > UPPER_LIMIT) ? UPPER_LIMIT : xc;
+  kd = (xc*SIMD_INV_LN2 + SIMD_ROUND_MAGIC) - SIMD_ROUND_MAGIC;
+  hi = xc - kd*SIMD_LN2_HI;
+  lo = kd*SIMD_LN2_LO - xlo;
+  r = hi - lo;
+
+  // exp(r) via rational approximation (FDLIBM)
+  z = r*r;
+  c = r - z*(P1 + z*(P2 + z*(P3 + z*(P4 + z*P5))));
+  result = 1.0 - ((lo - (r*c)/(2.0 - c)) - hi);
+
+  // scale by 2^(k - 1), then by 2 (so that k = 1024 doesn't overflow the
+  // exponent field); the low 11 bits of kd + SIMD_ROUND_MAGIC hold k + 1022
+  result *= SimdFromBits(SimdBits(kd + (1022.0 + SIMD_ROUND_MAGIC)) << 52);
+  result *= 2.0;
+
+  result = (x < LOWER_LIMIT) ? 0.0 : result;
+  return result;
+}
+
+/// Vectorizable exp(x)
+inline double SimdExp( double x )
+{
+  return SimdExpExtended(x, 0.0);
+}
+
+
+
+/* ---------------- log ------------------------------------------------ */
+
+/// Splits x > 0 into 2^k * (1 + f), with sqrt(2)/2 <= 1 + f < sqrt(2); returns f
+/// and stores k (as a double) in kd. (Denormalized x is handled.)
+inline double SimdLogReduce( double x, double &kd )
+{
+  // offset which moves the bit pattern of sqrt(2)/2 to that of 1.0, so that the
+  // exponent field of (bits + OFFSET) is k + 1023
+  const uint64_t  OFFSET = 0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL;
+  const uint64_t  EXPONENT_MASK = 0x7ff0000000000000ULL;
+  bool  denormal = (x < 2.2250738585072014e-308);
+  uint64_t  bits, shiftedBits;
+
+  bits = SimdBits(x * (denormal ? 18014398509481984.0 : 1.0));   // 2^54
+  shiftedBits = bits + OFFSET;
+  // (2^52 + k + 1023) - (2^52 + 1023)
+  kd = SimdFromBits(0x4330000000000000ULL | (shiftedBits >> 52)) - 4503599627371519.0;
+  kd -= (denormal ? 54.0 : 0.0);
+  return SimdFromBits(bits - (shiftedBits & EXPONENT_MASK) + 0x3ff0000000000000ULL) - 1.0;
+}
+
+/// Core of FDLIBM's log: returns s = f/(2 + f) and the polynomial term R, such that
+/// log(1 + f) = f - hfsq + s*(hfsq + R), where hfsq = f^2/2
+inline double SimdLogPolynomial( double f, double &s )
+{
+  const double  Lg1 = 6.666666666666735130e-01;
+  const double  Lg2 = 3.999999999940941908e-01;
+  const double  Lg3 = 2.857142874366239149e-01;
+  const double  Lg4 = 2.222219843214978396e-01;
+  const double  Lg5 = 1.818357216161805012e-01;
+  const double  Lg6 = 1.531383769920937332e-01;
+  const double  Lg7 = 1.479819860511658591e-01;
+  double  z, w;
+
+  s = f/(2.0 + f);
+  z = s*s;
+  w = z*z;
+  return z*(Lg1 + w*(Lg3 + w*(Lg5 + w*Lg7))) + w*(Lg2 + w*(Lg4 + w*Lg6));
+}
+
+/// Replaces result with the correct value of log(x) for x <= 0, x = +inf, and NaN
+inline double SimdLogSpecialCases( double x, double result )
+{
+  result = (x > 0.0) ? result : ((x == 0.0) ? -HUGE_VAL : NAN);
+  result = (x == HUGE_VAL) ? x : result;
+  return result;
+}
+
+/// Vectorizable log(x)
+inline double SimdLog( double x )
+{
+  double  kd, f, s, R, hfsq, result;
+
+  f = SimdLogReduce(x, kd);
+  R = SimdLogPolynomial(f, s);
+  hfsq = 0.5*f*f;
+  result = kd*SIMD_LN2_HI - ((hfsq - (s*(hfsq + R) + kd*SIMD_LN2_LO)) - f);
+  return SimdLogSpecialCases(x, result);
+}
+
+/// Computes log(x) in extended precision, as the unevaluated sum hi + lo
+/// (special cases are *not* handled; see SimdPow)
+inline void SimdLogExtended( double x, double &hi, double &lo )
+{
+  double  kd, f, s, R, hfsq, hfsq_lo, tail, a, a_lo, h, l;
+
+  f = SimdLogReduce(x, kd);   // exact
+  R = SimdLogPolynomial(f, s);
+  SimdTwoProduct(f, f, hfsq, hfsq_lo);
+  hfsq *= 0.5;
+  hfsq_lo *= 0.5;
+  tail = s*(hfsq + R);   // small compared to f, so rounding error matters less
+  // |f| > hfsq, and |kd*SIMD_LN2_HI| (which is exact) > |a| unless kd = 0
+  SimdFastTwoSum(f, -hfsq, a, a_lo);
+  SimdFastTwoSum(kd*SIMD_LN2_HI, a, h, l);
+  l += a_lo - hfsq_lo + tail + kd*SIMD_LN2_LO;
+  hi = h + l;
+  lo = l - (hi - h);
+}
+
+
+
+/* ---------------- pow ------------------------------------------------ */
+
+/// Vectorizable pow(x, y) for x >= 0
+inline double SimdPow( double x, double y )
+{
+  double  logHi, logLo, p, p_lo, result;
+
+  SimdLogExtended(x, logHi, logLo);
+  SimdTwoProduct(y, logHi, p, p_lo);
+  p_lo += y*logLo;
+  result = SimdExpExtended(p, p_lo);
+
+  // special cases (x = 0, inf, negative, or NaN; y = 0)
+  double  zeroResult = (y > 0.0) ? 0.0 : HUGE_VAL;
+  double  infResult = (y > 0.0) ? HUGE_VAL : 0.0;
+  result = (x > 0.0) ? result : ((x == 0.0) ? zeroResult : NAN);
+  result = (x == HUGE_VAL) ? infResult : result;
+  result = (y == 0.0) ? 1.0 : result;
+  return result;
+}
+
+
+
+/// Vectorizable pow(x, y) for x >= 0, computed as exp(y*log(x)) in ordinary double
+/// precision. This is about twice as fast as SimdPow, but the error grows with
+/// |y log(x)|, to ~ (1 + 1.5|y log(x)|) ULP. Suitable when |y log(x)| is small, or
+/// when the result is going to be multiplied by a large number and then passed to
+/// exp() (as in the Sersic function), which amplifies its rounding error anyway.
+inline double SimdPowFast( double x, double y )
+{
+  double  result = SimdExp(y*SimdLog(x));
+  result = (y == 0.0) ? 1.0 : result;
+  return result;
+}
+
+
+
+/* ---------------- sin, cos ------------------------------------------- */
+
+/// Vectorizable simultaneous sin(x) and cos(x) (accurate for |x| < ~1e6)
+inline void SimdSinCos( double x, double &sinx, double &cosx )
+{
+  const double  S1 = -1.66666666666666324348e-01;
+  const double  S2 = 8.33333333332248946124e-03;
+  const double  S3 = -1.98412698298579493134e-04;
+  const double  S4 = 2.75573137070700676789e-06;
+  const double  S5 = -2.50507602534068634195e-08;
+  const double  S6 = 1.58969099521155010221e-10;
+  const double  C1 = 4.16666666666666019037e-02;
+  const double  C2 = -1.38888888888741095749e-03;
+  const double  C3 = 2.48015872894767294178e-05;
+  const double  C4 = -2.75573143513906633035e-07;
+  const double  C5 = 2.08757232129817482790e-09;
+  const double  C6 = -1.13596475577881948265e-11;
+  double  nd, r1, w1, r2, w, r, r_lo, z, v, polySin, polyCos, hz, s, c;
+  uint64_t  quadrant, swapMask;
+
+  // argument reduction: x = n*pi/2 + (r + r_lo), |r| <= pi/4 (FDLIBM medium-size
+  // reduction, with pi/2 = SIMD_PIO2_1 + SIMD_PIO2_2 + SIMD_PIO2_2T)
+  nd = (x*SIMD_2_OVER_PI + SIMD_ROUND_MAGIC) - SIMD_ROUND_MAGIC;
+  quadrant = SimdBits(nd + SIMD_ROUND_MAGIC) & 3;
+  r1 = x - nd*SIMD_PIO2_1;
+  w1 = nd*SIMD_PIO2_2;
+  r2 = r1 - w1;
+  w = nd*SIMD_PIO2_2T - ((r1 - r2) - w1);
+  r = r2 - w;
+  r_lo = (r2 - r) - w;
+
+  // kernel sin and cos on [-pi/4, pi/4]
+  z = r*r;
+  v = z*r;
+  polySin = S2 + z*(S3 + z*(S4 + z*(S5 + z*S6)));
+  s = r - ((z*(0.5*r_lo - v*polySin) - r_lo) - v*S1);
+  polyCos = z*(C1 + z*(C2 + z*(C3 + z*(C4 + z*(C5 + z*C6)))));
+  hz = 0.5*z;
+  w = 1.0 - hz;
+  c = w + (((1.0 - w) - hz) + (z*polyCos - r*r_lo));
+
+  // select and sign-flip according to quadrant (using integer bit masks, so
+  // that the compiler doesn't have to mix integer and floating-point vectors)
+  swapMask = 0 - (quadrant & 1);
+  sinx = SimdFromBits(((SimdBits(c) & swapMask) | (SimdBits(s) & ~swapMask))
+  						^ ((quadrant & 2) << 62));
+  cosx = SimdFromBits(((SimdBits(s) & swapMask) | (SimdBits(c) & ~swapMask))
+  						^ (((quadrant + 1) & 2) << 62));
+}
+
+/// Vectorizable sin(x) (accurate for |x| < ~1e6)
+inline double SimdSin( double x )
+{
+  double  s, c;
+  SimdSinCos(x, s, c);
+  return s;
+}
+
+/// Vectorizable cos(x) (accurate for |x| < ~1e6)
+inline double SimdCos( double x )
+{
+  double  s, c;
+  SimdSinCos(x, s, c);
+  return c;
+}
+
+
+
+/* ---------------- atan2 ---------------------------------------------- */
+
+/// Vectorizable atan(t) for t >= 0 (FDLIBM, with the five argument ranges
+/// handled by selection rather than branching)
+inline double SimdAtanNonNegative( double t )
+{
+  const double  aT0 = 3.33333333333329318027e-01;
+  const double  aT1 = -1.99999999998764832476e-01;
+  const double  aT2 = 1.42857142725034663711e-01;
+  const double  aT3 = -1.11111104054623557880e-01;
+  const double  aT4 = 9.09088713343650656196e-02;
+  const double  aT5 = -7.69187620504482999495e-02;
+  const double  aT6 = 6.66107313738753120669e-02;
+  const double  aT7 = -5.83357013379057348645e-02;
+  const double  aT8 = 4.97687799461593236017e-02;
+  const double  aT9 = -3.65315727442169155270e-02;
+  const double  aT10 = 1.62858201153657823623e-02;
+  double  num, den, atanHi, atanLo, u, z, w, s1, s2;
+
+  // atan(t) = atanHi + atan(u), with num/den = u; the ranges are
+  // [0, 7/16), [7/16, 11/16), [11/16, 19/16), [19/16, 39/16), [39/16, inf]
+  // (each successive selection overrides the previous one for larger t; NaN
+  // fails all the comparisons, and stays in the first range)
+  num = t;
+  den = 1.0;
+  atanHi = 0.0;
+  atanLo = 0.0;
+  num = (t >= 0.4375) ? 2.0*t - 1.0 : num;
+  den = (t >= 0.4375) ? 2.0 + t : den;
+  atanHi = (t >= 0.4375) ? 4.63647609000806093515e-01 : atanHi;   // atan(0.5)
+  atanLo = (t >= 0.4375) ? 2.26987774529616870924e-17 : atanLo;
+  num = (t >= 0.6875) ? t - 1.0 : num;
+  den = (t >= 0.6875) ? t + 1.0 : den;
+  atanHi = (t >= 0.6875) ? 7.85398163397448278999e-01 : atanHi;   // atan(1)
+  atanLo = (t >= 0.6875) ? 3.06161699786838301793e-17 : atanLo;
+  num = (t >= 1.1875) ? t - 1.5 : num;
+  den = (t >= 1.1875) ? 1.0 + 1.5*t : den;
+  atanHi = (t >= 1.1875) ? 9.82793723247329054082e-01 : atanHi;   // atan(1.5)
+  atanLo = (t >= 1.1875) ? 1.39033110312309984516e-17 : atanLo;
+  num = (t >= 2.4375) ? -1.0 : num;
+  den = (t >= 2.4375) ? t : den;
+  atanHi = (t >= 2.4375) ? 1.57079632679489655800e+00 : atanHi;   // atan(inf)
+  atanLo = (t >= 2.4375) ? 6.12323399573676603587e-17 : atanLo;
+  u = num/den;
+  z = u*u;
+  w = z*z;
+  s1 = z*(aT0 + w*(aT2 + w*(aT4 + w*(aT6 + w*(aT8 + w*aT10)))));
+  s2 = w*(aT1 + w*(aT3 + w*(aT5 + w*(aT7 + w*aT9))));
+  return atanHi - ((u*(s1 + s2) - atanLo) - u);
+}
+
+/// Vectorizable atan2(y, x)
+inline double SimdAtan2( double y, double x )
+{
+  const uint64_t  SIGN_BIT = 0x8000000000000000ULL;
+  // x = -0 only counts as negative if y = 0 as well (adding +0 turns -0 into +0)
+  double  xForSign = (y == 0.0) ? x : x + 0.0;
+  uint64_t  xNegativeMask = 0 - (SimdBits(xForSign) >> 63);
+  double  t, result;
+
+  // result for x >= +0 is atan(|y/x|), for x <= -0 is pi - atan(|y/x|); the
+  // sign of y is applied at the end. (y = x = 0 gives t = NaN, and a result of
+  // +/-0 or +/-pi)
+  t = SimdAtanNonNegative(fabs(y/x));
+  t = (fabs(x) + fabs(y) == 0.0) ? 0.0 : t;
+  result = SimdFromBits((SimdBits(SIMD_PI - (t - SIMD_PI_LO)) & xNegativeMask)
+  						| (SimdBits(t) & ~xNegativeMask));
+  result = SimdFromBits(SimdBits(result) ^ (SimdBits(y) & SIGN_BIT));
+  result = (x + y != x + y) ? x + y : result;
+  return result;
+}
+
+
+
+/* ---------------- sqrt ----------------------------------------------- */
+
+/// sqrt(x) (included for completeness: the compiler vectorizes this directly)
+inline double SimdSqrt( double x )
+{
+  return sqrt(x);
+}
+
+
+
+/* ---------------- Array-at-a-time versions --------------------------- */
+
+/// output[i] = exp(x[i]) for i = 0 ... n - 1 (output may be the same as x)
+inline void VecExp( int n, const double *x, double *output )
+{
+  for (int i = 0; i < n; i++)
+    output[i] = SimdExp(x[i]);
+}
+
+/// output[i] = log(x[i]) for i = 0 ... n - 1 (output may be the same as x)
+inline void VecLog( int n, const double *x, double *output )
+{
+  for (int i = 0; i < n; i++)
+    output[i] = SimdLog(x[i]);
+}
+
+/// output[i] = pow(x[i], y) for i = 0 ... n - 1 (output may be the same as x)
+inline void VecPow( int n, const double *x, double y, double *output )
+{
+  for (int i = 0; i < n; i++)
+    output[i] = SimdPow(x[i], y);
+}
+
+/// sinOutput[i] = sin(x[i]), cosOutput[i] = cos(x[i]) for i = 0 ... n - 1
+inline void VecSinCos( int n, const double *x, double *sinOutput, double *cosOutput )
+{
+  for (int i = 0; i < n; i++)
+    SimdSinCos(x[i], sinOutput[i], cosOutput[i]);
+}
+
+/// output[i] = atan2(y[i], x[i]) for i = 0 ... n - 1
+inline void VecAtan2( int n, const double *y, const double *x, double *output )
+{
+  for (int i = 0; i < n; i++)
+    output[i] = SimdAtan2(y[i], x[i]);
+}
+
+/// output[i] = sqrt(x[i]) for i = 0 ... n - 1 (output may be the same as x)
+inline void VecSqrt( int n, const double *x, double *output )
+{
+  for (int i = 0; i < n; i++)
+    output[i] = SimdSqrt(x[i]);
+}
+
+
+#endif /* _SIMD_MATH_H_ */
@@ -57,6 +57,8 @@ coreFileDict = {"dir": "core", "file_list": dm.source_files_core.split()}
 solversFileDict = {"dir": "solvers", "file_list": dm.source_files_solvers.split()}
 mcmcFileDict = {"dir": "cdream", "file_list": dm.source_files_mcmc.split()}
 funcObjFileDict = {"dir": "function_objects", "file_list": dm.source_files_funcobj.split()}
+profilefitFileDict = {"dir": "profile_fitting", "file_list": dm.source_files_profilefit.split()}
+funcObj1dFileDict = {"dir": "function_objects_1d", "file_list": dm.source_files_funcobj1d.split()}
 exampleFileDict = {"dir": "examples", "file_list": dm.example_files.split()}
 pythonFileDict = {"dir": "python", "file_list": dm.python_files.split()}
 testFileDict_imfit = {"dir": "tests/imfit_reference", "file_list": dm.test_files_imfit.split()}
@@ -95,21 +97,32 @@ core_file_list = core_file_list_h + core_file_list_cpp
 
 funcobj_file_list_cpp = [ funcObjFileDict["dir"] + "/" + fname + ".cpp" for fname in funcObjFileDict["file_list"] ]
 funcobj_file_list_h = [ funcObjFileDict["dir"] + "/" + fname + ".h" for fname in funcObjFileDict["file_list"] ]
+funcobj_file_list_h += [ funcObjFileDict["dir"] + "/" + fname + ".h" for fname in dm.source_header_files_funcobj.split() ]
 funcobj_file_list = funcobj_file_list_h + funcobj_file_list_cpp
 
+profilefit_file_list_cpp = [ profilefitFileDict["dir"] + "/" + fname + ".cpp" for fname in profilefitFileDict["file_list"] ]
+profilefit_file_list_h = [ profilefitFileDict["dir"] + "/" + fname + ".h" for fname in dm.source_header_files_profilefit.split() ]
+profilefit_file_list = profilefit_file_list_h + profilefit_file_list_cpp
+
+funcobj1d_file_list_cpp = [ funcObj1dFileDict["dir"] + "/" + fname + ".cpp" for fname in funcObj1dFileDict["file_list"] ]
+funcobj1d_file_list_h = [ funcObj1dFileDict["dir"] + "/" + fname + ".h" for fname in funcObj1dFileDict["file_list"] ]
+funcobj1d_file_list = funcobj1d_file_list_h + funcobj1d_file_list_cpp
+
 
 allFileLists = [binary_only_file_list, misc_required_files_list, documentation_file_list, extras_file_list,
 				example_file_list, python_file_list, testing_scripts_list, test_file_imfit_list, 
 				test_file_mcmc_list, test_file_makeimage_list, test_file_list, solvers_file_list,
-				mcmc_file_list, core_file_list, funcobj_file_list]
+				mcmc_file_list, core_file_list, funcobj_file_list, profilefit_file_list,
+				funcobj1d_file_list]
 allFileLists_source = [misc_required_files_list, documentation_file_list, extras_file_list,
 				example_file_list, python_file_list, testing_scripts_list, test_file_imfit_list, 
 				test_file_mcmc_list, test_file_makeimage_list, test_file_list, solvers_file_list,
-				mcmc_file_list, core_file_list, funcobj_file_list]
+				mcmc_file_list, core_file_list, funcobj_file_list, profilefit_file_list,
+				funcobj1d_file_list]
 subdirs_list = ["docs", "extras", "examples", "python", "tests", "tests/osx", "tests/linux", 
 				"tests/imfit_reference", "tests/imfit-mcmc_reference", "tests/makeimage_reference", 
 				"tests/mcmc_data", "function_objects", "solvers", "cdream", "cdream/include", 
-				"cdream/include/rng", "core"]
+				"cdream/include/rng", "core", "profile_fitting", "function_objects_1d"]
 
 
 
@@ -37,7 +37,6 @@
 #include "func1d_n1543majmin.h"
 #include "func1d_n1543majmin2.h"
 
-#include "func1d_double-gauss-hermite.h"
 #include "func1d_gauss-hermite.h"
 
 
@@ -144,9 +143,6 @@ void PopulateFactoryMap( map<string, factory*>& input_factory_map )
   n1543MajMin21D::GetClassShortName(classFuncName);
   input_factory_map[classFuncName] = new funcobj_factory<n1543MajMin21D>();
 
-  DoubleGaussHermite1D::GetClassShortName(classFuncName);
-  input_factory_map[classFuncName] = new funcobj_factory<DoubleGaussHermite1D>();
-
   GaussHermite1D::GetClassShortName(classFuncName);
   input_factory_map[classFuncName] = new funcobj_factory<GaussHermite1D>();
   
@@ -155,7 +151,7 @@ void PopulateFactoryMap( map<string, factory*>& input_factory_map )
 
 
 int AddFunctions1d( ModelObject *theModel, vector<string> &functionNameList,
-                  vector<int> &FunctionBlockIndices )
+                  vector<int> &FunctionBlockIndices, int verboseLevel )
 {
   int  nFunctions = functionNameList.size();
   string  currentName;
@@ -166,7 +162,8 @@ int AddFunctions1d( ModelObject *theModel, vector<string> &functionNameList,
 
   for (int i = 0; i < nFunctions; i++) {
     currentName = functionNameList[i];
-    printf("\tFunction: %s\n", currentName.c_str());
+    if (verboseLevel >= 0)
+      printf("\tFunction: %s\n", currentName.c_str());
     if (factory_map.count(currentName) < 1) {
       printf("*** AddFunctions: unidentified function name (\"%s\")\n", currentName.c_str());
       return - 1;
@@ -179,7 +176,7 @@ int AddFunctions1d( ModelObject *theModel, vector<string> &functionNameList,
   // OK, we're done adding functions; now tell the model object to do some
   // final setup work
   // Tell model object about arrangement of functions into common-center sets
-  theModel->DefineFunctionBlocks(FunctionBlockIndices);
+  theModel->DefineFunctionSets(FunctionBlockIndices);
   
   // Tell model object to create vector of parameter labels
   theModel->PopulateParameterNames();
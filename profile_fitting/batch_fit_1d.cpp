@@ -0,0 +1,285 @@
+/* FILE: batch_fit_1d.cpp ---------------------------------------------- */
+/*
+ * Code for fitting many 1D profiles (e.g., from a multi-profile text or binary
+ * file) with the same model, PSF, and solver settings, and for saving the results
+ * in a single table.
+ *
+ * Each profile gets its own ModelObject1d, so profiles can be fit in parallel
+ * (one profile per thread) when the L-M solver is used. The other solvers
+ * keep global or static state (DE uses the global Mersenne Twister; the
+ * Nelder-Mead and NLopt wrappers use file-level variables), so with those the
+ * profiles are fit one at a time.
+ *
+ * Bootstrap resampling for profile p uses random-number streams
+ * p*nIterations ... (p + 1)*nIterations - 1 (with the common seed), so results
+ * are the same regardless of the number of threads.
+ */
+
+
+/* ------------------------ Include Files (Header Files )--------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include "definitions.h"
+#include "model_object_1d.h"
+#include "add_functions_1d.h"
+#include "dispatch_solver.h"
+#include "solver_results.h"
+#include "bootstrap_errors_1d.h"
+#include "batch_fit_1d.h"
+#include "utilities_pub.h"
+
+using namespace std;
+
+
+/* ---------------- Definitions ---------------------------------------- */
+#define PROGRESS_BAR_WIDTH  50
+
+
+/* ------------------- Function Prototypes ----------------------------- */
+static void FitOneProfile( profileSet& profiles, int profileNumber, batchFitSetup& setup,
+					profileFitResult& result );
+
+
+
+/* ---------------- FUNCTION: FitProfileBatch -------------------------- */
+/// Fits all the profiles in profiles, using up to nThreads threads (only for the
+/// L-M solver; other solvers are run serially). results is resized to hold one
+/// profileFitResult per profile. If verboseLevel >= 0, a progress bar is printed.
+/// Returns the number of profiles with successful fits (fitStatus > 0).
+int FitProfileBatch( profileSet& profiles, batchFitSetup& setup, int nThreads,
+					int verboseLevel, vector<profileFitResult>& results )
+{
+  int  nProfiles = profiles.nProfiles;
+  int  nProfilesDone = 0;
+  int  nSuccessful = 0;
+  int  progressStep;
+  int  nDigits = floor(log10(nProfiles > 0 ? nProfiles : 1)) + 1;
+  string  progressTemplate = PrintToString("] %%%dd", nDigits) + " (%3.1f%%)\r";
+
+  if (nThreads < 1)
+    nThreads = 1;
+  progressStep = nProfiles / PROGRESS_BAR_WIDTH;
+  if (progressStep < 1)
+    progressStep = 1;
+  results.resize(nProfiles);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(nThreads) if (setup.solver == MPFIT_SOLVER)
+  for (int p = 0; p < nProfiles; p++) {
+    int  nDone;
+    FitOneProfile(profiles, p, setup, results[p]);
+    #pragma omp atomic capture
+    nDone = ++nProfilesDone;
+    if ((verboseLevel >= 0) && (((nDone % progressStep) == 0) || (nDone == nProfiles))) {
+      #pragma omp critical (batch_fit_progress)
+      PrintProgressBar(nDone, nProfiles, progressTemplate, PROGRESS_BAR_WIDTH);
+    }
+  }
+  if (verboseLevel >= 0)
+    printf("\n");
+
+  for (int p = 0; p < nProfiles; p++) {
+    if (results[p].fitStatus > 0)
+      nSuccessful++;
+  }
+  return nSuccessful;
+}
+
+
+/* ---------------- FUNCTION: FitOneProfile ---------------------------- */
+// Sets up a new ModelObject1d for profile number profileNumber, fits it, and
+// (optionally) does bootstrap resampling, storing everything in result.
+// Safe to call from multiple threads as long as setup.solver = MPFIT_SOLVER.
+static void FitOneProfile( profileSet& profiles, int profileNumber, batchFitSetup& setup,
+					profileFitResult& result )
+{
+  ModelObject1d  *theModel;
+  SolverResults  resultsFromSolver;
+  string  solverName = setup.nloptSolverName;
+  vector<int>  functionSetIndices = setup.functionSetIndices;
+  vector<double>  weights, maskVals, deviates;
+  long  nDataVals = profiles.nDataVals;
+  int  nColumns = profiles.nColumnsPerProfile;
+  int  nParamsTot = (int)setup.initialParams.size();
+  int  nFreeParams = 0;
+  int  nDegFreedom, status;
+  double  *yVals, *errVals, *inputMask;
+  double  chi2;
+
+  result.fitStatus = BATCH_FIT_BAD_DATA;
+  result.nValidPoints = 0;
+  result.nFuncEvals = 0;
+  result.fitStatistic = result.reducedFitStatistic = 0.0;
+  result.nBootstrapIters = 0;
+  result.errorsPresent = false;
+  result.params = setup.initialParams;
+  result.paramErrs.assign(nParamsTot, 0.0);
+  for (int i = 0; i < nParamsTot; i++) {
+    if ((! setup.paramLimitsExist) || (setup.parameterInfo[i].fixed == 0))
+      nFreeParams++;
+  }
+
+  yVals = &profiles.values[(size_t)(profileNumber*nColumns)*nDataVals];
+  errVals = (nColumns > 1) ? yVals + nDataVals : NULL;
+  inputMask = (nColumns > 2) ? yVals + 2*nDataVals : NULL;
+
+  // Private copies of errors and mask (ModelObject1d converts both in place);
+  // errors for masked points are replaced with 1, so that bad values there
+  // don't invalidate the whole profile
+  weights.assign(nDataVals, 1.0);
+  if (inputMask != NULL)
+    maskVals.assign(inputMask, inputMask + nDataVals);
+  if (errVals != NULL) {
+    for (long z = 0; z < nDataVals; z++) {
+      if ((inputMask != NULL) && (((setup.maskFormat == MASK_ZERO_IS_GOOD) && (inputMask[z] > 0.0))
+      						|| ((setup.maskFormat == MASK_ZERO_IS_BAD) && (inputMask[z] < 1.0))))
+        continue;
+      if ((! isfinite(errVals[z])) || (errVals[z] <= 0.0))
+        return;
+      weights[z] = errVals[z];
+    }
+  }
+
+  theModel = new ModelObject1d();
+  theModel->SetVerboseLevel(-1);
+  status = AddFunctions1d(theModel, setup.functionList, functionSetIndices, -1);
+  if (status < 0) {
+    delete theModel;
+    return;
+  }
+  theModel->SetZeroPoint(setup.zeroPoint);
+  theModel->AddDataVectors(nDataVals, profiles.xVals.data(), yVals, setup.dataAreMagnitudes);
+  theModel->AddErrorVector1D(nDataVals, weights.data(), WEIGHTS_ARE_SIGMAS);
+  if (inputMask != NULL) {
+    status = theModel->AddMaskVector1D(nDataVals, maskVals.data(), setup.maskFormat);
+    if (status < 0) {
+      delete theModel;
+      return;
+    }
+  }
+  if (setup.psfVals != NULL) {
+    theModel->SetConvolutionMethod(setup.convolutionMethod);
+    theModel->AddPSFVector1D(setup.nPSFVals, setup.psfXVals, setup.psfVals);
+  }
+  status = theModel->FinalSetupForFitting();
+  result.nValidPoints = theModel->GetNValidPixels();
+  if ((status < 0) || (result.nValidPoints < 1)) {
+    delete theModel;
+    return;
+  }
+
+  result.fitStatus = DispatchToSolver(setup.solver, nParamsTot, nFreeParams, nDataVals,
+  							result.params.data(), setup.parameterInfo, theModel, setup.ftol,
+  							setup.paramLimitsExist, -1, &resultsFromSolver, solverName,
+  							setup.rngSeed);
+  result.nFuncEvals = resultsFromSolver.GetNFunctionEvals();
+
+  // chi^2 for the best-fit parameters (computed directly, since not all solvers
+  // store it)
+  deviates.resize(nDataVals);
+  theModel->ComputeDeviates(deviates.data(), result.params.data());
+  chi2 = 0.0;
+  for (long z = 0; z < nDataVals; z++)
+    chi2 += deviates[z]*deviates[z];
+  result.fitStatistic = chi2;
+  nDegFreedom = result.nValidPoints - nFreeParams;
+  if (nDegFreedom > 0)
+    result.reducedFitStatistic = chi2 / nDegFreedom;
+
+  if (result.fitStatus > 0) {
+    if (setup.bootstrapIterations > 0) {
+      result.nBootstrapIters = BootstrapErrors1D(result.params.data(), setup.parameterInfo,
+      							setup.paramLimitsExist, theModel, setup.ftol,
+      							setup.bootstrapIterations, nFreeParams, setup.rngSeed,
+      							(unsigned long)profileNumber*setup.bootstrapIterations,
+      							result.paramErrs.data());
+      result.errorsPresent = (result.nBootstrapIters > 1);
+    }
+    else if (resultsFromSolver.ErrorsPresent()) {
+      resultsFromSolver.GetErrors(result.paramErrs.data());
+      result.errorsPresent = true;
+    }
+  }
+
+  delete theModel;
+}
+
+
+/* ---------------- FUNCTION: SaveBatchResults ------------------------- */
+/// Saves the results of FitProfileBatch to a text file with one row per profile:
+/// profile number (starting with 1), fit status, number of unmasked data points,
+/// chi^2, reduced chi^2, number of function evaluations, best-fit parameter
+/// values, and parameter errors (all 0 for profiles without error estimates).
+/// Returns 0 on success, -1 if the file could not be written.
+int SaveBatchResults( string& outputFileName, vector<string>& outputHeader,
+					batchFitSetup& setup, vector<profileFitResult>& results )
+{
+  FILE  *outputFile;
+  ModelObject1d  *theModel;
+  vector<int>  functionSetIndices = setup.functionSetIndices;
+  vector<string>  paramNames;
+  string  paramName;
+  int  nParamsTot = (int)setup.initialParams.size();
+
+  // get the parameter column names (e.g., "X0_1", "I_0_1") from a model object
+  theModel = new ModelObject1d();
+  theModel->SetVerboseLevel(-1);
+  AddFunctions1d(theModel, setup.functionList, functionSetIndices, -1);
+  istringstream  headerStream(theModel->GetParamHeader().substr(2));
+  while (headerStream >> paramName)
+    paramNames.push_back(paramName);
+  delete theModel;
+  if ((int)paramNames.size() != nParamsTot) {
+    fprintf(stderr, "*** ERROR: SaveBatchResults: parameter names do not match parameters!\n");
+    return -1;
+  }
+
+  outputFile = fopen(outputFileName.c_str(), "w");
+  if (outputFile == NULL) {
+    fprintf(stderr, "*** ERROR: Unable to open batch-results file \"%s\"!\n",
+    		outputFileName.c_str());
+    return -1;
+  }
+  for (int i = 0; i < (int)outputHeader.size(); i++)
+    fprintf(outputFile, "%s\n", outputHeader[i].c_str());
+  fprintf(outputFile, "#\n# Fit status %d = profile not fit because of bad input data;\n",
+  		BATCH_FIT_BAD_DATA);
+  if (setup.bootstrapIterations > 0)
+    fprintf(outputFile, "# parameter errors from %d rounds of bootstrap resampling (RNG seed = %lu)\n",
+    		setup.bootstrapIterations, setup.rngSeed);
+  else
+    fprintf(outputFile, "# parameter errors from L-M covariance matrix (0 = not available)\n");
+  fprintf(outputFile, "#\n# profile\tstatus\tn_valid\tchi2\treduced_chi2\tn_evals");
+  for (int i = 0; i < nParamsTot; i++)
+    fprintf(outputFile, "\t%s", paramNames[i].c_str());
+  for (int i = 0; i < nParamsTot; i++)
+    fprintf(outputFile, "\t%s_err", paramNames[i].c_str());
+  fprintf(outputFile, "\n");
+
+  for (int p = 0; p < (int)results.size(); p++) {
+    fprintf(outputFile, "%d\t%d\t%ld\t%.8g\t%.8g\t%ld", p + 1, results[p].fitStatus,
+    		results[p].nValidPoints, results[p].fitStatistic, results[p].reducedFitStatistic,
+    		results[p].nFuncEvals);
+    for (int i = 0; i < nParamsTot; i++)
+      fprintf(outputFile, "\t%.10g", results[p].params[i]);
+    for (int i = 0; i < nParamsTot; i++)
+      fprintf(outputFile, "\t%.6g", results[p].paramErrs[i]);
+    fprintf(outputFile, "\n");
+  }
+
+  if (fclose(outputFile) != 0) {
+    fprintf(stderr, "*** ERROR: Unable to write batch-results file \"%s\"!\n",
+    		outputFileName.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+
+
+/* END OF FILE: batch_fit_1d.cpp --------------------------------------- */
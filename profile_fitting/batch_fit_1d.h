@@ -0,0 +1,65 @@
+/*   Public interfaces for function(s) which fit many 1D profiles (sharing the
+ * same x values, model, and PSF) in one go
+ */
+
+#ifndef _BATCH_FIT_1D_H_
+#define _BATCH_FIT_1D_H_
+
+#include <string>
+#include <vector>
+
+#include "param_struct.h"   // for mp_par structure
+#include "read_profile_pub.h"
+
+
+/// fitStatus value for profiles which could not be fit because of bad input data
+/// (e.g., non-positive errors or no unmasked data points)
+const int  BATCH_FIT_BAD_DATA = -100;
+
+
+/// Model, PSF, and solver settings shared by all profiles in a batch
+typedef struct {
+  std::vector<std::string>  functionList;
+  std::vector<int>  functionSetIndices;
+  std::vector<double>  initialParams;
+  std::vector<mp_par>  parameterInfo;
+  bool  paramLimitsExist;
+  bool  dataAreMagnitudes;
+  double  zeroPoint;
+  int  maskFormat;
+  // PSF (psfVals = NULL if no convolution)
+  int  nPSFVals;
+  double  *psfXVals;
+  double  *psfVals;
+  int  convolutionMethod;
+  // solver
+  int  solver;
+  std::string  nloptSolverName;
+  double  ftol;
+  int  bootstrapIterations;
+  unsigned long  rngSeed;
+} batchFitSetup;
+
+
+/// Fit results for a single profile
+typedef struct {
+  int  fitStatus;
+  long  nValidPoints;
+  long  nFuncEvals;
+  double  fitStatistic;         // chi^2 for best-fit parameters
+  double  reducedFitStatistic;
+  int  nBootstrapIters;         // number of successful bootstrap iterations
+  bool  errorsPresent;
+  std::vector<double>  params;
+  std::vector<double>  paramErrs;
+} profileFitResult;
+
+
+int FitProfileBatch( profileSet& profiles, batchFitSetup& setup, int nThreads,
+					int verboseLevel, std::vector<profileFitResult>& results );
+
+int SaveBatchResults( std::string& outputFileName, std::vector<std::string>& outputHeader,
+					batchFitSetup& setup, std::vector<profileFitResult>& results );
+
+
+#endif  // _BATCH_FIT_1D_H_
@@ -4,6 +4,10 @@
  * Code for estimating errors on fitted parameters (for a 1D profile fit via
  * profilefit) via bootstrap resampling.
  *
+ * Resampling uses counter-based RNG streams (rng_streams.h) rather than the
+ * global Mersenne Twister, so that multiple profiles can be bootstrapped in
+ * parallel with reproducible results.
+ *
  *     [v0.01]: 3 Mar 2011: Created; initial development.
  *
  */
@@ -15,6 +19,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
+#include <time.h>
 #include <tuple>
 #include <vector>
 #include "strings.h"  // for bzero on Linux systems
@@ -23,7 +28,7 @@
 #include "model_object_1d.h"
 #include "mpfit.h"
 #include "levmar_fit.h"
-#include "mersenne_twister.h"
+#include "rng_streams.h"
 #include "bootstrap_errors_1d.h"
 #include "statistics.h"
 #include "print_results.h"
@@ -34,28 +39,33 @@
 int myfunc( int nDataVals, int nParams, double *params, double *deviates,
            double **derivatives, ModelObject *aModel );
 
+/* Local Functions: */
+static int DoBootstrapIterations( double *bestfitParams, std::vector<mp_par> parameterLimits, 
+						bool paramLimitsExist, ModelObject *theModel, double ftol,
+						int nIterations, int nFreeParams, unsigned long rngSeed,
+						unsigned long firstStreamID, double **paramArray );
+
 
 
 
+/* ---------------- FUNCTION: BootstrapErrors -------------------------- */
+/// Does bootstrap resampling of the (single) profile in theModel and prints 
+/// statistics for the resulting parameter values.
 void BootstrapErrors( double *bestfitParams, std::vector<mp_par> parameterLimits, 
 						bool paramLimitsExist, ModelObject *theModel, double ftol,
-						int nIterations, int nFreeParams )
+						int nIterations, int nFreeParams, unsigned long rngSeed )
 {
-  mp_config  mpConfig;
-  mp_result  mpfitResult;
-//   mp_par  *mpfitParameterConstraints;
-  double  *paramsVect, *paramSigmas;
+  double  *paramSigmas;
   double  **paramArray;
   double  lower, upper, plus, minus, halfwidth;
-  int  i, status, nIter;
+  int  i, nSuccessful;
   int  nParams = theModel->GetNParams();
-  int  nStoredDataVals = theModel->GetNDataValues();
-  int  verboseLevel = -1;   // ensure minimizer stays silent
   
-  /* seed random number generators with current time */
-  init_genrand( (unsigned long)time(NULL) );
+  if (rngSeed == 0) {
+    rngSeed = (unsigned long)time(NULL);
+    printf("(bootstrap RNG seed = %lu)\n", rngSeed);
+  }
 
-  paramsVect = (double *) malloc(nParams * sizeof(double));
   // Allocate 2D array to hold bootstrap results for each parameter
   paramArray = (double **)calloc( (size_t)nParams, sizeof(double *) );
   for (i = 0; i < nParams; i++)
@@ -63,51 +73,33 @@ void BootstrapErrors( double *bestfitParams, std::vector<mp_par> parameterLimits
   // vector to hold estimated sigmas for each parameter
   paramSigmas = (double *)calloc( (size_t)nParams, sizeof(double) );
 
-
-  theModel->UseBootstrap();
-
-
-  // Set up things for L-M minimization
-//   if (paramLimitsExist)
-//     mpfitParameterConstraints = parameterLimits;
-//   else
-//     mpfitParameterConstraints = NULL;
-  bzero(&mpfitResult, sizeof(mpfitResult));       /* Zero the results structure */
-  bzero(&mpConfig, sizeof(mpConfig));
-  mpConfig.maxiter = 1000;
-
-  // Do minimization
   printf("\nStarting bootstrap iterations...\n");
-
-  for (nIter = 0; nIter < nIterations; nIter++) {
-    
-    theModel->MakeBootstrapSample();
-    for (i = 0; i < nParams; i++)
-      paramsVect[i] = bestfitParams[i];
-//     status = mpfit(myfunc, nStoredDataVals, nParams, paramsVect, mpfitParameterConstraints,
-//                       &mpConfig, theModel, &mpfitResult);
-    status = LevMarFit(nParams, nFreeParams, nStoredDataVals, paramsVect, parameterLimits, 
-	   					theModel, ftol, paramLimitsExist, verboseLevel);
-    for (i = 0; i < nParams; i++) {
-      paramArray[i][nIter] = paramsVect[i];
-    }
+  nSuccessful = DoBootstrapIterations(bestfitParams, parameterLimits, paramLimitsExist,
+  							theModel, ftol, nIterations, nFreeParams, rngSeed, 0, paramArray);
+  if (nSuccessful < 2) {
+    printf("*** WARNING: Too few successful bootstrap iterations (%d) to estimate errors!\n",
+    		nSuccessful);
+    nIterations = 0;
   }
-
+  else
+    nIterations = nSuccessful;
 
   /* Determine dispersions for parameter values */
   for (i = 0; i < nParams; i++) {
-    paramSigmas[i] = StandardDeviation(paramArray[i], nIterations);
+    if (nIterations > 0)
+      paramSigmas[i] = StandardDeviation(paramArray[i], nIterations);
   }
   
   /* Print parameter values + standard deviations: */
   /* (note that calling ConfidenceInterval() sorts the vectors in place!) */
-  printf("\nStatistics for parameter values from bootstrap resampling");
-  printf(" (%d rounds):\n", nIterations);
-  printf("Best-fit\t\t Bootstrap      [68%% conf.int., half-width]; (mean +/- standard deviation)\n");
-  for (i = 0; i < nParams; i++) {
-    if ((paramLimitsExist) && (parameterLimits[i].fixed == 0)) {
+  if (nIterations > 0) {
+    printf("\nStatistics for parameter values from bootstrap resampling");
+    printf(" (%d successful rounds):\n", nIterations);
+    printf("Best-fit\t\t Bootstrap      [68%% conf.int., half-width]; (mean +/- standard deviation)\n");
+  }
+  for (i = 0; (nIterations > 0) && (i < nParams); i++) {
+    if ((! paramLimitsExist) || (parameterLimits[i].fixed == 0)) {
       // OK, this parameter was not fixed
-      //ConfidenceInterval(paramArray[i], nIterations, &lower, &upper);
       std::tie(lower, upper) = ConfidenceInterval(paramArray[i], nIterations);
       plus = upper - bestfitParams[i];
       minus = bestfitParams[i] - lower;
@@ -125,7 +117,6 @@ void BootstrapErrors( double *bestfitParams, std::vector<mp_par> parameterLimits
   }
 
 
-  free(paramsVect);
   free(paramSigmas);
   for (i = 0; i < nParams; i++)
     free(paramArray[i]);
@@ -134,5 +125,87 @@ void BootstrapErrors( double *bestfitParams, std::vector<mp_par> parameterLimits
 }
 
 
+/* ---------------- FUNCTION: BootstrapErrors1D ------------------------ */
+/// Does bootstrap resampling of the profile in theModel without printing anything
+/// (so it can be called for many profiles in parallel), and stores the standard
+/// deviation of each parameter's bootstrap values in paramSigmas (0 for fixed 
+/// parameters, or if there were fewer than two successful iterations).
+/// Returns the number of successful iterations.
+int BootstrapErrors1D( double *bestfitParams, std::vector<mp_par> parameterLimits, 
+						bool paramLimitsExist, ModelObject *theModel, double ftol,
+						int nIterations, int nFreeParams, unsigned long rngSeed,
+						unsigned long firstStreamID, double *paramSigmas )
+{
+  double  **paramArray;
+  int  i, nSuccessful;
+  int  nParams = theModel->GetNParams();
+
+  paramArray = (double **)calloc( (size_t)nParams, sizeof(double *) );
+  for (i = 0; i < nParams; i++)
+    paramArray[i] = (double *)calloc( (size_t)nIterations, sizeof(double) );
+
+  nSuccessful = DoBootstrapIterations(bestfitParams, parameterLimits, paramLimitsExist,
+  							theModel, ftol, nIterations, nFreeParams, rngSeed, firstStreamID, 
+  							paramArray);
+  for (i = 0; i < nParams; i++) {
+    if ((nSuccessful > 1) && ((! paramLimitsExist) || (parameterLimits[i].fixed == 0)))
+      paramSigmas[i] = StandardDeviation(paramArray[i], nSuccessful);
+    else
+      paramSigmas[i] = 0.0;
+  }
+
+  for (i = 0; i < nParams; i++)
+    free(paramArray[i]);
+  free(paramArray);
+  return nSuccessful;
+}
+
+
+/* ---------------- FUNCTION: DoBootstrapIterations -------------------- */
+// Does the actual bootstrap resampling + fitting. Each resampling is generated
+// from its own counter-based random-number stream (rngSeed, firstStreamID + nIter),
+// so the results do not depend on what other profiles or threads are doing.
+// Best-fit parameters from successful fits are stored in paramArray[i][0...];
+// returns the number of successful fits.
+static int DoBootstrapIterations( double *bestfitParams, std::vector<mp_par> parameterLimits, 
+						bool paramLimitsExist, ModelObject *theModel, double ftol,
+						int nIterations, int nFreeParams, unsigned long rngSeed,
+						unsigned long firstStreamID, double **paramArray )
+{
+  double  *paramsVect;
+  int  i, status, nIter;
+  int  nSuccessful = 0;
+  int  nParams = theModel->GetNParams();
+  int  nStoredDataVals = theModel->GetNDataValues();
+  int  verboseLevel = -1;   // ensure minimizer stays silent
+  RNGStream  rngStream(rngSeed, firstStreamID);
+  
+  paramsVect = (double *) malloc(nParams * sizeof(double));
+
+  status = theModel->UseBootstrap(&rngStream);
+  if (status < 0) {
+    free(paramsVect);
+    return 0;
+  }
+
+  for (nIter = 0; nIter < nIterations; nIter++) {
+    rngStream.SetStream(firstStreamID + (unsigned long)nIter);
+    theModel->MakeBootstrapSample(&rngStream);
+    for (i = 0; i < nParams; i++)
+      paramsVect[i] = bestfitParams[i];
+    status = LevMarFit(nParams, nFreeParams, nStoredDataVals, paramsVect, parameterLimits, 
+	   					theModel, ftol, paramLimitsExist, verboseLevel);
+    if (status > 0) {
+      for (i = 0; i < nParams; i++)
+        paramArray[i][nSuccessful] = paramsVect[i];
+      nSuccessful++;
+    }
+  }
+
+  free(paramsVect);
+  return nSuccessful;
+}
+
+
 
 /* END OF FILE: bootstrap_errors_1d.cpp -------------------------------- */
@@ -10,9 +10,19 @@
 #include "model_object.h"
 
 
+/// Does bootstrap resampling and prints the resulting parameter statistics;
+/// if rngSeed = 0, the current time is used as the seed
 void BootstrapErrors( double *bestfitParams, std::vector<mp_par> parameterLimits, 
 						bool paramLimitsExist, ModelObject *theModel, double ftol,
-						int nIterations, int nFreeParams );
+						int nIterations, int nFreeParams, unsigned long rngSeed=0 );
+
+/// Does bootstrap resampling silently, storing the standard deviation of each
+/// parameter in paramSigmas; iteration i uses random-number stream 
+/// (rngSeed, firstStreamID + i). Returns the number of successful iterations.
+int BootstrapErrors1D( double *bestfitParams, std::vector<mp_par> parameterLimits, 
+						bool paramLimitsExist, ModelObject *theModel, double ftol,
+						int nIterations, int nFreeParams, unsigned long rngSeed,
+						unsigned long firstStreamID, double *paramSigmas );
 
 
 #endif  // _BOOTSTRAP_ERRORS_1D_H_
@@ -18,20 +18,33 @@
 
 #include "fftw3.h"
 
+#include "definitions.h"
 #include "convolver1d.h"
 
 //using namespace std;
 
 
+// Cost model for CONVOLVE_AUTO, in units of one multiply-add of the direct
+// convolution loop (same form as for the 2D Convolver class, but the 1D code uses
+// complex-to-complex FFTs, which cost about twice as much as real-to-complex ones):
+// each FFT of N pixels costs ~ FFT_COST_FACTOR_1D * N log2(N), plus ~
+// FFT_PIXEL_COST_1D * N for zeroing, copying, and complex multiplication.
+const double  FFT_COST_FACTOR_1D = 6.0;
+const double  FFT_PIXEL_COST_1D = 10.0;
+
+
 
 /* ---------------- CONSTRUCTOR ---------------------------------------- */
 
 Convolver1D::Convolver1D( )
 {
+  convolutionMethod = CONVOLVE_AUTO;
   psfInfoSet = false;
   profileInfoSet = false;
   fftVectorsAllocated = false;
   fftPlansCreated = false;
+  psfAllocated = false;
+  directVectorAllocated = false;
 }
 
 
@@ -41,9 +54,13 @@ Convolver1D::~Convolver1D( )
 {
 
   if (fftPlansCreated) {
+    // FFTW planner routines (including plan destruction) are not thread-safe
+    #pragma omp critical (fftw_planner_1d)
+    {
     fftw_destroy_plan(plan_InputProfile);
     fftw_destroy_plan(plan_psf);
     fftw_destroy_plan(plan_inverse);
+    }
   }
   if (fftVectorsAllocated) {
     fftw_free(profile_in_cmplx);
@@ -54,16 +71,38 @@ Convolver1D::~Convolver1D( )
     fftw_free(convolvedProfile_cmplx);
 
   }
+  if (psfAllocated)
+    free(psfPixels);
+  if (directVectorAllocated)
+    free(directOutput);
+}
+
+
+/* ---------------- SetConvolutionMethod ------------------------------- */
+/// Specifies how convolutions are done: CONVOLVE_FFT (zero-padded FFT of the whole
+/// profile), CONVOLVE_DIRECT (direct summation over the PSF), or CONVOLVE_AUTO
+/// (the default: whichever is estimated to be faster, which is direct summation for 
+/// short PSFs). Must be called before DoFullSetup. Returns -1 for other values.
+int Convolver1D::SetConvolutionMethod( int method )
+{
+  if ((method != CONVOLVE_AUTO) && (method != CONVOLVE_FFT) && (method != CONVOLVE_DIRECT)) {
+    fprintf(stderr, "*** ERROR: Convolver1D::SetConvolutionMethod: unsupported method (%d)!\n",
+    		method);
+    return -1;
+  }
+  convolutionMethod = method;
+  return 0;
 }
 
 
 /* ---------------- SetupPSF ------------------------------------------- */
 // Pass in a pointer to the pixel vector for the input PSF profiles, as well as
-// its size.
+// its size. (The input vector is not modified: DoFullSetup makes a normalized
+// copy, so the same PSF vector can be shared by multiple Convolver1D objects.)
 void Convolver1D::SetupPSF( double *psfPixels_input, int nPixels )
 {
 
-  psfPixels = psfPixels_input;
+  inputPsfPixels = psfPixels_input;
   nPixels_psf = nPixels;
   psfInfoSet = true;
 }
@@ -81,8 +120,9 @@ void Convolver1D::SetupProfile( int nPixels )
 
 /* ---------------- DoFullSetup ---------------------------------------- */
 // General setup prior to actually supplying the profiles data and doing the
-// convolution: determine padding size; allocate FFTW arrays and plans;
-// normalize, shift, and Fourier transform the PSF profiles.
+// convolution: normalize (a copy of) the PSF; choose the convolution method;
+// for FFT convolution, determine padding size, allocate FFTW arrays and plans,
+// and shift and Fourier transform the PSF profile.
 int Convolver1D::DoFullSetup( int debugLevel, bool doFFTWMeasure )
 {
   int  k;
@@ -98,15 +138,40 @@ int Convolver1D::DoFullSetup( int debugLevel, bool doFFTWMeasure )
   }
   nPixels_padded = nPixels_data + nPixels_psf - 1;
   rescaleFactor = 1.0 / nPixels_padded;
+
+  // Normalize the PSF
+  if (debugStatus >= 1) {
+    printf("Normalizing the PSF ...\n");
+    if (debugStatus >= 2) {
+      printf("The whole input PSF profile:\n");
+      PrintRealProfile(inputPsfPixels, nPixels_psf);
+    }
+  }
+  psfPixels = (double *) calloc((size_t)nPixels_psf, sizeof(double));
+  psfAllocated = true;
+  psfSum = 0.0;
+  for (k = 0; k < nPixels_psf; k++)
+    psfSum += inputPsfPixels[k];
+  for (k = 0; k < nPixels_psf; k++)
+    psfPixels[k] = inputPsfPixels[k] / psfSum;
+  if (debugStatus >= 2) {
+    printf("The whole *normalized* PSF profile:\n");
+    PrintRealProfile(psfPixels, nPixels_psf);
+  }
+
+  if (convolutionMethod == CONVOLVE_AUTO)
+    convolutionMethod = ChooseConvolutionMethod();
+  if (convolutionMethod == CONVOLVE_DIRECT) {
+    if (debugStatus >= 1)
+      printf("Using direct convolution\n");
+    directOutput = (double *) calloc((size_t)nPixels_data, sizeof(double));
+    directVectorAllocated = true;
+    return 0;
+  }
+
   if (debugStatus >= 1)
     printf("Profiles will be padded to %d pixels in size\n", nPixels_padded);
 
-#ifdef FFTW_THREADING
-  // TEST: multi-threaded FFTW:
-  int  threadStatus;
-  threadStatus = fftw_init_threads();
-#endif  // FFTW_THREADING
-
   // allocate memory for fftw_complex arrays
   profile_in_cmplx = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_padded);
   profile_fft_cmplx = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPixels_padded);
@@ -121,6 +186,16 @@ int Convolver1D::DoFullSetup( int debugLevel, bool doFFTWMeasure )
     fftwFlags = FFTW_MEASURE;
   else
     fftwFlags = FFTW_ESTIMATE;
+  // FFTW planner routines are not thread-safe, so only one thread at a time can
+  // be here (e.g., when profilefit is fitting multiple profiles in parallel)
+  #pragma omp critical (fftw_planner_1d)
+  {
+#ifdef FFTW_THREADING
+  // TEST: multi-threaded FFTW:
+  int  threadStatus;
+  threadStatus = fftw_init_threads();
+#endif  // FFTW_THREADING
+
   // Note that there's not much purpose in multi-threading plan_psf, since we only do
   // the FFT of the PSF once
   plan_psf = fftw_plan_dft_1d(nPixels_padded, psf_in_cmplx, psf_fft_cmplx, FFTW_FORWARD,
@@ -136,29 +211,12 @@ int Convolver1D::DoFullSetup( int debugLevel, bool doFFTWMeasure )
                              fftwFlags);
   plan_inverse = fftw_plan_dft_1d(nPixels_padded, multiplied_cmplx, convolvedProfile_cmplx, FFTW_BACKWARD, 
                              fftwFlags);
+  }
   fftPlansCreated = true;
   
 
   // Generate the Fourier transform of the PSF:
-  // First, normalize the PSF
-  if (debugStatus >= 1) {
-    printf("Normalizing the PSF ...\n");
-    if (debugStatus >= 2) {
-      printf("The whole input PSF profile:\n");
-      PrintRealProfile(psfPixels, nPixels_psf);
-    }
-  }
-  psfSum = 0.0;
-  for (k = 0; k < nPixels_psf; k++)
-    psfSum += psfPixels[k];
-  for (k = 0; k < nPixels_psf; k++)
-    psfPixels[k] = psfPixels[k] / psfSum;
-  if (debugStatus >= 2) {
-    printf("The whole *normalized* PSF profile:\n");
-    PrintRealProfile(psfPixels, nPixels_psf);
-  }
-
-  // Second, prepare (complex) psf array for FFT, and then copy input PSF into
+  // First, prepare (complex) psf array for FFT, and then copy normalized PSF into
   // it with appropriate shift/wrap:
   for (k = 0; k < nPixels_padded; k++) {
     psf_in_cmplx[k][0] = 0.0;
@@ -181,6 +239,27 @@ int Convolver1D::DoFullSetup( int debugLevel, bool doFFTWMeasure )
 }
 
 
+/* ---------------- ChooseConvolutionMethod ---------------------------- */
+// Returns CONVOLVE_DIRECT or CONVOLVE_FFT, whichever has the lower estimated cost
+// (see the cost-model constants at the top of this file): FFT convolution requires
+// two transforms of the padded profile, direct convolution one multiply-add per
+// PSF pixel per profile pixel.
+int Convolver1D::ChooseConvolutionMethod( )
+{
+  double  nPixPadded, fftCost, directCost;
+
+  nPixPadded = (double)nPixels_padded;
+  fftCost = 2.0*FFT_COST_FACTOR_1D*nPixPadded*log2(nPixPadded) + FFT_PIXEL_COST_1D*nPixPadded;
+  directCost = (double)nPixels_data * nPixels_psf;
+  if (debugStatus >= 1)
+    printf("Convolution cost estimates: FFT = %g, direct = %g\n", fftCost, directCost);
+  if (directCost < fftCost)
+    return CONVOLVE_DIRECT;
+  else
+    return CONVOLVE_FFT;
+}
+
+
 /* ---------------- ConvolveProfile ------------------------------------ */
 // Given an input profiles (pointer to its pixel vector), convolve it with the PSF
 // by: 1) Copying profiles to fft_complex array; 2) Taking FFT of profiles; 3)
@@ -191,6 +270,11 @@ void Convolver1D::ConvolveProfile( double *pixelVector )
   int  ii, jj;
   double  a, b, c, d, realPart;
   
+  if (convolutionMethod == CONVOLVE_DIRECT) {
+    ConvolveProfile_direct(pixelVector);
+    return;
+  }
+
   if (debugStatus >= 3) {
     printf("nPixels_data = %d, nPixels_padded = %d\n", nPixels_data, nPixels_padded);
     printf("Original input profile [pixelVector]:\n");
@@ -263,6 +347,35 @@ void Convolver1D::ConvolveProfile( double *pixelVector )
 }
 
 
+/* ---------------- ConvolveProfile_direct ----------------------------- */
+// Direct-space version of ConvolveProfile: output pixel i is the sum over PSF
+// pixels k of psf[k] * input[i + center - k], with input pixels outside the
+// profile treated as zero -- i.e., the same result as the zero-padded FFT
+// convolution, without its roundoff noise.
+void Convolver1D::ConvolveProfile_direct( double *pixelVector )
+{
+  int  centerX_psf = nPixels_psf / 2;
+  int  kMin, kMax;
+  double  sum;
+
+  for (int i = 0; i < nPixels_data; i++) {
+    // restrict k so that 0 <= i + centerX_psf - k < nPixels_data
+    kMin = i + centerX_psf - nPixels_data + 1;
+    if (kMin < 0)
+      kMin = 0;
+    kMax = i + centerX_psf;
+    if (kMax > nPixels_psf - 1)
+      kMax = nPixels_psf - 1;
+    sum = 0.0;
+    for (int k = kMin; k <= kMax; k++)
+      sum += psfPixels[k] * pixelVector[i + centerX_psf - k];
+    directOutput[i] = sum;
+  }
+  for (int i = 0; i < nPixels_data; i++)
+    pixelVector[i] = directOutput[i];
+}
+
+
 // ShiftAndWrapPSF: Takes the input PSF (assumed to be centered in the central pixel
 // of the profile) and copy it into the real part of the (padded) fftw_complex profile,
 // with the PSF wrapped into the edges, suitable for convolutions.
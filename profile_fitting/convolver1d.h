@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "fftw3.h"
+#include "definitions.h"
 
 using namespace std;
 
@@ -46,6 +47,14 @@ class Convolver1D
     ~Convolver1D( );
     
     // Public member functions:
+    /// Specify convolution method (CONVOLVE_AUTO [default], CONVOLVE_FFT, or
+    /// CONVOLVE_DIRECT)
+    int SetConvolutionMethod( int method );
+
+    /// Return the convolution method in use (after DoFullSetup, CONVOLVE_AUTO
+    /// will have been replaced by the method actually chosen)
+    int GetConvolutionMethod( ) { return convolutionMethod; };
+
     void SetupPSF( double *psfPixels_input, int nPixels );
     
     void SetupProfile( int nPixels );
@@ -57,19 +66,25 @@ class Convolver1D
 
   private:
   // Private member functions:
+    int ChooseConvolutionMethod( );
+
     void ShiftAndWrapPSF( );
   
+    void ConvolveProfile_direct( double *pixelVector );
+
     // Data members:
     int  nPixels_data, nPixels_psf, nPixels_padded;
+    int  convolutionMethod;
     double  rescaleFactor;
-    double  *dataPixels;
-    double  *psfPixels;
-    double  *convolvedData_real, *convolvedData_padded;
+    double  *inputPsfPixels;   // caller's PSF (not modified)
+    double  *psfPixels;      // normalized copy of input PSF
+    double  *directOutput;
     fftw_complex  *profile_in_cmplx, *profile_fft_cmplx;
     fftw_complex  *psf_in_cmplx, *psf_fft_cmplx;
     fftw_complex  *multiplied_cmplx, *convolvedProfile_cmplx;
     fftw_plan  plan_InputProfile, plan_psf, plan_inverse;
     bool  psfInfoSet, profileInfoSet, fftVectorsAllocated, fftPlansCreated;
+    bool  psfAllocated, directVectorAllocated;
     int  debugStatus;
 };
 
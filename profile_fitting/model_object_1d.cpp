@@ -63,7 +63,7 @@ ModelObject1d::ModelObject1d( )
   bootstrapIndicesAllocated = false;
   zeroPointSet = false;
   nFunctions = 0;
-  nFunctionBlocks = 0;
+  nFunctionSets = 0;
   nFunctionParams = 0;
   nParamsTot = 0;
   dataStartOffset = 0;
@@ -76,26 +76,26 @@ ModelObject1d::ModelObject1d( )
 }
 
 
-/* ---------------- PUBLIC METHOD: DefineFunctionBlocks --------------- */
+/* ---------------- PUBLIC METHOD: DefineFunctionSets --------------- */
 // We have to redefine this function from the ModelObject base function because
 // nParamsTot is calculated differently
-void ModelObject1d::DefineFunctionBlocks( vector<int>& functionStartIndices )
+void ModelObject1d::DefineFunctionSets( vector<int>& functionStartIndices )
 {
   int  nn, i;
   
-  nFunctionBlocks = functionStartIndices.size();
+  nFunctionSets = functionStartIndices.size();
     // define array of [false, false, false, ...]
-  fblockStartFlags = (bool *)calloc(nFunctions, sizeof(bool));
-  for (i = 0; i < nFunctionBlocks; i++) {
+  fsetStartFlags = (bool *)calloc(nFunctions, sizeof(bool));
+  for (i = 0; i < nFunctionSets; i++) {
     nn = functionStartIndices[i];
     // function number n is start of new function block; 
-    // change fblockStartFlags[n] to true
-    fblockStartFlags[nn] = true;
+    // change fsetStartFlags[n] to true
+    fsetStartFlags[nn] = true;
   }
   
   // total number of parameters = number of parameters for individual functions
   // plus x0 for each function block
-  nParamsTot = nFunctionParams + nFunctionBlocks;
+  nParamsTot = nFunctionParams + nFunctionSets;
 }
 
 
@@ -181,7 +181,7 @@ void ModelObject1d::AddErrorVector1D( int nDataValues, double *inputVector,
 // Note that although our default *input* format is "0 = good pixel, > 0 =
 // bad pixel", internally we convert all bad pixels to 0 and all good pixels
 // to 1, so that we can multiply the weight vector by the (internal) mask values.
-int ModelObject1d::AddMaskVector1D( int nDataValues, double *inputVector,
+int ModelObject1d::AddMaskVector1D( long nDataValues, double *inputVector,
                                       int inputType )
 {
   int  returnStatus = 0;
@@ -198,7 +198,8 @@ int ModelObject1d::AddMaskVector1D( int nDataValues, double *inputVector,
     case MASK_ZERO_IS_GOOD:
       // This is our "standard" input mask: good pixels are zero, bad pixels
       // are positive integers
-      printf("ModelObject1D::AddMaskVector -- treating zero-valued pixels as good ...\n");
+      if (verboseLevel >= 0)
+        printf("ModelObject1D::AddMaskVector -- treating zero-valued pixels as good ...\n");
       for (int z = 0; z < nDataVals; z++) {
         if (maskVector[z] > 0.0) {
           maskVector[z] = 0.0;
@@ -211,7 +212,8 @@ int ModelObject1d::AddMaskVector1D( int nDataValues, double *inputVector,
       break;
     case MASK_ZERO_IS_BAD:
       // Alternate form for input masks: good pixels are 1, bad pixels are 0
-      printf("ModelObject::AddMaskVector -- treating zero-valued pixels as bad ...\n");
+      if (verboseLevel >= 0)
+        printf("ModelObject1D::AddMaskVector -- treating zero-valued pixels as bad ...\n");
       for (int z = 0; z < nDataVals; z++) {
         if (maskVector[z] < 1.0)
           maskVector[z] = 0.0;
@@ -261,6 +263,7 @@ int ModelObject1d::AddPSFVector1D( int nPixels_psf, double *xValVector, double *
     modelXValues[i + nPSFVals + nDataVals] = dataXValues[nDataVals - 1] + deltaX*(i + 1);
   // 4. Create and setup Convolver1D object
   psfConvolver = new Convolver1D();
+  psfConvolver->SetConvolutionMethod(convolutionMethod);
   psfConvolver->SetupPSF(yValVector, nPSFVals);
   psfConvolver->SetupProfile(nModelVals);
   psfConvolver->DoFullSetup(debugLevel);
@@ -277,7 +280,7 @@ int ModelObject1d::AddPSFVector1D( int nPixels_psf, double *xValVector, double *
 int ModelObject1d::FinalSetupForFitting( )
 {
   int  nNonFinitePixels = 0;
-  int  returnStatus;
+  int  returnStatus = 0;
   
   // Create a default all-pixels-valid mask if no mask already exists
   if (! maskExists) {
@@ -383,7 +386,7 @@ void ModelObject1d::CreateModelImage( double params[] )
   // start at params[paramSizes[0]], the third at 
   // params[paramSizes[0] + paramSizes[1]], and so forth...
   for (n = 0; n < nFunctions; n++) {
-    if (fblockStartFlags[n] == true) {
+    if (fsetStartFlags[n] == true) {
       // start of new function block: extract x0 and then skip over them
       x0 = params[offset];
       offset += 1;
@@ -452,10 +455,14 @@ void ModelObject1d::ComputeDeviates( double yResults[], double params[] )
   CreateModelImage(params);
   
   if (doBootstrap) {
-    for (int z = 0; z < nDataVals; z++) {
+    // bootstrap samples contain nValidDataVals indices of unmasked points; 
+    // the remaining deviates are zero
+    for (int z = 0; z < nValidDataVals; z++) {
       int i = bootstrapIndices[z];
       yResults[z] = weightVector[i] * (dataVector[i] - modelVector[dataStartOffset + i]);
     }
+    for (int z = nValidDataVals; z < nDataVals; z++)
+      yResults[z] = 0.0;
   } else {
     for (int z = 0; z < nDataVals; z++) {
       yResults[z] = weightVector[z] * (dataVector[z] - modelVector[dataStartOffset + z]);
@@ -495,7 +502,7 @@ void ModelObject1d::PrintDescription( )
 //   string  funcName, paramName;
 // 
 //   for (int n = 0; n < nFunctions; n++) {
-//     if (fblockStartFlags[n] == true) {
+//     if (fsetStartFlags[n] == true) {
 //       // start of new function block: extract x0,y0 and then skip over them
 //       k = indexOffset;
 //       x0 = params[k] + parameterInfoVect[k].offset;
@@ -552,7 +559,7 @@ int ModelObject1d::PrintModelParamsToStrings( vector<string> &stringVector, doub
   }
 
   for (int n = 0; n < nFunctions; n++) {
-    if (fblockStartFlags[n] == true) {
+    if (fsetStartFlags[n] == true) {
       // start of new function block: extract x0,y0 and then skip over them
       k = indexOffset;
       x0 = params[k] + parameterInfoVect[k].offset;
@@ -603,6 +610,36 @@ int ModelObject1d::PrintModelParamsToStrings( vector<string> &stringVector, doub
 }
 
 
+/* ---------------- PUBLIC METHOD: GetParamHeader ---------------------- */
+// This function is redefined because the base function in ModelObject assumes
+// two positional parameters ("X0_1  Y0_1").
+
+string ModelObject1d::GetParamHeader( )
+{
+  int  nParamsThisFunc, nSet;
+  int  indexOffset = 0;
+  string  paramName, headerLine;
+
+  headerLine = "# ";
+  nSet = 0;
+  for (int n = 0; n < nFunctions; n++) {
+    if (fsetStartFlags[n] == true) {
+      // start of new function set: skip over x0
+      nSet += 1;
+      headerLine += PrintToString("X0_%d\t\t", nSet);
+      indexOffset += 1;
+    }
+    nParamsThisFunc = paramSizes[n];
+    for (int i = 0; i < nParamsThisFunc; i++) {
+      paramName = GetParameterName(indexOffset + i);
+      headerLine += PrintToString("%s_%d\t", paramName.c_str(), n + 1);
+    }
+    indexOffset += paramSizes[n];
+  }
+  return headerLine;
+}
+
+
 /* ---------------- PUBLIC METHOD: PopulateParameterNames -------------- */
 // This function is redefined because the base function in ModelObject assumes
 // two positional paramters ("X0").
@@ -612,7 +649,7 @@ void ModelObject1d::PopulateParameterNames( )
   int  n;
 
   for (n = 0; n < nFunctions; n++) {
-    if (fblockStartFlags[n] == true) {
+    if (fsetStartFlags[n] == true) {
       // start of new function block: extract x0
       parameterLabels.push_back("X0");
     }
@@ -785,7 +822,7 @@ ModelObject1d::~ModelObject1d()
     maskVectorAllocated = false;
   }
   if (doConvolution) {
-    free(psfConvolver);
+    delete psfConvolver;
     free(modelXValues);
     doConvolution = false;
   }
@@ -795,9 +832,9 @@ ModelObject1d::~ModelObject1d()
       delete functionObjects[i];
     nFunctions = 0;
   }
-  if (fblockStartFlags_allocated) {
-    free(fblockStartFlags);
-    fblockStartFlags_allocated = false;
+  if (fsetStartFlags_allocated) {
+    free(fsetStartFlags);
+    fsetStartFlags_allocated = false;
   }
   
   if (bootstrapIndicesAllocated) {
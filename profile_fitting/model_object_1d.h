@@ -31,7 +31,7 @@ class ModelObject1d : public ModelObject
     ModelObject1d( );
     
    // redefined method/member functions:
-    void DefineFunctionBlocks( vector<int>& functionStartIndices );
+    void DefineFunctionSets( vector<int>& functionStartIndices );
     
     void AddDataVectors( int nDataValues, double *xValVector, double *yValVector,
     											bool magnitudeData );
@@ -40,7 +40,7 @@ class ModelObject1d : public ModelObject
     
     void AddErrorVector1D( int nDataValues, double *inputVector, int inputType );
 
-    int AddMaskVector1D( int nDataValues, double *inputVector, int inputType );
+    int AddMaskVector1D( long nDataValues, double *inputVector, int inputType );
     
     int AddPSFVector1D( int nPixels_psf, double *xValVector, double *yValVector );
     
@@ -51,6 +51,8 @@ class ModelObject1d : public ModelObject
     void PrintDescription( );
     
     int Dimensionality( ) { return 1;};
+
+    string GetParamHeader( );
     
 //     void PrintModelParams( FILE *output_ptr, double params[], double errs[], 
 //     						const char *prefix="" );
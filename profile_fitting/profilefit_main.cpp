@@ -5,6 +5,12 @@
  * columns of numbers (first column = radius or x value; second column = 
  * intensity, magnitudes per square arcsec, or some other y value; third
  * column = optional errors on y values).
+ *
+ * With --batch, the data file instead contains many profiles with common x values
+ * (text file: x, then y [, y_err [, mask]] for each profile; or a binary profile
+ * file, as described in read_profile.cpp); all profiles are fit with the same model
+ * (in parallel, if the L-M solver is used), and the results are saved in a single
+ * table.
 */
 
 
@@ -14,9 +20,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <string>
 #include <vector>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 #include "definitions.h"
 #include "utilities_pub.h"
 #include "read_profile_pub.h"
@@ -27,6 +38,7 @@
 #include "func1d_exp.h"
 #include "param_struct.h"   // for mp_par structure
 #include "bootstrap_errors_1d.h"
+#include "batch_fit_1d.h"
 
 
 // Solvers (optimization algorithms)
@@ -61,6 +73,7 @@
 #define DEFAULT_CONFIG_FILE   "sample_imfit1d_config.dat"
 #define DEFAULT_MODEL_OUTPUT_FILE   "model_profile_save.dat"
 #define DEFAULT_1D_OUTPUT_PARAMETER_FILE   "bestfit_parameters_profilefit.dat"
+#define DEFAULT_1D_BATCH_OUTPUT_FILE   "bestfit_parameters_profilefit_batch.dat"
 
 #define VERSION_STRING      "v1.5"
 
@@ -94,6 +107,10 @@ typedef struct {
   int  bootstrapIterations;
   int  verbose;
   unsigned long  rngSeed;
+  bool  batchMode;
+  int  maxThreads;
+  bool  maxThreadsSet;
+  int  convolutionMethod;
 } commandOptions;
 
 
@@ -103,6 +120,11 @@ typedef struct {
 
 /* Local Functions: */
 void ProcessInput( int argc, char *argv[], commandOptions *theOptions );
+int ReadPSFProfile( std::string& psfFileName, double **xVals_psf, double **yVals_psf );
+int DoBatchFits( commandOptions& options, vector<string>& functionList,
+				vector<int>& functionSetIndices, vector<double>& parameterList,
+				vector<mp_par>& paramLimits, bool paramLimitsExist, 
+				vector<string>& programHeader );
 int myfunc( int nDataVals, int nParams, double *params, double *deviates,
            double **derivatives, ModelObject *aModel );
 
@@ -128,7 +150,7 @@ int myfunc( int nDataVals, int nParams, double *params, double *deviates,
 int main(int argc, char *argv[])
 {
   int  nDataVals, nStoredDataVals, nSavedRows;
-  int  nPixels_psf;
+  int  nPixels_psf = 0;
   int  startDataRow, endDataRow;
   int  nParamsTot, nFreeParams;
   int  nDegFreedom;
@@ -146,6 +168,7 @@ int main(int argc, char *argv[])
   vector<mp_par>  parameterInfo;
   int  status, fitStatus;
   vector<string>  functionList;
+  vector<string>  functionLabelList;
   vector<double>  parameterList;
   commandOptions  options;
   configOptions  userConfigOptions;
@@ -184,6 +207,10 @@ int main(int argc, char *argv[])
   options.verbose = 1;
   options.nloptSolverName = "";
   options.rngSeed = 0;
+  options.batchMode = false;
+  options.maxThreads = 0;
+  options.maxThreadsSet = false;
+  options.convolutionMethod = CONVOLVE_AUTO;
 
   progNameVersion += VERSION_STRING;
   MakeOutputHeader(&programHeader, progNameVersion, argc, argv);
@@ -201,13 +228,18 @@ int main(int argc, char *argv[])
            options.configFileName.c_str());
     return -1;
   }
-  status = ReadConfigFile(options.configFileName, false, functionList, parameterList, paramLimits, 
-                  FunctionBlockIndices, paramLimitsExist, userConfigOptions);
+  status = ReadConfigFile(options.configFileName, false, functionList, functionLabelList, 
+                  parameterList, paramLimits, FunctionBlockIndices, paramLimitsExist, 
+                  userConfigOptions);
   if (status < 0) {
     printf("\n*** WARNING: Problem in processing config file!\n\n");
     return -1;
   }
 
+  if (options.batchMode)
+    return DoBatchFits(options, functionList, FunctionBlockIndices, parameterList,
+    					paramLimits, paramLimitsExist, programHeader);
+
 
   /* GET THE DATA: */
   nDataVals = CountDataLines(options.dataFileName);
@@ -275,41 +307,15 @@ int main(int argc, char *argv[])
 
 
   /* Read in PSF profile, if supplied */
-  if (options.psfPresent) {
-    nPixels_psf = CountDataLines(options.psfFileName);
-    if ((nPixels_psf < 1) || (nPixels_psf > MAX_N_DATA_VALS)) {
-      /* file has no data *or* too much data (or an integer overflow occured 
-         in CountDataLines) */
-      printf("Something wrong: input PSF file %s has too few or too many data points\n", 
-             options.psfFileName.c_str());
-      printf("(nPixels_psf (# of PSF points) = %d)\n", nPixels_psf);
-      exit(1);
-    }
-    printf("PSF file \"%s\": %d data points\n", options.psfFileName.c_str(), nPixels_psf);
-    /* Set default end data row (if not specified) and check for reasonable values: */
-    startDataRow = 0;
-    endDataRow = nPixels_psf - 1;
-
-    xVals_psf = (double *)calloc( (size_t)nPixels_psf, sizeof(double) );
-    yVals_psf = (double *)calloc( (size_t)nPixels_psf, sizeof(double) );
-    if ( (xVals_psf == NULL) || (yVals_psf == NULL) ) {
-      fprintf(stderr, "\nFailure to allocate memory for PSF data!\n");
-      exit(-1);
-    }
-
-    nSavedRows = ReadDataFile(options.psfFileName, startDataRow, endDataRow, 
-                               xVals_psf, yVals_psf, NULL, NULL);
-    if (nSavedRows > nStoredDataVals) {
-      fprintf(stderr, "\nMore PSF rows saved (%d) than we allocated space for (%d)!\n",
-              nSavedRows, nPixels_psf);
-      exit(-1);
-    }
-  }
+  if (options.psfPresent)
+    nPixels_psf = ReadPSFProfile(options.psfFileName, &xVals_psf, &yVals_psf);
 
 
 
   /* Set up the model object */
   theModel = new ModelObject1d();
+  if (options.maxThreadsSet)
+    theModel->SetMaxThreads(options.maxThreads);
   
   /* Add functions to the model object */
   printf("Adding functions to model object...\n");
@@ -342,6 +348,7 @@ int main(int argc, char *argv[])
   }
   // Add PSF vector, if present, and thereby enable convolution
   if (options.psfPresent) {
+    theModel->SetConvolutionMethod(options.convolutionMethod);
     status = theModel->AddPSFVector1D(nPixels_psf, xVals_psf, yVals_psf);
     if (status < 0) {
       fprintf(stderr, "*** ERROR: Failure in ModelObject::AddPSFVector1D!\n\n");
@@ -402,9 +409,8 @@ int main(int argc, char *argv[])
   if ((options.doBootstrap) && (options.bootstrapIterations > 0)) {
     printf("\nNow doing bootstrap resampling (%d iterations) to estimate errors...\n",
            options.bootstrapIterations);
-    printf("[NOT YET PROPERLY IMPLEMENTED!]\n");
     BootstrapErrors(paramsVect, parameterInfo, paramLimitsExist, theModel,
-                    options.ftol, options.bootstrapIterations, nFreeParams);
+                    options.ftol, options.bootstrapIterations, nFreeParams, options.rngSeed);
   }
   
   
@@ -458,6 +464,154 @@ int main(int argc, char *argv[])
 
 
 
+/* ---------------- FUNCTION: ReadPSFProfile --------------------------- */
+/// Reads in the PSF profile (first two columns of psfFileName), allocating
+/// *xVals_psf and *yVals_psf; returns the number of PSF points (exits on errors).
+int ReadPSFProfile( std::string& psfFileName, double **xVals_psf, double **yVals_psf )
+{
+  int  nPixels_psf, nSavedRows;
+
+  nPixels_psf = CountDataLines(psfFileName);
+  if ((nPixels_psf < 1) || (nPixels_psf > MAX_N_DATA_VALS)) {
+    /* file has no data *or* too much data (or an integer overflow occured 
+       in CountDataLines) */
+    printf("Something wrong: input PSF file %s has too few or too many data points\n", 
+           psfFileName.c_str());
+    printf("(nPixels_psf (# of PSF points) = %d)\n", nPixels_psf);
+    exit(1);
+  }
+  printf("PSF file \"%s\": %d data points\n", psfFileName.c_str(), nPixels_psf);
+
+  *xVals_psf = (double *)calloc( (size_t)nPixels_psf, sizeof(double) );
+  *yVals_psf = (double *)calloc( (size_t)nPixels_psf, sizeof(double) );
+  if ( (*xVals_psf == NULL) || (*yVals_psf == NULL) ) {
+    fprintf(stderr, "\nFailure to allocate memory for PSF data!\n");
+    exit(-1);
+  }
+
+  nSavedRows = ReadDataFile(psfFileName, 0, nPixels_psf - 1, *xVals_psf, *yVals_psf, 
+                             NULL, NULL);
+  if (nSavedRows > nPixels_psf) {
+    fprintf(stderr, "\nMore PSF rows saved (%d) than we allocated space for (%d)!\n",
+            nSavedRows, nPixels_psf);
+    exit(-1);
+  }
+  return nPixels_psf;
+}
+
+
+
+/* ---------------- FUNCTION: DoBatchFits ------------------------------ */
+/// Reads all the profiles in the data file (multi-profile text file, or binary
+/// profile file), fits each of them with the model from the config file, and
+/// saves the results in a single table. Returns 0 on success, -1 on errors.
+int DoBatchFits( commandOptions& options, vector<string>& functionList,
+				vector<int>& functionSetIndices, vector<double>& parameterList,
+				vector<mp_par>& paramLimits, bool paramLimitsExist, 
+				vector<string>& programHeader )
+{
+  profileSet  profiles;
+  batchFitSetup  setup;
+  vector<profileFitResult>  results;
+  mp_par  newParamLimit;
+  double  *xVals_psf = NULL;
+  double  *yVals_psf = NULL;
+  int  nColumnsPerProfile, nProfiles, nSuccessful, nThreads;
+  int  status;
+  time_t  startTime, endTime;
+
+  /* Read in the profiles */
+  nColumnsPerProfile = 1;
+  if (! options.noErrors)
+    nColumnsPerProfile++;
+  if (! options.noMask) {
+    if (options.noErrors) {
+      fprintf(stderr, "*** ERROR: batch mode with --usemask requires --useerrors!\n\n");
+      return -1;
+    }
+    nColumnsPerProfile++;
+  }
+  if (IsBinaryProfileFile(options.dataFileName))
+    nProfiles = ReadBinaryProfileFile(options.dataFileName, nColumnsPerProfile, 
+    					options.startDataRow, options.endDataRow, profiles);
+  else
+    nProfiles = ReadMultiProfileFile(options.dataFileName, nColumnsPerProfile, 
+    					options.startDataRow, options.endDataRow, profiles);
+  if (nProfiles < 1) {
+    fprintf(stderr, "*** ERROR: Unable to read profiles from data file \"%s\"!\n\n",
+    		options.dataFileName.c_str());
+    return -1;
+  }
+  printf("Data file \"%s\": %d profiles with %ld data points each\n", 
+  		options.dataFileName.c_str(), nProfiles, profiles.nDataVals);
+
+  /* Set up everything which is common to all the fits */
+  setup.functionList = functionList;
+  setup.functionSetIndices = functionSetIndices;
+  setup.initialParams = parameterList;
+  for (int i = 0; i < (int)parameterList.size(); i++) {
+    memset(&newParamLimit, 0, sizeof(mp_par));
+    newParamLimit.fixed = paramLimits[i].fixed;
+    newParamLimit.limited[0] = paramLimits[i].limited[0];
+    newParamLimit.limited[1] = paramLimits[i].limited[1];
+    newParamLimit.limits[0] = paramLimits[i].limits[0];
+    newParamLimit.limits[1] = paramLimits[i].limits[1];
+    setup.parameterInfo.push_back(newParamLimit);
+  }
+  setup.paramLimitsExist = paramLimitsExist;
+  setup.dataAreMagnitudes = options.dataAreMagnitudes;
+  setup.zeroPoint = options.zeroPoint;
+  setup.maskFormat = options.maskFormat;
+  setup.nPSFVals = 0;
+  setup.psfXVals = setup.psfVals = NULL;
+  if (options.psfPresent) {
+    setup.nPSFVals = ReadPSFProfile(options.psfFileName, &xVals_psf, &yVals_psf);
+    setup.psfXVals = xVals_psf;
+    setup.psfVals = yVals_psf;
+  }
+  setup.convolutionMethod = options.convolutionMethod;
+  setup.solver = options.solver;
+  setup.nloptSolverName = options.nloptSolverName;
+  setup.ftol = options.ftol;
+  setup.bootstrapIterations = options.doBootstrap ? options.bootstrapIterations : 0;
+  // use a single seed for all profiles (each profile gets its own streams), and
+  // report it so the run can be reproduced
+  setup.rngSeed = options.rngSeed;
+  if ((setup.rngSeed == 0) && ((setup.bootstrapIterations > 0) || 
+  								(setup.solver == DIFF_EVOLN_SOLVER))) {
+    setup.rngSeed = (unsigned long)time(NULL);
+    printf("(RNG seed = %lu)\n", setup.rngSeed);
+  }
+
+  nThreads = 1;
+#ifdef USE_OPENMP
+  nThreads = options.maxThreadsSet ? options.maxThreads : omp_get_max_threads();
+#endif
+  if (setup.solver == MPFIT_SOLVER)
+    printf("Fitting %d profiles using up to %d threads...\n", nProfiles, nThreads);
+  else
+    printf("Fitting %d profiles (one at a time with this solver)...\n", nProfiles);
+
+  /* Do the fits and save the results */
+  startTime = time(NULL);
+  nSuccessful = FitProfileBatch(profiles, setup, nThreads, 0, results);
+  endTime = time(NULL);
+  printf("%d of %d profiles fit successfully (elapsed time = %ld sec)\n", nSuccessful,
+  		nProfiles, (long)(endTime - startTime));
+
+  printf("Saving fit results in file \"%s\"\n", options.outputParameterFileName.c_str());
+  status = SaveBatchResults(options.outputParameterFileName, programHeader, setup, results);
+
+  free(xVals_psf);
+  free(yVals_psf);
+  if (status < 0)
+    return -1;
+  printf("All done!\n\n");
+  return 0;
+}
+
+
+
 void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
 {
 
@@ -466,6 +620,7 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
   /* SET THE USAGE/HELP   */
   optParser->AddUsageLine("Usage: ");
   optParser->AddUsageLine("   profilefit [options] datafile configfile");
+  optParser->AddUsageLine("   profilefit --batch [options] multi-profile-datafile configfile");
   optParser->AddUsageLine(" -h  --help                   Prints this help");
   optParser->AddUsageLine(" -v  --version                Prints version number");
   optParser->AddUsageLine("     --list-functions         Prints list of available functions (components)");
@@ -475,6 +630,11 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
   optParser->AddUsageLine(" --usemask                    Use mask from data file (4th column)");
   optParser->AddUsageLine(" --intensities                Data y-values are intensities, not magnitudes");
   optParser->AddUsageLine(" --psf <psf_file>             PSF profile (centered on middle row, y-values = intensities)");
+  optParser->AddUsageLine(" --convolution <method>       PSF convolution: \"auto\" (default), \"fft\", or \"direct\"");
+  optParser->AddUsageLine("");
+  optParser->AddUsageLine(" --batch                      Data file has multiple profiles (text or binary); fit all of them");
+  optParser->AddUsageLine("                              and save results in one table (see --save-params)");
+  optParser->AddUsageLine(" --max-threads <int>          Maximum number of threads to use");
   optParser->AddUsageLine("");
 #ifndef NO_NLOPT
   optParser->AddUsageLine(" --nm                         Use Nelder-Mead simplex solver instead of L-M");
@@ -505,6 +665,9 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
   optParser->AddFlag("usemask");
   optParser->AddFlag("intensities");
   optParser->AddOption("psf");      /* an option (takes an argument), supporting only long form */
+  optParser->AddOption("convolution");
+  optParser->AddFlag("batch");
+  optParser->AddOption("max-threads");
 #ifndef NO_NLOPT
   optParser->AddFlag("nm");
   optParser->AddOption("nlopt");
@@ -587,6 +750,33 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
     theOptions->psfPresent = true;
     printf("\tPSF profile = %s\n", theOptions->psfFileName.c_str());
   }
+  if (optParser->OptionSet("convolution")) {
+    string  methodName = optParser->GetTargetString("convolution");
+    if (methodName == "auto")
+      theOptions->convolutionMethod = CONVOLVE_AUTO;
+    else if (methodName == "fft")
+      theOptions->convolutionMethod = CONVOLVE_FFT;
+    else if (methodName == "direct")
+      theOptions->convolutionMethod = CONVOLVE_DIRECT;
+    else {
+      fprintf(stderr, "*** ERROR: unrecognized convolution method (\"%s\")!\n\n", methodName.c_str());
+      delete optParser;
+      exit(1);
+    }
+  }
+  if (optParser->FlagSet("batch")) {
+    printf("\t* Batch mode: fitting all profiles in data file!\n");
+    theOptions->batchMode = true;
+  }
+  if (optParser->OptionSet("max-threads")) {
+    if (NotANumber(optParser->GetTargetString("max-threads").c_str(), 0, kPosInt)) {
+      fprintf(stderr, "*** ERROR: max-threads should be a positive integer!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    theOptions->maxThreads = atol(optParser->GetTargetString("max-threads").c_str());
+    theOptions->maxThreadsSet = true;
+  }
 #ifndef NO_NLOPT
   if (optParser->FlagSet("nm")) {
   	printf("\t* Nelder-Mead simplex solver selected!\n");
@@ -598,7 +788,7 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
     if (! ValidNLOptSolverName(theOptions->nloptSolverName)) {
       fprintf(stderr, "*** ERROR: \"%s\" is not a valid NLOpt solver name!\n", 
       			theOptions->nloptSolverName.c_str());
-      fprintf(stderr, "    (valid names for --nlopt: COBYLA, BOBYQA, NEWUOA, PRAXIS, NM, SBPLX)\n");
+      fprintf(stderr, "    (valid names for --nlopt: COBYLA, BOBYQA, NEWUOA, PRAXIS, NM, SBPLX,\n                              LBFGS, MMA, SLSQP, TNEWTON)\n");
       delete optParser;
       exit(1);
     }
@@ -690,6 +880,21 @@ void ProcessInput( int argc, char *argv[], commandOptions *theOptions )
     printf("\tRNG seed = %ld\n", theOptions->rngSeed);
   }
 
+  if (theOptions->batchMode) {
+    if ((theOptions->printChiSquaredOnly) || (theOptions->solver == NO_FITTING)) {
+      fprintf(stderr, "*** ERROR: --chisquare-only and --no-fitting cannot be used with --batch!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    if (theOptions->saveBestProfile) {
+      fprintf(stderr, "*** ERROR: --save-best-fit cannot be used with --batch!\n\n");
+      delete optParser;
+      exit(1);
+    }
+    if (! optParser->OptionSet("save-params"))
+      theOptions->outputParameterFileName = DEFAULT_1D_BATCH_OUTPUT_FILE;
+  }
+
   delete optParser;
 
 }
@@ -25,12 +25,20 @@
  *
  *    We use NULL for yErrs & maskVals because we know the file only has two columns,
  * or else we want to ignore the 3rd & 4th columns.
+ *
+ *    Files with many profiles sharing the same x values can be read into a
+ * profileSet structure with ReadMultiProfileFile() (text: x in the first column,
+ * followed by nColumnsPerProfile columns for each profile) or ReadBinaryProfileFile()
+ * (binary; see below for the format). Both read the whole file into memory at once
+ * and parse it directly, which is much faster than line-by-line reading for files
+ * with many columns.
  */
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <vector>
 #include <string>
 #ifdef LINUX
@@ -48,6 +56,17 @@ using namespace std;
 #define  NO_DATA_ERR_STRING3 "\n   Missing y_err data on line %ld of %s!\n\n"
 #define  NO_DATA_ERR_STRING4 "\n   Missing mask value on line %ld of %s!\n\n"
 
+// Binary profile files: an 8-byte identifier, then four 32-bit integers (number 
+// of profiles, number of data points per profile, number of columns per profile
+// [1--3], and 0), then the x values (nDataVals 64-bit doubles), then the data for
+// each profile in turn (nColumnsPerProfile*nDataVals doubles: all y values, then 
+// all y_err values [if present], then all mask values [if present]). Numbers are
+// in native byte order.
+const char  BINARY_PROFILE_ID[8] = {'P', 'R', 'O', 'F', 'B', 'I', 'N', '1'};
+const int  BINARY_PROFILE_HEADER_SIZE = 24;
+
+static int ReadWholeFile( string& fileName, vector<char>& buffer );
+
 
 long CountDataLines( string& fileName )
 {
@@ -160,3 +179,234 @@ long ReadDataFile( string& fileName, long startDataRow, long endDataRow,
   
   return(j + 1);
 }
+
+
+
+/* ---------------- FUNCTION: IsBinaryProfileFile ---------------------- */
+/// Returns true if the file starts with the identifier for binary profile files.
+bool IsBinaryProfileFile( string& fileName )
+{
+  FILE  *file_ptr;
+  char  fileID[8];
+  bool  isBinary = false;
+
+  if ((file_ptr = fopen(fileName.c_str(), "rb")) == NULL)
+    return false;
+  if (fread(fileID, 1, 8, file_ptr) == 8)
+    isBinary = (memcmp(fileID, BINARY_PROFILE_ID, 8) == 0);
+  fclose(file_ptr);
+  return isBinary;
+}
+
+
+/* ---------------- FUNCTION: ReadMultiProfileFile --------------------- */
+/// Reads a text file containing multiple profiles with common x values: the first
+/// column is x, followed by nColumnsPerProfile columns (y, [y_err, [mask]]) for each
+/// profile. Lines starting with "#" and blank lines are skipped. As with ReadDataFile,
+/// only data lines with indices >= startDataRow and <= endDataRow are stored
+/// (endDataRow = -1 means "last data line").
+/// Returns the number of profiles, or -1 if there was a problem with the file.
+int ReadMultiProfileFile( string& fileName, int nColumnsPerProfile, long startDataRow,
+                        long endDataRow, profileSet& profiles )
+{
+  vector<char>  buffer;
+  vector<double>  rowValues;
+  char  *linePtr, *endPtr, *nextLine;
+  long  nDataLines, nStoredRows, iData, nRow, iStored;
+  int  nColumns = 0;
+  int  nProfiles, nCols;
+
+  if (ReadWholeFile(fileName, buffer) < 0)
+    return -1;
+
+  // First pass: count data lines, and get the number of columns from the first one
+  nDataLines = 0;
+  linePtr = buffer.data();
+  while (*linePtr != '\0') {
+    nextLine = strchr(linePtr, '\n');
+    if (nextLine != NULL)
+      *nextLine = '\0';
+    linePtr += strspn(linePtr, " \t\r");
+    if ((*linePtr != '#') && (*linePtr != '\0')) {
+      if (nDataLines == 0) {
+        while (true) {
+          strtod(linePtr, &endPtr);
+          if (endPtr == linePtr)
+            break;
+          nColumns++;
+          linePtr = endPtr;
+        }
+      }
+      nDataLines++;
+    }
+    if (nextLine == NULL)
+      break;
+    *nextLine = '\n';
+    linePtr = nextLine + 1;
+  }
+  if ((nColumns < 1 + nColumnsPerProfile) || ((nColumns - 1) % nColumnsPerProfile != 0)) {
+    fprintf(stderr, "\n   Number of columns in %s (%d) does not match 1 + a multiple of %d!\n\n",
+    		fileName.c_str(), nColumns, nColumnsPerProfile);
+    return -1;
+  }
+  if (endDataRow < 0)
+    endDataRow = nDataLines - 1;
+  if ((startDataRow < 0) || (startDataRow > endDataRow) || (endDataRow >= nDataLines)) {
+    fprintf(stderr, "\n   Requested data rows (%ld--%ld) not in range of %s (%ld data rows)!\n\n",
+    		startDataRow + 1, endDataRow + 1, fileName.c_str(), nDataLines);
+    return -1;
+  }
+
+  nProfiles = (nColumns - 1) / nColumnsPerProfile;
+  nStoredRows = endDataRow - startDataRow + 1;
+  profiles.nProfiles = nProfiles;
+  profiles.nDataVals = nStoredRows;
+  profiles.nColumnsPerProfile = nColumnsPerProfile;
+  profiles.xVals.resize(nStoredRows);
+  profiles.values.resize((size_t)nProfiles * nColumnsPerProfile * nStoredRows);
+  rowValues.resize(nColumns);
+
+  // Second pass: parse the data lines (now that we know where each value goes)
+  iData = -1;
+  nRow = 0;
+  linePtr = buffer.data();
+  while (*linePtr != '\0') {
+    nRow++;
+    nextLine = strchr(linePtr, '\n');
+    if (nextLine != NULL)
+      *nextLine = '\0';
+    linePtr += strspn(linePtr, " \t\r");
+    if ((*linePtr != '#') && (*linePtr != '\0')) {
+      iData++;
+      if ((iData >= startDataRow) && (iData <= endDataRow)) {
+        for (nCols = 0; nCols < nColumns; nCols++) {
+          rowValues[nCols] = strtod(linePtr, &endPtr);
+          if (endPtr == linePtr)
+            break;
+          linePtr = endPtr;
+        }
+        if (nCols < nColumns) {
+          fprintf(stderr, "\n   Missing data on line %ld of %s (found %d of %d values)!\n\n",
+          		nRow, fileName.c_str(), nCols, nColumns);
+          return -1;
+        }
+        iStored = iData - startDataRow;
+        profiles.xVals[iStored] = rowValues[0];
+        for (int n = 0; n < nColumns - 1; n++)
+          profiles.values[(size_t)n*nStoredRows + iStored] = rowValues[n + 1];
+      }
+    }
+    if (nextLine == NULL)
+      break;
+    linePtr = nextLine + 1;
+  }
+
+  return nProfiles;
+}
+
+
+/* ---------------- FUNCTION: ReadBinaryProfileFile -------------------- */
+/// Reads a binary profile file (see format description at the top of this file).
+/// The first nColumnsPerProfile columns of each profile are stored (the file must
+/// have at least that many), for data points with indices >= startDataRow and 
+/// <= endDataRow (endDataRow = -1 means "last data point").
+/// Returns the number of profiles, or -1 if there was a problem with the file.
+int ReadBinaryProfileFile( string& fileName, int nColumnsPerProfile, long startDataRow,
+                        long endDataRow, profileSet& profiles )
+{
+  FILE  *file_ptr;
+  char  fileID[8];
+  int32_t  headerValues[4];
+  vector<double>  xValsAll, profileBlock;
+  long  nDataValsFile, nStoredRows;
+  int  nProfiles, nColumnsFile;
+  size_t  nBlockVals;
+  bool  readOK;
+
+  if ((file_ptr = fopen(fileName.c_str(), "rb")) == NULL) {
+    fprintf(stderr, FILE_OPEN_ERR_STRING, fileName.c_str());
+    return -1;
+  }
+  readOK = (fread(fileID, 1, 8, file_ptr) == 8) && (fread(headerValues, sizeof(int32_t), 4, file_ptr) == 4);
+  if ((! readOK) || (memcmp(fileID, BINARY_PROFILE_ID, 8) != 0)) {
+    fprintf(stderr, "\n   %s is not a binary profile file!\n\n", fileName.c_str());
+    fclose(file_ptr);
+    return -1;
+  }
+  nProfiles = headerValues[0];
+  nDataValsFile = headerValues[1];
+  nColumnsFile = headerValues[2];
+  if ((nProfiles < 1) || (nDataValsFile < 1) || (nColumnsFile < 1) || (nColumnsFile > 3)) {
+    fprintf(stderr, "\n   Bad header in binary profile file %s (%d profiles, %ld points, %d columns)!\n\n",
+    		fileName.c_str(), nProfiles, nDataValsFile, nColumnsFile);
+    fclose(file_ptr);
+    return -1;
+  }
+  if (nColumnsFile < nColumnsPerProfile) {
+    fprintf(stderr, "\n   Binary profile file %s has %d column(s) per profile (%d needed)!\n\n",
+    		fileName.c_str(), nColumnsFile, nColumnsPerProfile);
+    fclose(file_ptr);
+    return -1;
+  }
+  if (endDataRow < 0)
+    endDataRow = nDataValsFile - 1;
+  if ((startDataRow < 0) || (startDataRow > endDataRow) || (endDataRow >= nDataValsFile)) {
+    fprintf(stderr, "\n   Requested data rows (%ld--%ld) not in range of %s (%ld data points)!\n\n",
+    		startDataRow + 1, endDataRow + 1, fileName.c_str(), nDataValsFile);
+    fclose(file_ptr);
+    return -1;
+  }
+
+  nStoredRows = endDataRow - startDataRow + 1;
+  profiles.nProfiles = nProfiles;
+  profiles.nDataVals = nStoredRows;
+  profiles.nColumnsPerProfile = nColumnsPerProfile;
+  profiles.values.resize((size_t)nProfiles * nColumnsPerProfile * nStoredRows);
+  xValsAll.resize(nDataValsFile);
+  nBlockVals = (size_t)nColumnsFile * nDataValsFile;
+  profileBlock.resize(nBlockVals);
+
+  readOK = (fread(xValsAll.data(), sizeof(double), nDataValsFile, file_ptr) == (size_t)nDataValsFile);
+  for (int p = 0; (p < nProfiles) && readOK; p++) {
+    readOK = (fread(profileBlock.data(), sizeof(double), nBlockVals, file_ptr) == nBlockVals);
+    for (int c = 0; c < nColumnsPerProfile; c++)
+      memcpy(&profiles.values[((size_t)p*nColumnsPerProfile + c)*nStoredRows],
+      		&profileBlock[(size_t)c*nDataValsFile + startDataRow], nStoredRows*sizeof(double));
+  }
+  fclose(file_ptr);
+  if (! readOK) {
+    fprintf(stderr, "\n   Binary profile file %s is too short!\n\n", fileName.c_str());
+    return -1;
+  }
+  profiles.xVals.assign(xValsAll.begin() + startDataRow, xValsAll.begin() + endDataRow + 1);
+
+  return nProfiles;
+}
+
+
+/* ---------------- FUNCTION: ReadWholeFile ---------------------------- */
+// Reads the entire contents of a file into buffer (with a terminating '\0').
+// Returns 0 on success, -1 if the file could not be read.
+static int ReadWholeFile( string& fileName, vector<char>& buffer )
+{
+  FILE  *file_ptr;
+  long  fileSize;
+  
+  if ((file_ptr = fopen(fileName.c_str(), "rb")) == NULL) {
+    fprintf(stderr, FILE_OPEN_ERR_STRING, fileName.c_str());
+    return -1;
+  }
+  fseek(file_ptr, 0, SEEK_END);
+  fileSize = ftell(file_ptr);
+  fseek(file_ptr, 0, SEEK_SET);
+  if (fileSize >= 0)
+    buffer.resize(fileSize + 1);
+  if ((fileSize < 0) || (fread(buffer.data(), 1, fileSize, file_ptr) != (size_t)fileSize)) {
+    fprintf(stderr, "\n   Error reading file \"%s\"\n\n", fileName.c_str());
+    fclose(file_ptr);
+    return -1;
+  }
+  buffer[fileSize] = '\0';
+  fclose(file_ptr);
+  return 0;
+}
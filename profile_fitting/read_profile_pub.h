@@ -4,11 +4,33 @@
 #define _READ_PROFILE_H_
 
 #include <string>
+#include <vector>
+
+
+/// Set of profiles sharing the same x values (as read from a multi-profile file)
+typedef struct {
+  int  nProfiles;
+  long  nDataVals;            // number of data points in each profile
+  int  nColumnsPerProfile;    // 1 (y), 2 (y, y_err), or 3 (y, y_err, mask)
+  std::vector<double>  xVals;
+  // column c (0 = y, 1 = y_err, 2 = mask) of profile p is stored as nDataVals
+  // values starting at values[(p*nColumnsPerProfile + c)*nDataVals]
+  std::vector<double>  values;
+} profileSet;
+
 
 long CountDataLines( std::string& fileName );
 
 long ReadDataFile( std::string& fileName, long startDataRow, long endDataRow, 
                         double *xVals, double *yVals, double *yErrs, double *maskVals );
 
+bool IsBinaryProfileFile( std::string& fileName );
+
+int ReadMultiProfileFile( std::string& fileName, int nColumnsPerProfile, long startDataRow,
+                        long endDataRow, profileSet& profiles );
+
+int ReadBinaryProfileFile( std::string& fileName, int nColumnsPerProfile, long startDataRow,
+                        long endDataRow, profileSet& profiles );
+
 
 #endif /* _READ_PROFILE_H_ */
@@ -0,0 +1,110 @@
+#!/usr/bin/env python
+#
+# A Python script to compare two sets of results from the benchmark program
+# (JSON files written by "benchmark -o <file.json>"). The first file is the
+# reference (e.g., from the previous version of the code), the second is the new
+# run. For each benchmark and thread count present in both files, the ratio of
+# new to reference time is printed; ratios larger than 1 + threshold (default =
+# 0.10) are flagged as regressions.
+#
+# The script uses sys.exit() to return either 0 for success (no regressions) or 1
+# for some kind of failure (including one or more regressions); this is for use with
+# shell scripts for regression tests, etc.
+
+from __future__ import print_function
+
+import sys, os, optparse, json
+
+
+DEFAULT_THRESHOLD = 0.10
+
+# predefine some ANSI color codes
+RED  = '\033[31m' # red
+NC = '\033[0m' # No Color
+
+
+def ReadBenchmarks( fileName ):
+    """
+    Reads a JSON file from the benchmark program and returns the top-level
+    dict plus a dict mapping (benchmark name, thread count) to (time, unit).
+    """
+    with open(fileName) as f:
+        data = json.load(f)
+    timings = {}
+    for benchmark in data["benchmarks"]:
+        for result in benchmark["results"]:
+            key = (benchmark["name"], result["threads"])
+            timings[key] = (result["time"], benchmark["unit"])
+    return data, timings
+
+
+def CompareBenchmarks( refTimings, newTimings, threshold ):
+    """
+    Prints a table comparing the benchmark times common to both inputs;
+    returns the number of regressions (new/reference > 1 + threshold).
+    """
+    nRegressions = 0
+    commonKeys = [key for key in refTimings if key in newTimings]
+    print("%-36s %7s %14s %14s %-14s %8s" % ("benchmark", "threads", "reference", "new",
+            "unit", "ratio"))
+    for key in sorted(commonKeys):
+        refTime, unit = refTimings[key]
+        newTime = newTimings[key][0]
+        ratio = newTime / refTime
+        line = "%-36s %7d %14.5g %14.5g %-14s %8.3f" % (key[0], key[1], refTime, newTime,
+                unit, ratio)
+        if ratio > 1.0 + threshold:
+            line = RED + line + "   <-- slower" + NC
+            nRegressions += 1
+        print(line)
+    nMissing = len([key for key in refTimings if key not in newTimings])
+    if nMissing > 0:
+        print("\n(%d benchmark/thread-count combination(s) in reference file not in new file)"
+                % nMissing)
+    return nRegressions
+
+
+
+def main(argv=None):
+
+    usageString = "%prog [options] reference.json new.json\n"
+    parser = optparse.OptionParser(usage=usageString, version="%prog ")
+    parser.add_option("--threshold", type="float", dest="threshold", default=DEFAULT_THRESHOLD,
+                      help="maximum allowed fractional slowdown [default = %default]")
+
+    (options, args) = parser.parse_args(argv)
+
+    if (len(args)) < 3:
+        msg = "you must supply two JSON file names!\n"
+        print(RED + "ERROR: " + msg + NC)
+        sys.exit(1)
+    refFile = args[1]
+    newFile = args[2]
+    for fileName in [refFile, newFile]:
+        if not os.path.exists(fileName):
+            msg = "unable to find file %s!\n" % fileName
+            print(RED + "ERROR: " + msg + NC)
+            sys.exit(1)
+
+    refData, refTimings = ReadBenchmarks(refFile)
+    newData, newTimings = ReadBenchmarks(newFile)
+    if refData.get("host") != newData.get("host"):
+        print("* WARNING: results are from different hosts (%s, %s)" % (refData.get("host"),
+                newData.get("host")))
+    if refData.get("quick_mode") != newData.get("quick_mode"):
+        print("* WARNING: only one of the runs used quick mode")
+
+    nRegressions = CompareBenchmarks(refTimings, newTimings, options.threshold)
+    if nRegressions > 0:
+        txt = "\n\t" + RED + ">>> WARNING:" + NC
+        print(txt + " %d benchmark(s) slower by more than %g%%!\n" % (nRegressions,
+                100*options.threshold))
+        sys.exit(1)
+    else:
+        print(" OK.")
+        sys.exit(0)
+
+
+if __name__ == '__main__':
+
+    main(sys.argv)
@@ -53,6 +53,11 @@ echo $RESULT
 RESULT+=$?
 echo $RESULT
 
+# Unit tests for convolver
+./run_unittest_convolver.sh 2>> temperror.log
+RESULT+=$?
+echo $RESULT
+
 # Unit tests for downsample
 ./run_unittest_downsample.sh 2>> temperror.log
 RESULT+=$?
@@ -73,11 +78,31 @@ echo $RESULT
 RESULT+=$?
 echo $RESULT
 
+# Unit tests for block_average
+./run_unittest_block_average.sh 2>> temperror.log
+RESULT+=$?
+echo $RESULT
+
+# Unit tests for checkpoint
+./run_unittest_checkpoint.sh 2>> temperror.log
+RESULT+=$?
+echo $RESULT
+
+# Unit tests for multistart_monitor
+./run_unittest_multistart_monitor.sh 2>> temperror.log
+RESULT+=$?
+echo $RESULT
+
 # Unit tests for mpfit
 ./run_unittest_mpfit.sh 2>> temperror.log
 RESULT+=$?
 echo $RESULT
 
+# Unit tests for rng_streams
+./run_unittest_rng_streams.sh 2>> temperror.log
+RESULT+=$?
+echo $RESULT
+
 # Unit tests for solver_results
 ./run_unittest_solverresults.sh 2>> temperror.log
 RESULT+=$?
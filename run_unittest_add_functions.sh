@@ -30,9 +30,9 @@ function_objects/integrator.cpp function_objects/func_expdisk3d.cpp function_obj
 function_objects/func_gaussianring3d.cpp function_objects/func_ferrersbar3d.cpp \
 function_objects/func_ferrersbar2d.cpp function_objects/func_king.cpp \
 function_objects/func_king2.cpp function_objects/func_pointsource.cpp \
-function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp \
+function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp function_objects/helper_funcs_bessel.cpp function_objects/radial_lookup_table.cpp \
 function_objects/psf_interpolators.cpp \
-core/mersenne_twister.cpp core/mp_enorm.cpp \
+core/mersenne_twister.cpp core/rng_streams.cpp core/mp_enorm.cpp \
 -I. -Icore -Isolvers -I/usr/local/include -Ifunction_objects -I$CXXTEST -L/usr/local/lib \
 -lfftw3_threads -lfftw3 -lcfitsio -lgsl -lgslcblas -lm
 if [ $? -eq 0 ]
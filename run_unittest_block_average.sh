@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# load environment-dependent definitions for CXXTESTGEN, CPP, etc.
+. ./define_unittest_vars.sh
+
+# Predefine some ANSI color escape codes
+RED='\033[0;31m'
+GREEN='\033[0;0;32m'
+NC='\033[0m' # No Color
+
+echo
+echo "Generating and compiling unit tests for block_average..."
+$CXXTESTGEN --error-printer -o test_runner_block_average.cpp unit_tests/unittest_block_average.t.h 
+$CPP -std=c++11 -o test_runner_block_average test_runner_block_average.cpp core/block_average.cpp \
+function_objects/function_object.cpp function_objects/func_broken-exp.cpp \
+function_objects/func_double-broken-exp.cpp function_objects/func_logspiral2.cpp \
+function_objects/func_logspiral_gauss.cpp function_objects/helper_funcs.cpp \
+function_objects/radial_lookup_table.cpp core/utilities.cpp \
+-I. -Icore -Isolvers -Ifunction_objects -I/usr/local/include -I$CXXTEST \
+-L/usr/local/lib -lm
+if [ $? -eq 0 ]
+then
+  echo "Running unit tests for block_average:"
+  ./test_runner_block_average
+  exit
+else
+  echo -e "${RED}Compilation of unit tests for block_average.cpp failed.${NC}"
+  exit 1
+fi
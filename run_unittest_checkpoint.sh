@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# load environment-dependent definitions for CXXTESTGEN, CPP, etc.
+. ./define_unittest_vars.sh
+
+# Predefine some ANSI color escape codes
+RED='\033[0;31m'
+GREEN='\033[0;0;32m'
+NC='\033[0m' # No Color
+
+echo
+echo "Generating and compiling unit tests for checkpoint..."
+$CXXTESTGEN --error-printer -o test_runner_checkpoint.cpp unit_tests/unittest_checkpoint.t.h 
+$CPP -std=c++11 -o test_runner_checkpoint test_runner_checkpoint.cpp core/checkpoint.cpp core/mersenne_twister.cpp \
+-I. -Icore -Isolvers -I/usr/local/include -I$CXXTEST \
+-L/usr/local/lib -lm -lpthread
+if [ $? -eq 0 ]
+then
+  echo "Running unit tests for checkpoint:"
+  ./test_runner_checkpoint
+  exit
+else
+  echo -e "${RED}Compilation of unit tests for checkpoint.cpp failed.${NC}"
+  exit 1
+fi
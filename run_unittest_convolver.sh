@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# load environment-dependent definitions for CXXTESTGEN, CPP, etc.
+. ./define_unittest_vars.sh
+
+# Predefine some ANSI color escape codes
+RED='\033[0;31m'
+GREEN='\033[0;0;32m'
+NC='\033[0m' # No Color
+
+echo
+echo "Generating and compiling unit tests for convolver..."
+$CXXTESTGEN --error-printer -o test_runner_convolver.cpp unit_tests/unittest_convolver.t.h 
+$CPP -std=c++11 -o test_runner_convolver test_runner_convolver.cpp core/convolver.cpp \
+-I. -Icore -Isolvers -I/usr/local/include -I$CXXTEST \
+-L/usr/local/lib -lfftw3 -lm
+if [ $? -eq 0 ]
+then
+  echo "Running unit tests for convolver:"
+  ./test_runner_convolver
+  exit
+else
+  echo -e "${RED}Compilation of unit tests for convolver.cpp failed.${NC}"
+  exit 1
+fi
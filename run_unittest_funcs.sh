@@ -20,7 +20,7 @@ function_objects/func_broken-exp2d.cpp function_objects/func_edge-on-disk.cpp \
 function_objects/func_gauss_extraparams.cpp function_objects/func_ferrersbar3d.cpp \
 function_objects/func_pointsource.cpp function_objects/psf_interpolators.cpp \
 function_objects_1d/func1d_exp_test.cpp \
-function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp \
+function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp function_objects/helper_funcs_bessel.cpp function_objects/radial_lookup_table.cpp \
 function_objects/integrator.cpp core/utilities.cpp \
 -I/usr/local/include -I$CXXTEST -I. -Icore -Isolvers -Ifunction_objects \
 -L/usr/local/lib -lm -lgsl -lgslcblas
@@ -22,8 +22,8 @@ $CXXTESTGEN --error-printer -o test_runner_modelobj.cpp unit_tests/unittest_mode
 $CPP -std=c++11  -DDEBUG -DUSE_TEST_FUNCS \
 -o test_runner_modelobj \
 test_runner_modelobj.cpp core/model_object.cpp core/utilities.cpp core/convolver.cpp \
-core/add_functions.cpp core/config_file_parser.cpp core/mersenne_twister.cpp \
-core/mp_enorm.cpp core/oversampled_region.cpp core/downsample.cpp \
+core/add_functions.cpp core/config_file_parser.cpp core/mersenne_twister.cpp core/rng_streams.cpp \
+core/mp_enorm.cpp core/oversampled_region.cpp core/downsample.cpp core/profile_counters.cpp \
 core/image_io.cpp core/psf_oversampling_info.cpp \
 function_objects/function_object.cpp function_objects/func_gaussian.cpp \
 function_objects/func_exp.cpp function_objects/func_gen-exp.cpp \
@@ -41,7 +41,7 @@ function_objects/func_ferrersbar3d.cpp function_objects/func_king.cpp \
 function_objects/func_ferrersbar2d.cpp \
 function_objects/func_king2.cpp function_objects/func_gauss_extraparams.cpp \
 function_objects/func_pointsource.cpp \
-function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp \
+function_objects/helper_funcs.cpp function_objects/helper_funcs_3d.cpp function_objects/helper_funcs_bessel.cpp function_objects/radial_lookup_table.cpp \
 function_objects/psf_interpolators.cpp \
 -I. -Icore -Isolvers -I/usr/local/include -Ifunction_objects -I$CXXTEST \
 -L/usr/local/lib -lfftw3_threads -lcfitsio -lfftw3 -lgsl -lgslcblas -lm
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# load environment-dependent definitions for CXXTESTGEN, CPP, etc.
+. ./define_unittest_vars.sh
+
+# Predefine some ANSI color escape codes
+RED='\033[0;31m'
+GREEN='\033[0;0;32m'
+NC='\033[0m' # No Color
+
+echo
+echo "Generating and compiling unit tests for multistart_monitor..."
+$CXXTESTGEN --error-printer -o test_runner_multistart_monitor.cpp unit_tests/unittest_multistart_monitor.t.h 
+$CPP -std=c++11 -o test_runner_multistart_monitor test_runner_multistart_monitor.cpp solvers/multistart_monitor.cpp \
+-I. -Icore -Isolvers -I/usr/local/include -I$CXXTEST \
+-lm
+if [ $? -eq 0 ]
+then
+  echo "Running unit tests for multistart_monitor:"
+  ./test_runner_multistart_monitor
+  exit
+else
+  echo -e "${RED}Compilation of unit tests for multistart_monitor.cpp failed.${NC}"
+  exit 1
+fi
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# load environment-dependent definitions for CXXTESTGEN, CPP, etc.
+. ./define_unittest_vars.sh
+
+# Predefine some ANSI color escape codes
+RED='\033[0;31m'
+GREEN='\033[0;0;32m'
+NC='\033[0m' # No Color
+
+echo
+echo "Generating and compiling unit tests for rng_streams..."
+$CXXTESTGEN --error-printer -o test_runner_rng_streams.cpp unit_tests/unittest_rng_streams.t.h 
+$CPP -std=c++11 -o test_runner_rng_streams test_runner_rng_streams.cpp core/rng_streams.cpp \
+-I. -Icore -Isolvers -I/usr/local/include -I$CXXTEST \
+-L/usr/local/lib -lm
+if [ $? -eq 0 ]
+then
+  echo "Running unit tests for rng_streams:"
+  ./test_runner_rng_streams
+  exit
+else
+  echo -e "${RED}Compilation of unit tests for rng_streams.cpp failed.${NC}"
+  exit 1
+fi
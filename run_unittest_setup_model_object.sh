@@ -14,8 +14,9 @@ echo "Generating and compiling unit tests for setup_model_object..."
 $CXXTESTGEN --error-printer -o test_runner_setup_modelobj.cpp unit_tests/unittest_setup_model_object.t.h
 $CPP -std=c++11 -o test_runner_setup_modelobj test_runner_setup_modelobj.cpp core/model_object.cpp \
 core/setup_model_object.cpp core/utilities.cpp core/convolver.cpp core/config_file_parser.cpp \
-core/mersenne_twister.cpp core/mp_enorm.cpp core/oversampled_region.cpp core/downsample.cpp \
+core/mersenne_twister.cpp core/rng_streams.cpp core/mp_enorm.cpp core/oversampled_region.cpp core/downsample.cpp \
 core/image_io.cpp core/psf_oversampling_info.cpp function_objects/psf_interpolators.cpp \
+function_objects/helper_funcs.cpp \
 -I. -Icore -Isolvers -I/usr/local/include -Ifunction_objects -I$CXXTEST \
 -L/usr/local/lib -lfftw3_threads -lcfitsio -lfftw3 -lgsl -lgslcblas -lm
 if [ $? -eq 0 ]
@@ -55,7 +55,8 @@ DESolver::DESolver( int dim, int popSize ) :
           generations(0), strategy(stRand1Exp),
           scale(0.7), probability(0.5), trialEnergy(0), bestEnergy(0.0),
           trialSolution(0), bestSolution(0),
-          popEnergy(0), population(0), oldValues(0), minBounds(0), maxBounds(0)
+          popEnergy(0), population(0), oldValues(0), minBounds(0), maxBounds(0),
+          rngType(RNG_MERSENNE_TWISTER), checkpointInterval(0), resumeFromCheckpoint(false)
 {
   trialSolution = new double[nDim];
   bestSolution = new double[nDim];
@@ -87,7 +88,8 @@ DESolver::~DESolver( )
 
 
 void DESolver::Setup( double *min, double *max, int deStrategy, double diffScale, 
-					double crossoverProb, double ftol, unsigned long rngSeed, bool useLHS )
+					double crossoverProb, double ftol, unsigned long rngSeed, bool useLHS,
+					int whichRNG )
 {
   int i;
 
@@ -97,10 +99,13 @@ void DESolver::Setup( double *min, double *max, int deStrategy, double diffScale
   tolerance = ftol;
   
   // PE: seed the (Mersenne Twister) RNG
-  if (rngSeed > 0)
-    init_genrand(rngSeed);
+  if (rngSeed == 0)
+    rngSeed = (unsigned long)time((time_t *)NULL);
+  rngType = whichRNG;
+  if (rngType == RNG_PHILOX)
+    rngStream.SetSeed(rngSeed, 0);   // stream 0 = initial population
   else
-    init_genrand((unsigned long)time((time_t *)NULL));
+    init_genrand(rngSeed);
   
   CopyVector(minBounds, min);
   CopyVector(maxBounds, max);
@@ -108,32 +113,10 @@ void DESolver::Setup( double *min, double *max, int deStrategy, double diffScale
   if (useLHS) {
     // Latin hypercube sampling
     printf("   DESolver::Setup -- using Latin hypercube sampling.\n");
-    int  sampleOffset;
-    double  intervalSize, p;
-    // prep Latin hypercube sampling --> sampleIndices
-    vector< vector<int> >  sampleIndices;   // [nDim][nPop]
-    random_device rd;
-    mt19937 g(rd());
-    vector<int> singleParamSampleIndices(nPop);
-  
-    // set up the shuffled indices
-    for (int j = 0; j < nDim; j++) {   // iterate over parameters
-      for (int i = 0; i < nPop; i++)      // iterate over samples
-        singleParamSampleIndices[i] = i;
-      shuffle(singleParamSampleIndices.begin(), singleParamSampleIndices.end(), g);
-      sampleIndices.push_back(singleParamSampleIndices);
-    }
-
-    // generate actual samples
-    for (int i = 0; i < nPop; i++) {
-      for (int j = 0; j < nDim; j++) {
-        sampleOffset = sampleIndices[j][i];
-        intervalSize = (max[j] - min[j])/nPop;
-        p = genrand_real1();
-        Element(population,i,j) = min[j] + (sampleOffset + p)*intervalSize;
-      }
+    LatinHypercubeSample(nPop, nDim, min, max, population, 
+    					(rngType == RNG_PHILOX) ? &rngStream : NULL);
+    for (i = 0; i < nPop; i++)
       popEnergy[i] = 1.0E20;
-    }
   }
   else {
   	// Uniform sampling
@@ -152,6 +135,18 @@ void DESolver::Setup( double *min, double *max, int deStrategy, double diffScale
 }
 
 
+/// Sets the checkpoint file, interval (in generations), and whether to resume
+/// from an existing checkpoint; does nothing if settings is NULL.
+void DESolver::SetCheckpointing( const CheckpointSettings *settings )
+{
+  if (settings == NULL)
+    return;
+  checkpointFilename = settings->filename;
+  checkpointInterval = (checkpointFilename != "") ? settings->interval : 0;
+  resumeFromCheckpoint = settings->resume;
+}
+
+
 // Added by PE
 void DESolver::CalcTrialSolution( int candidate )
 {
@@ -213,10 +208,26 @@ int DESolver::Solve( int maxGenerations, int verbose )
 
   bAtSolution = false;
 
-  for (generation = 0; (generation < maxGenerations) && !bAtSolution; generation++) {
+  int  firstGeneration = 0;
+  if (resumeFromCheckpoint) {
+    if (RestoreCheckpoint(&firstGeneration, &lastBestEnergy, relativeDeltas)) {
+      if (verbose > 0)
+        printf("   DESolver::Solve -- resuming from checkpoint after generation %d.\n", 
+        		firstGeneration);
+      firstGeneration += 1;
+    } else {
+      fprintf(stderr, "\n*** WARNING: unable to resume from checkpoint file \"%s\";", 
+      		checkpointFilename.c_str());
+      fprintf(stderr, " starting from scratch.\n");
+    }
+  }
+
+  for (generation = firstGeneration; (generation < maxGenerations) && !bAtSolution; generation++) {
     for (candidate = 0; candidate < nPop; candidate++) {
       // modified by PE
       //(this->*calcTrialSolution)(candidate);
+      if (rngType == RNG_PHILOX)
+        SetCandidateStream(generation, candidate);
       CalcTrialSolution(candidate);
       // trialSolution now contains a newly generated parameter vector
       // check for out-of-bounds values and generate random values w/in the bounds
@@ -284,6 +295,9 @@ int DESolver::Solve( int maxGenerations, int verbose )
       printf("\n\tcandidate %d, bestEnergy = %f\n", candidate, bestEnergy);
     }
 
+    if ((checkpointInterval > 0) && (((generation + 1) % checkpointInterval) == 0))
+      SaveCheckpoint(generation, lastBestEnergy, relativeDeltas);
+
   }
   
   generations = generation;
@@ -552,12 +566,151 @@ double DESolver::RandomUniform( double minValue, double maxValue )
 {
   double  uniformRand, result;
   
-  uniformRand = genrand_real1();   // generates a random number on [0,1]-real-interval
+  if (rngType == RNG_PHILOX)
+    uniformRand = rngStream.Uniform();   // [0,1)-real-interval
+  else
+    uniformRand = genrand_real1();   // generates a random number on [0,1]-real-interval
   result = minValue + uniformRand*(maxValue - minValue);
   return result;
 }
 
 
+/// Switches the counter-based RNG to the stream for the specified candidate in the
+/// specified generation (stream 0 is reserved for the initial population).
+void DESolver::SetCandidateStream( int generation, int candidate )
+{
+  rngStream.SetStream(1 + (unsigned long)generation*nPop + candidate);
+}
+
+
+/// Saves everything Solve() needs to continue after the specified (completed)
+/// generation; the file is written in the background.
+/// In Philox mode, the RNG streams are determined by (seed, generation, candidate),
+/// so only the seed needs to be saved.
+void DESolver::SaveCheckpoint( int generation, double lastBestEnergy, double *relativeDeltas )
+{
+  unsigned long  mtState[MT_STATE_SIZE];
+  int  mtPosition;
+
+  checkpointWriter.Begin("DESolver");
+  checkpointWriter.Add(nDim);
+  checkpointWriter.Add(nPop);
+  checkpointWriter.Add(rngType);
+  checkpointWriter.Add(generation);
+  checkpointWriter.AddArray(population, nPop*nDim);
+  checkpointWriter.AddArray(popEnergy, nPop);
+  checkpointWriter.AddArray(bestSolution, nDim);
+  checkpointWriter.Add(bestEnergy);
+  checkpointWriter.Add(lastBestEnergy);
+  checkpointWriter.AddArray(relativeDeltas, 3);
+  if (rngType == RNG_PHILOX)
+    checkpointWriter.Add(rngStream.GetSeed());
+  else {
+    get_genrand_state(mtState, &mtPosition);
+    checkpointWriter.AddArray(mtState, MT_STATE_SIZE);
+    checkpointWriter.Add(mtPosition);
+  }
+  checkpointWriter.WriteAsync(checkpointFilename);
+}
+
+
+/// Restores the state saved by SaveCheckpoint; returns false (leaving the current
+/// state unchanged) if the checkpoint file is missing or doesn't match this problem.
+bool DESolver::RestoreCheckpoint( int *generation, double *lastBestEnergy, 
+									double *relativeDeltas )
+{
+  CheckpointReader  reader;
+  int  savedDim, savedPop, savedRNGType, savedGeneration, mtPosition;
+  unsigned long  seed;
+  unsigned long  mtState[MT_STATE_SIZE];
+
+  if (! reader.Open(checkpointFilename, "DESolver"))
+    return false;
+  reader.Get(savedDim);
+  reader.Get(savedPop);
+  reader.Get(savedRNGType);
+  if ((savedDim != nDim) || (savedPop != nPop) || (savedRNGType != rngType))
+    return false;
+  vector<double>  savedPopulation(nPop*nDim), savedPopEnergy(nPop), savedBest(nDim);
+  double  savedBestEnergy, savedLastBestEnergy, savedDeltas[3];
+  reader.Get(savedGeneration);
+  reader.GetArray(savedPopulation.data(), nPop*nDim);
+  reader.GetArray(savedPopEnergy.data(), nPop);
+  reader.GetArray(savedBest.data(), nDim);
+  reader.Get(savedBestEnergy);
+  reader.Get(savedLastBestEnergy);
+  reader.GetArray(savedDeltas, 3);
+  if (rngType == RNG_PHILOX)
+    reader.Get(seed);
+  else {
+    reader.GetArray(mtState, MT_STATE_SIZE);
+    reader.Get(mtPosition);
+  }
+  if (! reader.Finished())
+    return false;
+
+  memcpy(population, savedPopulation.data(), nPop*nDim*sizeof(double));
+  memcpy(popEnergy, savedPopEnergy.data(), nPop*sizeof(double));
+  CopyVector(bestSolution, savedBest.data());
+  bestEnergy = savedBestEnergy;
+  *lastBestEnergy = savedLastBestEnergy;
+  for (int i = 0; i < 3; i++)
+    relativeDeltas[i] = savedDeltas[i];
+  if (rngType == RNG_PHILOX)
+    rngStream.SetSeed(seed, 0);
+  else
+    set_genrand_state(mtState, mtPosition);
+  *generation = savedGeneration;
+  return true;
+}
+
+
+/// Generates nSamples points within [minValues, maxValues] by Latin hypercube
+/// sampling and stores them in samples (nSamples x nDim, row-major). If rngStream
+/// is NULL, the global Mersenne Twister generator is used for the sample positions
+/// (and the index shuffling is *not* reproducible); otherwise all random numbers
+/// come from rngStream. (Extracted from DESolver::Setup, so it can also be used
+/// for multi-start fitting.)
+void LatinHypercubeSample( int nSamples, int nDim, const double *minValues, 
+							const double *maxValues, double *samples, RNGStream *rngStream )
+{
+  int  sampleOffset;
+  double  intervalSize, p;
+  // prep Latin hypercube sampling --> sampleIndices
+  vector< vector<int> >  sampleIndices;   // [nDim][nSamples]
+  random_device rd;
+  mt19937 g(rd());
+  vector<int> singleParamSampleIndices(nSamples);
+
+  // set up the shuffled indices
+  for (int j = 0; j < nDim; j++) {   // iterate over parameters
+    for (int i = 0; i < nSamples; i++)      // iterate over samples
+      singleParamSampleIndices[i] = i;
+    if (rngStream != NULL) {
+      // reproducible Fisher-Yates shuffle
+      for (int i = nSamples - 1; i > 0; i--)
+        swap(singleParamSampleIndices[i], singleParamSampleIndices[(int)(rngStream->Uniform()*(i + 1.0))]);
+    }
+    else
+      shuffle(singleParamSampleIndices.begin(), singleParamSampleIndices.end(), g);
+    sampleIndices.push_back(singleParamSampleIndices);
+  }
+
+  // generate actual samples
+  for (int i = 0; i < nSamples; i++) {
+    for (int j = 0; j < nDim; j++) {
+      sampleOffset = sampleIndices[j][i];
+      intervalSize = (maxValues[j] - minValues[j])/nSamples;
+      if (rngStream != NULL)
+        p = rngStream->Uniform();
+      else
+        p = genrand_real1();
+      samples[i*nDim + j] = minValues[j] + (sampleOffset + p)*intervalSize;
+    }
+  }
+}
+
+
 /// Function added by PE: test for convergence
 /// If the last three stored objective-function values (values are stored every 10
 /// generations) are all < TOLERANCE, then we decide that we have converged.
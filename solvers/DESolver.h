@@ -18,6 +18,10 @@
 #ifndef _DESOLVER_H
 #define _DESOLVER_H
 
+#include "definitions.h"
+#include "rng_streams.h"
+#include "checkpoint.h"
+
 const int stBest1Exp       =    0;
 const int stRand1Exp       =    1;
 const int stRandToBest1Exp =    2;
@@ -32,6 +36,12 @@ const int stRand2Bin       =    9;
 
 class DESolver;
 
+/// Latin hypercube sampling within [minValues, maxValues] (samples = nSamples x nDim);
+/// uses rngStream if non-NULL, otherwise the global Mersenne Twister generator
+void LatinHypercubeSample( int nSamples, int nDim, const double *minValues, 
+							const double *maxValues, double *samples, 
+							RNGStream *rngStream=NULL );
+
 // this defines a type called "StrategyFunction" which is a pointer to
 // a member function of DESolver, which takes an int and returns void
 // Currently commented out bcs compilation errors resulted when trying to
@@ -53,13 +63,18 @@ public:
   /// Setup() must be called before Solve to set min, max, strategy etc.
   void Setup( double min[], double max[], int deStrategy,
 							double diffScale, double crossoverProb, double ftol,
-							unsigned long rngSeed=0, bool useLHS=false );
+							unsigned long rngSeed=0, bool useLHS=false,
+							int rngType=RNG_MERSENNE_TWISTER );
 
   /// CalcTrialSolution is used to determine which strategy to use (added by PE
   /// to replace tricky and non-working use of pointers to member functions in
   /// original code)
   void CalcTrialSolution( int candidate );
   
+  /// Enables periodic checkpoints and/or resuming from a checkpoint (call
+  /// after Setup() and before Solve())
+  void SetCheckpointing( const CheckpointSettings *settings );
+
   virtual int Solve( int maxGenerations, int verbose=1 );
 
   // EnergyFunction must be overridden for problem to solve
@@ -85,6 +100,9 @@ protected:
   void SelectSamples( int candidate, int *r1, int *r2=0, int *r3=0, 
 												int *r4=0, int *r5=0 );
   double RandomUniform( double min, double max );
+  void SetCandidateStream( int generation, int candidate );
+  void SaveCheckpoint( int generation, double lastBestEnergy, double *relativeDeltas );
+  bool RestoreCheckpoint( int *generation, double *lastBestEnergy, double *relativeDeltas );
 
   int nDim;
   int nPop;
@@ -108,6 +126,15 @@ protected:
   double *maxBounds;
   // added by PE for user specification of fractional tolerance (for convergence test)
   double  tolerance;
+  // counter-based RNG (if rngType = RNG_PHILOX): each candidate in each generation
+  // gets its own stream, so random draws don't depend on evaluation order
+  int  rngType;
+  RNGStream  rngStream;
+  // checkpointing (interval = 0 --> no checkpoints)
+  string  checkpointFilename;
+  int  checkpointInterval;
+  bool  resumeFromCheckpoint;
+  CheckpointWriter  checkpointWriter;
 
 private:
   void Best1Exp(int candidate);
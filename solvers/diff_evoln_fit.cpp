@@ -100,7 +100,8 @@ double ImfitSolver::EnergyFunction( double *trial, bool &bAtSolution )
 // main function called by exterior routines to set up and run the minimization
 int DiffEvolnFit( int nParamsTot, double *paramVector, vector<mp_par> parameterLimits, 
                   ModelObject *theModel, const double ftol, const int verbose, 
-                  SolverResults *solverResults, unsigned long rngSeed, bool useLHS )
+                  SolverResults *solverResults, unsigned long rngSeed, bool useLHS,
+                  int rngType, const CheckpointSettings *checkpoint )
 {
   ImfitSolver  *solver;
   double  *minParamValues;
@@ -154,7 +155,9 @@ int DiffEvolnFit( int nParamsTot, double *paramVector, vector<mp_par> parameterL
   maxGenerations = MAX_DE_GENERATIONS;
   // Instantiate and set up the DE solver:
   solver = new ImfitSolver(nParamsTot, POP_SIZE_PER_PARAMETER*nFreeParameters, theModel);
-  solver->Setup(minParamValues, maxParamValues, deStrategy, F, CR, ftol, rngSeed, useLHS);
+  solver->Setup(minParamValues, maxParamValues, deStrategy, F, CR, ftol, rngSeed, useLHS,
+  				rngType);
+  solver->SetCheckpointing(checkpoint);
 
   status = solver->Solve(maxGenerations, verbose);
 
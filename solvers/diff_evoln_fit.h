@@ -11,6 +11,7 @@
 #include "param_struct.h"   // for mp_par structure
 #include "model_object.h"
 #include "solver_results.h"
+#include "checkpoint.h"
 
 
 // Note on possible return values for DiffEvolnFit: these are meant to be similar to
@@ -23,7 +24,8 @@
 int DiffEvolnFit( int nParamsTot, double *initialParams, vector<mp_par> parameterLimits, 
 									ModelObject *theModel, const double ftol, const int verbose,
 									SolverResults *solverResults=0, unsigned long rngSeed=0,
-									bool useLHS=false );
+									bool useLHS=false, int rngType=RNG_MERSENNE_TWISTER,
+									const CheckpointSettings *checkpoint=NULL );
 
 
 #endif  // _DIFF_EVOLN_FIT_H_
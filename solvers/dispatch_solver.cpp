@@ -34,6 +34,7 @@
 #include "definitions.h"
 #include "model_object.h"
 #include "param_struct.h"   // for vector<mp_par>
+#include "profile_counters.h"
 #include "solver_results.h"
 #include "dispatch_solver.h"
 
@@ -49,10 +50,22 @@ int DispatchToSolver( int solverID, int nParametersTot, int nFreeParameters, int
 					double *parameters, vector<mp_par> parameterInfo, ModelObject *modelObj, 
 					double fracTolerance, bool paramLimitsExist, int verboseLevel, 
 					SolverResults *solverResults, string& solverName, 
-					unsigned long rngSeed, bool useLHS )
+					unsigned long rngSeed, bool useLHS, int rngType, 
+					const CheckpointSettings *checkpoint )
 {
   int  fitStatus = -100;
+  profileCounterValues&  profileCounters = GlobalProfileCounters();
+  double  profileStartTime = 0.0;
+  double  solverTime, modelTime = 0.0;
   
+  // when profiling, solver overhead = time spent in the solver minus time spent
+  // computing model images and fit statistics
+  if (ProfilingEnabled()) {
+    profileStartTime = ProfileClock();
+    modelTime = profileCounters.phaseTimes[PROFILE_MODEL_IMAGE] 
+    			+ profileCounters.phaseTimes[PROFILE_FIT_STATISTIC];
+  }
+
   switch (solverID) {
     case MPFIT_SOLVER:
       if (verboseLevel >= 0)
@@ -64,7 +77,7 @@ int DispatchToSolver( int solverID, int nParametersTot, int nFreeParameters, int
       if (verboseLevel >= 0)
         printf("Calling Differential Evolution solver ..\n");
       fitStatus = DiffEvolnFit(nParametersTot, parameters, parameterInfo, modelObj, fracTolerance, 
-      							verboseLevel, solverResults, rngSeed, useLHS);
+      							verboseLevel, solverResults, rngSeed, useLHS, rngType, checkpoint);
 
       break;
 #ifndef NO_NLOPT
@@ -83,6 +96,14 @@ int DispatchToSolver( int solverID, int nParametersTot, int nFreeParameters, int
 #endif
   }
 
+  if (profileStartTime > 0.0) {
+    solverTime = ProfileClock() - profileStartTime;
+    modelTime = profileCounters.phaseTimes[PROFILE_MODEL_IMAGE] 
+    			+ profileCounters.phaseTimes[PROFILE_FIT_STATISTIC] - modelTime;
+    AddProfileTime(PROFILE_SOLVER, solverTime);
+    AddProfileTime(PROFILE_SOLVER_OVERHEAD, solverTime - modelTime);
+  }
+
   return fitStatus;
 }
 
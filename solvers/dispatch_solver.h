@@ -12,6 +12,7 @@
 #include "model_object.h"
 #include "param_struct.h"   // for mp_par structure
 #include "solver_results.h"
+#include "checkpoint.h"
 
 // NOTE: The following functions is used in PyImfit
 
@@ -76,7 +77,9 @@ int DispatchToSolver( int solverID, int nParametersTot, int nFreeParameters, int
 					double *parameters, vector<mp_par> parameterInfo, ModelObject *modelObj, 
 					double fracTolerance, bool paramLimitsExist, int verboseLevel, 
 					SolverResults *solverResults, string& solverName, 
-					unsigned long rngSeed=0, bool useLHS=false );
+					unsigned long rngSeed=0, bool useLHS=false,
+					int rngType=RNG_MERSENNE_TWISTER, 
+					const CheckpointSettings *checkpoint=NULL );
 
 
 #endif /* _DISPATCH_SOLVER_H_ */
@@ -85,6 +85,7 @@
 #include "mpfit.h"
 #include "model_object.h"
 #include "mp_enorm.h"
+#include "profile_counters.h"
 #include "utilities_pub.h"
 
 
@@ -359,6 +360,7 @@ int mpfit(mp_func funct, int m, int npar, double *xall, mp_par *pars, mp_config
   double actred, delta, dirder, fnorm, fnorm1, gnorm, orignorm;
   double par, pnorm, prered, ratio;
   double sum, temp, temp1, temp2, temp3, xnorm, alpha;
+  double jacobianStartTime;
   int nfev = 0;
 
   double *step = 0, *dstep = 0, *llim = 0, *ulim = 0;
@@ -556,10 +558,17 @@ int mpfit(mp_func funct, int m, int npar, double *xall, mp_par *pars, mp_config
 #ifdef DEBUG
   printf("\n*mpfit: (iter=%d) calling mp_fdjac2...\n", iter);
 #endif
+  jacobianStartTime = 0.0;
+  if (ProfilingEnabled())
+    jacobianStartTime = ProfileClock();
   iflag = mp_fdjac2(funct, m, nfree, ifree, npar, xnew, fvec, fjac, ldfjac,
                     conf.epsfcn, wa4, theModel, &nfev,
                     step, dstep, mpside, qulim, ulim,
                     ddebug, ddrtol, ddatol);
+  if (jacobianStartTime > 0.0) {
+    AddProfileTime(PROFILE_JACOBIAN, ProfileClock() - jacobianStartTime);
+    ProfileCount(PROFILE_N_JACOBIANS);
+  }
 #ifdef DEBUG
   if (CheckFinite(m*nfree, fjac)) {
     printf("*mpfit: fjac is finite\n");
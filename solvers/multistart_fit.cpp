@@ -0,0 +1,281 @@
+/** @file
+ * \brief Implementation of MultiStartFit (multi-start local fitting)
+ */
+/* FILE: multistart_fit.cpp ---------------------------------------------- */
+/*
+ * Multi-start fitting: a middle ground between a single local fit (LM, N-M simplex,
+ * NLopt) from the config-file initial values, and a full global search with DE.
+ * We run nStarts local fits from Latin-hypercube points within the parameter
+ * limits (using the same LHS code as DESolver::Setup), group the resulting
+ * solutions into distinct minima, and then "polish" the best one with a final
+ * local fit, which also provides the usual solver results (e.g., LM errors).
+ *
+ * The starts are run one after another, since they share the ModelObject (whose
+ * model-image computation is itself parallelized with OpenMP); each start has its
+ * own parameter vector and solver workspace.
+ *
+ * (Running the starts in parallel would require a separate ModelObject per thread.)
+ *
+ * For LM starts, the deviates function passes each evaluation to a StartMonitor
+ * (see multistart_monitor.cpp), which cancels the start early if it is converging
+ * to an already-found minimum with a worse fit statistic, or if it is improving
+ * too slowly to reach the best fit statistic found so far.
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <time.h>
+
+#include "definitions.h"
+#include "model_object.h"
+#include "param_struct.h"   // for mp_par structure
+#include "mpfit.h"
+#include "DESolver.h"   // for LatinHypercubeSample
+#include "mersenne_twister.h"
+#include "rng_streams.h"
+#include "dispatch_solver.h"
+#include "multistart_fit.h"
+#include "multistart_monitor.h"
+#include "solver_results.h"
+
+using namespace std;
+
+
+const int  MULTISTART_MAX_ITERATIONS = 1000;
+// LM starts are checked for stalling every this many iterations
+const int  MULTISTART_STALL_WINDOW = 10;
+const int  MULTISTART_N_MINIMA_TO_PRINT = 10;
+
+
+// Monitor for the LM start currently running (starts are run one at a time)
+static StartMonitor  *currentMonitor = NULL;
+
+
+/* ------------------- Function Prototypes ----------------------------- */
+
+int myfunc_multistart( int nDataVals, int nParams, double *params, double *deviates,
+						double **derivatives, ModelObject *theModel );
+static int LocalLevMarFit( int nParamsTot, int nDataVals, double *paramVector,
+						vector<mp_par>& parameterLimits, ModelObject *theModel,
+						double ftol, bool paramLimitsExist );
+
+
+
+
+// Deviates function for LM starts; returns -1 (which makes mpfit stop) if the
+// current start's StartMonitor says it cannot improve on the minima already found
+int myfunc_multistart( int nDataVals, int nParams, double *params, double *deviates,
+						double **derivatives, ModelObject *theModel )
+{
+  theModel->ComputeDeviates(deviates, params);
+  if (currentMonitor != NULL) {
+    double  fitStatistic = 0.0;
+    for (int i = 0; i < nDataVals; i++)
+      fitStatistic += deviates[i]*deviates[i];
+    if (currentMonitor->CheckForCancel(params, fitStatistic))
+      return -1;
+  }
+  return 0;
+}
+
+
+// Minimal version of LevMarFit, using myfunc_multistart
+static int LocalLevMarFit( int nParamsTot, int nDataVals, double *paramVector,
+						vector<mp_par>& parameterLimits, ModelObject *theModel,
+						double ftol, bool paramLimitsExist )
+{
+  mp_par  *mpfitParameterConstraints = NULL;
+  mp_result  mpfitResult;
+  mp_config  mpConfig;
+  int  status;
+
+  if (paramLimitsExist) {
+    mpfitParameterConstraints = (mp_par *) calloc((size_t)nParamsTot, sizeof(mp_par));
+    for (int i = 0; i < nParamsTot; i++) {
+      mpfitParameterConstraints[i].fixed = parameterLimits[i].fixed;
+      mpfitParameterConstraints[i].limited[0] = parameterLimits[i].limited[0];
+      mpfitParameterConstraints[i].limited[1] = parameterLimits[i].limited[1];
+      mpfitParameterConstraints[i].limits[0] = parameterLimits[i].limits[0];
+      mpfitParameterConstraints[i].limits[1] = parameterLimits[i].limits[1];
+    }
+  }
+  memset(&mpfitResult, 0, sizeof(mpfitResult));
+  memset(&mpConfig, 0, sizeof(mpConfig));
+  mpConfig.maxiter = MULTISTART_MAX_ITERATIONS;
+  mpConfig.ftol = ftol;
+  mpConfig.verbose = 0;
+
+  status = mpfit(myfunc_multistart, nDataVals, nParamsTot, paramVector,
+  				mpfitParameterConstraints, &mpConfig, theModel, &mpfitResult);
+
+  if (mpfitParameterConstraints != NULL)
+    free(mpfitParameterConstraints);
+  return status;
+}
+
+
+// Sort helper: orders minima indices by fit statistic
+static bool CompareFitStats( const pair<double, int>& a, const pair<double, int>& b )
+{
+  return (a.first < b.first);
+}
+
+
+
+
+// main function called by exterior routines to set up and run the minimization
+int MultiStartFit( int nStarts, int localSolverID, int nParamsTot, int nFreeParams,
+					int nPixelsTot, double *paramVector, vector<mp_par> parameterLimits,
+					ModelObject *theModel, double ftol, bool paramLimitsExist, int verbose,
+					SolverResults *solverResults, string& nloptSolverName,
+					unsigned long rngSeed, int rngType )
+{
+  vector<double>  minParamValues(nParamsTot), maxParamValues(nParamsTot);
+  vector<double>  ranges(nParamsTot, 0.0);
+  vector<double>  startPoints((size_t)nStarts*nParamsTot);
+  vector<double>  startParams(nParamsTot);
+  vector<LocalMinimum>  minima;
+  RNGStream  rngStream;
+  bool  paramLimitsOK = true;
+  long  nFuncEvalsTotal = 0;
+  int  nCancelled = 0, nStalled = 0;
+  int  status;
+  string  dummyName;
+
+  // Check for valid parameter limits (as for DE, these define the sampling volume)
+  for (int i = 0; i < nParamsTot; i++) {
+    if (parameterLimits[i].fixed == 1) {
+      minParamValues[i] = paramVector[i];
+      maxParamValues[i] = paramVector[i];
+    }
+    else if ((parameterLimits[i].limited[0] == 1) && (parameterLimits[i].limited[1] == 1)) {
+      minParamValues[i] = parameterLimits[i].limits[0];
+      maxParamValues[i] = parameterLimits[i].limits[1];
+      ranges[i] = maxParamValues[i] - minParamValues[i];
+    }
+    else
+      paramLimitsOK = false;
+  }
+  if (! paramLimitsOK) {
+    fprintf(stderr, "\n*** Parameter limits must be supplied for all parameters when using multi-start fitting!\n");
+    return -2;
+  }
+
+  // Generate the starting points
+  if (rngSeed == 0)
+    rngSeed = (unsigned long)time((time_t *)NULL);
+  if (rngType == RNG_PHILOX) {
+    rngStream.SetSeed(rngSeed, 0);
+    LatinHypercubeSample(nStarts, nParamsTot, minParamValues.data(), maxParamValues.data(),
+    					startPoints.data(), &rngStream);
+  } else {
+    init_genrand(rngSeed);
+    LatinHypercubeSample(nStarts, nParamsTot, minParamValues.data(), maxParamValues.data(),
+    					startPoints.data(), NULL);
+  }
+
+  if (verbose >= 0)
+    printf("Running %d local fits from Latin-hypercube starting points ...\n", nStarts);
+  // each LM iteration needs ~ nFreeParams + 1 function evaluations
+  StartMonitor  monitor(&minima, ranges, (long)MULTISTART_STALL_WINDOW*(nFreeParams + 1),
+  						(long)MULTISTART_MAX_ITERATIONS*(nFreeParams + 1));
+  for (int s = 0; s < nStarts; s++) {
+    for (int j = 0; j < nParamsTot; j++)
+      startParams[j] = startPoints[(size_t)s*nParamsTot + j];
+
+    if (localSolverID == MPFIT_SOLVER) {
+      monitor.NewStart();
+      currentMonitor = &monitor;
+      status = LocalLevMarFit(nParamsTot, nPixelsTot, startParams.data(), parameterLimits,
+      						theModel, ftol, paramLimitsExist);
+      currentMonitor = NULL;
+      nFuncEvalsTotal += monitor.GetNFuncEvals();
+      if (monitor.GetMatchedMinimum() >= 0) {
+        // cancelled: this start was converging to an already-known minimum
+        minima[monitor.GetMatchedMinimum()].nStarts += 1;
+        nCancelled++;
+        if (verbose > 0)
+          printf("   start %d: cancelled (converging to known minimum)\n", s + 1);
+        continue;
+      }
+      if (monitor.Stalled()) {
+        // cancelled: this start was improving too slowly to beat the best minimum
+        nCancelled++;
+        nStalled++;
+        if (verbose > 0)
+          printf("   start %d: cancelled (too slow to reach best fit statistic)\n", s + 1);
+        continue;
+      }
+    } else {
+      SolverResults  startResults;
+      status = DispatchToSolver(localSolverID, nParamsTot, nFreeParams, nPixelsTot,
+      						startParams.data(), parameterLimits, theModel, ftol, paramLimitsExist,
+      						-1, &startResults, nloptSolverName);
+      nFuncEvalsTotal += startResults.GetNFunctionEvals();
+    }
+
+    double  fitStatistic = theModel->GetFitStatistic(startParams.data());
+    nFuncEvalsTotal += 1;
+    if (verbose > 0)
+      printf("   start %d: fit statistic = %.10g (status = %d)\n", s + 1, fitStatistic, status);
+    if (std::isnan(fitStatistic))
+      continue;
+    int  k = FindMinimum(startParams.data(), minima, ranges);
+    if (k >= 0) {
+      minima[k].nStarts += 1;
+      if (fitStatistic < minima[k].fitStatistic) {
+        minima[k].params = startParams;
+        minima[k].fitStatistic = fitStatistic;
+      }
+    } else {
+      LocalMinimum  newMinimum;
+      newMinimum.params = startParams;
+      newMinimum.fitStatistic = fitStatistic;
+      newMinimum.nStarts = 1;
+      minima.push_back(newMinimum);
+    }
+  }
+
+  if (minima.size() == 0) {
+    fprintf(stderr, "\n*** WARNING: none of the multi-start fits produced a valid fit statistic!\n");
+    fprintf(stderr, "    (Fitting from initial parameter values instead.)\n");
+  } else {
+    // sort minima by fit statistic, best first
+    vector< pair<double, int> >  order;
+    for (int k = 0; k < (int)minima.size(); k++)
+      order.push_back(make_pair(minima[k].fitStatistic, k));
+    sort(order.begin(), order.end(), CompareFitStats);
+    LocalMinimum&  bestMinimum = minima[order[0].second];
+    for (int j = 0; j < nParamsTot; j++)
+      paramVector[j] = bestMinimum.params[j];
+
+    if (verbose >= 0) {
+      printf("Multi-start summary: %d starts (%d cancelled early, %d of them for stalling), %d distinct minima, %ld function evaluations\n",
+      		nStarts, nCancelled, nStalled, (int)minima.size(), nFuncEvalsTotal);
+      int  nToPrint = min((int)order.size(), MULTISTART_N_MINIMA_TO_PRINT);
+      for (int n = 0; n < nToPrint; n++) {
+        LocalMinimum&  thisMinimum = minima[order[n].second];
+        printf("   minimum %2d: fit statistic = %.10g  (reached by %d start%s)\n", n + 1,
+        		thisMinimum.fitStatistic, thisMinimum.nStarts, (thisMinimum.nStarts > 1) ? "s" : "");
+      }
+      if ((int)order.size() > nToPrint)
+        printf("   (%d more minima not shown)\n", (int)order.size() - nToPrint);
+    }
+  }
+
+  // Final local fit from the best solution, to get the standard solver results
+  // (e.g., parameter errors from LM)
+  status = DispatchToSolver(localSolverID, nParamsTot, nFreeParams, nPixelsTot,
+  						paramVector, parameterLimits, theModel, ftol, paramLimitsExist,
+  						verbose, solverResults, nloptSolverName);
+  return status;
+}
+
+
+
+/* END OF FILE: multistart_fit.cpp --------------------------------------- */
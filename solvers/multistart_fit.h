@@ -0,0 +1,33 @@
+/** @file
+ * \brief Public function for multi-start local fitting (LM, N-M simplex, or NLopt)
+ *
+ *   Runs a set of local fits, each started from a different Latin-hypercube point
+ * within the parameter limits, and returns the best of the resulting solutions.
+ */
+
+#ifndef _MULTISTART_FIT_H_
+#define _MULTISTART_FIT_H_
+
+#include <string>
+#include <vector>
+#include "definitions.h"
+#include "param_struct.h"   // for mp_par structure
+#include "model_object.h"
+#include "solver_results.h"
+
+using namespace std;
+
+
+// Return values for MultiStartFit:
+//    value = -2  --> FAILURE: missing parameter limits for at least one free parameter
+//    otherwise, the return value of the final (polishing) local fit from the best
+//    solution, as returned by DispatchToSolver for the local solver
+
+int MultiStartFit( int nStarts, int localSolverID, int nParamsTot, int nFreeParams,
+					int nPixelsTot, double *paramVector, vector<mp_par> parameterLimits,
+					ModelObject *theModel, double ftol, bool paramLimitsExist, int verbose,
+					SolverResults *solverResults, string& nloptSolverName,
+					unsigned long rngSeed=0, int rngType=RNG_MERSENNE_TWISTER );
+
+
+#endif  // _MULTISTART_FIT_H_
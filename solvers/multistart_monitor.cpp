@@ -0,0 +1,149 @@
+/* FILE: multistart_monitor.cpp ------------------------------------------ */
+/*
+ * Code for deciding when a single start of a multi-start fit (see multistart_fit.cpp)
+ * can be cancelled, because it cannot end up better than the best minimum already
+ * found by earlier starts.
+ */
+
+#include <vector>
+#include <cmath>
+
+#include "multistart_monitor.h"
+
+using namespace std;
+
+
+
+/* ---------------- FUNCTION: ScaledDistance --------------------------- */
+/// RMS difference between two parameter vectors, in units of the parameter ranges
+/// (fixed parameters, which have range = 0, are skipped)
+double ScaledDistance( const double *params1, const double *params2,
+						const vector<double>& ranges )
+{
+  double  sum = 0.0, delta;
+  int  nFree = 0;
+
+  for (int j = 0; j < (int)ranges.size(); j++) {
+    if (ranges[j] > 0.0) {
+      delta = (params1[j] - params2[j])/ranges[j];
+      sum += delta*delta;
+      nFree++;
+    }
+  }
+  if (nFree == 0)
+    return 0.0;
+  return sqrt(sum/nFree);
+}
+
+
+/* ---------------- FUNCTION: FindMinimum ------------------------------ */
+/// Returns index of the minimum within MULTISTART_CLUSTER_TOLERANCE of params, or
+/// -1 if there is none
+int FindMinimum( const double *params, const vector<LocalMinimum>& minima,
+				const vector<double>& ranges )
+{
+  for (int k = 0; k < (int)minima.size(); k++) {
+    if (ScaledDistance(params, minima[k].params.data(), ranges) < MULTISTART_CLUSTER_TOLERANCE)
+      return k;
+  }
+  return -1;
+}
+
+
+
+/* ---------------- CONSTRUCTOR ---------------------------------------- */
+
+StartMonitor::StartMonitor( const vector<LocalMinimum> *knownMinima,
+							const vector<double>& paramRanges, long windowEvals, long maxEvals )
+{
+  minima = knownMinima;
+  ranges = paramRanges;
+  nEvalsPerWindow = windowEvals;
+  maxFuncEvals = maxEvals;
+  NewStart();
+}
+
+
+/* ---------------- PUBLIC METHOD: NewStart ---------------------------- */
+/// Resets the monitor for a new start
+void StartMonitor::NewStart( )
+{
+  nFuncEvals = 0;
+  windowStartEval = 0;
+  startBestFitStat = HUGE_VAL;
+  windowStartBestFitStat = HUGE_VAL;
+  matchedMinimum = -1;
+  stalled = false;
+}
+
+
+/* ---------------- PUBLIC METHOD: CheckForCancel ---------------------- */
+/// Records one evaluation of the current start (parameters and resulting fit
+/// statistic); returns true if the start should be cancelled.
+bool StartMonitor::CheckForCancel( const double *params, double fitStatistic )
+{
+  double  bestKnownFitStat, gap, progress;
+  long  nWindowEvals;
+  int  k;
+
+  nFuncEvals++;
+  if (fitStatistic < startBestFitStat)
+    startBestFitStat = fitStatistic;
+  if (nFuncEvals == 1)
+    windowStartBestFitStat = startBestFitStat;
+  if (minima->size() == 0)
+    return false;
+
+  // converging to a known minimum?
+  k = FindMinimum(params, *minima, ranges);
+  if ((k >= 0) && (fitStatistic >= (*minima)[k].fitStatistic)) {
+    matchedMinimum = k;
+    return true;
+  }
+
+  // stalling above the best known minimum?
+  nWindowEvals = nFuncEvals - windowStartEval;
+  if (nWindowEvals >= nEvalsPerWindow) {
+    bestKnownFitStat = (*minima)[0].fitStatistic;
+    for (k = 1; k < (int)minima->size(); k++)
+      bestKnownFitStat = fmin(bestKnownFitStat, (*minima)[k].fitStatistic);
+    gap = startBestFitStat - bestKnownFitStat;
+    progress = windowStartBestFitStat - startBestFitStat;
+    if ((gap > 0.0) && (progress*(maxFuncEvals - nFuncEvals) < gap*nWindowEvals)) {
+      stalled = true;
+      return true;
+    }
+    windowStartEval = nFuncEvals;
+    windowStartBestFitStat = startBestFitStat;
+  }
+  return false;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetNFuncEvals ----------------------- */
+
+long StartMonitor::GetNFuncEvals( )
+{
+  return nFuncEvals;
+}
+
+
+/* ---------------- PUBLIC METHOD: GetMatchedMinimum ------------------- */
+/// Returns index of the known minimum the start was converging to when it was
+/// cancelled, or -1 if it wasn't cancelled for that reason
+int StartMonitor::GetMatchedMinimum( )
+{
+  return matchedMinimum;
+}
+
+
+/* ---------------- PUBLIC METHOD: Stalled ----------------------------- */
+/// Returns true if the start was cancelled because it was stalling
+bool StartMonitor::Stalled( )
+{
+  return stalled;
+}
+
+
+
+/* END OF FILE: multistart_monitor.cpp ----------------------------------- */
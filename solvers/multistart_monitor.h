@@ -0,0 +1,70 @@
+/** @file
+ * \brief Class declaration for StartMonitor, which decides when a single start of
+ * a multi-start fit can be cancelled early
+ */
+
+#ifndef _MULTISTART_MONITOR_H_
+#define _MULTISTART_MONITOR_H_
+
+#include <vector>
+
+using namespace std;
+
+
+// Two solutions belong to the same minimum if their RMS separation, in units of
+// the parameter-limit ranges, is smaller than this
+const double  MULTISTART_CLUSTER_TOLERANCE = 1.0e-3;
+
+
+/// Local minimum found by one or more starts
+typedef struct {
+  vector<double>  params;
+  double  fitStatistic;
+  int  nStarts;
+} LocalMinimum;
+
+
+double ScaledDistance( const double *params1, const double *params2,
+						const vector<double>& ranges );
+
+int FindMinimum( const double *params, const vector<LocalMinimum>& minima,
+				const vector<double>& ranges );
+
+
+/// \brief Watches the fit-statistic values of one local-fit start and decides
+/// whether it can be cancelled, because it cannot improve on the best minimum
+/// found by earlier starts.
+///
+/// A start is cancelled if either:
+///    1. it comes within MULTISTART_CLUSTER_TOLERANCE of an already-found minimum
+///       while having a worse fit statistic (it is converging to that minimum); or
+///    2. it is stalling: at the end of each window of windowEvals evaluations, the
+///       improvement in its best fit statistic during that window, extrapolated
+///       linearly over all its remaining evaluations (out of maxEvals), would not
+///       bring it down to the best fit statistic found so far. (Local minimizers
+///       slow down as they converge, so the linear extrapolation is optimistic.)
+class StartMonitor
+{
+  public:
+    StartMonitor( const vector<LocalMinimum> *knownMinima, const vector<double>& paramRanges,
+    			long windowEvals, long maxEvals );
+
+    void NewStart( );
+    bool CheckForCancel( const double *params, double fitStatistic );
+
+    long GetNFuncEvals( );
+    int GetMatchedMinimum( );
+    bool Stalled( );
+
+  private:
+    const vector<LocalMinimum>  *minima;
+    vector<double>  ranges;
+    long  nEvalsPerWindow, maxFuncEvals;
+    long  nFuncEvals, windowStartEval;
+    double  startBestFitStat, windowStartBestFitStat;
+    int  matchedMinimum;   // index of minimum this start is converging to (-1 = none)
+    bool  stalled;
+};
+
+
+#endif  // _MULTISTART_MONITOR_H_
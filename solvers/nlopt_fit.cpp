@@ -54,8 +54,10 @@
 #include <string>
 #include <sstream>
 #include <map>
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
+#include <float.h>
 // Use cmath instead of math.h to avoid GCC-5 problems with C++-11 and isnan()
 //#include <math.h>
 #include <cmath>
@@ -82,6 +84,11 @@ static int  verboseOutput;
 static int  funcCallCount = 0;
 nlopt_opt  theOptimizer;
 string  currentSolverName;
+// parameter bounds (used to keep finite-difference steps within limits)
+static double  *lowerBounds = NULL;
+static double  *upperBounds = NULL;
+// scratch parameter vector for finite-difference gradient
+static double  *stepParams = NULL;
 
 
 
@@ -93,6 +100,19 @@ void PopulateAlgorithmMap( map<string, nlopt_algorithm>& input_map )
   input_map["PRAXIS"] = NLOPT_LN_PRAXIS;
   input_map["NM"] = NLOPT_LN_NELDERMEAD;
   input_map["SBPLX"] = NLOPT_LN_SBPLX;
+  // gradient-based ("LD") algorithms; gradients computed by FitStatisticGradient
+  input_map["LBFGS"] = NLOPT_LD_LBFGS;
+  input_map["MMA"] = NLOPT_LD_MMA;
+  input_map["SLSQP"] = NLOPT_LD_SLSQP;
+  input_map["TNEWTON"] = NLOPT_LD_TNEWTON;
+}
+
+
+/// Returns true if the algorithm requires gradients (and so calls FitStatisticGradient)
+static bool IsGradientAlgorithm( nlopt_algorithm algorithm )
+{
+  return ((algorithm == NLOPT_LD_LBFGS) || (algorithm == NLOPT_LD_MMA) || 
+  		(algorithm == NLOPT_LD_SLSQP) || (algorithm == NLOPT_LD_TNEWTON));
 }
 
 
@@ -109,10 +129,45 @@ bool ValidNLOptSolverName( string solverName )
 }
 
 
-/// Objective function: calculates the objective value (ignore gradient calculation)
+/// Computes gradient of fit statistic by forward differences, re-using the already-
+/// computed fit statistic at params (so the objective value and gradient together cost
+/// nFree + 1 model evaluations, each of which is itself OpenMP-parallelized). Step sizes
+/// follow mpfit (h = sqrt(DBL_EPSILON)*|x|); steps are taken backwards if a forward step
+/// would cross the upper parameter limit. Fixed parameters get zero gradient.
+/// Returns the number of extra fit-statistic evaluations.
+static int FitStatisticGradient( unsigned n, const double *params, double fitStatistic,
+								double *grad, ModelObject *theModel )
+{
+  double  h, newFitStatistic;
+  const double  relStep = sqrt(DBL_EPSILON);
+  int  nEvals = 0;
+
+  for (unsigned j = 0; j < n; j++)
+    stepParams[j] = params[j];
+  for (unsigned j = 0; j < n; j++) {
+    if (lowerBounds[j] == upperBounds[j]) {
+      grad[j] = 0.0;
+      continue;
+    }
+    h = relStep*fabs(params[j]);
+    if (h == 0.0)
+      h = relStep;
+    if (params[j] + h > upperBounds[j])
+      h = -h;
+    stepParams[j] = params[j] + h;
+    newFitStatistic = theModel->GetFitStatistic(stepParams);
+    nEvals++;
+    grad[j] = (newFitStatistic - fitStatistic)/h;
+    stepParams[j] = params[j];
+  }
+  return nEvals;
+}
+
+
+/// Objective function: calculates the objective value, plus the gradient if the
+/// algorithm requires it (grad != NULL)
 /// Keep track of how many times this function has been called, and report current
 /// chi^2 (or other objective-function value) every 20 calls
-/// Note that parameters n and grad are unused, but required by the NLopt interface.
 double myfunc_nlopt_gen( unsigned n, const double *x, double *grad, void *my_func_data )
 {
   ModelObject *theModel = (ModelObject *)my_func_data;
@@ -120,16 +175,21 @@ double myfunc_nlopt_gen( unsigned n, const double *x, double *grad, void *my_fun
   // const double*
   double  *params = (double *)x;
   double  fitStatistic;
+  int  prevCallCount = funcCallCount;
+  const int  verboseStep = REPORT_STEPS_PER_VERBOSE_OUTPUT*FUNCS_PER_REPORTING_STEP;
   nlopt_result  junk;
   
   fitStatistic = theModel->GetFitStatistic(params);
+  if ((grad != NULL) && (! std::isnan(fitStatistic)))
+    funcCallCount += FitStatisticGradient(n, x, fitStatistic, grad, theModel);
   
-  // feedback to user
+  // feedback to user (with gradient evaluations, funcCallCount can advance by more
+  // than one per call, so check for crossing a reporting step)
   funcCallCount++;
   if (verboseOutput > 0) {
-    if ((funcCallCount % FUNCS_PER_REPORTING_STEP) == 0) {
+    if ((funcCallCount / FUNCS_PER_REPORTING_STEP) > (prevCallCount / FUNCS_PER_REPORTING_STEP)) {
       printf("\tN-M simplex: function call %d: objective = %f\n", funcCallCount, fitStatistic);
-      if ( (verboseOutput > 1) && ((funcCallCount % (REPORT_STEPS_PER_VERBOSE_OUTPUT*FUNCS_PER_REPORTING_STEP)) == 0) ) {
+      if ( (verboseOutput > 1) && ((funcCallCount / verboseStep) > (prevCallCount / verboseStep)) ) {
         PrintParametersSimple(theModel, params);
       }
     }
@@ -244,7 +304,7 @@ int NLOptFit( int nParamsTot, double *paramVector, vector<mp_par> parameterLimit
                   SolverResults *solverResults )
 {
   nlopt_result  result;
-  int  maxEvaluations;
+  int  maxEvaluations, nFreeParams = 0;
   double  initialStatisticVal, finalStatisticVal;
   double  *minParamValues;
   double  *maxParamValues;
@@ -294,11 +354,23 @@ int NLOptFit( int nParamsTot, double *paramVector, vector<mp_par> parameterLimit
   nlopt_set_ftol_abs(theOptimizer, ftol);
   // specify relative tolerance for all parameters
   nlopt_set_xtol_rel(theOptimizer, ftol);
-  // maximum number of function calls (MAXEVAL_BASE * total number of parameters)
+  // maximum number of fit-statistic evaluations (MAXEVAL_BASE * total number of 
+  // parameters); NLopt counts objective-function calls, and for gradient-based
+  // algorithms each call costs nFree + 1 evaluations
   maxEvaluations = nParamsTot * MAXEVAL_BASE;
+  if (IsGradientAlgorithm(algorithmName)) {
+    for (int i = 0; i < nParamsTot; i++) {
+      if (minParamValues[i] != maxParamValues[i])
+        nFreeParams++;
+    }
+    maxEvaluations = std::max(maxEvaluations / (nFreeParams + 1), 1);
+  }
   nlopt_set_maxeval(theOptimizer, maxEvaluations);
   
   // Set up the optimizer for minimization
+  lowerBounds = minParamValues;
+  upperBounds = maxParamValues;
+  stepParams = (double *)calloc( (size_t)nParamsTot, sizeof(double) );
   nlopt_set_min_objective(theOptimizer, myfunc_nlopt_gen, theModel);  
   // Specify parameter boundaries, if they exist
   nlopt_set_lower_bounds(theOptimizer, minParamValues);
@@ -309,6 +381,7 @@ int NLOptFit( int nParamsTot, double *paramVector, vector<mp_par> parameterLimit
 
   // Specify level of verbosity and start the optimization
   verboseOutput = verbose;
+  funcCallCount = 0;
   result = nlopt_optimize(theOptimizer, paramVector, &finalStatisticVal);
   if (verbose >= 0)
     InterpretResult(result, algorithmName);
@@ -325,6 +398,8 @@ int NLOptFit( int nParamsTot, double *paramVector, vector<mp_par> parameterLimit
   nlopt_destroy(theOptimizer);
   free(minParamValues);
   free(maxParamValues);
+  free(stepParams);
+  lowerBounds = upperBounds = stepParams = NULL;
   return (int)result;
 }
 
@@ -100,6 +100,38 @@ public:
 
 
 
+  // Every available function must specify how its parameters scale with pixel
+  // size (used by multi-resolution fitting)
+  void testAllFunctionsHaveParameterScalings( void )
+  {
+    vector<string>  fnameList, flabelList;
+    vector<int>  funcSetIndices;
+    double  psfImage[25];
+    int  status, nParamsTot;
+
+    for (int k = 0; k < 25; k++)
+      psfImage[k] = 0.04;
+
+    GetFunctionNames(fnameList);
+    for (int i = 0; i < (int)fnameList.size(); i++) {
+      ModelObject  *modelObj = new ModelObject();
+      // PSF is needed for PointSource
+      modelObj->AddPSFVector(25, 5, 5, psfImage);
+      vector<string>  oneFunction(1, fnameList[i]);
+      funcSetIndices.assign(1, 0);
+      flabelList.assign(1, "");
+      status = AddFunctions(modelObj, oneFunction, flabelList, funcSetIndices, false, -1);
+      TS_ASSERT_EQUALS(status, 0);
+      nParamsTot = modelObj->GetNParams();
+      TS_ASSERT_EQUALS(modelObj->GetParameterScaling(0), PARAM_SCALING_POSITION);
+      TS_ASSERT_EQUALS(modelObj->GetParameterScaling(1), PARAM_SCALING_POSITION);
+      for (int j = 2; j < nParamsTot; j++) {
+        TS_ASSERT_DIFFERS(modelObj->GetParameterScaling(j), PARAM_SCALING_UNKNOWN);
+      }
+      delete modelObj;
+    }
+  }
+
   void testAddFunctionsToModel( void )
   {
     ModelObject *modelObj;
@@ -0,0 +1,204 @@
+// Unit tests for block-averaging of images and parameters (block_average.cpp)
+
+// See run_unittest_block_average.sh for how to compile and run these tests.
+
+
+#include <cxxtest/TestSuite.h>
+
+#include <math.h>
+#include <string>
+#include <vector>
+#include "block_average.h"
+#include "function_objects/function_object.h"
+#include "function_objects/func_broken-exp.h"
+#include "function_objects/func_double-broken-exp.h"
+#include "function_objects/func_logspiral2.h"
+#include "function_objects/func_logspiral_gauss.h"
+
+using namespace std;
+
+
+class NewTestSuite : public CxxTest::TestSuite 
+{
+public:
+
+  void testBlockAveragedSizes( void )
+  {
+    TS_ASSERT_EQUALS(BlockAveragedSize(100, 2), 50);
+    TS_ASSERT_EQUALS(BlockAveragedSize(101, 2), 51);
+    TS_ASSERT_EQUALS(BlockAveragedSize(7, 4), 2);
+    TS_ASSERT_EQUALS(BlockAveragedPsfSize(35, 2), 19);
+    TS_ASSERT_EQUALS(BlockAveragedPsfSize(35, 4), 9);
+    TS_ASSERT_EQUALS(BlockAveragedPsfSize(5, 8), 1);
+  }
+
+  void testBlockAverageImage( void )
+  {
+    // 5x3 image (5 columns, 3 rows), block size = 2 --> 3x2 output
+    double  image[15] = {1, 2, 3, 4, 5,
+                         6, 7, 8, 9, 10,
+                         11, 12, 13, 14, 15};
+    double  mask[15] = {1, 1, 1, 1, 1,
+                        1, 1, 0, 0, 1,
+                        1, 1, 1, 1, 1};
+    double  outputImage[6], outputMask[6];
+    double  correctImage[6] = {4.0, 3.5, 7.5, 11.5, 13.5, 15.0};
+
+    BlockAverageImage(image, mask, NULL, 5, 3, 2, outputImage, outputMask);
+    for (int i = 0; i < 6; i++) {
+      TS_ASSERT_DELTA(outputImage[i], correctImage[i], 1.0e-12);
+      TS_ASSERT_EQUALS(outputMask[i], 1.0);
+    }
+  }
+
+  void testBlockAverageImage_Weights( void )
+  {
+    // 2x2 image -> single pixel; one pixel masked
+    double  image[4] = {1, 2, 3, 100};
+    double  mask[4] = {1, 1, 1, 0};
+    double  weights[4] = {1.0, 0.25, 0.5, 1.0};   // sigma^2 = 1, 4, 2, [1]
+    double  outputImage[1], outputMask[1], outputWeights[1];
+
+    BlockAverageImage(image, mask, weights, 2, 2, 2, outputImage, outputMask, outputWeights);
+    TS_ASSERT_DELTA(outputImage[0], 2.0, 1.0e-12);
+    TS_ASSERT_EQUALS(outputMask[0], 1.0);
+    // variance of mean = (1 + 4 + 2)/3^2
+    TS_ASSERT_DELTA(outputWeights[0], 9.0/7.0, 1.0e-12);
+
+    // fully masked block
+    double  mask2[4] = {0, 0, 0, 0};
+    BlockAverageImage(image, mask2, weights, 2, 2, 2, outputImage, outputMask, outputWeights);
+    TS_ASSERT_EQUALS(outputMask[0], 0.0);
+    TS_ASSERT_EQUALS(outputWeights[0], 0.0);
+  }
+
+  void testBlockAveragePsf( void )
+  {
+    // 5x5 PSF with central peak, block size = 2 --> 3x3 output, same total flux
+    double  psf[25];
+    double  outputPsf[9];
+    double  total = 0.0;
+    for (int i = 0; i < 25; i++)
+      psf[i] = 1.0;
+    psf[12] = 10.0;
+
+    BlockAveragePsf(psf, 5, 5, 2, outputPsf);
+    for (int i = 0; i < 9; i++)
+      total += outputPsf[i];
+    TS_ASSERT_DELTA(total, 34.0, 1.0e-12);
+    // center stays at center, and output is symmetric
+    for (int i = 0; i < 9; i++)
+      TS_ASSERT(outputPsf[4] >= outputPsf[i]);
+    TS_ASSERT_DELTA(outputPsf[0], outputPsf[8], 1.0e-12);
+    TS_ASSERT_DELTA(outputPsf[2], outputPsf[6], 1.0e-12);
+  }
+
+  // Parameter scalings come from the function objects themselves; check some
+  // which name-matching used to get wrong
+  void testFunctionParameterScalings( void )
+  {
+    vector<int>  scalings;
+    FunctionObject  *funcObj;
+
+    funcObj = new DoubleBrokenExponential();
+    funcObj->GetParameterScalings(scalings);
+    delete funcObj;
+    TS_ASSERT_EQUALS((int)scalings.size(), 10);
+    TS_ASSERT_EQUALS(scalings[6], PARAM_SCALING_LENGTH);       // r_break1
+    TS_ASSERT_EQUALS(scalings[7], PARAM_SCALING_LENGTH);       // r_break2
+    TS_ASSERT_EQUALS(scalings[8], PARAM_SCALING_INV_LENGTH);   // alpha1
+
+    scalings.clear();
+    funcObj = new LogSpiralGauss();
+    funcObj->GetParameterScalings(scalings);
+    delete funcObj;
+    TS_ASSERT_EQUALS((int)scalings.size(), 11);
+    TS_ASSERT_EQUALS(scalings[8], PARAM_SCALING_LENGTH);       // R_max
+    TS_ASSERT_EQUALS(scalings[9], PARAM_SCALING_LENGTH);       // sigma_max_in
+    TS_ASSERT_EQUALS(scalings[10], PARAM_SCALING_LENGTH);      // sigma_max_out
+  }
+
+  // Block-averaging a function's image should give (nearly) the same result as
+  // evaluating the function on the coarse grid with block-averaged parameters
+  void testRoundTripThroughCoarseLevel( void )
+  {
+    double  brokenExpParams[7] = {20.0, 0.3, 100.0, 15.0, 6.0, 30.0, 0.5};
+    double  doubleBrokenExpParams[10] = {20.0, 0.3, 100.0, 20.0, 8.0, 15.0,
+    									15.0, 35.0, 0.5, 0.5};
+    double  logSpiral2Params[11] = {10.0, 0.2, 2.0, 20.0, 20.0, 40.0, 0.0,
+    								10.0, 20.0, 15.0, 5.0};
+    double  logSpiralGaussParams[11] = {10.0, 0.2, 2.0, 20.0, 10.0, 20.0, 40.0,
+    									0.0, 25.0, 8.0, 12.0};
+
+    CheckRoundTrip(new BrokenExponential(), brokenExpParams);
+    CheckRoundTrip(new DoubleBrokenExponential(), doubleBrokenExpParams);
+    CheckRoundTrip(new LogSpiral2(), logSpiral2Params);
+    CheckRoundTrip(new LogSpiralGauss(), logSpiralGaussParams);
+  }
+
+  // Computes funcObj on a fine grid, block-averages it, and compares the result with
+  // funcObj computed on the coarse grid; also checks that the parameters survive the
+  // round trip fine -> coarse -> fine. Deletes funcObj when done.
+  void CheckRoundTrip( FunctionObject *funcObj, double params[] )
+  {
+    const int  nFine = 120;
+    const int  blockSize = 2;
+    const int  nCoarse = nFine/blockSize;
+    const double  x0 = 60.5;
+    const double  y0 = 60.5;
+    vector<int>  scalings;
+    vector<double>  fineImage(nFine*nFine), mask(nFine*nFine, 1.0);
+    vector<double>  averagedImage(nCoarse*nCoarse), averagedMask(nCoarse*nCoarse);
+    double  coarseParams[20];
+    double  x0Coarse, y0Coarse, coarseValue, sumDiff = 0.0, sumTotal = 0.0;
+    int  nParams = funcObj->GetNParams();
+
+    funcObj->GetParameterScalings(scalings);
+    TS_ASSERT_EQUALS((int)scalings.size(), nParams);
+    for (int i = 0; i < nParams; i++) {
+      coarseParams[i] = BlockAverageParameter(params[i], scalings[i], blockSize);
+      TS_ASSERT_DELTA(UnBlockAverageParameter(coarseParams[i], scalings[i], blockSize),
+      				params[i], 1.0e-10);
+    }
+    x0Coarse = BlockAverageParameter(x0, PARAM_SCALING_POSITION, blockSize);
+    y0Coarse = BlockAverageParameter(y0, PARAM_SCALING_POSITION, blockSize);
+
+    funcObj->Setup(params, 0, x0, y0);
+    for (int i = 0; i < nFine; i++) {
+      for (int j = 0; j < nFine; j++)
+        fineImage[i*nFine + j] = funcObj->GetValue(j + 1.0, i + 1.0);
+    }
+    BlockAverageImage(fineImage.data(), mask.data(), NULL, nFine, nFine, blockSize,
+    				averagedImage.data(), averagedMask.data());
+
+    funcObj->Setup(coarseParams, 0, x0Coarse, y0Coarse);
+    for (int i = 0; i < nCoarse; i++) {
+      for (int j = 0; j < nCoarse; j++) {
+        coarseValue = funcObj->GetValue(j + 1.0, i + 1.0);
+        sumDiff += fabs(coarseValue - averagedImage[i*nCoarse + j]);
+        sumTotal += fabs(averagedImage[i*nCoarse + j]);
+      }
+    }
+    TS_ASSERT_LESS_THAN(sumDiff/sumTotal, 0.03);
+    delete funcObj;
+  }
+
+  void testParameterConversions( void )
+  {
+    // original pixels 1 and 2 form block-averaged pixel 1 (for block size = 2),
+    // so their common edge (x = 1.5) maps to the center of the new pixel
+    TS_ASSERT_DELTA(BlockAverageParameter(1.5, PARAM_SCALING_POSITION, 2), 1.0, 1.0e-12);
+    TS_ASSERT_DELTA(BlockAverageParameter(2.5, PARAM_SCALING_POSITION, 4), 1.0, 1.0e-12);
+    TS_ASSERT_DELTA(BlockAverageParameter(20.0, PARAM_SCALING_LENGTH, 4), 5.0, 1.0e-12);
+    TS_ASSERT_DELTA(BlockAverageParameter(100.0, PARAM_SCALING_TOTAL_FLUX, 2), 25.0, 1.0e-12);
+    TS_ASSERT_DELTA(BlockAverageParameter(3.0, PARAM_SCALING_INV_LENGTH, 2), 6.0, 1.0e-12);
+    TS_ASSERT_DELTA(BlockAverageParameter(3.0, PARAM_SCALING_NONE, 8), 3.0, 1.0e-12);
+
+    int  types[5] = {PARAM_SCALING_NONE, PARAM_SCALING_POSITION, PARAM_SCALING_LENGTH,
+    				PARAM_SCALING_TOTAL_FLUX, PARAM_SCALING_INV_LENGTH};
+    for (int k = 0; k < 5; k++) {
+      double  coarse = BlockAverageParameter(123.4, types[k], 8);
+      TS_ASSERT_DELTA(UnBlockAverageParameter(coarse, types[k], 8), 123.4, 1.0e-10);
+    }
+  }
+};
@@ -0,0 +1,119 @@
+// Unit tests for binary checkpoint files (checkpoint.cpp)
+
+// See run_unittest_checkpoint.sh for how to compile and run these tests.
+
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "checkpoint.h"
+#include "mersenne_twister.h"
+
+using namespace std;
+
+const string  TEST_CHECKPOINT_FILE = "temp_checkpoint_test.bin";
+
+
+class NewTestSuite : public CxxTest::TestSuite 
+{
+public:
+
+  // Values written with CheckpointWriter should be read back unchanged, in order
+  void testRoundTrip( void )
+  {
+    CheckpointWriter  writer;
+    CheckpointReader  reader;
+    int  nValues = 1000;
+    int  generation = 123, generation_in = 0;
+    double  energy = 1.2345678901234e-5, energy_in = 0.0;
+    vector<double>  values(nValues), values_in(nValues, 0.0);
+    bool  status;
+
+    for (int i = 0; i < nValues; i++)
+      values[i] = 0.1*i - 3.0;
+    writer.Begin("TestSolver");
+    writer.Add(generation);
+    writer.AddArray(values.data(), nValues);
+    writer.Add(energy);
+    status = writer.WriteAsync(TEST_CHECKPOINT_FILE);
+    TS_ASSERT_EQUALS(status, true);
+    status = writer.Wait();
+    TS_ASSERT_EQUALS(status, true);
+
+    status = reader.Open(TEST_CHECKPOINT_FILE, "TestSolver");
+    TS_ASSERT_EQUALS(status, true);
+    reader.Get(generation_in);
+    reader.GetArray(values_in.data(), nValues);
+    reader.Get(energy_in);
+    TS_ASSERT_EQUALS(reader.Finished(), true);
+    TS_ASSERT_EQUALS(generation_in, generation);
+    TS_ASSERT_EQUALS(energy_in, energy);
+    for (int i = 0; i < nValues; i++)
+      TS_ASSERT_EQUALS(values_in[i], values[i]);
+    remove(TEST_CHECKPOINT_FILE.c_str());
+  }
+
+  // Wrong kind label, missing file, or reading past the end should all fail
+  void testBadCheckpoints( void )
+  {
+    CheckpointWriter  writer;
+    CheckpointReader  reader;
+    int  x = 1;
+    double  y;
+
+    TS_ASSERT_EQUALS(reader.Open("nonexistent_checkpoint_file.bin", "TestSolver"), false);
+    TS_ASSERT_EQUALS(CheckpointExists("nonexistent_checkpoint_file.bin"), false);
+
+    writer.Begin("TestSolver");
+    writer.Add(x);
+    writer.WriteAsync(TEST_CHECKPOINT_FILE);
+    writer.Wait();
+    TS_ASSERT_EQUALS(CheckpointExists(TEST_CHECKPOINT_FILE), true);
+    TS_ASSERT_EQUALS(reader.Open(TEST_CHECKPOINT_FILE, "OtherSolver"), false);
+    TS_ASSERT_EQUALS(reader.Open(TEST_CHECKPOINT_FILE, "TestSolver"), true);
+    TS_ASSERT_EQUALS(reader.Get(y), false);   // only 4 bytes of data in file
+    TS_ASSERT_EQUALS(reader.Finished(), false);
+    remove(TEST_CHECKPOINT_FILE.c_str());
+  }
+
+  // Successive asynchronous writes: the file should hold the last one
+  void testRepeatedWrites( void )
+  {
+    CheckpointWriter  writer;
+    CheckpointReader  reader;
+    int  value_in = -1;
+
+    for (int n = 0; n < 5; n++) {
+      writer.Begin("TestSolver");
+      writer.Add(n);
+      writer.WriteAsync(TEST_CHECKPOINT_FILE);
+    }
+    writer.Wait();
+    TS_ASSERT_EQUALS(reader.Open(TEST_CHECKPOINT_FILE, "TestSolver"), true);
+    reader.Get(value_in);
+    TS_ASSERT_EQUALS(value_in, 4);
+    remove(TEST_CHECKPOINT_FILE.c_str());
+  }
+
+  // Restoring a saved Mersenne Twister state should reproduce the same sequence
+  void testMersenneTwisterState( void )
+  {
+    unsigned long  mtState[MT_STATE_SIZE];
+    int  mtPosition;
+    double  firstSequence[700];
+
+    init_genrand(42);
+    for (int i = 0; i < 100; i++)
+      genrand_real1();
+    get_genrand_state(mtState, &mtPosition);
+    for (int i = 0; i < 700; i++)
+      firstSequence[i] = genrand_real1();
+
+    init_genrand(99);
+    set_genrand_state(mtState, mtPosition);
+    for (int i = 0; i < 700; i++)
+      TS_ASSERT_EQUALS(genrand_real1(), firstSequence[i]);
+  }
+};
@@ -0,0 +1,356 @@
+// Unit tests for convolver.cpp
+//
+// Compares overlap-save (tiled) FFT convolution, direct-space convolution, and
+// low-rank (SVD) convolution against standard full-image FFT convolution, using
+// pseudo-random images and PSFs with odd and even dimensions.
+//
+// cxxtestgen --error-printer -o test_runner_convolver.cpp unit_tests/unittest_convolver.t.h
+// g++ -o test_runner_convolver test_runner_convolver.cpp core/convolver.cpp -I. -Icore -I/usr/local/include -I$CXXTEST -lfftw3 -lm
+// ./test_runner_convolver
+
+#include <cxxtest/TestSuite.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace std;
+
+#include "convolver.h"
+
+#define DELTA  1.0e-10
+
+
+// Fills vector with deterministic pseudo-random values in [0,1)
+void FillImage( vector<double>& pixels, int nPixels, unsigned int seed )
+{
+  pixels.resize(nPixels);
+  for (int k = 0; k < nPixels; k++) {
+    seed = 1103515245*seed + 12345;
+    pixels[k] = ((seed >> 8) & 0xFFFF) / 65536.0;
+  }
+}
+
+// Returns a copy of image convolved with psf using the specified method, tile size
+// (0 = automatic), and output region (nCols_out = 0 --> full image)
+vector<double> DoConvolution( vector<double> image, int nCols, int nRows, 
+							vector<double> psf, int nCols_psf, int nRows_psf, int method,
+							int tileSize=0, int x0_out=0, int y0_out=0, int nCols_out=0,
+							int nRows_out=0 )
+{
+  Convolver  convolver;
+  convolver.SetupPSF(&psf[0], nCols_psf, nRows_psf);
+  convolver.SetupImage(nCols, nRows);
+  convolver.SetConvolutionMethod(method);
+  if (tileSize > 0)
+    convolver.SetFFTTileSize(tileSize, tileSize);
+  if (nCols_out > 0)
+    convolver.SetOutputRegion(x0_out, y0_out, nCols_out, nRows_out);
+  convolver.DoFullSetup(0, false);
+  convolver.ConvolveImage(&image[0]);
+  return image;
+}
+
+
+// Fills vector with a (separable) 2D Gaussian
+void MakeGaussianPSF( vector<double>& pixels, int nCols, int nRows, double sigma )
+{
+  pixels.resize(nCols*nRows);
+  for (int i = 0; i < nRows; i++) {
+    for (int j = 0; j < nCols; j++) {
+      double  dx = j - nCols/2;
+      double  dy = i - nRows/2;
+      pixels[i*nCols + j] = exp(-(dx*dx + dy*dy)/(2.0*sigma*sigma));
+    }
+  }
+}
+
+
+class TestConvolver : public CxxTest::TestSuite 
+{
+public:
+
+  void testGoodFFTSize( void )
+  {
+    TS_ASSERT_EQUALS( GoodFFTSize(1), 1 );
+    TS_ASSERT_EQUALS( GoodFFTSize(64), 64 );
+    TS_ASSERT_EQUALS( GoodFFTSize(11), 12 );
+    TS_ASSERT_EQUALS( GoodFFTSize(97), 98 );
+    TS_ASSERT_EQUALS( GoodFFTSize(121), 125 );
+  }
+
+  void testBadMethod( void )
+  {
+    Convolver  convolver;
+    TS_ASSERT_EQUALS( convolver.SetConvolutionMethod(-1), -1 );
+    TS_ASSERT_EQUALS( convolver.SetConvolutionMethod(CONVOLVE_FFT_TILED), 0 );
+    TS_ASSERT_EQUALS( convolver.GetConvolutionMethod(), CONVOLVE_FFT_TILED );
+  }
+
+  void testTiledMatchesFullFFT_oddPSF( void )
+  {
+    int  nCols = 67, nRows = 45, nCols_psf = 7, nRows_psf = 5;
+    vector<double>  image, psf, ref, tiled;
+    FillImage(image, nCols*nRows, 1);
+    FillImage(psf, nCols_psf*nRows_psf, 2);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    // small tiles, so that image is split into many tiles, some of them partial
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, 
+    						CONVOLVE_FFT_TILED, 16);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( tiled[k], ref[k], DELTA );
+    // automatic tile size
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT_TILED);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( tiled[k], ref[k], DELTA );
+  }
+
+  void testTiledMatchesFullFFT_evenPSF( void )
+  {
+    int  nCols = 50, nRows = 61, nCols_psf = 6, nRows_psf = 8;
+    vector<double>  image, psf, ref, tiled;
+    FillImage(image, nCols*nRows, 3);
+    FillImage(psf, nCols_psf*nRows_psf, 4);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, 
+    						CONVOLVE_FFT_TILED, 20);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( tiled[k], ref[k], DELTA );
+  }
+
+  // tiles only slightly larger than the PSF, so that each row of tiles is shorter
+  // than the strip of original input rows the next row of tiles needs
+  void testTiledMatchesFullFFT_tilesSmallerThanHalo( void )
+  {
+    int  nCols = 37, nRows = 29, nCols_psf = 9, nRows_psf = 9;
+    vector<double>  image, psf, ref, tiled;
+    FillImage(image, nCols*nRows, 13);
+    FillImage(psf, nCols_psf*nRows_psf, 14);
+
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf,
+    						CONVOLVE_FFT_TILED, 10);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( tiled[k], ref[k], DELTA );
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf,
+    						CONVOLVE_FFT_TILED, 10, 3, 4, 30, 20);
+    CheckOutputRegion(tiled, ref, image, nCols, nRows, 3, 4, 30, 20);
+  }
+
+  void testDirectMatchesFullFFT_nonseparable( void )
+  {
+    int  nCols = 41, nRows = 37, nCols_psf = 5, nRows_psf = 6;
+    vector<double>  image, psf, ref, direct;
+    FillImage(image, nCols*nRows, 7);
+    FillImage(psf, nCols_psf*nRows_psf, 8);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    direct = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_DIRECT);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( direct[k], ref[k], DELTA );
+  }
+
+  void testDirectMatchesFullFFT_separable( void )
+  {
+    int  nCols = 52, nRows = 33, nCols_psf = 7, nRows_psf = 4;
+    vector<double>  image, psf, ref, direct;
+    FillImage(image, nCols*nRows, 9);
+    MakeGaussianPSF(psf, nCols_psf, nRows_psf, 1.3);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    direct = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_DIRECT);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( direct[k], ref[k], DELTA );
+  }
+
+  void testJacobiSVD( void )
+  {
+    // 3x2 matrix with known singular values sqrt(3) and 1
+    double  A[6] = {1.0, 1.0,  0.0, 1.0,  1.0, 0.0};
+    double  V[4], sigma[2];
+    JacobiSVD(A, 3, 2, sigma, V);
+    double  sMax = (sigma[0] > sigma[1]) ? sigma[0] : sigma[1];
+    double  sMin = (sigma[0] > sigma[1]) ? sigma[1] : sigma[0];
+    TS_ASSERT_DELTA( sMax, sqrt(3.0), DELTA );
+    TS_ASSERT_DELTA( sMin, 1.0, DELTA );
+  }
+
+  void testLowRank_separablePSF( void )
+  {
+    int  nCols = 40, nRows = 30;
+    vector<double>  image, psf, ref, lowrank;
+    FillImage(image, nCols*nRows, 13);
+    MakeGaussianPSF(psf, 9, 9, 2.0);
+    
+    Convolver  convolver;
+    convolver.SetupPSF(&psf[0], 9, 9);
+    convolver.SetupImage(nCols, nRows);
+    convolver.SetConvolutionMethod(CONVOLVE_LOWRANK);
+    convolver.DoFullSetup(0, false);
+    TS_ASSERT_EQUALS( convolver.GetNSeparableTerms(), 1 );
+    TS_ASSERT_LESS_THAN( convolver.GetLowRankResidual(), 1.0e-10 );
+
+    ref = DoConvolution(image, nCols, nRows, psf, 9, 9, CONVOLVE_FFT);
+    lowrank = DoConvolution(image, nCols, nRows, psf, 9, 9, CONVOLVE_LOWRANK);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( lowrank[k], ref[k], DELTA );
+  }
+
+  void testLowRank_nonseparablePSF( void )
+  {
+    // Moffat-like PSF (not separable, but well approximated by a few terms)
+    int  nCols = 45, nRows = 38, nCols_psf = 15, nRows_psf = 15;
+    vector<double>  image, psf, ref, lowrank;
+    FillImage(image, nCols*nRows, 14);
+    psf.resize(nCols_psf*nRows_psf);
+    for (int i = 0; i < nRows_psf; i++)
+      for (int j = 0; j < nCols_psf; j++) {
+        double  r2 = (i - 7)*(i - 7) + (j - 7)*(j - 7);
+        psf[i*nCols_psf + j] = pow(1.0 + r2/9.0, -2.5);
+      }
+    
+    Convolver  convolver;
+    convolver.SetupPSF(&psf[0], nCols_psf, nRows_psf);
+    convolver.SetupImage(nCols, nRows);
+    convolver.SetConvolutionMethod(CONVOLVE_LOWRANK);
+    convolver.SetLowRankTolerance(1.0e-3);
+    convolver.DoFullSetup(0, false);
+    int  nTerms = convolver.GetNSeparableTerms();
+    double  residual = convolver.GetLowRankResidual();
+    TS_ASSERT( nTerms > 1 );
+    TS_ASSERT( nTerms < nCols_psf );
+    
+    // error of convolved image is bounded by residual * max|image| (max|image| < 1)
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    lowrank = image;
+    convolver.ConvolveImage(&lowrank[0]);
+    for (int k = 0; k < nCols*nRows; k++)
+      TS_ASSERT_DELTA( lowrank[k], ref[k], residual + DELTA );
+  }
+
+  void testAutoMethodChoice( void )
+  {
+    int  nCols = 200, nRows = 200;
+    vector<double>  smallPSF, bigPSF;
+    MakeGaussianPSF(smallPSF, 5, 5, 1.0);
+    FillImage(bigPSF, 51*51, 10);
+    
+    Convolver  convolver1;
+    convolver1.SetupPSF(&smallPSF[0], 5, 5);
+    convolver1.SetupImage(nCols, nRows);
+    convolver1.SetConvolutionMethod(CONVOLVE_AUTO);
+    convolver1.DoFullSetup(0, false);
+    TS_ASSERT_EQUALS( convolver1.GetConvolutionMethod(), CONVOLVE_DIRECT );
+
+    Convolver  convolver2;
+    convolver2.SetupPSF(&bigPSF[0], 51, 51);
+    convolver2.SetupImage(nCols, nRows);
+    convolver2.SetConvolutionMethod(CONVOLVE_AUTO);
+    convolver2.DoFullSetup(0, false);
+    TS_ASSERT_EQUALS( convolver2.GetConvolutionMethod(), CONVOLVE_FFT );
+  }
+
+  void testTiledOutputRegion( void )
+  {
+    int  nCols = 60, nRows = 40, nCols_psf = 5, nRows_psf = 5;
+    int  x0 = 5, y0 = 7, nCols_out = 33, nRows_out = 21;
+    vector<double>  image, psf, ref, tiled;
+    FillImage(image, nCols*nRows, 5);
+    FillImage(psf, nCols_psf*nRows_psf, 6);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, CONVOLVE_FFT);
+    tiled = DoConvolution(image, nCols, nRows, psf, nCols_psf, nRows_psf, 
+    						CONVOLVE_FFT_TILED, 12, x0, y0, nCols_out, nRows_out);
+    CheckOutputRegion(tiled, ref, image, nCols, nRows, x0, y0, nCols_out, nRows_out);
+  }
+
+  void testDirectOutputRegion( void )
+  {
+    int  nCols = 60, nRows = 40;
+    int  x0 = 2, y0 = 9, nCols_out = 50, nRows_out = 30;
+    vector<double>  image, psf, psfSep, ref, direct;
+    FillImage(image, nCols*nRows, 11);
+    FillImage(psf, 6*5, 12);
+    MakeGaussianPSF(psfSep, 5, 6, 1.5);
+    
+    ref = DoConvolution(image, nCols, nRows, psf, 6, 5, CONVOLVE_FFT);
+    direct = DoConvolution(image, nCols, nRows, psf, 6, 5, CONVOLVE_DIRECT, 0, 
+    						x0, y0, nCols_out, nRows_out);
+    CheckOutputRegion(direct, ref, image, nCols, nRows, x0, y0, nCols_out, nRows_out);
+
+    ref = DoConvolution(image, nCols, nRows, psfSep, 5, 6, CONVOLVE_FFT);
+    direct = DoConvolution(image, nCols, nRows, psfSep, 5, 6, CONVOLVE_DIRECT, 0, 
+    						x0, y0, nCols_out, nRows_out);
+    CheckOutputRegion(direct, ref, image, nCols, nRows, x0, y0, nCols_out, nRows_out);
+  }
+
+  // Batched FFTs: 19 images = one full batch of 16 plus 3 left over, then a second
+  // call with a different number of images (so the batch plans are re-created)
+  void testBatchedMatchesSingleFFT_oddPSF( void )
+  {
+    CheckBatchedConvolution(47, 39, 7, 5, 19);
+    CheckBatchedConvolution(47, 39, 7, 5, 5);
+  }
+
+  void testBatchedMatchesSingleFFT_evenPSF( void )
+  {
+    CheckBatchedConvolution(32, 50, 6, 8, 19);
+  }
+
+  // Convolves nImages different images with ConvolveImages, and each one separately
+  // with ConvolveImage (same Convolver, to check that the batched calls don't
+  // disturb its single-image arrays), and compares the results
+  void CheckBatchedConvolution( int nCols, int nRows, int nCols_psf, int nRows_psf,
+  								int nImages )
+  {
+    Convolver  convolver;
+    vector<double>  psf;
+    vector< vector<double> >  images(nImages), refImages(nImages);
+    vector<double *>  imagePointers(nImages);
+
+    FillImage(psf, nCols_psf*nRows_psf, 21);
+    for (int n = 0; n < nImages; n++) {
+      FillImage(images[n], nCols*nRows, 100 + n);
+      refImages[n] = images[n];
+      imagePointers[n] = &images[n][0];
+    }
+    convolver.SetupPSF(&psf[0], nCols_psf, nRows_psf);
+    convolver.SetupImage(nCols, nRows);
+    convolver.DoFullSetup(0, false);
+
+    convolver.ConvolveImages(&imagePointers[0], nImages);
+    for (int n = 0; n < nImages; n++) {
+      convolver.ConvolveImage(&refImages[n][0]);
+      for (int k = 0; k < nCols*nRows; k++)
+        TS_ASSERT_DELTA( images[n][k], refImages[n][k], DELTA );
+    }
+    // and the same with a separate Convolver which has never done batched transforms
+    for (int n = 0; n < nImages; n++) {
+      vector<double>  original;
+      FillImage(original, nCols*nRows, 100 + n);
+      vector<double>  single = DoConvolution(original, nCols, nRows, psf, nCols_psf,
+      										nRows_psf, CONVOLVE_FFT);
+      for (int k = 0; k < nCols*nRows; k++)
+        TS_ASSERT_DELTA( images[n][k], single[k], DELTA );
+    }
+  }
+
+  // Pixels inside output region should match reference; pixels outside should be
+  // untouched
+  void CheckOutputRegion( vector<double>& result, vector<double>& ref, 
+  						vector<double>& image, int nCols, int nRows, int x0, int y0,
+  						int nCols_out, int nRows_out )
+  {
+    for (int i = 0; i < nRows; i++) {
+      for (int j = 0; j < nCols; j++) {
+        long  k = (long)i*nCols + j;
+        if ((i >= y0) && (i < y0 + nRows_out) && (j >= x0) && (j < x0 + nCols_out))
+          TS_ASSERT_DELTA( result[k], ref[k], DELTA );
+        else
+          TS_ASSERT_EQUALS( result[k], image[k] );
+      }
+    }
+  }
+};
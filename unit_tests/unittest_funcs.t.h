@@ -32,6 +32,9 @@ using namespace std;
 #include "function_objects/func_ferrersbar3d.h"
 #include "function_objects/func_double-broken-exp.h"
 //#include "function_objects/func_spline-profile.h"
+#include "function_objects/simd_math.h"
+#include "function_objects/helper_funcs_bessel.h"
+#include "gsl/gsl_sf_bessel.h"
 
 const double  DELTA = 1.0e-9;
 const double  DELTA_e9 = 1.0e-9;
@@ -40,6 +43,78 @@ const double  DELTA_e7 = 1.0e-7;
 const double PI = 3.14159265358979;
 
 
+// Returns the difference between a and b in units of the spacing between doubles
+// at b (zero if both are NaN)
+double UlpDifference( double a, double b )
+{
+  if ((a == b) || ((a != a) && (b != b)))
+    return 0.0;
+  double  ulp = fabs(nextafter(b, HUGE_VAL) - b);
+  if (b == 0.0)
+    ulp = 4.9406564584124654e-324;
+  return fabs(a - b)/ulp;
+}
+
+// Simple (reproducible) pseudo-random numbers in [0,1)
+double TestUniform( unsigned long long *state )
+{
+  *state = (*state)*6364136223846793005ULL + 1442695040888963407ULL;
+  return ((*state) >> 11) * (1.0/9007199254740992.0);
+}
+
+// Returns the largest difference between GetRowValues() and GetValue() for the
+// rows of a 40x40 image, relative to the image's maximum value
+double MaxRowValuesDifference( FunctionObject *theFunc )
+{
+  double  rowValues[40];
+  double  value, maxValue = 0.0, maxDiff = 0.0;
+  for (int i = 1; i <= 40; i++) {
+    theFunc->GetRowValues(1.0, (double)i, 40, rowValues);
+    for (int j = 0; j < 40; j++) {
+      value = theFunc->GetValue(1.0 + j, (double)i);
+      maxValue = fmax(maxValue, fabs(value));
+      maxDiff = fmax(maxDiff, fabs(rowValues[j] - value));
+    }
+  }
+  return maxDiff/maxValue;
+}
+
+
+// Sets up tableFunc (with a radial lookup table of relative tolerance tol) and
+// directFunc (without one) for an nColumns x nRows image, and returns the largest
+// difference between their GetRowValues() results, relative to the larger of the
+// directly computed value and 1e-6 times the image's maximum value
+double MaxRadialTableDifference( FunctionObject *tableFunc, FunctionObject *directFunc,
+								double params[], double tol, int nColumns, int nRows )
+{
+  map<string, string>  extraParams;
+  char  tolString[40];
+  vector<double>  tableValues(nColumns), directValues(nColumns);
+  double  maxValue = 0.0, maxDiff = 0.0;
+
+  sprintf(tolString, "%g", tol);
+  extraParams["radialTableTol"] = tolString;
+  tableFunc->SetExtraParams(extraParams);
+  tableFunc->SetImageExtent(1.0, nColumns, 1.0, nRows);
+  directFunc->SetImageExtent(1.0, nColumns, 1.0, nRows);
+  tableFunc->Setup(params, 0, 0.4*nColumns + 0.3, 0.5*nRows - 0.2);
+  directFunc->Setup(params, 0, 0.4*nColumns + 0.3, 0.5*nRows - 0.2);
+  for (int i = 1; i <= nRows; i++) {
+    directFunc->GetRowValues(1.0, (double)i, nColumns, directValues.data());
+    for (int j = 0; j < nColumns; j++)
+      maxValue = fmax(maxValue, fabs(directValues[j]));
+  }
+  for (int i = 1; i <= nRows; i++) {
+    tableFunc->GetRowValues(1.0, (double)i, nColumns, tableValues.data());
+    directFunc->GetRowValues(1.0, (double)i, nColumns, directValues.data());
+    for (int j = 0; j < nColumns; j++)
+      maxDiff = fmax(maxDiff, fabs(tableValues[j] - directValues[j]) 
+      						/ fmax(fabs(directValues[j]), 1.0e-6*maxValue));
+  }
+  return maxDiff;
+}
+
+
 // Testing temporary 1D function (exponential with linear input and output,
 // plus SetExtraParams testing)
 class TestExp1DTest : public CxxTest::TestSuite 
@@ -272,6 +347,20 @@ public:
 
   }
 
+  void testRowValues( void )
+  {
+    // elliptical Exponential, with and without subsampling; batched (vectorized)
+    // calculations should agree with GetValue() to within a few ULP of the
+    // peak intensity
+    double  params[4] = {30.0, 0.3, 100.0, 6.0};
+    
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+    thisFunc->SetSubsampling(true);
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+  }
+
   void testLabels( void )
   {
     string  result;
@@ -397,6 +486,20 @@ public:
 
   }
 
+  void testRowValues( void )
+  {
+    // elliptical Sersic, with and without subsampling; batched (vectorized)
+    // calculations should agree with GetValue() to within a few ULP of the
+    // peak intensity
+    double  params[5] = {30.0, 0.3, 2.5, 1.0, 8.0};
+    
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+    thisFunc->SetSubsampling(true);
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+  }
+
   void testIsBackground( void )
   {
     bool result = thisFunc->IsBackground();
@@ -460,6 +563,22 @@ public:
     correctCircFlux = 3546.3105962151512;   // from astro_utils.LSersic, using non-exact b_n
     TS_ASSERT_DELTA( thisFunc->TotalFlux(), correctCircFlux, DELTA_e7 );
   }
+
+  void testRadialTable( void )
+  {
+    // radial lookup table should reproduce the direct calculation to within the
+    // requested tolerance; for a small image, the table isn't used at all
+    double  params[5] = {30.0, 0.3, 4.0, 1.0, 20.0};
+    Sersic  directFunc;
+    directFunc.SetSubsampling(false);
+    
+    double  maxDiff = MaxRadialTableDifference(thisFunc, &directFunc, params, 1.0e-6, 500, 450);
+    TS_ASSERT_LESS_THAN( maxDiff, 2.0e-6 );
+    TS_ASSERT_LESS_THAN( 0.0, maxDiff );
+    TS_ASSERT_EQUALS( thisFunc->ExtraParamsSet(), true );
+    maxDiff = MaxRadialTableDifference(thisFunc, &directFunc, params, 1.0e-6, 20, 20);
+    TS_ASSERT_EQUALS( maxDiff, 0.0 );
+  }
 };
 
 
@@ -533,6 +652,20 @@ public:
 
   }
   
+  void testRowValues( void )
+  {
+    // elliptical Gaussian, with and without subsampling; batched (vectorized)
+    // calculations should agree with GetValue() to within a few ULP of the
+    // peak intensity
+    double  params[4] = {30.0, 0.3, 100.0, 4.0};
+    
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+    thisFunc->SetSubsampling(true);
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+  }
+
   void testIsBackground( void )
   {
     bool result = thisFunc->IsBackground();
@@ -976,6 +1109,17 @@ public:
     bool result = thisFunc->CanCalculateTotalFlux();
     TS_ASSERT_EQUALS(result, false);
   }
+
+  void testRadialTable( void )
+  {
+    double  params[5] = {30.0, 0.3, 100.0, 4.0, 2.5};   // PA, ell, I_0, fwhm, beta
+    Moffat  directFunc;
+    directFunc.SetSubsampling(false);
+    
+    double  maxDiff = MaxRadialTableDifference(thisFunc, &directFunc, params, 1.0e-6, 500, 450);
+    TS_ASSERT_LESS_THAN( maxDiff, 2.0e-6 );
+    TS_ASSERT_LESS_THAN( 0.0, maxDiff );
+  }
 };
 
 
@@ -1119,11 +1263,38 @@ public:
     TS_ASSERT_DELTA( thisFunc->GetValue(10.0, 0.0), rEqualsSigmaValue, DELTA );
   }
 
+  void testRowValues( void )
+  {
+    // elliptical ModifiedKing (r_t = 15), with and without subsampling;
+    // batched (vectorized) calculations should agree with GetValue() to within
+    // a few ULP of the peak intensity
+    double  params[6] = {30.0, 0.3, 100.0, 5.0, 15.0, 2.5};
+    
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+    thisFunc->SetSubsampling(true);
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+  }
+
   void testCanCalculateTotalFlux( void )
   {
     bool result = thisFunc->CanCalculateTotalFlux();
     TS_ASSERT_EQUALS(result, false);
   }
+
+  void testRadialTable( void )
+  {
+    // table only extends to r_t; intensity beyond that should still be exactly 0
+    double  params[6] = {30.0, 0.3, 100.0, 5.0, 80.0, 2.0};   // PA, ell, I_0, r_c, r_t, alpha
+    ModifiedKing  directFunc;
+    directFunc.SetSubsampling(false);
+    
+    double  maxDiff = MaxRadialTableDifference(thisFunc, &directFunc, params, 1.0e-6, 500, 450);
+    TS_ASSERT_LESS_THAN( maxDiff, 2.0e-6 );
+    TS_ASSERT_LESS_THAN( 0.0, maxDiff );
+    TS_ASSERT_EQUALS( thisFunc->GetValue(1.0, 1.0), 0.0 );
+  }
 };
 
 
@@ -1270,6 +1441,20 @@ public:
     TS_ASSERT_DELTA( thisFunc->GetValue(10.0, 0.0), rEqualsSigmaValue, DELTA );
   }
 
+  void testRowValues( void )
+  {
+    // elliptical ModifiedKing2 (r_t = 15), with and without subsampling;
+    // batched (vectorized) calculations should agree with GetValue() to within
+    // a few ULP of the peak intensity
+    double  params[6] = {30.0, 0.3, 100.0, 5.0, 3.0, 2.5};
+    
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+    thisFunc->SetSubsampling(true);
+    thisFunc->Setup(params, 0, 20.3, 19.6);
+    TS_ASSERT_LESS_THAN( MaxRowValuesDifference(thisFunc), 1.0e-14 );
+  }
+
   void testCanCalculateTotalFlux( void )
   {
     bool result = thisFunc->CanCalculateTotalFlux();
@@ -1534,6 +1719,35 @@ public:
     bool result = thisFunc->CanCalculateTotalFlux();
     TS_ASSERT_EQUALS(result, false);
   }
+
+  void testRadialTable( void )
+  {
+    double  params[7] = {30.0, 0.3, 100.0, 20.0, 8.0, 40.0, 1.0};   // PA, ell, I_0, h1, h2, r_b, alpha
+    BrokenExponential  directFunc;
+    directFunc.SetSubsampling(false);
+    
+    double  maxDiff = MaxRadialTableDifference(thisFunc, &directFunc, params, 1.0e-6, 500, 450);
+    TS_ASSERT_LESS_THAN( maxDiff, 2.0e-6 );
+    TS_ASSERT_LESS_THAN( 0.0, maxDiff );
+  }
+
+  void testSetExtraParams_radialTable( void )
+  {
+    map<string, string>  extraParams;
+    
+    extraParams["radialTableTol"] = "bob";
+    TS_ASSERT_EQUALS( thisFunc->SetExtraParams(extraParams), -3 );
+    extraParams["radialTableTol"] = "-1e-6";
+    TS_ASSERT_EQUALS( thisFunc->SetExtraParams(extraParams), -3 );
+    TS_ASSERT_EQUALS( thisFunc->ExtraParamsSet(), false );
+    extraParams.clear();
+    extraParams["floor"] = "1.0";
+    TS_ASSERT_EQUALS( thisFunc->SetExtraParams(extraParams), 0 );
+    extraParams.clear();
+    extraParams["radialTableTol"] = "1e-5";
+    TS_ASSERT_EQUALS( thisFunc->SetExtraParams(extraParams), 1 );
+    TS_ASSERT_EQUALS( thisFunc->ExtraParamsSet(), true );
+  }
 };
 
 
@@ -1808,6 +2022,48 @@ public:
 
   }
 
+  void testXTimesBesselK1( void )
+  {
+    double  x, correctValue, relError, maxRelError = 0.0;
+
+    TS_ASSERT_EQUALS( XTimesBesselK1(0.0), 1.0 );
+    TS_ASSERT_EQUALS( XTimesBesselK1(800.0), 0.0 );
+    // log-spaced from 1e-8 to 700, including both sides of the series/table
+    // boundary at x = 2
+    for (int i = 0; i <= 20000; i++) {
+      x = 1.0e-8 * pow(7.0e10, i/20000.0);
+      correctValue = x * gsl_sf_bessel_K1(x);
+      relError = fabs(XTimesBesselK1(x) - correctValue) / correctValue;
+      maxRelError = fmax(maxRelError, relError);
+    }
+    TS_ASSERT_LESS_THAN( maxRelError, 1.0e-14 );
+  }
+
+  void testSechFastPaths( void )
+  {
+    // n = 1 (sech^2) and n = 2 (sech) use special-case code; compare with
+    // direct calculation of sech^(2/n)
+    double  x0 = 100.0;
+    double  y0 = 100.0;
+    double  h = 10.0;
+    double  L0 = 1.0;
+    double  z0 = 2.0;
+    double  centralValue = 2.0 * h * L0;
+    double  nValues[2] = {1.0, 2.0};
+    double  z, alpha, correctValue;
+
+    for (int i = 0; i < 2; i++) {
+      double  params[5] = {90.0, L0, h, nValues[i], z0};
+      thisFunc->Setup(params, 0, x0, y0);
+      alpha = 2.0/nValues[i];
+      for (int j = 0; j < 5; j++) {
+        z = 3.0*j;
+        correctValue = centralValue * pow(1.0/cosh(z/(alpha*z0)), alpha);
+        TS_ASSERT_DELTA( thisFunc->GetValue(100.0, 100.0 + z), correctValue, 1.0e-12 );
+      }
+    }
+  }
+
   void testCanCalculateTotalFlux( void )
   {
     bool result = thisFunc->CanCalculateTotalFlux();
@@ -1917,6 +2173,164 @@ public:
 };
 
 
+
+// Accuracy tests for the vectorizable math functions in simd_math.h (errors are
+// measured relative to the standard library)
+class TestSimdMath : public CxxTest::TestSuite 
+{
+public:
+  void testExp( void )
+  {
+    unsigned long long  state = 1;
+    double  x, maxUlp = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      x = -708.0 + 1417.0*TestUniform(&state);
+      maxUlp = fmax(maxUlp, UlpDifference(SimdExp(x), exp(x)));
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp, 1.0 );
+
+    TS_ASSERT_EQUALS( SimdExp(0.0), 1.0 );
+    TS_ASSERT_EQUALS( SimdExp(1000.0), HUGE_VAL );
+    TS_ASSERT_EQUALS( SimdExp(-1000.0), 0.0 );
+    TS_ASSERT_EQUALS( SimdExp(-HUGE_VAL), 0.0 );
+    TS_ASSERT( isnan(SimdExp(NAN)) );
+  }
+
+  void testLog( void )
+  {
+    unsigned long long  state = 2;
+    double  x, maxUlp = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      // log-uniform over [1e-300, 1e300], plus uniform over [0.5, 2]
+      x = exp(-690.0 + 1380.0*TestUniform(&state));
+      maxUlp = fmax(maxUlp, UlpDifference(SimdLog(x), log(x)));
+      x = 0.5 + 1.5*TestUniform(&state);
+      maxUlp = fmax(maxUlp, UlpDifference(SimdLog(x), log(x)));
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp, 1.0 );
+
+    // denormalized input
+    TS_ASSERT_LESS_THAN_EQUALS( UlpDifference(SimdLog(1.0e-310), log(1.0e-310)), 1.0 );
+    TS_ASSERT_EQUALS( SimdLog(1.0), 0.0 );
+    TS_ASSERT_EQUALS( SimdLog(0.0), -HUGE_VAL );
+    TS_ASSERT_EQUALS( SimdLog(HUGE_VAL), HUGE_VAL );
+    TS_ASSERT( isnan(SimdLog(-1.0)) );
+  }
+
+  void testPow( void )
+  {
+    unsigned long long  state = 3;
+    double  x, y, result, maxUlp = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      x = 100.0*TestUniform(&state);
+      y = -5.0 + 20.0*TestUniform(&state);
+      result = pow(x, y);
+      if ((result > 1.0e-300) && (result < 1.0e300))
+        maxUlp = fmax(maxUlp, UlpDifference(SimdPow(x, y), result));
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp, 2.0 );
+
+    TS_ASSERT_EQUALS( SimdPow(2.0, 10.0), 1024.0 );
+    TS_ASSERT_EQUALS( SimdPow(5.0, 0.0), 1.0 );
+    TS_ASSERT_EQUALS( SimdPow(0.0, 0.0), 1.0 );
+    TS_ASSERT_EQUALS( SimdPow(0.0, 0.5), 0.0 );
+    TS_ASSERT_EQUALS( SimdPow(0.0, -0.5), HUGE_VAL );
+    TS_ASSERT_EQUALS( SimdPow(HUGE_VAL, -0.5), 0.0 );
+    TS_ASSERT( isnan(SimdPow(-2.0, 0.5)) );
+  }
+
+  void testPowFast( void )
+  {
+    // error bound scales with |y log(x)|, because exp() amplifies the rounding
+    // error of y*log(x)
+    unsigned long long  state = 7;
+    double  x, y, result, bound, maxExcess = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      x = 100.0*TestUniform(&state);
+      y = -5.0 + 20.0*TestUniform(&state);
+      result = pow(x, y);
+      if ((result > 1.0e-300) && (result < 1.0e300)) {
+        bound = 2.0*(1.0 + fabs(y*log(x)));
+        maxExcess = fmax(maxExcess, UlpDifference(SimdPowFast(x, y), result) - bound);
+      }
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxExcess, 0.0 );
+
+    TS_ASSERT_EQUALS( SimdPowFast(5.0, 0.0), 1.0 );
+    TS_ASSERT_EQUALS( SimdPowFast(0.0, 0.5), 0.0 );
+    TS_ASSERT_EQUALS( SimdPowFast(0.0, -0.5), HUGE_VAL );
+  }
+
+  void testSinCos( void )
+  {
+    unsigned long long  state = 4;
+    double  x, s, c, maxUlp_sin = 0.0, maxUlp_cos = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      x = -1000.0 + 2000.0*TestUniform(&state);
+      SimdSinCos(x, s, c);
+      maxUlp_sin = fmax(maxUlp_sin, UlpDifference(s, sin(x)));
+      maxUlp_cos = fmax(maxUlp_cos, UlpDifference(c, cos(x)));
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp_sin, 1.0 );
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp_cos, 1.0 );
+
+    TS_ASSERT_EQUALS( SimdSin(0.0), 0.0 );
+    TS_ASSERT_EQUALS( SimdCos(0.0), 1.0 );
+    TS_ASSERT_LESS_THAN_EQUALS( UlpDifference(SimdSin(1.0e5), sin(1.0e5)), 1.0 );
+    TS_ASSERT_LESS_THAN_EQUALS( UlpDifference(SimdCos(1.0e5), cos(1.0e5)), 1.0 );
+  }
+
+  void testAtan2( void )
+  {
+    unsigned long long  state = 5;
+    double  x, y, maxUlp = 0.0;
+    for (int i = 0; i < 100000; i++) {
+      x = -100.0 + 200.0*TestUniform(&state);
+      y = -100.0 + 200.0*TestUniform(&state);
+      maxUlp = fmax(maxUlp, UlpDifference(SimdAtan2(y, x), atan2(y, x)));
+    }
+    TS_ASSERT_LESS_THAN_EQUALS( maxUlp, 1.0 );
+
+    // axes and signed zeros
+    double  values[4] = {0.0, -0.0, 1.0, -1.0};
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 4; j++) {
+        TS_ASSERT_EQUALS( SimdAtan2(values[i], values[j]), atan2(values[i], values[j]) );
+        TS_ASSERT_EQUALS( signbit(SimdAtan2(values[i], values[j])), 
+        				signbit(atan2(values[i], values[j])) );
+      }
+    }
+  }
+
+  void testVectorFunctions( void )
+  {
+    double  x[5] = {0.1, 0.5, 1.0, 2.0, 3.0};
+    double  output1[5], output2[5];
+
+    VecExp(5, x, output1);
+    VecLog(5, x, output2);
+    for (int i = 0; i < 5; i++) {
+      TS_ASSERT_EQUALS( output1[i], SimdExp(x[i]) );
+      TS_ASSERT_EQUALS( output2[i], SimdLog(x[i]) );
+    }
+    VecPow(5, x, 1.7, output1);
+    VecSqrt(5, x, output2);
+    for (int i = 0; i < 5; i++) {
+      TS_ASSERT_EQUALS( output1[i], SimdPow(x[i], 1.7) );
+      TS_ASSERT_EQUALS( output2[i], sqrt(x[i]) );
+    }
+    VecSinCos(5, x, output1, output2);
+    for (int i = 0; i < 5; i++) {
+      TS_ASSERT_EQUALS( output1[i], SimdSin(x[i]) );
+      TS_ASSERT_EQUALS( output2[i], SimdCos(x[i]) );
+    }
+    VecAtan2(5, x, x, output1);
+    for (int i = 0; i < 5; i++)
+      TS_ASSERT_EQUALS( output1[i], SimdAtan2(x[i], x[i]) );
+  }
+};
+
+
 // class TestSplineProfile : public CxxTest::TestSuite 
 // {
 // 
@@ -26,6 +26,8 @@ using namespace std;
 #include "add_functions.h"
 #include "config_file_parser.h"
 #include "param_struct.h"
+#include "mersenne_twister.h"
+#include "profile_counters.h"
 
 
 #define SIMPLE_CONFIG_FILE "tests/imfit_reference/config_imfit_flatsky.dat"
@@ -327,6 +329,36 @@ public:
       TS_ASSERT_EQUALS(outputModelVect[i], trueVals[i]);
   }
 
+  void testModelImageGeneration_profileCounters( void )
+  {
+    // Same model as above, with profiling turned on
+    double params[3] = {26.0, 26.0, 100.0};   // X0, Y0, I_sky
+    int  nDataVals = nSmallDataCols*nSmallDataRows;
+    vector<string>  componentNames;
+    vector<double>  componentTimes;
+    vector<long>  componentPixels;
+
+    ResetProfileCounters();
+    EnableProfileCounters(true);
+    modelObj3a->SetupModelImage(nSmallDataCols, nSmallDataRows);
+    modelObj3a->CreateModelImage(params);
+    modelObj3a->CreateModelImage(params);
+    EnableProfileCounters(false);
+    // this one shouldn't be counted
+    modelObj3a->CreateModelImage(params);
+
+    TS_ASSERT_EQUALS(GlobalProfileCounters().phaseCalls[PROFILE_MODEL_IMAGE], 2);
+    TS_ASSERT_EQUALS(GlobalProfileCounters().counts[PROFILE_N_MODEL_IMAGES], 2);
+    TS_ASSERT_EQUALS(GlobalProfileCounters().counts[PROFILE_N_PIXELS], 2*nDataVals);
+    TS_ASSERT_EQUALS(GlobalProfileCounters().phaseCalls[PROFILE_CONVOLUTION], 0);
+
+    modelObj3a->GetComponentProfile(componentNames, componentTimes, componentPixels);
+    TS_ASSERT_EQUALS(componentNames.size(), 1);
+    TS_ASSERT_EQUALS(componentNames[0], string("FlatSky"));
+    TS_ASSERT_EQUALS(componentPixels[0], 2*nDataVals);
+    ResetProfileCounters();
+  }
+
 
    void testResidualImageGeneration( void )
   {
@@ -405,6 +437,388 @@ public:
       TS_ASSERT_DELTA(outputModelVect[i], trueVals[i] + floorVal, 1e-7);
     delete modelObj;
  }
+
+
+  void testModelImageGeneration_withCulling( void )
+  {
+    // model image: 40x40 pixels, circular Gaussian (I_0 = 100, sigma = 1) centered
+    // at (x,y) = (10,10). With culling threshold = 1e-6, the Gaussian's bounding box
+    // has half-width sigma*sqrt(2 ln(1e6)) + 1 = 6.3 pixels, so pixels far from the
+    // center should be exactly zero, and all others within 1e-6*I_0 of full model
+    ModelObject *modelObjFull, *modelObjCulled;
+    double *fullModelVect, *culledModelVect;
+    double params[6] = {10.0, 10.0, 0.0, 0.0, 100.0, 1.0};   // X0, Y0, PA, ell, I_0, sigma
+    vector<string> funcList = {"Gaussian"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    int  nColumns = 40;
+    int  nRows = 40;
+    int  status;
+    
+    modelObjFull = new ModelObject();
+    status = AddFunctions(modelObjFull, funcList, funcLabelList, funcSetIndices, true, -1);
+    modelObjFull->SetupModelImage(nColumns, nRows);
+    modelObjFull->CreateModelImage(params);
+    fullModelVect = modelObjFull->GetModelImageVector();
+
+    modelObjCulled = new ModelObject();
+    status = AddFunctions(modelObjCulled, funcList, funcLabelList, funcSetIndices, true, -1);
+    status = modelObjCulled->SetCullingThreshold(1.5);
+    TS_ASSERT_EQUALS(status, -1);
+    status = modelObjCulled->SetCullingThreshold(1.0e-6);
+    TS_ASSERT_EQUALS(status, 0);
+    modelObjCulled->SetupModelImage(nColumns, nRows);
+    modelObjCulled->CreateModelImage(params);
+    culledModelVect = modelObjCulled->GetModelImageVector();
+
+    for (int i = 0; i < nColumns*nRows; i++)
+      TS_ASSERT_DELTA(culledModelVect[i], fullModelVect[i], 1.0e-4);
+    // pixel at center: (x,y) = (10,10)
+    TS_ASSERT_EQUALS(culledModelVect[9*nColumns + 9], fullModelVect[9*nColumns + 9]);
+    // pixels outside bounding box: (x,y) = (30,10), (10,30)
+    TS_ASSERT_EQUALS(culledModelVect[9*nColumns + 29], 0.0);
+    TS_ASSERT_EQUALS(culledModelVect[29*nColumns + 9], 0.0);
+    TS_ASSERT_DIFFERS(fullModelVect[9*nColumns + 29], 0.0);
+
+    delete modelObjFull;
+    delete modelObjCulled;
+  }
+
+  void testModelImageGeneration_sharedGeometry( void )
+  {
+    // Sersic + Exponential + Gaussian with the same center, PA, and ellipticity
+    // in a single function set share one set of radius calculations per tile;
+    // the result should be identical to putting each function in its own set
+    // (no sharing). Culling is turned on so the functions' bounding boxes differ.
+    ModelObject *modelObjShared, *modelObjSeparate;
+    double *sharedModelVect, *separateModelVect;
+    double paramsShared[15] = {20.3, 19.6, 30.0, 0.4, 2.5, 10.0, 4.0, 30.0, 0.4,
+    							50.0, 6.0, 30.0, 0.4, 200.0, 1.5};
+    double paramsSeparate[19] = {20.3, 19.6, 30.0, 0.4, 2.5, 10.0, 4.0, 20.3, 19.6,
+    							30.0, 0.4, 50.0, 6.0, 20.3, 19.6, 30.0, 0.4, 200.0, 1.5};
+    vector<string> funcList = {"Sersic", "Exponential", "Gaussian"};
+    vector<string> funcLabelList = {"", "", ""};
+    vector<int> funcSetIndicesShared = {0};
+    vector<int> funcSetIndicesSeparate = {0, 1, 2};
+    int  nColumns = 50;
+    int  nRows = 45;
+    int  nDifferent = 0;
+    int  status;
+    
+    modelObjShared = new ModelObject();
+    status = AddFunctions(modelObjShared, funcList, funcLabelList, funcSetIndicesShared, 
+    						true, -1);
+    modelObjShared->SetCullingThreshold(1.0e-8);
+    modelObjShared->SetTileSize(16, 16);
+    modelObjShared->SetupModelImage(nColumns, nRows);
+    modelObjShared->CreateModelImage(paramsShared);
+    sharedModelVect = modelObjShared->GetModelImageVector();
+
+    modelObjSeparate = new ModelObject();
+    status = AddFunctions(modelObjSeparate, funcList, funcLabelList, funcSetIndicesSeparate, 
+    						true, -1);
+    modelObjSeparate->SetCullingThreshold(1.0e-8);
+    modelObjSeparate->SetTileSize(16, 16);
+    modelObjSeparate->SetupModelImage(nColumns, nRows);
+    modelObjSeparate->CreateModelImage(paramsSeparate);
+    separateModelVect = modelObjSeparate->GetModelImageVector();
+
+    for (int i = 0; i < nColumns*nRows; i++) {
+      if (sharedModelVect[i] != separateModelVect[i])
+        nDifferent++;
+    }
+    TS_ASSERT_EQUALS(nDifferent, 0);
+    TS_ASSERT_DIFFERS(sharedModelVect[19*nColumns + 20], 0.0);
+
+    delete modelObjShared;
+    delete modelObjSeparate;
+  }
+
+  void testGetAllSingleFunctionImages( void )
+  {
+    // Single-pass computation of all the individual-function images (with full-image
+    // FFT convolution, so that batched transforms are used, and more functions than
+    // fit in one group) should match separate GetSingleFunctionImage calls
+    ModelObject *modelObj;
+    vector<string> funcList = {"FlatSky"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    vector<double> params = {20.3, 19.6, 0.5};
+    double  psfImage[25] = {0.0, 0.1, 0.2, 0.1, 0.0, 0.1, 0.5, 1.0, 0.5, 0.1,
+    						0.2, 1.0, 2.0, 1.0, 0.2, 0.1, 0.5, 1.0, 0.5, 0.1,
+    						0.0, 0.1, 0.2, 0.1, 0.0};
+    double  *singleImage;
+    double  **allImages;
+    int  nGaussians = 17;
+    int  nColumns = 40;
+    int  nRows = 35;
+    int  nFuncs, nDifferent = 0;
+    int  status;
+    
+    for (int n = 0; n < nGaussians; n++) {
+      funcList.push_back("Gaussian");
+      funcLabelList.push_back("");
+      params.push_back(10.0*n);
+      params.push_back(0.02*n);
+      params.push_back(100.0 + n);
+      params.push_back(1.0 + 0.5*n);
+    }
+    modelObj = new ModelObject();
+    status = AddFunctions(modelObj, funcList, funcLabelList, funcSetIndices, true, -1);
+    modelObj->SetConvolutionMethod(CONVOLVE_FFT);
+    status = modelObj->AddPSFVector(25, 5, 5, psfImage);
+    modelObj->SetupModelImage(nColumns, nRows);
+    nFuncs = modelObj->GetNFunctions();
+    TS_ASSERT_EQUALS(nFuncs, nGaussians + 1);
+
+    allImages = (double **)calloc(nFuncs, sizeof(double *));
+    for (int n = 0; n < nFuncs; n++)
+      allImages[n] = (double *)calloc(nColumns*nRows, sizeof(double));
+    status = modelObj->GetAllSingleFunctionImages(params.data(), allImages);
+    TS_ASSERT_EQUALS(status, 0);
+
+    for (int n = 0; n < nFuncs; n++) {
+      singleImage = modelObj->GetSingleFunctionImage(params.data(), n);
+      for (int i = 0; i < nColumns*nRows; i++) {
+        if (fabs(allImages[n][i] - singleImage[i]) > 1.0e-10*fabs(singleImage[i]) + 1.0e-12)
+          nDifferent++;
+      }
+    }
+    TS_ASSERT_EQUALS(nDifferent, 0);
+    TS_ASSERT_DELTA(allImages[0][0], 0.5, 1.0e-10);
+    TS_ASSERT_DIFFERS(allImages[nFuncs - 1][19*nColumns + 20], 0.0);
+
+    for (int n = 0; n < nFuncs; n++)
+      free(allImages[n]);
+    free(allImages);
+    delete modelObj;
+  }
+
+  void testBootstrapModes( void )
+  {
+    // Multinomial-count bootstrap uses same random draws as index-list bootstrap,
+    // so the chi^2 value for a given RNG seed should be the same; Poisson bootstrap
+    // should give a different (but positive) value
+    ModelObject *modelObjs[3];
+    int  modes[3] = {BOOTSTRAP_INDICES, BOOTSTRAP_MULTINOMIAL, BOOTSTRAP_POISSON};
+    double  chi2[3];
+    double params[6] = {10.0, 10.0, 0.0, 0.0, 100.0, 2.0};   // X0, Y0, PA, ell, I_0, sigma
+    vector<string> funcList = {"Gaussian"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    int  nColumns = 20;
+    int  nRows = 20;
+    double  *dataImage = (double *)calloc(nColumns*nRows, sizeof(double));
+    for (int i = 0; i < nColumns*nRows; i++)
+      dataImage[i] = 10.0 + (i % 7);
+    
+    for (int n = 0; n < 3; n++) {
+      modelObjs[n] = new ModelObject();
+      AddFunctions(modelObjs[n], funcList, funcLabelList, funcSetIndices, true, -1);
+      modelObjs[n]->AddImageDataVector(dataImage, nColumns, nRows);
+      modelObjs[n]->GenerateErrorVector();
+      modelObjs[n]->FinalSetupForFitting();
+      TS_ASSERT_EQUALS(modelObjs[n]->SetBootstrapMode(modes[n]), 0);
+      init_genrand(10);
+      modelObjs[n]->UseBootstrap();
+      chi2[n] = modelObjs[n]->GetFitStatistic(params);
+    }
+    TS_ASSERT_EQUALS(modelObjs[0]->GetNDeviates(), nColumns*nRows);
+    TS_ASSERT_EQUALS(modelObjs[1]->GetNDeviates(), nColumns*nRows);
+    TS_ASSERT_DELTA(chi2[1], chi2[0], 1.0e-9*chi2[0]);
+    TS_ASSERT(chi2[2] > 0.0);
+    TS_ASSERT_DIFFERS(chi2[2], chi2[0]);
+    TS_ASSERT_EQUALS(modelObjs[0]->SetBootstrapMode(-1), -1);
+
+    for (int n = 0; n < 3; n++)
+      delete modelObjs[n];
+    free(dataImage);
+  }
+
+  void testFitStatisticBounded( void )
+  {
+    // Early-terminating fit statistic: with a large enough bound, result must be
+    // identical to the full fit statistic; with a smaller bound, result must
+    // exceed the bound but not the full fit statistic
+    ModelObject *modelObj = new ModelObject();
+    double params[6] = {20.0, 20.0, 0.0, 0.0, 100.0, 3.0};   // X0, Y0, PA, ell, I_0, sigma
+    vector<string> funcList = {"Gaussian"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    int  nColumns = 40;
+    int  nRows = 40;
+    double  fullFitStat, boundedFitStat, maxFitStat;
+    double  *dataImage = (double *)calloc(nColumns*nRows, sizeof(double));
+    for (int i = 0; i < nColumns*nRows; i++)
+      dataImage[i] = 10.0 + (i % 7);
+    
+    AddFunctions(modelObj, funcList, funcLabelList, funcSetIndices, true, -1);
+    modelObj->AddImageDataVector(dataImage, nColumns, nRows);
+    modelObj->GenerateErrorVector();
+    modelObj->FinalSetupForFitting();
+    modelObj->SetTileSize(8, 8);
+    TS_ASSERT_EQUALS(modelObj->CanTerminateFitStatEarly(), true);
+
+    fullFitStat = modelObj->GetFitStatistic(params);
+    boundedFitStat = modelObj->GetFitStatisticBounded(params, 2.0*fullFitStat);
+    TS_ASSERT_EQUALS(boundedFitStat, fullFitStat);
+    
+    maxFitStat = 0.1*fullFitStat;
+    boundedFitStat = modelObj->GetFitStatisticBounded(params, maxFitStat);
+    TS_ASSERT(boundedFitStat > maxFitStat);
+    TS_ASSERT(boundedFitStat <= fullFitStat*(1.0 + 1.0e-12));
+    
+    // full computation afterwards must be unaffected
+    TS_ASSERT_EQUALS(modelObj->GetFitStatistic(params), fullFitStat);
+
+    // not possible with model-based errors (non-constant weights)
+    modelObj->UseModelErrors();
+    TS_ASSERT_EQUALS(modelObj->CanTerminateFitStatEarly(), false);
+
+    delete modelObj;
+    free(dataImage);
+  }
+
+  void testFitStatisticBounded_withPSF( void )
+  {
+    // Same as above, but with PSF convolution: with tiled FFT convolution, the
+    // test is applied after each band of rows is convolved (the data image is
+    // tall enough for several bands); with standard FFT convolution, the
+    // bounded result is always the full fit statistic
+    ModelObject *modelObj;
+    double params[6] = {30.0, 100.0, 0.0, 0.0, 100.0, 3.0};   // X0, Y0, PA, ell, I_0, sigma
+    vector<string> funcList = {"Gaussian"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    double  psfImage[25] = {0.0, 0.1, 0.2, 0.1, 0.0, 0.1, 0.5, 1.0, 0.5, 0.1,
+    						0.2, 1.0, 2.0, 1.0, 0.2, 0.1, 0.5, 1.0, 0.5, 0.1,
+    						0.0, 0.1, 0.2, 0.1, 0.0};
+    int  methods[2] = {CONVOLVE_FFT_TILED, CONVOLVE_FFT};
+    int  nColumns = 60;
+    int  nRows = 200;
+    double  fullFitStat, boundedFitStat, maxFitStat;
+    double  *dataImage = (double *)calloc(nColumns*nRows, sizeof(double));
+    for (int i = 0; i < nColumns*nRows; i++)
+      dataImage[i] = 10.0 + (i % 7);
+    
+    for (int m = 0; m < 2; m++) {
+      modelObj = new ModelObject();
+      AddFunctions(modelObj, funcList, funcLabelList, funcSetIndices, true, -1);
+      modelObj->SetConvolutionMethod(methods[m]);
+      modelObj->AddPSFVector(25, 5, 5, psfImage);
+      modelObj->AddImageDataVector(dataImage, nColumns, nRows);
+      modelObj->GenerateErrorVector();
+      modelObj->FinalSetupForFitting();
+      TS_ASSERT_EQUALS(modelObj->CanTerminateFitStatEarly(), true);
+
+      fullFitStat = modelObj->GetFitStatistic(params);
+      boundedFitStat = modelObj->GetFitStatisticBounded(params, 2.0*fullFitStat);
+      TS_ASSERT_EQUALS(boundedFitStat, fullFitStat);
+
+      maxFitStat = 0.1*fullFitStat;
+      boundedFitStat = modelObj->GetFitStatisticBounded(params, maxFitStat);
+      TS_ASSERT(boundedFitStat > maxFitStat);
+      if (methods[m] == CONVOLVE_FFT_TILED)
+        TS_ASSERT(boundedFitStat < fullFitStat);
+      else
+        TS_ASSERT_DELTA(boundedFitStat, fullFitStat, 1.0e-10*fullFitStat);
+
+      TS_ASSERT_EQUALS(modelObj->GetFitStatistic(params), fullFitStat);
+      delete modelObj;
+    }
+    free(dataImage);
+  }
+
+  void testBootstrapWithRNGStream( void )
+  {
+    // A given (seed, stream) pair must always produce the same bootstrap resample,
+    // independent of the global Mersenne Twister state
+    ModelObject *modelObjs[2];
+    double  chi2[2];
+    double params[6] = {10.0, 10.0, 0.0, 0.0, 100.0, 2.0};   // X0, Y0, PA, ell, I_0, sigma
+    vector<string> funcList = {"Gaussian"};
+    vector<string> funcLabelList = {""};
+    vector<int> funcSetIndices = {0};
+    int  nColumns = 20;
+    int  nRows = 20;
+    double  *dataImage = (double *)calloc(nColumns*nRows, sizeof(double));
+    for (int i = 0; i < nColumns*nRows; i++)
+      dataImage[i] = 10.0 + (i % 7);
+    
+    for (int n = 0; n < 2; n++) {
+      RNGStream  rngStream(10, 3);
+      modelObjs[n] = new ModelObject();
+      AddFunctions(modelObjs[n], funcList, funcLabelList, funcSetIndices, true, -1);
+      modelObjs[n]->AddImageDataVector(dataImage, nColumns, nRows);
+      modelObjs[n]->GenerateErrorVector();
+      modelObjs[n]->FinalSetupForFitting();
+      init_genrand(10 + n);
+      modelObjs[n]->UseBootstrap();
+      modelObjs[n]->MakeBootstrapSample(&rngStream);
+      chi2[n] = modelObjs[n]->GetFitStatistic(params);
+    }
+    TS_ASSERT_EQUALS(chi2[1], chi2[0]);
+
+    for (int n = 0; n < 2; n++)
+      delete modelObjs[n];
+    free(dataImage);
+  }
+
+  void testFrozenFunctions( void )
+  {
+    // Function set 1 (Gaussian) has free parameters, function set 2 (Exponential)
+    // is completely fixed; the latter should be cached, without changing the model
+    // image -- including when the fixed parameter values are changed
+    ModelObject *modelObjs[2];
+    double *modelVects[2];
+    double params[14] = {10.0, 10.0, 0.0, 0.0, 100.0, 2.0,    // X0, Y0, PA, ell, I_0, sigma
+    					25.0, 20.0, 30.0, 0.5, 20.0, 5.0};  // X0, Y0, PA, ell, I_0, h
+    vector<string> funcList = {"Gaussian", "Exponential"};
+    vector<string> funcLabelList = {"", ""};
+    vector<int> funcSetIndices = {0, 1};
+    vector<mp_par> paramInfo(12);
+    int  nColumns = 40;
+    int  nRows = 30;
+    double  *dataImage = (double *)calloc(nColumns*nRows, sizeof(double));
+    for (int i = 0; i < nColumns*nRows; i++)
+      dataImage[i] = 10.0 + (i % 7);
+    for (int i = 0; i < 12; i++) {
+      paramInfo[i].fixed = (i >= 6) ? 1 : 0;
+      paramInfo[i].limited[0] = paramInfo[i].limited[1] = 0;
+      paramInfo[i].limits[0] = paramInfo[i].limits[1] = 0.0;
+    }
+    
+    for (int n = 0; n < 2; n++) {
+      modelObjs[n] = new ModelObject();
+      AddFunctions(modelObjs[n], funcList, funcLabelList, funcSetIndices, true, -1);
+      modelObjs[n]->AddImageDataVector(dataImage, nColumns, nRows);
+      modelObjs[n]->GenerateErrorVector();
+      modelObjs[n]->FinalSetupForFitting();
+    }
+    // parameter info for second ModelObject only (no parameter info --> no caching)
+    modelObjs[1]->AddParameterInfo(paramInfo);
+    TS_ASSERT_EQUALS(modelObjs[0]->GetNFrozenFunctions(), 0);
+    TS_ASSERT_EQUALS(modelObjs[1]->GetNFrozenFunctions(), 1);
+    
+    for (int k = 0; k < 3; k++) {
+      if (k == 1)
+        params[4] = 50.0;   // free parameter changes
+      if (k == 2)
+        params[11] = 8.0;   // fixed parameter changes --> cached image must be updated
+      for (int n = 0; n < 2; n++) {
+        modelObjs[n]->CreateModelImage(params);
+        modelVects[n] = modelObjs[n]->GetModelImageVector();
+      }
+      for (int i = 0; i < nColumns*nRows; i++)
+        TS_ASSERT_DELTA(modelVects[1][i], modelVects[0][i], 1.0e-12*(1.0 + fabs(modelVects[0][i])));
+      TS_ASSERT_DELTA(modelObjs[1]->GetFitStatistic(params), modelObjs[0]->GetFitStatistic(params),
+      				1.0e-10*modelObjs[0]->GetFitStatistic(params));
+    }
+
+    for (int n = 0; n < 2; n++)
+      delete modelObjs[n];
+    free(dataImage);
+  }
 };
 
 
@@ -0,0 +1,158 @@
+// Unit tests for early cancellation of multi-start fits (multistart_monitor.cpp)
+
+// See run_unittest_multistart_monitor.sh for how to compile and run these tests.
+
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <vector>
+#include "multistart_monitor.h"
+
+using namespace std;
+
+const long  WINDOW_EVALS = 10;
+const long  MAX_EVALS = 1000;
+
+
+// Returns a single known minimum at (x, y) with the specified fit statistic
+vector<LocalMinimum> OneMinimum( double x, double y, double fitStatistic )
+{
+  LocalMinimum  minimum;
+  minimum.params.push_back(x);
+  minimum.params.push_back(y);
+  minimum.fitStatistic = fitStatistic;
+  minimum.nStarts = 1;
+  return vector<LocalMinimum>(1, minimum);
+}
+
+
+class NewTestSuite : public CxxTest::TestSuite
+{
+public:
+
+  // Fixed parameters (range = 0) should be ignored
+  void testScaledDistance( void )
+  {
+    vector<double>  ranges = {2.0, 0.0, 4.0};
+    double  params1[3] = {0.0, 5.0, 0.0};
+    double  params2[3] = {1.0, -5.0, 2.0};
+
+    TS_ASSERT_DELTA( ScaledDistance(params1, params2, ranges), sqrt(0.25), 1.0e-12 );
+    TS_ASSERT_DELTA( ScaledDistance(params1, params1, ranges), 0.0, 1.0e-12 );
+  }
+
+  // Nothing can be cancelled before any minima have been found
+  void testNoKnownMinima( void )
+  {
+    vector<LocalMinimum>  minima;
+    vector<double>  ranges(2, 1.0);
+    double  params[2] = {0.5, 0.5};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+
+    for (int n = 0; n < 200; n++)
+      TS_ASSERT( ! monitor.CheckForCancel(params, 100.0) );
+    TS_ASSERT_EQUALS( monitor.GetNFuncEvals(), 200 );
+    TS_ASSERT( ! monitor.Stalled() );
+    TS_ASSERT_EQUALS( monitor.GetMatchedMinimum(), -1 );
+  }
+
+  // A start which reaches a known minimum with a worse fit statistic is cancelled;
+  // one which is better than that minimum is not
+  void testConvergingToKnownMinimum( void )
+  {
+    vector<LocalMinimum>  minima = OneMinimum(0.5, 0.5, 10.0);
+    vector<double>  ranges(2, 1.0);
+    double  farParams[2] = {0.1, 0.9};
+    double  nearParams[2] = {0.5, 0.5001};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+
+    TS_ASSERT( ! monitor.CheckForCancel(farParams, 50.0) );
+    TS_ASSERT( ! monitor.CheckForCancel(nearParams, 9.0) );
+    TS_ASSERT( monitor.CheckForCancel(nearParams, 10.5) );
+    TS_ASSERT_EQUALS( monitor.GetMatchedMinimum(), 0 );
+    TS_ASSERT( ! monitor.Stalled() );
+  }
+
+  // A start far from any known minimum, whose fit statistic is dropping too slowly
+  // to reach the best known value within the evaluation budget, is cancelled at the
+  // end of the first window
+  void testStallingFarFromKnownMinima( void )
+  {
+    vector<LocalMinimum>  minima = OneMinimum(0.1, 0.1, 10.0);
+    vector<double>  ranges(2, 1.0);
+    double  params[2] = {0.8, 0.8};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+    bool  cancelled = false;
+    int  n;
+
+    for (n = 0; (n < 100) && (! cancelled); n++) {
+      params[0] -= 1.0e-4;
+      cancelled = monitor.CheckForCancel(params, 100.0 - 0.01*n);
+    }
+    TS_ASSERT( cancelled );
+    TS_ASSERT( monitor.Stalled() );
+    TS_ASSERT_EQUALS( monitor.GetMatchedMinimum(), -1 );
+    TS_ASSERT_EQUALS( monitor.GetNFuncEvals(), WINDOW_EVALS );
+  }
+
+  // Same, but for a start which stops improving after a good initial phase
+  // (including function evaluations which are worse than the start's best so far)
+  void testStallingAfterInitialProgress( void )
+  {
+    vector<LocalMinimum>  minima = OneMinimum(0.1, 0.1, 10.0);
+    vector<double>  ranges(2, 1.0);
+    double  params[2] = {0.8, 0.8};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+    bool  cancelled = false;
+    int  n;
+
+    for (n = 0; (n < 300) && (! cancelled); n++) {
+      double  fitStat = (n < 50) ? 200.0 - 3.0*n : 50.0 - 1.0e-4*n;
+      if (n % 3 == 1)
+        fitStat += 20.0;
+      cancelled = monitor.CheckForCancel(params, fitStat);
+    }
+    TS_ASSERT( cancelled );
+    TS_ASSERT( monitor.Stalled() );
+    TS_ASSERT( monitor.GetNFuncEvals() > 50 );
+    TS_ASSERT( monitor.GetNFuncEvals() <= 50 + 2*WINDOW_EVALS );
+  }
+
+  // A start which is improving fast enough to reach the best known value, or which
+  // is already better than it, is not cancelled
+  void testNotCancelledWhenProgressing( void )
+  {
+    vector<LocalMinimum>  minima = OneMinimum(0.1, 0.1, 10.0);
+    vector<double>  ranges(2, 1.0);
+    double  params[2] = {0.8, 0.8};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+
+    for (int n = 0; n < 95; n++)
+      TS_ASSERT( ! monitor.CheckForCancel(params, 100.0 - 1.0*n) );
+    for (int n = 0; n < 200; n++)
+      TS_ASSERT( ! monitor.CheckForCancel(params, 5.0) );
+    TS_ASSERT( ! monitor.Stalled() );
+  }
+
+  // NewStart should reset everything
+  void testNewStart( void )
+  {
+    vector<LocalMinimum>  minima = OneMinimum(0.1, 0.1, 10.0);
+    vector<double>  ranges(2, 1.0);
+    double  params[2] = {0.8, 0.8};
+    StartMonitor  monitor(&minima, ranges, WINDOW_EVALS, MAX_EVALS);
+    bool  cancelled = false;
+
+    for (int n = 0; (n < 100) && (! cancelled); n++)
+      cancelled = monitor.CheckForCancel(params, 100.0);
+    TS_ASSERT( monitor.Stalled() );
+
+    monitor.NewStart();
+    TS_ASSERT( ! monitor.Stalled() );
+    TS_ASSERT_EQUALS( monitor.GetMatchedMinimum(), -1 );
+    TS_ASSERT_EQUALS( monitor.GetNFuncEvals(), 0 );
+    for (int n = 0; n < WINDOW_EVALS - 1; n++)
+      TS_ASSERT( ! monitor.CheckForCancel(params, 100.0) );
+  }
+};
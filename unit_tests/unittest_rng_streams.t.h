@@ -0,0 +1,143 @@
+// Unit tests for counter-based random-number streams (rng_streams.cpp)
+
+// See run_unittest_rng_streams.sh for how to compile and run these tests.
+
+
+#include <cxxtest/TestSuite.h>
+
+#include <math.h>
+#include <stdint.h>
+#include "rng_streams.h"
+
+
+class NewTestSuite : public CxxTest::TestSuite 
+{
+public:
+
+  // Known-answer tests for Philox4x32-10 (from the Random123 distribution)
+  void testPhilox4x32_KnownAnswers( void )
+  {
+    uint32_t  counter1[4] = {0, 0, 0, 0};
+    uint32_t  key1[2] = {0, 0};
+    uint32_t  correct1[4] = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+    uint32_t  counter2[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+    uint32_t  key2[2] = {0xffffffff, 0xffffffff};
+    uint32_t  correct2[4] = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+    uint32_t  counter3[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    uint32_t  key3[2] = {0xa4093822, 0x299f31d0};
+    uint32_t  correct3[4] = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+    uint32_t  output[4];
+    
+    Philox4x32(counter1, key1, output);
+    for (int i = 0; i < 4; i++)
+      TS_ASSERT_EQUALS(output[i], correct1[i]);
+    Philox4x32(counter2, key2, output);
+    for (int i = 0; i < 4; i++)
+      TS_ASSERT_EQUALS(output[i], correct2[i]);
+    Philox4x32(counter3, key3, output);
+    for (int i = 0; i < 4; i++)
+      TS_ASSERT_EQUALS(output[i], correct3[i]);
+  }
+
+  // Same (seed, stream) must always give the same sequence, regardless of what
+  // other streams were used in between; different streams must differ
+  void testStreamReproducibility( void )
+  {
+    RNGStream  rng1(10, 5);
+    RNGStream  rng2(10, 0);
+    double  first[20];
+    
+    for (int i = 0; i < 20; i++)
+      first[i] = rng1.Uniform();
+    // advance a different stream, then come back to stream 5
+    for (int i = 0; i < 7; i++)
+      rng2.Uniform();
+    rng2.SetStream(5);
+    for (int i = 0; i < 20; i++)
+      TS_ASSERT_EQUALS(rng2.Uniform(), first[i]);
+
+    rng2.SetStream(6);
+    int  nSame = 0;
+    for (int i = 0; i < 20; i++) {
+      if (rng2.Uniform() == first[i])
+        nSame++;
+    }
+    TS_ASSERT_EQUALS(nSame, 0);
+
+    rng2.SetSeed(11, 5);
+    nSame = 0;
+    for (int i = 0; i < 20; i++) {
+      if (rng2.Uniform() == first[i])
+        nSame++;
+    }
+    TS_ASSERT_EQUALS(nSame, 0);
+  }
+
+  // Vector generation must reproduce the scalar sequence exactly, including
+  // when the scalar and vector calls are interleaved
+  void testFillUniformMatchesScalar( void )
+  {
+    RNGStream  rngScalar(12345, 3);
+    RNGStream  rngVector(12345, 3);
+    double  scalarValues[103], vectorValues[103];
+    
+    for (int i = 0; i < 103; i++)
+      scalarValues[i] = rngScalar.Uniform();
+    vectorValues[0] = rngVector.Uniform();
+    rngVector.FillUniform(vectorValues + 1, 51);
+    vectorValues[52] = rngVector.Uniform();
+    rngVector.FillUniform(vectorValues + 53, 50);
+    for (int i = 0; i < 103; i++)
+      TS_ASSERT_EQUALS(vectorValues[i], scalarValues[i]);
+    for (int i = 0; i < 103; i++) {
+      TS_ASSERT(scalarValues[i] >= 0.0);
+      TS_ASSERT(scalarValues[i] < 1.0);
+    }
+  }
+
+  void testFillNormalMatchesScalar( void )
+  {
+    RNGStream  rngScalar(42, 0);
+    RNGStream  rngVector(42, 0);
+    double  scalarValues[41], vectorValues[41];
+    
+    for (int i = 0; i < 41; i++)
+      scalarValues[i] = rngScalar.Normal();
+    vectorValues[0] = rngVector.Normal();
+    rngVector.FillNormal(vectorValues + 1, 20);
+    rngVector.FillNormal(vectorValues + 21, 20);
+    for (int i = 0; i < 41; i++)
+      TS_ASSERT_EQUALS(vectorValues[i], scalarValues[i]);
+  }
+
+  void testDistributionMoments( void )
+  {
+    const long  nVals = 200000;
+    double  *values = new double[nVals];
+    double  sum, sumSq, mean, variance;
+    RNGStream  rng(2718, 1);
+    
+    rng.FillUniform(values, nVals);
+    sum = sumSq = 0.0;
+    for (long i = 0; i < nVals; i++) {
+      sum += values[i];
+      sumSq += values[i]*values[i];
+    }
+    mean = sum/nVals;
+    variance = sumSq/nVals - mean*mean;
+    TS_ASSERT_DELTA(mean, 0.5, 0.005);
+    TS_ASSERT_DELTA(variance, 1.0/12.0, 0.002);
+
+    rng.FillNormal(values, nVals);
+    sum = sumSq = 0.0;
+    for (long i = 0; i < nVals; i++) {
+      sum += values[i];
+      sumSq += values[i]*values[i];
+    }
+    mean = sum/nVals;
+    variance = sumSq/nVals - mean*mean;
+    TS_ASSERT_DELTA(mean, 0.0, 0.01);
+    TS_ASSERT_DELTA(variance, 1.0, 0.01);
+    delete [] values;
+  }
+};